@@ -0,0 +1,136 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pixel_kernels.h"
+#include "status_code.h"
+
+#define LINE_WIDTH (160)
+#define LINES_PER_FRAME (144)
+#define TILE_DATA_SIZE (0x1800)
+#define NUM_FRAMES (2000)
+
+typedef struct
+{
+  pixel_kernels_isa_t isa;
+  const char *name;
+} isa_info_t;
+
+static const isa_info_t isas[] = {
+    {PIXEL_KERNELS_ISA_SCALAR, "scalar"},
+    {PIXEL_KERNELS_ISA_SSE2, "sse2"},
+    {PIXEL_KERNELS_ISA_AVX2, "avx2"},
+};
+
+static const uint8_t palette[4] = {0x0, 0x1, 0x2, 0x3};
+static const uint32_t colors[16] = {
+    0xFFD0FDE0, 0xFF70C088, 0xFF566834, 0xFF201808,
+    0xFFD0FDE0, 0xFF70C088, 0xFF566834, 0xFF201808,
+    0xFFD0FDE0, 0xFF70C088, 0xFF566834, 0xFF201808,
+    0xFFD0FDE0, 0xFF70C088, 0xFF566834, 0xFF201808};
+
+static uint8_t tile_data[TILE_DATA_SIZE];
+static uint8_t indices[LINES_PER_FRAME][LINE_WIDTH];
+static uint8_t frame[LINES_PER_FRAME][LINE_WIDTH];
+static uint32_t rgba_frame[LINES_PER_FRAME][LINE_WIDTH];
+
+static double now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+/** Decode all of the tile data both ways, like a full tile cache rebuild */
+static double bench_decode_tile_rows(uint32_t *const checksum)
+{
+  uint8_t pixels[8];
+  double const start = now_ns();
+
+  for (uint32_t n = 0; n < NUM_FRAMES; n++)
+  {
+    for (uint16_t offset = 0; offset < TILE_DATA_SIZE; offset += 2)
+    {
+      pixel_kernels_decode_tile_row(tile_data[offset], tile_data[offset + 1], false, pixels);
+      *checksum += pixels[n & 0x7];
+      pixel_kernels_decode_tile_row(tile_data[offset], tile_data[offset + 1], true, pixels);
+      *checksum += pixels[n & 0x7];
+    }
+  }
+
+  return (now_ns() - start) / (NUM_FRAMES * (TILE_DATA_SIZE / 2) * 2);
+}
+
+/** Convert full frames of color indices to indexed pixels, one line at a time */
+static double bench_map_palette(uint32_t *const checksum)
+{
+  double const start = now_ns();
+
+  for (uint32_t n = 0; n < NUM_FRAMES; n++)
+  {
+    for (uint8_t ly = 0; ly < LINES_PER_FRAME; ly++)
+    {
+      pixel_kernels_map_palette(indices[ly], palette, frame[ly], LINE_WIDTH);
+    }
+    *checksum += frame[n % LINES_PER_FRAME][n % LINE_WIDTH];
+  }
+
+  return (now_ns() - start) / (NUM_FRAMES * LINES_PER_FRAME);
+}
+
+/** Convert full frames of indexed pixels to RGBA, one line at a time, like presenting them */
+static double bench_expand_pixels(uint32_t *const checksum)
+{
+  double const start = now_ns();
+
+  for (uint32_t n = 0; n < NUM_FRAMES; n++)
+  {
+    for (uint8_t ly = 0; ly < LINES_PER_FRAME; ly++)
+    {
+      pixel_kernels_expand_pixels(frame[ly], colors, rgba_frame[ly], LINE_WIDTH);
+    }
+    *checksum += rgba_frame[n % LINES_PER_FRAME][n % LINE_WIDTH];
+  }
+
+  return (now_ns() - start) / (NUM_FRAMES * LINES_PER_FRAME);
+}
+
+int main(void)
+{
+  srand(0x2BB);
+
+  for (uint16_t i = 0; i < TILE_DATA_SIZE; i++)
+  {
+    tile_data[i] = rand();
+  }
+
+  for (uint8_t ly = 0; ly < LINES_PER_FRAME; ly++)
+  {
+    for (uint8_t x = 0; x < LINE_WIDTH; x++)
+    {
+      indices[ly][x] = rand() & 0x3;
+    }
+  }
+
+  printf("%-8s %16s %16s %16s %10s\n", "kernels", "tile row (ns)", "line (ns)", "expand (ns)", "checksum");
+
+  for (uint8_t i = 0; i < sizeof(isas) / sizeof(isas[0]); i++)
+  {
+    uint32_t checksum = 0;
+
+    if (pixel_kernels_select(isas[i].isa) != STATUS_OK)
+    {
+      printf("%-8s %16s %16s %16s\n", isas[i].name, "unsupported", "unsupported", "unsupported");
+      continue;
+    }
+
+    double const decode_ns = bench_decode_tile_rows(&checksum);
+    double const map_ns = bench_map_palette(&checksum);
+    double const expand_ns = bench_expand_pixels(&checksum);
+
+    printf("%-8s %16.2f %16.2f %16.2f %10u\n", isas[i].name, decode_ns, map_ns, expand_ns, checksum);
+  }
+
+  return 0;
+}
@@ -2,14 +2,23 @@
 #define __DMG_APU_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "apu_pwm.h"
 #include "apu_lfsr.h"
 #include "apu_wave.h"
+#include "blip_buffer.h"
 #include "bus_interface.h"
 #include "callback.h"
+#include "sample_buffer.h"
 #include "status_code.h"
 
+#define APU_CLOCK_HZ (1048576)          /** The APU is ticked once per M-cycle */
+#define APU_DEFAULT_SAMPLE_RATE (44000) /** Output sample rate until one is set with `apu_set_sample_rate` */
+#define APU_MAX_SAMPLE_RATE (192000)
+#define APU_CHANNEL_COUNT (4)
+#define APU_MAX_OUTPUT_FRAMES (1024) /** Most frames written to each track between two calls of the output callback */
+
 typedef enum
 {
   APU_ACTL_CH1_EN = (1 << 0),
@@ -52,6 +61,35 @@ typedef struct
   uint8_t frame_step;
 } apu_frame_sequencer_counter_t;
 
+/**
+ * One output track: a pair of blip buffers synthesizing the left and right sides, and the frames
+ * read out of them waiting to be consumed.
+ */
+typedef struct
+{
+  sample_buffer_t sample_buffer; /** Mixed frames waiting to be consumed */
+  blip_buffer_t left;            /** Band-limited synthesis of the left side */
+  blip_buffer_t right;           /** Band-limited synthesis of the right side */
+  int32_t left_level;            /** Level last fed to the left blip buffer */
+  int32_t right_level;           /** Level last fed to the right blip buffer */
+} apu_output_track_t;
+
+/**
+ * Output stage of the APU. Whenever the level of either side of a track changes, the change is fed to
+ * that side's blip buffer at the tick it happens on. The output frames are read out of the blip
+ * buffers as the APU is advanced, and handed to the audio device.
+ */
+typedef struct
+{
+  apu_output_track_t mix;                       /** All channels mixed together, as heard */
+  apu_output_track_t channels[APU_CHANNEL_COUNT]; /** Each channel on its own, only synthesized when enabled */
+  bool channel_tracks_enabled;                  /** Whether the per-channel tracks are synthesized */
+  callback_t output_callback;                   /** Optional callback for when new frames have been written */
+  uint32_t sample_rate_hz;                      /** Output sample rate */
+  int32_t rate_adjust_ppm;                      /** Deviation of the actual output rate from the sample rate */
+  uint32_t frame_ticks;                         /** Ticks synthesized since the output frame was last ended */
+} apu_output_t;
+
 typedef struct
 {
   apu_registers_t registers;
@@ -61,10 +99,86 @@ typedef struct
   apu_lfsr_handle_t ch4;
   apu_frame_sequencer_counter_t frame_sequencer;
   bus_interface_t bus_interface;
-  callback_t playback_cb;
+  apu_output_t output;
 } apu_handle_t;
 
 status_code_t apu_init(apu_handle_t *const apu);
-status_code_t apu_tick(apu_handle_t *const apu);
+
+/**
+ * Advance the APU in lockstep with the CPU, writing the output frames it covers to the sample buffer.
+ * The channels are only stepped when their amplitude may change, rather than on every tick.
+ * Must be called from the same thread that accesses the APU registers.
+ *
+ * @param apu Pointer to an APU object
+ * @param m_cycles Number of M-cycles to advance by
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_advance(apu_handle_t *const apu, uint32_t const m_cycles);
+
+/**
+ * Advance the APU like `apu_advance`, but only hand over the output on frame sequencer steps rather than
+ * at the end of every call. Meant for advancing the APU in many short stretches, e.g. to each of its
+ * events, where ending an output frame every time would cost more than the synthesis itself.
+ *
+ * @param apu Pointer to an APU object
+ * @param m_cycles Number of M-cycles to advance by
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_catch_up(apu_handle_t *const apu, uint32_t const m_cycles);
+
+/**
+ * Number of M-cycles until the APU's output may next change: the next frame sequencer step, or the
+ * next step of an audible channel
+ */
+uint32_t apu_m_cycles_until_event(apu_handle_t const *const apu);
+
+/**
+ * Set the rate of the output frames, to match the audio device
+ *
+ * @param apu Pointer to an APU object
+ * @param sample_rate_hz Output sample rate, no higher than `APU_MAX_SAMPLE_RATE`
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_set_sample_rate(apu_handle_t *const apu, uint32_t const sample_rate_hz);
+
+/**
+ * Fine-tune the number of frames produced per emulated second, so that a rate controller can make up
+ * for the audio device's clock running slightly faster or slower than its nominal sample rate.
+ * Takes effect from the next frame on, without discarding any output.
+ *
+ * @param apu Pointer to an APU object
+ * @param adjust_ppm Deviation from the sample rate in parts per million, within `BLIP_MAX_RATE_ADJUST_PPM`
+ *                   either way. Positive values produce more frames.
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_set_rate_adjust(apu_handle_t *const apu, int32_t const adjust_ppm);
+
+/**
+ * Start or stop synthesizing each channel on its own track, alongside the mix. Each channel's track
+ * carries its contribution to the mix, with panning and master volume applied. The tracks start
+ * from silence whenever they're enabled.
+ *
+ * @param apu Pointer to an APU object
+ * @param enabled Whether to synthesize the per-channel tracks
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_set_channel_tracks_enabled(apu_handle_t *const apu, bool const enabled);
+
+/**
+ * Register a callback to be called on the emulation thread whenever new frames have been written to the
+ * output tracks. The callback may block to hold the emulation back; as long as every track has room for
+ * `APU_MAX_OUTPUT_FRAMES` more frames when it returns, no frame is dropped before the next call.
+ *
+ * @param apu Pointer to an APU object
+ * @param output_callback Pointer to the callback, copied into the APU
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_register_output_callback(apu_handle_t *const apu, callback_t *const output_callback);
 
 #endif /* __DMG_APU_H__ */
@@ -41,9 +41,35 @@ typedef struct
 } apu_lfsr_handle_t;
 
 status_code_t apu_lfsr_init(apu_lfsr_handle_t *const apu_lfsr);
-status_code_t apu_lfsr_tick(apu_lfsr_handle_t *const apu_lfsr);
+
+/**
+ * Advance the channel's period counter, shifting the LFSR as many times as it runs out
+ *
+ * @param apu_lfsr Pointer to a noise channel object
+ * @param ticks Number of APU ticks to advance by
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_lfsr_advance(apu_lfsr_handle_t *const apu_lfsr, uint32_t const ticks);
+
+/**
+ * @param apu_lfsr Pointer to a noise channel object
+ *
+ * @return Number of APU ticks until the LFSR shifts, and the channel's amplitude may change
+ */
+uint32_t apu_lfsr_ticks_until_step(apu_lfsr_handle_t const *const apu_lfsr);
+
 status_code_t apu_lfsr_reset(apu_lfsr_handle_t *const apu_lfsr);
-status_code_t apu_lfsr_sample(apu_lfsr_handle_t *const apu_lfsr, float *const sample_out);
+
+/**
+ * Get the current input to the channel's DAC
+ *
+ * @param apu_lfsr Pointer to a noise channel object
+ * @param sample_out Pointer to store the DAC input to, between 0 and 15
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_lfsr_sample(apu_lfsr_handle_t *const apu_lfsr, uint8_t *const sample_out);
 status_code_t apu_lfsr_handle_frame_sequencer(apu_lfsr_handle_t *const apu_lfsr, uint8_t const frame_step);
 
 #endif /* __DMG_APU_LFSR_H__ */
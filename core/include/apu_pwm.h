@@ -61,9 +61,35 @@ typedef struct
 } apu_pwm_handle_t;
 
 status_code_t apu_pwm_init(apu_pwm_handle_t *const apu_pwm, bool const with_sweep);
-status_code_t apu_pwm_tick(apu_pwm_handle_t *const apu_pwm);
+
+/**
+ * Advance the channel's period counter, stepping through the duty cycle as many times as it runs out
+ *
+ * @param apu_pwm Pointer to a PWM channel object
+ * @param ticks Number of APU ticks to advance by
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_pwm_advance(apu_pwm_handle_t *const apu_pwm, uint32_t const ticks);
+
+/**
+ * @param apu_pwm Pointer to a PWM channel object
+ *
+ * @return Number of APU ticks until the duty cycle steps, and the channel's amplitude may change
+ */
+uint32_t apu_pwm_ticks_until_step(apu_pwm_handle_t const *const apu_pwm);
+
 status_code_t apu_pwm_reset(apu_pwm_handle_t *const apu_pwm);
-status_code_t apu_pwm_sample(apu_pwm_handle_t *const apu_pwm, float *const sample_out);
+
+/**
+ * Get the current input to the channel's DAC
+ *
+ * @param apu_pwm Pointer to a PWM channel object
+ * @param sample_out Pointer to store the DAC input to, between 0 and 15
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_pwm_sample(apu_pwm_handle_t *const apu_pwm, uint8_t *const sample_out);
 status_code_t apu_pwm_handle_frame_sequencer(apu_pwm_handle_t *const apu_pwm, uint8_t const frame_step);
 
 #endif /* __DMG_APU_PWM_H__ */
@@ -56,9 +56,35 @@ typedef struct
 } apu_wave_handle_t;
 
 status_code_t apu_wave_init(apu_wave_handle_t *const apu_wave);
-status_code_t apu_wave_tick(apu_wave_handle_t *const apu_wave);
+
+/**
+ * Advance the channel's period timer, stepping through the wave RAM as many times as it runs out
+ *
+ * @param apu_wave Pointer to a wave channel object
+ * @param ticks Number of APU ticks to advance by
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_wave_advance(apu_wave_handle_t *const apu_wave, uint32_t const ticks);
+
+/**
+ * @param apu_wave Pointer to a wave channel object
+ *
+ * @return Number of APU ticks until the next wave sample is played, and the channel's amplitude may change
+ */
+uint32_t apu_wave_ticks_until_step(apu_wave_handle_t const *const apu_wave);
+
 status_code_t apu_wave_reset(apu_wave_handle_t *const apu_wave);
-status_code_t apu_wave_sample(apu_wave_handle_t *const apu_wave, float *const sample_out);
+
+/**
+ * Get the current input to the channel's DAC
+ *
+ * @param apu_wave Pointer to a wave channel object
+ * @param sample_out Pointer to store the DAC input to, between 0 and 15
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t apu_wave_sample(apu_wave_handle_t *const apu_wave, uint8_t *const sample_out);
 status_code_t apu_wave_handle_frame_sequencer(apu_wave_handle_t *const apu_wave, uint8_t const frame_step);
 
 #endif /*  __DMG_APU_WAVE_H__ */
@@ -0,0 +1,61 @@
+#ifndef __DMG_AUDIO_PACER_H__
+#define __DMG_AUDIO_PACER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "status_code.h"
+
+#define AUDIO_PACER_MAX_RATE_ADJUST_PPM (5000) /** Largest deviation the rate controller applies, well below audible pitch */
+
+/**
+ * Decides how long to hold the emulation back so that it keeps in step with the audio device, and how
+ * much faster the APU has to produce frames to make up for the emulation falling behind. It only works
+ * on fill levels of the sample buffer, so the waiting itself is left to the caller.
+ *
+ * The device drains the buffer a whole device buffer at a time, so after waiting the fill level sits
+ * between the target and one device buffer below it. It only drops further when the emulation fell
+ * behind, and then the rate adjustment grows in proportion to the shortfall, so the buffer recovers
+ * before it runs dry. The adjustment is smoothed so that it eases back to the nominal rate rather than
+ * jumping.
+ */
+typedef struct
+{
+  uint32_t device_buffer_frames;   /** Number of frames the device asks for at once; 0 if there's no device to pace with */
+  uint32_t target_buffered_frames; /** Fill level the sample buffer is kept at, two device buffers */
+  int32_t rate_adjust_ppm;         /** Deviation of the APU output rate from the nominal rate */
+} audio_pacer_t;
+
+/**
+ * Initialize an audio pacer
+ *
+ * @param pacer Pointer to an audio pacer object to initialize
+ * @param device_buffer_frames Number of frames the device asks for at once, or 0 if no audio device is
+ *                             available, in which case frames are never paced by the audio
+ *
+ * @return `STATUS_OK` if initialization is successful, otherwise appropriate error code.
+ */
+status_code_t audio_pacer_init(audio_pacer_t *const pacer, uint32_t const device_buffer_frames);
+
+/**
+ * @param pacer Pointer to an audio pacer object
+ * @param buffered_frames Number of frames in the sample buffer
+ *
+ * @return Whether the emulation has to wait for the device to drain the sample buffer before the next
+ *         frame is due; never without a device.
+ */
+bool audio_pacer_must_wait(audio_pacer_t const *const pacer, uint32_t const buffered_frames);
+
+/**
+ * Work out the rate adjustment once the emulation no longer has to wait for the device
+ *
+ * @param pacer Pointer to an audio pacer object
+ * @param buffered_frames Number of frames left in the sample buffer after waiting
+ * @param paced Set if the frame has been paced by the audio, or cleared if there's no device, in which
+ *              case the frame has to be paced some other way and the nominal rate is used
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t audio_pacer_update(audio_pacer_t *const pacer, uint32_t const buffered_frames, bool *const paced);
+
+#endif /* __DMG_AUDIO_PACER_H__ */
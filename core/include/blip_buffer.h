@@ -0,0 +1,95 @@
+#ifndef __DMG_BLIP_BUFFER_H__
+#define __DMG_BLIP_BUFFER_H__
+
+#include <stdint.h>
+
+#include "status_code.h"
+
+#define BLIP_BUFFER_SIZE (1024)  /** Number of output samples that can be pending at once */
+#define BLIP_KERNEL_WIDTH (16)   /** Number of output samples each step is spread over */
+#define BLIP_TIME_BITS (32)      /** Fractional bits of positions in output samples */
+#define BLIP_MAX_RATE_ADJUST_PPM (10000)
+
+/**
+ * Band-limited step synthesizer.
+ *
+ * Rather than being point sampled, a waveform is described by the changes in its amplitude, each at
+ * the input clock cycle it happens on. Each change is spread over the neighboring output samples by a
+ * band-limited kernel, picked by where the change falls between two samples, and the output samples
+ * are recovered by summing up the changes. Square waves come out without aliasing, and the cost scales
+ * with the number of changes rather than with the input clock rate.
+ *
+ * Time is split into frames. Changes are added relative to the start of the current frame, and the
+ * samples a frame covers become available once it's ended. The ratio between the clock and the output
+ * sample rate is kept with 32 fractional bits, so any pair of rates is resampled without drift, and it
+ * can be nudged between frames to keep up with an output device whose clock doesn't quite match.
+ */
+typedef struct
+{
+  uint64_t nominal_factor;                              /** Output samples per input clock cycle, with `BLIP_TIME_BITS` fractional bits */
+  uint64_t factor;                                      /** Nominal factor with the rate adjustment applied */
+  uint64_t offset;                                      /** Position of the start of the current frame, in the same format */
+  int32_t integrator;                                   /** Running sum of the amplitude changes read so far */
+  int32_t deltas[BLIP_BUFFER_SIZE + BLIP_KERNEL_WIDTH]; /** Amplitude changes spread over each output sample */
+} blip_buffer_t;
+
+/**
+ * Clear the buffer and set up the conversion between the input clock and the output sample rate
+ *
+ * @param blip_buffer Pointer to a blip buffer object to initialize
+ * @param clock_rate_hz Rate of the clock amplitude changes are timed with
+ * @param sample_rate_hz Output sample rate, no higher than the clock rate
+ *
+ * @return `STATUS_OK` if initialization is successful, otherwise appropriate error code.
+ */
+status_code_t blip_buffer_init(blip_buffer_t *const blip_buffer, uint32_t const clock_rate_hz, uint32_t const sample_rate_hz);
+
+/**
+ * Stretch or shrink the output relative to the nominal sample rate, without disturbing the samples
+ * already pending. Meant to be driven by a rate controller, so the adjustment is kept small.
+ *
+ * @param blip_buffer Pointer to a blip buffer object
+ * @param adjust_ppm Change in the number of samples per clock cycle, in parts per million, within
+ *                   `BLIP_MAX_RATE_ADJUST_PPM` either way. Positive values produce more samples.
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t blip_buffer_set_rate_adjust(blip_buffer_t *const blip_buffer, int32_t const adjust_ppm);
+
+/**
+ * Add a change in amplitude. The samples it affects must fit in the buffer, so frames have to be ended
+ * and their samples read out often enough.
+ *
+ * @param blip_buffer Pointer to a blip buffer object
+ * @param time Clock cycle the change happens on, relative to the start of the current frame
+ * @param delta Change in amplitude
+ */
+void blip_buffer_add_delta(blip_buffer_t *const blip_buffer, uint32_t const time, int32_t const delta);
+
+/**
+ * End the current frame, making the samples it covers available to read. The next frame starts where it ended.
+ *
+ * @param blip_buffer Pointer to a blip buffer object
+ * @param duration Length of the frame in clock cycles
+ */
+void blip_buffer_end_frame(blip_buffer_t *const blip_buffer, uint32_t const duration);
+
+/**
+ * @param blip_buffer Pointer to a blip buffer object
+ *
+ * @return The number of samples that can be read
+ */
+uint32_t blip_buffer_samples_avail(blip_buffer_t const *const blip_buffer);
+
+/**
+ * Take the oldest available samples off the buffer. The output is high-pass filtered to remove DC offset.
+ *
+ * @param blip_buffer Pointer to a blip buffer object
+ * @param samples Buffer to store the samples
+ * @param count Maximum number of samples to take
+ *
+ * @return The number of samples actually taken
+ */
+uint32_t blip_buffer_read_samples(blip_buffer_t *const blip_buffer, int16_t *const samples, uint32_t const count);
+
+#endif /* __DMG_BLIP_BUFFER_H__ */
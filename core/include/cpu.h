@@ -75,16 +75,45 @@ typedef struct cpu_state_s
   callback_t interrupt_callback;
   bus_interface_t bus_interface;
   callback_t *cycle_sync_callback;
+  callback_t *halt_wake_callback;
   uint8_t current_inst_m_cycle_count; // TODO: find more elegant solution
+  uint8_t exit_requested;
+  uint8_t batched_sync;
+  uint32_t owed_m_cycles;
+  uint32_t cycle_budget;
 } cpu_state_t;
 
 typedef struct
 {
   bus_interface_t *bus_interface;
   callback_t *cycle_sync_callback;
+
+  /**
+   * Optional. Called while the CPU is halted with a pointer to a `uint32_t` that the
+   * callback sets to the number of M-cycles until the earliest device event that may
+   * raise an interrupt. The CPU then skips those cycles in a single sync step.
+   */
+  callback_t *halt_wake_callback;
 } cpu_init_param_t;
 
 status_code_t cpu_init(cpu_state_t *const state, cpu_init_param_t *const param);
 status_code_t cpu_emulation_cycle(cpu_state_t *const state);
 
+/**
+ * Run instructions back-to-back with the threaded interpreter until an exit is requested
+ * with cpu_request_exit() (typically from the cycle sync callback), the CPU is stopped,
+ * or an error occurs.
+ */
+status_code_t cpu_run_threaded(cpu_state_t *const state);
+void cpu_request_exit(cpu_state_t *const state);
+
+/**
+ * Run the CPU with the threaded interpreter for at least `budget` M-cycles. Instead of invoking
+ * the cycle sync callback on every bus access, owed cycles are accumulated and devices are caught
+ * up only when the CPU accesses VRAM, OAM, the I/O registers, or the IE register, and once more
+ * when the budget is used up. Interrupts raised by devices are seen with up to `budget` M-cycles
+ * of latency.
+ */
+status_code_t cpu_run_cycles(cpu_state_t *const state, uint32_t const budget);
+
 #endif /* __DMG_CPU_H__ */
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "bus_interface.h"
+#include "memory_map.h"
 #include "status_code.h"
 
 typedef enum
@@ -28,6 +29,7 @@ typedef struct
 typedef struct
 {
   data_bus_segment_t segments[MAX_SEGMENT_TYPE];
+  memory_map_t memory_map;
   bus_interface_t bus_interface;
 } data_bus_handle_t;
 
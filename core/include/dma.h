@@ -25,4 +25,14 @@ status_code_t dma_init(dma_handle_t *const handle, bus_interface_t const bus_int
 status_code_t dma_tick(dma_handle_t *const handle);
 status_code_t dma_start(dma_handle_t *const handle, uint8_t const offset);
 
+/**
+ * Advance the DMA by the given number of M-cycles
+ */
+status_code_t dma_advance(dma_handle_t *const handle, uint32_t const m_cycles);
+
+/**
+ * Number of M-cycles until the DMA transfers its next byte, or UINT32_MAX if the DMA is idle
+ */
+uint32_t dma_m_cycles_until_event(dma_handle_t const *const handle);
+
 #endif /* __DMG_DMA_H__ */
@@ -14,14 +14,29 @@
 #include "ppu.h"
 #include "apu.h"
 #include "timer.h"
+#include "scheduler.h"
+#include "bus_interface.h"
 #include "status_code.h"
 #include "callback.h"
 
+/* Number of M-cycles the CPU runs ahead of the devices in batched timing mode (one scanline) */
+#define EMULATOR_BATCH_M_CYCLES (114)
+
 typedef enum {
   EMU_MODE_RUNNING,
   EMU_MODE_STOPPED,
 } emulator_state_t;
 
+typedef enum {
+  CPU_EXEC_MODE_STEP,
+  CPU_EXEC_MODE_THREADED,
+} cpu_exec_mode_t;
+
+typedef enum {
+  TIMING_MODE_PER_ACCESS,
+  TIMING_MODE_BATCHED,
+} timing_mode_t;
+
 typedef struct
 {
   cpu_state_t cpu_state;
@@ -35,7 +50,15 @@ typedef struct
   mbc_handle_t mbc;
   joypad_handle_t joypad;
   callback_t cycle_sync_callback;
+  callback_t halt_wake_callback;
+  bus_interface_t io_bus_interface;
+  scheduler_t scheduler;
+  callback_t device_event_callbacks[SCHEDULER_EVENT_COUNT];
+  uint64_t device_cycles[SCHEDULER_EVENT_COUNT];
+  uint64_t master_cycles;
   emulator_state_t state;
+  cpu_exec_mode_t cpu_exec_mode;
+  timing_mode_t timing_mode;
   uint32_t prev_frame_count;
 } emulator_t;
 
@@ -45,4 +68,16 @@ status_code_t emulator_run_frame(emulator_t *const emulator);
 void emulator_stop(emulator_t *const emulator);
 status_code_t emulator_cleanup(emulator_t *const emulator);
 
+/**
+ * Bring every device up to the current master cycle count and re-evaluate all of their events.
+ * Devices are otherwise only advanced when their events fire or their registers are accessed,
+ * so this must be called before reading device state from outside of the emulation, and again
+ * after changing it (e.g. when saving or loading a snapshot).
+ *
+ * @param emulator Pointer to the emulator object
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t emulator_sync_devices(emulator_t *const emulator);
+
 #endif /* __DMG_EMULATOR_H__ */
@@ -0,0 +1,122 @@
+#ifndef __DMG_FRAME_BUFFER_H__
+#define __DMG_FRAME_BUFFER_H__
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "callback.h"
+#include "lcd.h"
+#include "status_code.h"
+
+#define FRAME_BUFFER_COUNT (3)
+
+/**
+ * Rendered pixels as indexed values (see `LCD_PIXEL_PALETTE_SHIFT`), a quarter of the size of RGBA.
+ * They're converted to RGBA with `pixel_kernels_expand_pixels` when the frame is presented.
+ */
+typedef union
+{
+  uint8_t matrix[SCREEN_HEIGHT][SCREEN_WIDTH];
+  uint8_t buffer[SCREEN_HEIGHT * SCREEN_WIDTH];
+} video_buffer_t;
+
+/**
+ * A video buffer along with a hash of each of its lines, so that the lines that differ
+ * between two frames can be found without comparing the pixels
+ */
+typedef struct
+{
+  video_buffer_t video_buffer;
+  uint64_t line_hashes[SCREEN_HEIGHT];
+} frame_t;
+
+/**
+ * Triple buffer to hand complete frames from the emulation thread over to the display thread.
+ *
+ * The PPU draws into the back buffer and publishes it once the frame is complete, which swaps it
+ * with the latest buffer. The display acquires the latest buffer by swapping it with the front buffer.
+ * Neither side ever waits for the other, and a buffer is never written while it's being presented.
+ */
+typedef struct
+{
+  frame_t frames[FRAME_BUFFER_COUNT]; /** Underlying frame storage */
+  uint8_t back;                       /** Index of the buffer being drawn; only used by the producer */
+  uint8_t front;                      /** Index of the buffer being presented; only used by the consumer */
+  _Atomic uint8_t latest;             /** Index of the latest complete frame, with `FRAME_BUFFER_FRESH` set until it's acquired */
+  callback_t frame_ready_callback;    /** (Optional) Called by the producer after publishing a frame */
+} frame_buffer_t;
+
+/**
+ * Clear all of the buffers and reset the buffer indices
+ *
+ * @param frame_buffer Pointer to a frame buffer object to initialize
+ *
+ * @return `STATUS_OK` if initialization is successful, otherwise appropriate error code.
+ */
+status_code_t frame_buffer_init(frame_buffer_t *const frame_buffer);
+
+/**
+ * Register a callback to be notified whenever a frame is published. The callback is called on the
+ * producer thread with a pointer to the frame buffer object as its argument.
+ *
+ * @param frame_buffer Pointer to a frame buffer object
+ * @param frame_ready_callback Pointer to the callback to register
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t frame_buffer_register_ready_callback(frame_buffer_t *const frame_buffer, callback_t *const frame_ready_callback);
+
+/**
+ * Mark the back buffer as the latest complete frame, and take over the previous latest buffer to draw the next frame
+ *
+ * @param frame_buffer Pointer to a frame buffer object
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t frame_buffer_publish(frame_buffer_t *const frame_buffer);
+
+/**
+ * Update the hash of a line of the back buffer. To be called once the line has been drawn.
+ *
+ * @param frame_buffer Pointer to a frame buffer object
+ * @param line_y The line that has been drawn
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t frame_buffer_hash_line(frame_buffer_t *const frame_buffer, uint8_t const line_y);
+
+/**
+ * Take the latest complete frame to be presented. The frame stays valid until the next call to this function.
+ *
+ * @param frame_buffer Pointer to a frame buffer object
+ *
+ * @return Pointer to the latest frame, or NULL if no frame has been published since the last call.
+ */
+frame_t const *frame_buffer_acquire(frame_buffer_t *const frame_buffer);
+
+/**
+ * Find the next run of consecutive lines of a frame whose hashes differ from those of the lines
+ * currently presented, so that each run can be uploaded in one go
+ *
+ * @param frame Pointer to the frame to present
+ * @param line_hashes Hashes of the lines currently presented, or NULL if nothing has been presented yet, in which case every line has changed
+ * @param start_line Line to start looking from
+ * @param first_line Set to the first line of the run, or `SCREEN_HEIGHT` if no line from `start_line` on has changed
+ * @param line_count Set to the number of lines in the run, or 0 if no line from `start_line` on has changed
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t frame_buffer_find_changed_lines(frame_t const *const frame, uint64_t const *const line_hashes, uint16_t const start_line,
+                                              uint16_t *const first_line, uint16_t *const line_count);
+
+/**
+ * @param frame_buffer Pointer to a frame buffer object
+ *
+ * @return Pointer to the buffer the producer is drawing into
+ */
+static inline video_buffer_t *frame_buffer_back(frame_buffer_t *const frame_buffer)
+{
+  return &frame_buffer->frames[frame_buffer->back].video_buffer;
+}
+
+#endif /* __DMG_FRAME_BUFFER_H__ */
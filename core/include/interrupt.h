@@ -40,6 +40,13 @@ typedef struct
 
 status_code_t interrupt_init(interrupt_handle_t *const interrupt, callback_t *const interrupt_cb);
 bool has_pending_interrupts(interrupt_handle_t *const interrupt);
+
+/**
+ * @param interrupt Pointer to an interrupt handle
+ *
+ * @return Whether any interrupt is both requested and enabled, i.e. would be serviced by `service_interrupt` with IME set
+ */
+bool has_serviceable_interrupts(interrupt_handle_t *const interrupt);
 bool interrupt_globally_enabled(interrupt_handle_t *const interrupt);
 status_code_t global_interrupt_enable(interrupt_handle_t *const interrupt, bool enable);
 
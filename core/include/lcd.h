@@ -10,6 +10,18 @@
 #define SCREEN_WIDTH (160)
 #define SCREEN_HEIGHT (144)
 
+#define LCD_NUM_PALETTES (3)
+#define LCD_COLORS_PER_PALETTE (4)
+
+/**
+ * Rendered pixels are stored as indexed values rather than RGBA: bits 0-1 hold the shade the palette
+ * mapped the color index to, and bits 2-3 hold the palette type. They're converted to RGBA once the
+ * frame is presented, through a table of `LCD_NUM_PIXEL_VALUES` colors.
+ */
+#define LCD_PIXEL_SHADE_MASK (0x3)
+#define LCD_PIXEL_PALETTE_SHIFT (2)
+#define LCD_NUM_PIXEL_VALUES (16)
+
 /**
  * LCD status register bit field definitions
  */
@@ -88,8 +100,9 @@ typedef union
  */
 typedef struct
 {
-  lcd_registers_t registers;     /** LCD registers */
-  bus_interface_t bus_interface; /** Interface to allow the data bus to write to and read from LCD registers */
+  lcd_registers_t registers;                                         /** LCD registers */
+  bus_interface_t bus_interface;                                     /** Interface to allow the data bus to write to and read from LCD registers */
+  uint8_t palette_pixels[LCD_NUM_PALETTES][LCD_COLORS_PER_PALETTE]; /** Indexed pixel values of the colors of BGP, OBP-0, and OBP-1; rebuilt when those registers change */
 } lcd_handle_t;
 
 /**
@@ -114,6 +127,40 @@ status_code_t lcd_init(lcd_handle_t *const handle);
  */
 status_code_t lcd_get_palette_color(lcd_handle_t *const handle, palette_type_t const palette_type, uint8_t const color_index, color_rgba_t *const color);
 
+/**
+ * Get the colors of all of the indexed pixel values, to convert rendered pixels to RGBA
+ *
+ * @param colors Buffer of `LCD_NUM_PIXEL_VALUES` entries to store the colors as `color_rgba_t` hex values
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t lcd_get_pixel_colors(uint32_t *const colors);
+
+/**
+ * Rebuild the palette lookup tables from the BGP, OBP-0, and OBP-1 registers.
+ * Writes through the bus interface do this automatically; call this after modifying the registers directly.
+ *
+ * @param handle Pointer to an LCD handle object
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t lcd_update_palettes(lcd_handle_t *const handle);
+
+/**
+ * Look up the indexed pixel value of one of the colors of one of the palettes without any argument checks.
+ * This is meant for the rendering hot paths.
+ *
+ * @param handle Pointer to an LCD handle object storing the palette data
+ * @param palette_type Specifies which palette to use (BG palette, OBP-0, or OBP-1)
+ * @param color_index Specifies which one of the 4 colors in the palette to choose (0-3)
+ *
+ * @return The indexed pixel value, see `LCD_PIXEL_PALETTE_SHIFT`
+ */
+static inline uint8_t lcd_palette_pixel(lcd_handle_t const *const handle, palette_type_t const palette_type, uint8_t const color_index)
+{
+  return handle->palette_pixels[palette_type][color_index & 0x3];
+}
+
 /**
  * Get the base address of background tile map
  *
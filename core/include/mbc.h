@@ -5,6 +5,7 @@
 #include <stdbool.h>
 
 #include "bus_interface.h"
+#include "memory_map.h"
 #include "rom.h"
 #include "rtc.h"
 #include "status_code.h"
@@ -79,11 +80,13 @@ typedef struct
   mbc_flags_t flags;
   bus_interface_t bus_interface;
   mbc_callbacks_t callbacks;
+  memory_map_t *memory_map;
 } mbc_handle_t;
 
 status_code_t mbc_init(mbc_handle_t *const mbc);
 status_code_t mbc_load_rom(mbc_handle_t *const mbc, uint8_t *const rom_data, const size_t size);
 status_code_t mbc_register_callbacks(mbc_handle_t *const mbc, mbc_callbacks_t *const callbacks);
+status_code_t mbc_attach_memory_map(mbc_handle_t *const mbc, memory_map_t *const memory_map);
 status_code_t mbc_cleanup(mbc_handle_t *const mbc);
 status_code_t mbc_save_game(mbc_handle_t *const mbc);
 status_code_t mbc_load_saved_game(mbc_handle_t *const mbc);
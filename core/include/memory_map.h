@@ -0,0 +1,46 @@
+#ifndef __DMG_MEMORY_MAP_H__
+#define __DMG_MEMORY_MAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MEMORY_MAP_PAGE_SHIFT (8)
+#define MEMORY_MAP_PAGE_SIZE (1 << MEMORY_MAP_PAGE_SHIFT)
+#define MEMORY_MAP_PAGE_MASK (MEMORY_MAP_PAGE_SIZE - 1)
+#define MEMORY_MAP_NUM_PAGES (0x10000 >> MEMORY_MAP_PAGE_SHIFT)
+
+/**
+ * Page table translating each 256-byte page of the CPU address space directly into host memory.
+ * A NULL entry means accesses to that page have side effects (or are not plain memory) and must
+ * be routed through the data bus segment handlers instead.
+ *
+ * High RAM (0xFF80 - 0xFFFE) shares page 0xFF with the I/O registers and the IE register, so it
+ * is mapped through a dedicated pointer rather than a page entry.
+ */
+typedef struct
+{
+  uint8_t *read[MEMORY_MAP_NUM_PAGES];
+  uint8_t *write[MEMORY_MAP_NUM_PAGES];
+  uint8_t *hram;
+} memory_map_t;
+
+/**
+ * Point the pages covering [address, address + size) to the given host buffers.
+ * Passing NULL for either buffer routes that access type through the bus handlers.
+ */
+static inline void memory_map_set_pages(
+    memory_map_t *const map,
+    uint16_t const address,
+    uint32_t const size,
+    uint8_t *const read_buf,
+    uint8_t *const write_buf)
+{
+  for (uint32_t offset = 0; offset < size; offset += MEMORY_MAP_PAGE_SIZE)
+  {
+    uint8_t const page = (uint8_t)((address + offset) >> MEMORY_MAP_PAGE_SHIFT);
+    map->read[page] = read_buf ? &read_buf[offset] : NULL;
+    map->write[page] = write_buf ? &write_buf[offset] : NULL;
+  }
+}
+
+#endif /* __DMG_MEMORY_MAP_H__ */
@@ -2,11 +2,13 @@
 #define __DMG_OAM_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "bus_interface.h"
 #include "status_code.h"
 
 #define OAM_ENTRY_SIZE (40)
 #define MAX_SPRITES_PER_LINE (10)
+#define OAM_INDEXED_LINES (144) /** Number of visible scanlines covered by the OAM scan index */
 
 /**
  * OAM attribute bit field
@@ -47,6 +49,17 @@ typedef struct
   oam_entry_t sprite_attributes[MAX_SPRITES_PER_LINE]; /** Copies of collected sprite data */
 } oam_scanned_sprites_t;
 
+/**
+ * Per-scanline lookup table of the sprites an OAM scan would collect, built at most once per frame
+ */
+typedef struct
+{
+  uint8_t sprite_count[OAM_INDEXED_LINES];                        /** Number of sprites on each scanline */
+  uint8_t sprite_index[OAM_INDEXED_LINES][MAX_SPRITES_PER_LINE]; /** OAM indices of the sprites on each scanline, in priority order */
+  obj_size_t sprite_size;                                         /** Sprite height the index was built for */
+  bool dirty;                                                     /** Indicates that OAM has changed since the index was built */
+} oam_scan_index_t;
+
 /**
  * Top-level OAM data structure definition
  */
@@ -58,6 +71,7 @@ typedef struct
     uint8_t oam_buf[sizeof(oam_entry_t) * OAM_ENTRY_SIZE]; /** OAM entry data store as byte array */
   };
   bus_interface_t bus_interface; /** Interface to allow the data bus to write to and read from the OAM */
+  oam_scan_index_t scan_index;   /** Sprites on each scanline, rebuilt at the start of a frame if OAM has changed */
 } oam_handle_t;
 
 /**
@@ -74,6 +88,9 @@ status_code_t oam_init(oam_handle_t *const oam_handle);
  * This function is to be called during mode 2 (OAM scan) of PPU rendering.
  * Sprites returned by this function are sorted by their X coordinate in ascending order.
  *
+ * If OAM has changed, the scan index is rebuilt when line 0 is scanned; the rest of the frame is then
+ * a lookup. Lines scanned after a mid-frame OAM change fall back to a full scan until the next frame.
+ *
  * @param oam_handle Pointer to the OAM object to scan the sprites from
  * @param line_y Current scanline y-coordinate, the same as the current value of the LCD register LY
  * @param sprite_size Indicates whether the sprite is 8 pixels or 16 pixels tall, as determined by bit-2 of the LCDC register
@@ -83,4 +100,14 @@ status_code_t oam_init(oam_handle_t *const oam_handle);
  */
 status_code_t oam_scan(oam_handle_t *const oam_handle, uint8_t const line_y, obj_size_t const sprite_size, oam_scanned_sprites_t *const scan_results);
 
+/**
+ * Mark the OAM scan index as out of date. Writes through the bus interface do this automatically;
+ * call this after modifying the OAM entries directly.
+ *
+ * @param oam_handle Pointer to the OAM object
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t oam_invalidate_scan_index(oam_handle_t *const oam_handle);
+
 #endif /* __DMG_OAM_H__ */
@@ -7,30 +7,32 @@
 #include "lcd.h"
 #include "oam.h"
 #include "status_code.h"
-
-#define MAX_FETCHED_SPRITES (10)
+#include "tile_cache.h"
 
 typedef struct
 {
   uint8_t tile_num;
   uint8_t tile_data_low;
   uint8_t tile_data_high;
+  uint8_t pixels[TILE_CACHE_TILE_SIZE];
 } fetched_bgw_tile_t;
 
+/**
+ * The sprite pixel that ends up on top at a given X coordinate of the current scanline
+ */
 typedef struct
 {
-  oam_entry_t tile_entry;
-  uint8_t tile_data_low;
-  uint8_t tile_data_high;
-} fetched_sprite_tile_t;
+  uint8_t pixel_color;    /** Sprite pixel color value between 0 and 3; 0 if there's no sprite pixel */
+  palette_type_t palette; /** Either OBP-0 or OBP-1 */
+  uint8_t bg_priority;    /** OBJ-to-BG priority bit */
+} sprite_row_pixel_t;
 
 typedef struct
 {
   uint8_t fetcher_x_index;
   uint8_t window_line;
-  uint8_t fetched_sprite_count;
   fetched_bgw_tile_t bgw_tile_data;
-  fetched_sprite_tile_t sprite_tile_data[MAX_FETCHED_SPRITES];
+  sprite_row_pixel_t sprite_row[SCREEN_WIDTH];
   oam_scanned_sprites_t oam_scanned_sprites;
 } pixel_fetcher_state_t;
 
@@ -39,12 +41,23 @@ typedef struct
   pixel_fetcher_state_t *fetcher_state;
   lcd_handle_t *lcd_handle;
   bus_interface_t *bus_interface;
+  uint8_t const *vram;            /** VRAM contents to read tile maps and tile data from directly, or NULL to read through the bus interface */
+  tile_cache_t const *tile_cache; /** Decoded tile data to look up rows of pixels from, or NULL to decode fetched tile data */
 } pixel_fetcher_context_t;
 
 status_code_t pixel_fetcher_reset(pixel_fetcher_state_t *const state);
 status_code_t fetch_tile_number(pixel_fetcher_context_t *const ctx);
 status_code_t fetch_tile_data(pixel_fetcher_context_t *const ctx, uint8_t const offset);
 uint8_t bgw_pixel_color_index(fetched_bgw_tile_t *const bgw_tile, uint8_t index);
-uint8_t sprite_pixel_color_index(fetched_sprite_tile_t *const sprite_tile, uint8_t index);
+
+/**
+ * Fetch the sprites found by the OAM scan and resolve them into a row of sprite pixels for the current scanline.
+ * Sprites earlier in the scan results (lower X coordinate, then lower OAM index) take priority over later ones.
+ *
+ * @param ctx Pointer to the pixel fetcher context
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t fetch_sprite_row(pixel_fetcher_context_t *const ctx);
 
 #endif /* __DMG_BG_TILE_FETCHER_H__ */
@@ -4,11 +4,10 @@
 #include <stdint.h>
 
 #include "bus_interface.h"
-#include "color.h"
 #include "lcd.h"
 #include "pixel_fetcher.h"
-#include "ring_buf.h"
 #include "status_code.h"
+#include "tile_cache.h"
 
 /**
  * Pixel FIFO FSM state definitions
@@ -22,33 +21,73 @@ typedef enum
   PXFIFO_PUSH,
 } pxfifo_state_t;
 
+#define PXFIFO_CAPACITY (16) /** Must be a power of two */
+
 /**
- * Definition of each item on the FIFO
- * TODO: compact
+ * Definition of each item on the FIFO. Sprite pixels are mixed in as the background / window
+ * pixels are pushed, so only what's needed to look up the final pixel value is kept.
  */
 typedef struct
 {
   uint8_t pixel_color;    /** Pixel color value between 0 and 3 */
-  palette_type_t palette; /** A value between 0 and 7 on CGB; applies only to object on DMG */
-  uint8_t obj_priority;   /** On CGB this is the OAM index for the object; on DMG this doesn’t exist */
-  uint8_t bg_priority;    /** OBJ-to-BG priority bit */
+  palette_type_t palette; /** Palette to look the color up from */
 } pxfifo_item_t;
 
 /**
- * Ring buffer as the underlying FIFO implementation
+ * Fixed-size FIFO of pixels, indexed with the lower bits of free-running counters
  */
 typedef struct
 {
-  ring_buffer_t buffer;      /** Ring buffer internal state */
-  pxfifo_item_t storage[16]; /** Ring buffer underlying data storage */
+  pxfifo_item_t items[PXFIFO_CAPACITY]; /** FIFO storage */
+  uint8_t head;                         /** Position of the next item to pop off, modulo the capacity */
+  uint8_t size;                         /** Number of items in the FIFO */
 } pxfifo_buffer_t;
 
+/**
+ * Push a pixel onto the back of the FIFO. The FIFO never holds more than 16 pixels, so there's no
+ * check for it being full.
+ *
+ * @param fifo Pointer to a FIFO that isn't full
+ * @param item The pixel to push
+ */
+static inline void pxfifo_buffer_push(pxfifo_buffer_t *const fifo, pxfifo_item_t const item)
+{
+  fifo->items[(fifo->head + fifo->size) & (PXFIFO_CAPACITY - 1)] = item;
+  fifo->size++;
+}
+
+/**
+ * Pop a pixel off the front of the FIFO, without checking for it being empty
+ *
+ * @param fifo Pointer to a FIFO that isn't empty
+ *
+ * @return The oldest pixel in the FIFO
+ */
+static inline pxfifo_item_t pxfifo_buffer_pop(pxfifo_buffer_t *const fifo)
+{
+  pxfifo_item_t const item = fifo->items[fifo->head & (PXFIFO_CAPACITY - 1)];
+  fifo->head++;
+  fifo->size--;
+  return item;
+}
+
+/**
+ * Discard every pixel in the FIFO
+ *
+ * @param fifo Pointer to a FIFO
+ */
+static inline void pxfifo_buffer_flush(pxfifo_buffer_t *const fifo)
+{
+  fifo->head = 0;
+  fifo->size = 0;
+}
+
 /**
  * Data for pixels that are ready to be rendered on the display
  */
 typedef struct
 {
-  color_rgba_t color; /** Actual RGBA color of the pixel to be rendered */
+  uint8_t pixel;      /** Indexed value of the pixel to be rendered, see `lcd_palette_pixel` */
   uint16_t screen_x;  /** X coordinate of the pixel on the screen */
   uint16_t screen_y;  /** Y coordinate of the pixel on the screen */
   uint8_t data_valid; /** Indicates if this pixel holds valid data. If set to 0, this pixel should not be rendered */
@@ -74,7 +113,9 @@ typedef struct
   pxfifo_buffer_t bg_fifo;             /** Buffer to hold background and window tile pixels */
   pxfifo_counter_t counters;           /** FIFO internal counters */
   bus_interface_t bus_interface;       /** Bus interface to allow the FIFO to read from VRAM */
+  uint8_t const *vram;                 /** VRAM contents to read directly, or NULL to read through the bus interface */
   lcd_handle_t *lcd;                   /** LCD registers handle */
+  tile_cache_t const *tile_cache;      /** Decoded VRAM tile data, or NULL to decode tile data as it is fetched */
   pixel_fetcher_state_t pixel_fetcher; /** Pixel fetcher object */
 } pxfifo_handle_t;
 
@@ -84,7 +125,9 @@ typedef struct
 typedef struct
 {
   bus_interface_t *bus_interface; /** Pinter to bus interface to allow the FIFO to read from VRAM */
+  uint8_t const *vram;            /** (Optional) Pointer to the VRAM contents, to read them without going through the bus interface */
   lcd_handle_t *lcd;              /** Pointerr to an LCD registers handle */
+  tile_cache_t const *tile_cache; /** (Optional) Pointer to the decoded VRAM tile data */
 } pxfifo_init_param_t;
 
 /**
@@ -0,0 +1,71 @@
+#ifndef __DMG_PIXEL_KERNELS_H__
+#define __DMG_PIXEL_KERNELS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "status_code.h"
+
+/**
+ * Instruction set extensions the pixel conversion kernels can be built on
+ */
+typedef enum
+{
+  PIXEL_KERNELS_ISA_SCALAR, /** Portable C, always available */
+  PIXEL_KERNELS_ISA_SSE2,   /** x86 SSE2 */
+  PIXEL_KERNELS_ISA_AVX2,   /** x86 AVX2 and BMI2 */
+} pixel_kernels_isa_t;
+
+/**
+ * Select the fastest kernels supported by the host CPU. Until this is called,
+ * the scalar kernels are used.
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t pixel_kernels_init(void);
+
+/**
+ * Force the kernels built on a specific instruction set to be used
+ *
+ * @param isa Instruction set to use
+ *
+ * @return `STATUS_OK` if successful, `STATUS_ERR_UNSUPPORTED` if the host CPU does not support it.
+ */
+status_code_t pixel_kernels_select(pixel_kernels_isa_t const isa);
+
+/**
+ * @return The instruction set of the kernels currently in use
+ */
+pixel_kernels_isa_t pixel_kernels_isa(void);
+
+/**
+ * Decode a row of 2bpp tile data into color indices
+ *
+ * @param data_low Low bit plane of the row
+ * @param data_high High bit plane of the row
+ * @param x_flip Whether to flip the row horizontally
+ * @param pixels Buffer to store the 8 color indices (0-3), leftmost first
+ */
+void pixel_kernels_decode_tile_row(uint8_t const data_low, uint8_t const data_high, bool const x_flip, uint8_t *const pixels);
+
+/**
+ * Convert color indices to indexed pixel values through a 4-entry palette
+ *
+ * @param indices Color indices to convert. Only the lower 2 bits of each are used.
+ * @param palette The 4 indexed pixel values of the palette, see `lcd_palette_pixel`
+ * @param pixels Buffer to store the converted pixels
+ * @param count Number of pixels to convert
+ */
+void pixel_kernels_map_palette(uint8_t const *const indices, uint8_t const *const palette, uint8_t *const pixels, uint16_t const count);
+
+/**
+ * Convert indexed pixel values to RGBA through a 16-color table
+ *
+ * @param pixels Indexed pixel values to convert. Only the lower 4 bits of each are used.
+ * @param colors The 16 colors of the table, as `color_rgba_t` hex values
+ * @param rgba Buffer to store the converted colors
+ * @param count Number of pixels to convert
+ */
+void pixel_kernels_expand_pixels(uint8_t const *const pixels, uint32_t const *const colors, uint32_t *const rgba, uint16_t const count);
+
+#endif /* __DMG_PIXEL_KERNELS_H__ */
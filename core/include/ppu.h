@@ -2,20 +2,26 @@
 #define __DMG_PPU_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "bus_interface.h"
 #include "callback.h"
+#include "frame_buffer.h"
 #include "interrupt.h"
 #include "lcd.h"
 #include "oam.h"
 #include "pixel_fifo.h"
 #include "status_code.h"
+#include "tile_cache.h"
 
-typedef union
+/**
+ * How the PPU draws pixels during pixel transfer (mode 3)
+ */
+typedef enum
 {
-  uint32_t matrix[SCREEN_HEIGHT][SCREEN_WIDTH];
-  uint32_t buffer[SCREEN_HEIGHT * SCREEN_WIDTH];
-} video_buffer_t;
+  PPU_RENDER_MODE_PIXEL_FIFO, /** Shift pixels through the pixel FIFO dot by dot (accurate) */
+  PPU_RENDER_MODE_SCANLINE,   /** Draw the whole line at the end of mode 3 (fast) */
+} ppu_render_mode_t;
 
 typedef struct
 {
@@ -23,20 +29,70 @@ typedef struct
   oam_handle_t oam;
   interrupt_handle_t *interrupt;
   pxfifo_handle_t pxfifo;
+  tile_cache_t *tile_cache;
   callback_t fps_sync_callback;
+  callback_t vram_block_callback; /** (Optional) Called when the PPU starts or stops blocking VRAM access, see `ppu_register_vram_block_callback` */
   uint32_t current_frame;
   uint32_t line_ticks;
-  video_buffer_t video_buffer;
+  uint8_t lcd_off;
+  ppu_render_mode_t render_mode;
+  frame_buffer_t frame_buffer; /** Frames drawn by the PPU; a frame is published when V-blank starts */
 } ppu_handle_t;
 
 typedef struct
 {
   bus_interface_t *bus_interface;
   interrupt_handle_t *interrupt;
+  tile_cache_t *tile_cache; /** (Optional) Decoded VRAM tile data to render from */
+  uint8_t const *vram;      /** (Optional) VRAM contents, to fetch tile maps and tile data with plain reads instead of through the bus interface */
 } ppu_init_param_t;
 
 status_code_t ppu_init(ppu_handle_t *const ppu, ppu_init_param_t *const param);
 status_code_t ppu_tick(ppu_handle_t *const ppu);
+
+/**
+ * Advance the PPU by the given number of dots (T-cycles). Dots in which the PPU only counts
+ * towards its next mode or LY change are skipped in one step; only pixel transfer is stepped
+ * dot by dot. While the LCD is off the PPU idles, but still counts frames so that frame
+ * boundaries keep occurring.
+ *
+ * @param ppu Pointer to a PPU handle object
+ * @param ticks Number of dots to advance by
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t ppu_advance(ppu_handle_t *const ppu, uint32_t const ticks);
+
+/**
+ * Lower bound of the number of dots until the PPU changes mode or LY,
+ * which is when it can raise the STAT and VBlank interrupts
+ *
+ * @param ppu Pointer to a PPU handle object
+ *
+ * @return Number of dots until the next PPU event, at least 1.
+ */
+uint32_t ppu_ticks_until_event(ppu_handle_t const *const ppu);
+
 status_code_t ppu_register_fps_sync_callback(ppu_handle_t *const ppu, callback_t *const fps_sync_callback);
 
+/**
+ * Register a callback to be notified when the PPU starts and stops blocking VRAM access, i.e. when it
+ * enters and leaves pixel transfer (mode 3). The callback is called with a `bool const *` argument
+ * that is true when VRAM becomes blocked. This is the hook for whoever maps VRAM into the CPU's view
+ * to make it inaccessible while the PPU is reading it.
+ *
+ * @param ppu Pointer to a PPU handle object
+ * @param vram_block_callback Pointer to the callback to register
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t ppu_register_vram_block_callback(ppu_handle_t *const ppu, callback_t *const vram_block_callback);
+
+/**
+ * @param ppu Pointer to a PPU handle object
+ *
+ * @return true if the CPU can access VRAM, false if the PPU is blocking it for pixel transfer.
+ */
+bool ppu_vram_accessible(ppu_handle_t const *const ppu);
+
 #endif /* __DMG_PPU_H__ */
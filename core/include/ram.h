@@ -4,7 +4,9 @@
 #include <stdint.h>
 #include "bus_interface.h"
 #include "status_code.h"
+#include "tile_cache.h"
 
+#define VRAM_ADDR (0x8000)
 #define VRAM_SIZE (0x2000)
 #define WRAM_SIZE (0x2000)
 #define HRAM_SIZE (0x7F)
@@ -30,6 +32,7 @@ typedef struct
   wram_t wram;
   vram_t vram;
   hram_t hram;
+  tile_cache_t tile_cache;
   bus_interface_t bus_interface;
 } ram_handle_t;
 
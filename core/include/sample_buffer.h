@@ -0,0 +1,72 @@
+#ifndef __DMG_SAMPLE_BUFFER_H__
+#define __DMG_SAMPLE_BUFFER_H__
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "status_code.h"
+
+#define SAMPLE_BUFFER_CAPACITY (2048) /** Number of stereo frames; must be a power of two */
+
+/**
+ * A mixed stereo output frame
+ */
+typedef struct
+{
+  int16_t left;
+  int16_t right;
+} sample_frame_t;
+
+/**
+ * Single-producer, single-consumer ring of output frames to hand audio from the emulation thread
+ * over to the audio device thread.
+ *
+ * Both indices run freely and are only reduced to a position on access, so a full ring can be told
+ * apart from an empty one without giving up a slot. Each index is only ever written by one side.
+ */
+typedef struct
+{
+  sample_frame_t frames[SAMPLE_BUFFER_CAPACITY]; /** Underlying frame storage */
+  _Atomic uint32_t write_index;                  /** Total number of frames written; only written by the producer */
+  _Atomic uint32_t read_index;                   /** Total number of frames read; only written by the consumer */
+} sample_buffer_t;
+
+/**
+ * Empty the sample buffer. Must not be called while either side is accessing it.
+ *
+ * @param sample_buffer Pointer to a sample buffer object to initialize
+ *
+ * @return `STATUS_OK` if initialization is successful, otherwise appropriate error code.
+ */
+status_code_t sample_buffer_init(sample_buffer_t *const sample_buffer);
+
+/**
+ * Append frames to the buffer. Frames that don't fit are dropped.
+ *
+ * @param sample_buffer Pointer to a sample buffer object
+ * @param frames Frames to append
+ * @param count Number of frames to append
+ *
+ * @return The number of frames actually appended
+ */
+uint32_t sample_buffer_write(sample_buffer_t *const sample_buffer, sample_frame_t const *const frames, uint32_t const count);
+
+/**
+ * Take the oldest frames off the buffer
+ *
+ * @param sample_buffer Pointer to a sample buffer object
+ * @param frames Buffer to store the frames
+ * @param count Maximum number of frames to take
+ *
+ * @return The number of frames actually taken
+ */
+uint32_t sample_buffer_read(sample_buffer_t *const sample_buffer, sample_frame_t *const frames, uint32_t const count);
+
+/**
+ * @param sample_buffer Pointer to a sample buffer object
+ *
+ * @return The number of frames waiting to be read
+ */
+uint32_t sample_buffer_size(sample_buffer_t *const sample_buffer);
+
+#endif /* __DMG_SAMPLE_BUFFER_H__ */
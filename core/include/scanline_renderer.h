@@ -0,0 +1,38 @@
+#ifndef __DMG_SCANLINE_RENDERER_H__
+#define __DMG_SCANLINE_RENDERER_H__
+
+#include <stdint.h>
+
+#include "bus_interface.h"
+#include "lcd.h"
+#include "oam.h"
+#include "status_code.h"
+#include "tile_cache.h"
+
+/**
+ * Everything the scanline renderer needs to draw the current line (LY)
+ */
+typedef struct
+{
+  lcd_handle_t *lcd_handle;               /** LCD registers handle */
+  bus_interface_t *bus_interface;         /** Bus interface to read tile maps and tile data from VRAM */
+  uint8_t const *vram;                    /** (Optional) VRAM contents to read tile maps and tile data from directly, bypassing the bus interface */
+  oam_scanned_sprites_t *scanned_sprites; /** Sprites collected by the OAM scan of the current line, in priority order */
+  uint8_t window_line;                    /** Line of the window layer to draw if the window is visible */
+  tile_cache_t const *tile_cache;         /** (Optional) Decoded tile data to look up rows of pixels from */
+} scanline_renderer_context_t;
+
+/**
+ * Draw a complete scanline of background, window, and sprites in one go, using the LCD
+ * registers as they are when this is called. This is a faster alternative to shifting
+ * pixels through the pixel FIFO one dot at a time, at the cost of not seeing register
+ * writes made in the middle of the line.
+ *
+ * @param ctx Pointer to a renderer context object
+ * @param line_buffer Pointer to a buffer of `SCREEN_WIDTH` pixels to store the rendered line as indexed pixel values
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t scanline_render(scanline_renderer_context_t *const ctx, uint8_t *const line_buffer);
+
+#endif /* __DMG_SCANLINE_RENDERER_H__ */
@@ -0,0 +1,118 @@
+#ifndef __DMG_SCHEDULER_H__
+#define __DMG_SCHEDULER_H__
+
+#include <stdint.h>
+
+#include "callback.h"
+#include "status_code.h"
+
+/** Timestamp returned when no event is scheduled */
+#define SCHEDULER_NO_EVENT (UINT64_MAX)
+
+/**
+ * Events that can be scheduled. Each event can be queued at most once;
+ * scheduling an event that is already queued moves it to the new timestamp.
+ */
+typedef enum
+{
+  SCHEDULER_EVENT_TIMER, /** TIMA overflow */
+  SCHEDULER_EVENT_PPU,   /** PPU mode transition or LY change */
+  SCHEDULER_EVENT_DMA,   /** OAM DMA byte transfer */
+  SCHEDULER_EVENT_APU,   /** APU frame sequencer step or channel step */
+  SCHEDULER_EVENT_COUNT,
+} scheduler_event_t;
+
+/**
+ * Definition of each item on the event queue
+ */
+typedef struct
+{
+  uint64_t timestamp;      /** Master cycle count at which the event fires */
+  scheduler_event_t event; /** Event identifier */
+} scheduler_entry_t;
+
+/**
+ * Top-level scheduler object definition. Queued events are kept in a binary min-heap
+ * ordered by timestamp.
+ */
+typedef struct
+{
+  scheduler_entry_t heap[SCHEDULER_EVENT_COUNT]; /** Min-heap of queued events */
+  uint8_t heap_index[SCHEDULER_EVENT_COUNT];     /** Position of each event on the heap */
+  uint8_t size;                                  /** Number of queued events */
+  callback_t handlers[SCHEDULER_EVENT_COUNT];    /** Callbacks invoked when each event fires */
+} scheduler_t;
+
+/**
+ * Initialize a scheduler with an empty event queue
+ *
+ * @param scheduler Pointer to a scheduler object to initialize
+ *
+ * @return `STATUS_OK` if initialization is successful, otherwise appropriate error code.
+ */
+status_code_t scheduler_init(scheduler_t *const scheduler);
+
+/**
+ * Register the callback to invoke when an event fires. The callback receives a pointer
+ * to the `uint64_t` timestamp the event was scheduled at.
+ *
+ * @param scheduler Pointer to a scheduler object
+ * @param event The event to register the handler for
+ * @param handler Pointer to an initialized callback object
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t scheduler_register_handler(scheduler_t *const scheduler, scheduler_event_t const event, callback_t *const handler);
+
+/**
+ * Queue an event at the given timestamp, or move it there if it is already queued
+ *
+ * @param scheduler Pointer to a scheduler object
+ * @param event The event to schedule
+ * @param timestamp Master cycle count at which the event fires
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t scheduler_schedule(scheduler_t *const scheduler, scheduler_event_t const event, uint64_t const timestamp);
+
+/**
+ * Remove an event from the queue. Cancelling an event that is not queued has no effect.
+ *
+ * @param scheduler Pointer to a scheduler object
+ * @param event The event to cancel
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t scheduler_cancel(scheduler_t *const scheduler, scheduler_event_t const event);
+
+/**
+ * Get the timestamp of the earliest queued event
+ *
+ * @param scheduler Pointer to a scheduler object
+ *
+ * @return The earliest timestamp, or `SCHEDULER_NO_EVENT` if no event is queued.
+ */
+uint64_t scheduler_next_timestamp(scheduler_t const *const scheduler);
+
+/**
+ * Get the timestamp an event is queued at
+ *
+ * @param scheduler Pointer to a scheduler object
+ * @param event The event to look up
+ *
+ * @return The event's timestamp, or `SCHEDULER_NO_EVENT` if the event is not queued.
+ */
+uint64_t scheduler_event_timestamp(scheduler_t const *const scheduler, scheduler_event_t const event);
+
+/**
+ * Fire every event scheduled at or before the given timestamp, in timestamp order.
+ * Each event is removed from the queue before its handler runs, so the handler may reschedule it.
+ *
+ * @param scheduler Pointer to a scheduler object
+ * @param timestamp Current master cycle count
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t scheduler_run_until(scheduler_t *const scheduler, uint64_t const timestamp);
+
+#endif /* __DMG_SCHEDULER_H__ */
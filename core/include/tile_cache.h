@@ -0,0 +1,88 @@
+#ifndef __DMG_TILE_CACHE_H__
+#define __DMG_TILE_CACHE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "status_code.h"
+
+#define TILE_CACHE_NUM_TILES (384)          /** Number of tiles in VRAM tile data (0x8000 - 0x97FF) */
+#define TILE_CACHE_TILE_SIZE (8)            /** Width and height of a tile in pixels */
+#define TILE_CACHE_BYTES_PER_TILE (16)      /** Size of an encoded 2bpp tile in bytes */
+#define TILE_CACHE_TILE_DATA_SIZE (0x1800)  /** Size of the VRAM tile data region in bytes */
+#define TILE_CACHE_TILE_DATA_ADDR (0x8000)  /** Start address of the VRAM tile data region */
+
+/**
+ * VRAM tile data decoded into one color index (0-3) per pixel. Every tile is kept both as is
+ * and flipped horizontally, so that fetching a row of pixels is a plain table lookup.
+ */
+typedef struct
+{
+  uint8_t pixels[TILE_CACHE_NUM_TILES][TILE_CACHE_TILE_SIZE][TILE_CACHE_TILE_SIZE];           /** Decoded tiles */
+  uint8_t pixels_x_flipped[TILE_CACHE_NUM_TILES][TILE_CACHE_TILE_SIZE][TILE_CACHE_TILE_SIZE]; /** Decoded tiles, flipped horizontally */
+  uint8_t dirty[TILE_CACHE_NUM_TILES];                                                        /** Set for each tile modified since it was last marked clean */
+} tile_cache_t;
+
+/**
+ * Decode all of the tile data and mark every tile as dirty
+ *
+ * @param cache Pointer to a tile cache object to initialize
+ * @param tile_data Pointer to the VRAM tile data region (`TILE_CACHE_TILE_DATA_SIZE` bytes)
+ *
+ * @return `STATUS_OK` if initialization is successful, otherwise appropriate error code.
+ */
+status_code_t tile_cache_init(tile_cache_t *const cache, uint8_t const *const tile_data);
+
+/**
+ * Re-decode the row of pixels containing a byte of tile data after it has been written,
+ * and mark its tile as dirty
+ *
+ * @param cache Pointer to a tile cache object
+ * @param tile_data Pointer to the VRAM tile data region, already holding the new byte
+ * @param offset Offset of the written byte from the start of the tile data region
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t tile_cache_update(tile_cache_t *const cache, uint8_t const *const tile_data, uint16_t const offset);
+
+/**
+ * Mark a tile as clean, once it has been redrawn by whoever is tracking changes to tiles
+ *
+ * @param cache Pointer to a tile cache object
+ * @param tile_index Index of the tile (0-383) counted from 0x8000
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t tile_cache_mark_clean(tile_cache_t *const cache, uint16_t const tile_index);
+
+/**
+ * Get a decoded row of pixels of a tile
+ *
+ * @param cache Pointer to a tile cache object
+ * @param tile_index Index of the tile (0-383) counted from 0x8000
+ * @param row Row of the tile (0-7)
+ * @param x_flip Whether to get the row flipped horizontally
+ *
+ * @return Pointer to the `TILE_CACHE_TILE_SIZE` color indices of the row
+ */
+static inline uint8_t const *tile_cache_row(tile_cache_t const *const cache, uint16_t const tile_index, uint8_t const row, bool const x_flip)
+{
+  return x_flip ? cache->pixels_x_flipped[tile_index][row] : cache->pixels[tile_index][row];
+}
+
+/**
+ * Get the decoded row of pixels holding the tile data at a VRAM address
+ *
+ * @param cache Pointer to a tile cache object
+ * @param address VRAM address of either byte of the row (0x8000 - 0x97FF)
+ * @param x_flip Whether to get the row flipped horizontally
+ *
+ * @return Pointer to the `TILE_CACHE_TILE_SIZE` color indices of the row
+ */
+static inline uint8_t const *tile_cache_row_at(tile_cache_t const *const cache, uint16_t const address, bool const x_flip)
+{
+  uint16_t const offset = address - TILE_CACHE_TILE_DATA_ADDR;
+  return tile_cache_row(cache, offset / TILE_CACHE_BYTES_PER_TILE, (offset % TILE_CACHE_BYTES_PER_TILE) / 2, x_flip);
+}
+
+#endif /* __DMG_TILE_CACHE_H__ */
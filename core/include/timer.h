@@ -12,17 +12,33 @@ typedef enum
   TMR_TAC_ENABLE = (1 << 2),
 } timer_reg_tac_t;
 
+/** Overflow cycle count used while the timer is disabled */
+#define TIMER_NO_OVERFLOW (UINT64_MAX)
+
 typedef struct
 {
-  uint16_t div;
-  uint8_t tima;
+  uint8_t tima; /** TIMA value as of `tima_epoch` */
   uint8_t tma;
   uint8_t tac;
 } timer_registers_t;
 
+/**
+ * Rather than counting every T-cycle, the timer keeps the cycle counts at which DIV was
+ * last reset and TIMA was last written or reloaded. DIV and TIMA are derived from these
+ * on demand, and the cycle count of the next TIMA overflow is precomputed.
+ */
+typedef struct
+{
+  uint64_t cycles;         /** Number of T-cycles the timer has been advanced by */
+  uint64_t div_epoch;      /** Cycle count at which the internal DIV counter was zero */
+  uint64_t tima_epoch;     /** Cycle count at which TIMA was last written or reloaded */
+  uint64_t overflow_cycle; /** Cycle count of the next TIMA overflow, or `TIMER_NO_OVERFLOW` */
+} timer_state_t;
+
 typedef struct
 {
   timer_registers_t registers;
+  timer_state_t state;
   interrupt_handle_t *interrupt;
   bus_interface_t bus_interface;
 } timer_handle_t;
@@ -30,4 +46,15 @@ typedef struct
 status_code_t timer_init(timer_handle_t *const timer, interrupt_handle_t *const interrupt);
 status_code_t timer_tick(timer_handle_t *const timer);
 
+/**
+ * Advance the timer by the given number of T-cycles
+ */
+status_code_t timer_advance(timer_handle_t *const timer, uint32_t const ticks);
+
+/**
+ * Number of T-cycles until TIMA overflows and raises the timer interrupt,
+ * or UINT32_MAX if the timer is disabled
+ */
+uint32_t timer_ticks_until_event(timer_handle_t const *const timer);
+
 #endif /* __DMG_TIMER_H__ */
@@ -6,20 +6,30 @@
 #include "apu_pwm.h"
 #include "apu_lfsr.h"
 #include "apu_wave.h"
-#include "audio_playback_samples.h"
+#include "blip_buffer.h"
 #include "bus_interface.h"
 #include "callback.h"
+#include "sample_buffer.h"
 #include "logging.h"
 #include "status_code.h"
 
-#define CPU_FREQ (1048576)
-#define DEFAULT_VOLUME (INT16_MAX)
+#define FRAME_SEQUENCER_PERIOD (8192 / 4)
+#define OUTPUT_CHUNK_FRAMES (32) /** Number of frames read out of the blip buffers at once */
+
+/** All 4 channels at full volume on one side, with the master volume at its highest, reach half of the output range */
+#define OUTPUT_LEVEL_SCALE (INT16_MAX / (15 * 4 * 8 * 2))
 
 static status_code_t apu_bus_read(void *const resource, uint16_t const address, uint8_t *const data);
 static status_code_t apu_bus_write(void *const resource, uint16_t const address, uint8_t const data);
 static status_code_t apu_reset(apu_handle_t *const apu);
-static status_code_t apu_sample(apu_handle_t *const apu, float *const left_sample, float *const right_sample);
-static status_code_t apu_playback(void *const ctx, const void *arg);
+static status_code_t apu_synthesize(apu_handle_t *const apu, uint32_t const ticks);
+static status_code_t apu_end_output_frame(apu_handle_t *const apu);
+static status_code_t apu_clock_frame_sequencer(apu_handle_t *const apu);
+static status_code_t apu_init_track(apu_output_track_t *const track, uint32_t const sample_rate_hz, int32_t const adjust_ppm);
+static status_code_t apu_update_output(apu_handle_t *const apu);
+static void apu_update_track(apu_output_track_t *const track, uint32_t const time, int32_t const left_level, int32_t const right_level);
+static void apu_end_track_frame(apu_output_track_t *const track, uint32_t const ticks);
+static uint32_t apu_read_track(apu_output_track_t *const track);
 
 status_code_t apu_init(apu_handle_t *const apu)
 {
@@ -46,141 +56,410 @@ status_code_t apu_init(apu_handle_t *const apu)
   status = apu_lfsr_init(&apu->ch4);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = callback_init(&apu->playback_cb, apu_playback, apu);
+  status = sample_buffer_init(&apu->output.mix.sample_buffer);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  for (uint8_t i = 0; i < APU_CHANNEL_COUNT; i++)
+  {
+    status = sample_buffer_init(&apu->output.channels[i].sample_buffer);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  memset(&apu->output.output_callback, 0, sizeof(callback_t));
+  apu->output.channel_tracks_enabled = false;
+  apu->output.rate_adjust_ppm = 0;
+  status = apu_set_sample_rate(apu, APU_DEFAULT_SAMPLE_RATE);
   RETURN_STATUS_IF_NOT_OK(status);
 
   return bus_interface_init(&apu->bus_interface, apu_bus_read, apu_bus_write, apu);
 }
 
-status_code_t apu_tick(apu_handle_t *const apu)
+status_code_t apu_advance(apu_handle_t *const apu, uint32_t const m_cycles)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu);
 
-  apu_pwm_tick(&apu->ch1);
-  apu_pwm_tick(&apu->ch2);
-  apu_wave_tick(&apu->ch3);
-  apu_lfsr_tick(&apu->ch4);
+  status_code_t status = STATUS_OK;
+
+  status = apu_synthesize(apu, m_cycles);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  return apu_end_output_frame(apu);
+}
+
+status_code_t apu_catch_up(apu_handle_t *const apu, uint32_t const m_cycles)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(apu);
+
+  return apu_synthesize(apu, m_cycles);
+}
+
+/**
+ * Only audible channels count, since a disabled channel's amplitude stays at 0 until it's triggered
+ */
+uint32_t apu_m_cycles_until_event(apu_handle_t const *const apu)
+{
+  uint32_t ticks = FRAME_SEQUENCER_PERIOD - apu->frame_sequencer.tick_count;
+  uint32_t channel_ticks;
+
+  if (apu->ch1.state.enabled && ((channel_ticks = apu_pwm_ticks_until_step(&apu->ch1)) < ticks))
+  {
+    ticks = channel_ticks;
+  }
+
+  if (apu->ch2.state.enabled && ((channel_ticks = apu_pwm_ticks_until_step(&apu->ch2)) < ticks))
+  {
+    ticks = channel_ticks;
+  }
 
-  apu->frame_sequencer.tick_count++;
+  if (apu->ch3.state.enabled && ((channel_ticks = apu_wave_ticks_until_step(&apu->ch3)) < ticks))
+  {
+    ticks = channel_ticks;
+  }
 
-  if (apu->frame_sequencer.tick_count == (8192 / 4))
+  if (apu->ch4.state.enabled && ((channel_ticks = apu_lfsr_ticks_until_step(&apu->ch4)) < ticks))
   {
-    apu_pwm_handle_frame_sequencer(&apu->ch1, apu->frame_sequencer.frame_step);
-    apu_pwm_handle_frame_sequencer(&apu->ch2, apu->frame_sequencer.frame_step);
-    apu_wave_handle_frame_sequencer(&apu->ch3, apu->frame_sequencer.frame_step);
-    apu_lfsr_handle_frame_sequencer(&apu->ch4, apu->frame_sequencer.frame_step);
+    ticks = channel_ticks;
+  }
+
+  return ticks;
+}
+
+status_code_t apu_set_sample_rate(apu_handle_t *const apu, uint32_t const sample_rate_hz)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(apu);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE((sample_rate_hz == 0) || (sample_rate_hz > APU_MAX_SAMPLE_RATE), STATUS_ERR_INVALID_ARG);
 
-    apu->frame_sequencer.tick_count = 0;
-    apu->frame_sequencer.frame_step++;
-    apu->frame_sequencer.frame_step &= 0x7;
+  status_code_t status = STATUS_OK;
+
+  status = apu_init_track(&apu->output.mix, sample_rate_hz, apu->output.rate_adjust_ppm);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  for (uint8_t i = 0; i < APU_CHANNEL_COUNT; i++)
+  {
+    status = apu_init_track(&apu->output.channels[i], sample_rate_hz, apu->output.rate_adjust_ppm);
+    RETURN_STATUS_IF_NOT_OK(status);
   }
 
+  apu->output.sample_rate_hz = sample_rate_hz;
+  apu->output.frame_ticks = 0;
+
   return STATUS_OK;
 }
 
-static status_code_t apu_reset(apu_handle_t *const apu)
+status_code_t apu_set_rate_adjust(apu_handle_t *const apu, int32_t const adjust_ppm)
 {
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(apu);
+
   status_code_t status = STATUS_OK;
 
-  memset(&apu->registers, 0, sizeof(apu_registers_t));
-  memset(&apu->frame_sequencer, 0, sizeof(apu_frame_sequencer_counter_t));
+  status = blip_buffer_set_rate_adjust(&apu->output.mix.left, adjust_ppm);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  status = apu_pwm_reset(&apu->ch1);
+  status = blip_buffer_set_rate_adjust(&apu->output.mix.right, adjust_ppm);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = apu_pwm_reset(&apu->ch2);
+  for (uint8_t i = 0; i < APU_CHANNEL_COUNT; i++)
+  {
+    status = blip_buffer_set_rate_adjust(&apu->output.channels[i].left, adjust_ppm);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    status = blip_buffer_set_rate_adjust(&apu->output.channels[i].right, adjust_ppm);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  apu->output.rate_adjust_ppm = adjust_ppm;
+
+  return STATUS_OK;
+}
+
+status_code_t apu_set_channel_tracks_enabled(apu_handle_t *const apu, bool const enabled)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(apu);
+
+  status_code_t status = STATUS_OK;
+
+  /** The tracks pick up from the current channel levels on the next frame */
+  for (uint8_t i = 0; (i < APU_CHANNEL_COUNT) && enabled && !apu->output.channel_tracks_enabled; i++)
+  {
+    status = apu_init_track(&apu->output.channels[i], apu->output.sample_rate_hz, apu->output.rate_adjust_ppm);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  apu->output.channel_tracks_enabled = enabled;
+
+  return STATUS_OK;
+}
+
+status_code_t apu_register_output_callback(apu_handle_t *const apu, callback_t *const output_callback)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(apu);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(output_callback);
+  VERIFY_PTR_RETURN_STATUS_IF_NULL(output_callback->callback_fn, STATUS_ERR_NOT_INITIALIZED);
+
+  memcpy(&apu->output.output_callback, output_callback, sizeof(callback_t));
+
+  return STATUS_OK;
+}
+
+/**
+ * Clear the synthesis of a track, so that it starts from silence. Frames already handed over to the
+ * sample buffer are left for the consumer.
+ */
+static status_code_t apu_init_track(apu_output_track_t *const track, uint32_t const sample_rate_hz, int32_t const adjust_ppm)
+{
+  status_code_t status = STATUS_OK;
+
+  status = blip_buffer_init(&track->left, APU_CLOCK_HZ, sample_rate_hz);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = apu_wave_reset(&apu->ch3);
+  status = blip_buffer_init(&track->right, APU_CLOCK_HZ, sample_rate_hz);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = apu_lfsr_reset(&apu->ch4);
+  status = blip_buffer_set_rate_adjust(&track->left, adjust_ppm);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  status = blip_buffer_set_rate_adjust(&track->right, adjust_ppm);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  track->left_level = 0;
+  track->right_level = 0;
+
   return STATUS_OK;
 }
 
-static status_code_t apu_sample(apu_handle_t *const apu, float *const left_sample, float *const right_sample)
+/**
+ * Synthesize a stretch of output. The channels and the frame sequencer are advanced together in spans
+ * that end on the next tick where any of them may change the output level. The output frame is ended on
+ * every frame sequencer step, so that its output always fits in the blip buffers and within
+ * `APU_MAX_OUTPUT_FRAMES`.
+ */
+static status_code_t apu_synthesize(apu_handle_t *const apu, uint32_t const ticks)
 {
-  float channel_samples[4];
-
   status_code_t status = STATUS_OK;
+  uint32_t time = 0;
 
-  float left_volume = ((apu->registers.mvp & APU_MVP_LEFT_VOL) >> 4) + 1;
-  float right_volume = (apu->registers.mvp & APU_MVP_RIGHT_VOL) + 1;
+  /** Register writes since the last call may have changed the output level */
+  status = apu_update_output(apu);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  status = apu_pwm_sample(&apu->ch1, &channel_samples[0]);
+  while (time < ticks)
+  {
+    uint32_t span = apu_m_cycles_until_event(apu);
+    span = (span < (ticks - time)) ? span : (ticks - time);
+
+    status = apu_pwm_advance(&apu->ch1, span);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    status = apu_pwm_advance(&apu->ch2, span);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    status = apu_wave_advance(&apu->ch3, span);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    status = apu_lfsr_advance(&apu->ch4, span);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    apu->frame_sequencer.tick_count += span;
+    apu->output.frame_ticks += span;
+    time += span;
+
+    if (apu->frame_sequencer.tick_count == FRAME_SEQUENCER_PERIOD)
+    {
+      status = apu_end_output_frame(apu);
+      RETURN_STATUS_IF_NOT_OK(status);
+
+      status = apu_clock_frame_sequencer(apu);
+      RETURN_STATUS_IF_NOT_OK(status);
+    }
+
+    status = apu_update_output(apu);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  return STATUS_OK;
+}
+
+/**
+ * Hand over the frames synthesized since the output frame was last ended
+ */
+static status_code_t apu_end_output_frame(apu_handle_t *const apu)
+{
+  uint32_t const ticks = apu->output.frame_ticks;
+  uint32_t frame_count = 0;
+
+  if (ticks == 0)
+  {
+    return STATUS_OK;
+  }
+
+  apu->output.frame_ticks = 0;
+
+  apu_end_track_frame(&apu->output.mix, ticks);
+  frame_count += apu_read_track(&apu->output.mix);
+
+  for (uint8_t i = 0; (i < APU_CHANNEL_COUNT) && apu->output.channel_tracks_enabled; i++)
+  {
+    apu_end_track_frame(&apu->output.channels[i], ticks);
+    frame_count += apu_read_track(&apu->output.channels[i]);
+  }
+
+  if ((frame_count > 0) && apu->output.output_callback.callback_fn)
+  {
+    return callback_call(&apu->output.output_callback, NULL);
+  }
+
+  return STATUS_OK;
+}
+
+static status_code_t apu_clock_frame_sequencer(apu_handle_t *const apu)
+{
+  status_code_t status = STATUS_OK;
+
+  status = apu_pwm_handle_frame_sequencer(&apu->ch1, apu->frame_sequencer.frame_step);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = apu_pwm_sample(&apu->ch2, &channel_samples[1]);
+  status = apu_pwm_handle_frame_sequencer(&apu->ch2, apu->frame_sequencer.frame_step);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = apu_wave_sample(&apu->ch3, &channel_samples[2]);
+  status = apu_wave_handle_frame_sequencer(&apu->ch3, apu->frame_sequencer.frame_step);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = apu_lfsr_sample(&apu->ch4, &channel_samples[3]);
+  status = apu_lfsr_handle_frame_sequencer(&apu->ch4, apu->frame_sequencer.frame_step);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  *left_sample = 0.0f;
-  *right_sample = 0.0f;
+  apu->frame_sequencer.tick_count = 0;
+  apu->frame_sequencer.frame_step++;
+  apu->frame_sequencer.frame_step &= 0x7;
+
+  return STATUS_OK;
+}
+
+static status_code_t apu_reset(apu_handle_t *const apu)
+{
+  status_code_t status = STATUS_OK;
+
+  memset(&apu->registers, 0, sizeof(apu_registers_t));
+  memset(&apu->frame_sequencer, 0, sizeof(apu_frame_sequencer_counter_t));
 
-  *left_sample += (apu->registers.sndp & APU_SNDP_CH1_LEFT) ? channel_samples[0] : 0;
-  *left_sample += (apu->registers.sndp & APU_SNDP_CH2_LEFT) ? channel_samples[1] : 0;
-  *left_sample += (apu->registers.sndp & APU_SNDP_CH3_LEFT) ? channel_samples[2] : 0;
-  *left_sample += (apu->registers.sndp & APU_SNDP_CH4_LEFT) ? channel_samples[3] : 0;
+  status = apu_pwm_reset(&apu->ch1);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  *right_sample += (apu->registers.sndp & APU_SNDP_CH1_RIGHT) ? channel_samples[0] : 0;
-  *right_sample += (apu->registers.sndp & APU_SNDP_CH2_RIGHT) ? channel_samples[1] : 0;
-  *right_sample += (apu->registers.sndp & APU_SNDP_CH3_RIGHT) ? channel_samples[2] : 0;
-  *right_sample += (apu->registers.sndp & APU_SNDP_CH4_RIGHT) ? channel_samples[3] : 0;
+  status = apu_pwm_reset(&apu->ch2);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  *left_sample /= 4.0f;
-  *right_sample /= 4.0f;
+  status = apu_wave_reset(&apu->ch3);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  *left_sample *= (left_volume / 8.0f);
-  *right_sample *= (right_volume / 8.0f);
+  status = apu_lfsr_reset(&apu->ch4);
+  RETURN_STATUS_IF_NOT_OK(status);
 
   return STATUS_OK;
 }
 
-static status_code_t apu_playback(void *const ctx, const void *arg)
+/**
+ * Mix the current DAC inputs of the channels, and feed the change in level of each side to the blip buffers
+ */
+static status_code_t apu_update_output(apu_handle_t *const apu)
 {
-  VERIFY_PTR_RETURN_ERROR_IF_NULL(ctx);
-  VERIFY_PTR_RETURN_ERROR_IF_NULL(arg);
+  static const uint8_t left_masks[] = {APU_SNDP_CH1_LEFT, APU_SNDP_CH2_LEFT, APU_SNDP_CH3_LEFT, APU_SNDP_CH4_LEFT};
+  static const uint8_t right_masks[] = {APU_SNDP_CH1_RIGHT, APU_SNDP_CH2_RIGHT, APU_SNDP_CH3_RIGHT, APU_SNDP_CH4_RIGHT};
 
-  apu_handle_t *const apu = (apu_handle_t *)ctx;
-  audio_playback_samples_t *const playback_samples = (audio_playback_samples_t *)arg;
+  apu_output_t *const output = &apu->output;
+  uint32_t const time = output->frame_ticks;
+  status_code_t status = STATUS_OK;
+  uint8_t channel_samples[APU_CHANNEL_COUNT] = {0};
+  int32_t left_scale = 0;
+  int32_t right_scale = 0;
+  int32_t left_level = 0;
+  int32_t right_level = 0;
+
+  if (apu->registers.actl & APU_ACTL_AUDIO_EN)
+  {
+    status = apu_pwm_sample(&apu->ch1, &channel_samples[0]);
+    RETURN_STATUS_IF_NOT_OK(status);
 
-  int16_t *stream_buf = (int16_t *)playback_samples->data;
-  uint32_t buffer_len = playback_samples->length / sizeof(int16_t);
+    status = apu_pwm_sample(&apu->ch2, &channel_samples[1]);
+    RETURN_STATUS_IF_NOT_OK(status);
 
-  float left_sample = 0.0f;
-  float right_sample = 0.0f;
+    status = apu_wave_sample(&apu->ch3, &channel_samples[2]);
+    RETURN_STATUS_IF_NOT_OK(status);
 
-  memset(playback_samples->data, 0, playback_samples->length);
+    status = apu_lfsr_sample(&apu->ch4, &channel_samples[3]);
+    RETURN_STATUS_IF_NOT_OK(status);
 
-  const uint32_t ticks_per_sample = CPU_FREQ / playback_samples->sample_rate_hz;
+    left_scale = (((apu->registers.mvp & APU_MVP_LEFT_VOL) >> 4) + 1) * OUTPUT_LEVEL_SCALE;
+    right_scale = ((apu->registers.mvp & APU_MVP_RIGHT_VOL) + 1) * OUTPUT_LEVEL_SCALE;
+  }
 
-  for (uint32_t i = 0; i < buffer_len; i += 2)
+  for (uint8_t i = 0; i < APU_CHANNEL_COUNT; i++)
   {
-    for (uint32_t j = 0; j < ticks_per_sample; j++)
+    int32_t const channel_left = (apu->registers.sndp & left_masks[i]) ? (channel_samples[i] * left_scale) : 0;
+    int32_t const channel_right = (apu->registers.sndp & right_masks[i]) ? (channel_samples[i] * right_scale) : 0;
+
+    if (output->channel_tracks_enabled)
     {
-      apu_tick(apu);
+      apu_update_track(&output->channels[i], time, channel_left, channel_right);
     }
 
-    if (apu->registers.actl & APU_ACTL_AUDIO_EN)
-    {
-      apu_sample(apu, &left_sample, &right_sample);
+    left_level += channel_left;
+    right_level += channel_right;
+  }
 
-      left_sample *= playback_samples->volume_adjust * DEFAULT_VOLUME;
-      right_sample *= playback_samples->volume_adjust * DEFAULT_VOLUME;
+  apu_update_track(&output->mix, time, left_level, right_level);
 
-      stream_buf[i] = (int16_t)(left_sample);
-      stream_buf[i + 1] = (int16_t)(right_sample);
+  return STATUS_OK;
+}
+
+static void apu_update_track(apu_output_track_t *const track, uint32_t const time, int32_t const left_level, int32_t const right_level)
+{
+  if (left_level != track->left_level)
+  {
+    blip_buffer_add_delta(&track->left, time, left_level - track->left_level);
+    track->left_level = left_level;
+  }
+
+  if (right_level != track->right_level)
+  {
+    blip_buffer_add_delta(&track->right, time, right_level - track->right_level);
+    track->right_level = right_level;
+  }
+}
+
+static void apu_end_track_frame(apu_output_track_t *const track, uint32_t const ticks)
+{
+  blip_buffer_end_frame(&track->left, ticks);
+  blip_buffer_end_frame(&track->right, ticks);
+}
+
+/**
+ * Hand the available frames of a track over to its consumer. If the consumer has fallen behind and the
+ * sample buffer is full, the frames that don't fit are dropped rather than blocking emulation.
+ *
+ * @return The number of frames read out of the blip buffers
+ */
+static uint32_t apu_read_track(apu_output_track_t *const track)
+{
+  int16_t left_samples[OUTPUT_CHUNK_FRAMES];
+  int16_t right_samples[OUTPUT_CHUNK_FRAMES];
+  sample_frame_t frames[OUTPUT_CHUNK_FRAMES];
+  uint32_t frame_count = 0;
+
+  while (blip_buffer_samples_avail(&track->left) > 0)
+  {
+    uint32_t const count = blip_buffer_read_samples(&track->left, left_samples, OUTPUT_CHUNK_FRAMES);
+    blip_buffer_read_samples(&track->right, right_samples, count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+      frames[i].left = left_samples[i];
+      frames[i].right = right_samples[i];
     }
+
+    sample_buffer_write(&track->sample_buffer, frames, count);
+    frame_count += count;
   }
 
-  return STATUS_OK;
+  return frame_count;
 }
 
 static status_code_t apu_bus_read(void *const resource, uint16_t const address, uint8_t *const data)
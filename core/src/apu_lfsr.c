@@ -13,6 +13,7 @@ static status_code_t apu_lfsr_write(void *const resource, uint16_t const address
 
 static status_code_t update_envelope(apu_lfsr_handle_t *const apu_lfsr);
 static inline uint8_t get_current_amplitude(apu_lfsr_handle_t *const apu_lfsr);
+static inline void shift_lfsr(apu_lfsr_handle_t *const apu_lfsr);
 static inline void trigger_channel(apu_lfsr_handle_t *const apu_lfsr);
 static inline bool length_timer_enabled(apu_lfsr_handle_t *const apu_lfsr);
 
@@ -28,31 +29,42 @@ status_code_t apu_lfsr_init(apu_lfsr_handle_t *const apu_lfsr)
   return STATUS_OK;
 }
 
-status_code_t apu_lfsr_tick(apu_lfsr_handle_t *const apu_lfsr)
+status_code_t apu_lfsr_advance(apu_lfsr_handle_t *const apu_lfsr, uint32_t const ticks)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu_lfsr);
 
-  if (apu_lfsr->state.period_counter == 0)
+  if (ticks <= apu_lfsr->state.period_counter)
   {
-    uint8_t clock_divider = apu_lfsr->registers.frqrand & APU_FRQRAND_CLK_DIV;
-    uint8_t clock_shift = (apu_lfsr->registers.frqrand & APU_FRQRAND_CLK_SHIFT) >> 4;
+    apu_lfsr->state.period_counter -= ticks;
+    return STATUS_OK;
+  }
 
-    apu_lfsr->state.period_counter = (clock_divider ? (clock_divider << 4) : 8) << clock_shift;
+  uint8_t const clock_divider = apu_lfsr->registers.frqrand & APU_FRQRAND_CLK_DIV;
+  uint8_t const clock_shift = (apu_lfsr->registers.frqrand & APU_FRQRAND_CLK_SHIFT) >> 4;
 
-    uint8_t xor_result = (apu_lfsr->state.lfsr & 0x1) ^ ((apu_lfsr->state.lfsr & 0x2) >> 1);
-    apu_lfsr->state.lfsr = (apu_lfsr->state.lfsr >> 1) | (xor_result << 14);
+  /** The period is truncated to the 16-bit counter, and a period of 0 wraps it around */
+  uint32_t period = (uint16_t)((clock_divider ? (clock_divider << 4) : 8) << clock_shift);
+  period = period ? period : (UINT16_MAX + 1);
 
-    if (apu_lfsr->registers.frqrand & APU_FRQRAND_LFSR_WIDTH)
-    {
-      apu_lfsr->state.lfsr &= ~(1 << 6);
-      apu_lfsr->state.lfsr |= (xor_result << 6);
-    }
+  uint32_t const ticks_after_step = ticks - apu_lfsr->state.period_counter - 1;
+  uint32_t steps = 1 + (ticks_after_step / period);
+
+  apu_lfsr->state.period_counter = period - 1 - (ticks_after_step % period);
+
+  /** Triggering the channel resets the LFSR, so it only needs to be shifted while it's audible */
+  while (apu_lfsr->state.enabled && steps--)
+  {
+    shift_lfsr(apu_lfsr);
   }
 
-  apu_lfsr->state.period_counter--;
   return STATUS_OK;
 }
 
+uint32_t apu_lfsr_ticks_until_step(apu_lfsr_handle_t const *const apu_lfsr)
+{
+  return apu_lfsr->state.period_counter + 1;
+}
+
 status_code_t apu_lfsr_reset(apu_lfsr_handle_t *const apu_lfsr)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu_lfsr);
@@ -63,12 +75,12 @@ status_code_t apu_lfsr_reset(apu_lfsr_handle_t *const apu_lfsr)
   return STATUS_OK;
 }
 
-status_code_t apu_lfsr_sample(apu_lfsr_handle_t *const apu_lfsr, float *const sample_out)
+status_code_t apu_lfsr_sample(apu_lfsr_handle_t *const apu_lfsr, uint8_t *const sample_out)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu_lfsr);
   VERIFY_PTR_RETURN_ERROR_IF_NULL(sample_out);
 
-  *sample_out = apu_lfsr->state.enabled ? (get_current_amplitude(apu_lfsr) * (apu_lfsr->state.volume / 15.0f)) : 0.0f;
+  *sample_out = apu_lfsr->state.enabled ? (get_current_amplitude(apu_lfsr) * apu_lfsr->state.volume) : 0;
   return STATUS_OK;
 }
 
@@ -124,6 +136,18 @@ static inline uint8_t get_current_amplitude(apu_lfsr_handle_t *const apu_lfsr)
   return ~apu_lfsr->state.lfsr & 0x1;
 }
 
+static inline void shift_lfsr(apu_lfsr_handle_t *const apu_lfsr)
+{
+  uint8_t xor_result = (apu_lfsr->state.lfsr & 0x1) ^ ((apu_lfsr->state.lfsr & 0x2) >> 1);
+  apu_lfsr->state.lfsr = (apu_lfsr->state.lfsr >> 1) | (xor_result << 14);
+
+  if (apu_lfsr->registers.frqrand & APU_FRQRAND_LFSR_WIDTH)
+  {
+    apu_lfsr->state.lfsr &= ~(1 << 6);
+    apu_lfsr->state.lfsr |= (xor_result << 6);
+  }
+}
+
 static inline bool length_timer_enabled(apu_lfsr_handle_t *const apu_lfsr)
 {
   return !!(apu_lfsr->registers.ctrl & APU_LENGTH_EN);
@@ -42,21 +42,32 @@ status_code_t apu_pwm_init(apu_pwm_handle_t *const apu_pwm, bool const with_swee
   return STATUS_OK;
 }
 
-status_code_t apu_pwm_tick(apu_pwm_handle_t *const apu_pwm)
+status_code_t apu_pwm_advance(apu_pwm_handle_t *const apu_pwm, uint32_t const ticks)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu_pwm);
 
-  if (apu_pwm->state.period_counter == 0)
+  if (ticks <= apu_pwm->state.period_counter)
   {
-    apu_pwm->state.period_counter = 2048 - get_channel_period(apu_pwm);
-    apu_pwm->state.wave_duty_position++;
-    apu_pwm->state.wave_duty_position &= 0x7;
+    apu_pwm->state.period_counter -= ticks;
+    return STATUS_OK;
   }
 
-  apu_pwm->state.period_counter--;
+  /** The duty position steps when the counter runs out, then once every period after that */
+  uint32_t const period = 2048 - get_channel_period(apu_pwm);
+  uint32_t const ticks_after_step = ticks - apu_pwm->state.period_counter - 1;
+  uint32_t const steps = 1 + (ticks_after_step / period);
+
+  apu_pwm->state.period_counter = period - 1 - (ticks_after_step % period);
+  apu_pwm->state.wave_duty_position = (apu_pwm->state.wave_duty_position + steps) & 0x7;
+
   return STATUS_OK;
 }
 
+uint32_t apu_pwm_ticks_until_step(apu_pwm_handle_t const *const apu_pwm)
+{
+  return apu_pwm->state.period_counter + 1;
+}
+
 status_code_t apu_pwm_reset(apu_pwm_handle_t *const apu_pwm)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu_pwm);
@@ -71,12 +82,12 @@ status_code_t apu_pwm_reset(apu_pwm_handle_t *const apu_pwm)
   return STATUS_OK;
 }
 
-status_code_t apu_pwm_sample(apu_pwm_handle_t *const apu_pwm, float *const sample_out)
+status_code_t apu_pwm_sample(apu_pwm_handle_t *const apu_pwm, uint8_t *const sample_out)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu_pwm);
   VERIFY_PTR_RETURN_ERROR_IF_NULL(sample_out);
 
-  *sample_out = apu_pwm->state.enabled ? (get_current_amplitude(apu_pwm) * (apu_pwm->state.volume / 15.0f)) : 0.0f;
+  *sample_out = apu_pwm->state.enabled ? (get_current_amplitude(apu_pwm) * apu_pwm->state.volume) : 0;
   return STATUS_OK;
 }
 
@@ -36,21 +36,34 @@ status_code_t apu_wave_init(apu_wave_handle_t *const apu_wave)
   return STATUS_OK;
 }
 
-status_code_t apu_wave_tick(apu_wave_handle_t *const apu_wave)
+status_code_t apu_wave_advance(apu_wave_handle_t *const apu_wave, uint32_t const ticks)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu_wave);
 
-  if (apu_wave->state.period_timer == 0)
+  if (ticks <= apu_wave->state.period_timer)
   {
-    apu_wave->state.period_timer = (2048 - get_channel_period(apu_wave)) >> 1;
-    apu_wave->state.sample_index++;
-    apu_wave->state.sample_index &= 0x1F;
+    apu_wave->state.period_timer -= ticks;
+    return STATUS_OK;
   }
 
-  apu_wave->state.period_timer--;
+  /** A period of 0 wraps the 16-bit timer around */
+  uint32_t period = (2048 - get_channel_period(apu_wave)) >> 1;
+  period = period ? period : (UINT16_MAX + 1);
+
+  uint32_t const ticks_after_step = ticks - apu_wave->state.period_timer - 1;
+  uint32_t const steps = 1 + (ticks_after_step / period);
+
+  apu_wave->state.period_timer = period - 1 - (ticks_after_step % period);
+  apu_wave->state.sample_index = (apu_wave->state.sample_index + steps) & 0x1F;
+
   return STATUS_OK;
 }
 
+uint32_t apu_wave_ticks_until_step(apu_wave_handle_t const *const apu_wave)
+{
+  return apu_wave->state.period_timer + 1;
+}
+
 status_code_t apu_wave_reset(apu_wave_handle_t *const apu_wave)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu_wave);
@@ -61,7 +74,7 @@ status_code_t apu_wave_reset(apu_wave_handle_t *const apu_wave)
   return STATUS_OK;
 }
 
-status_code_t apu_wave_sample(apu_wave_handle_t *const apu_wave, float *const sample_out)
+status_code_t apu_wave_sample(apu_wave_handle_t *const apu_wave, uint8_t *const sample_out)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(apu_wave);
   VERIFY_PTR_RETURN_ERROR_IF_NULL(sample_out);
@@ -71,7 +84,7 @@ status_code_t apu_wave_sample(apu_wave_handle_t *const apu_wave, float *const sa
   uint8_t vol_shift_index = (apu_wave->registers.vol & APU_WAVE_VOL) >> 5;
   uint8_t volume_shift = volume_shift_table[vol_shift_index];
 
-  *sample_out = apu_wave->state.enabled ? ((get_current_amplitude(apu_wave) >> volume_shift) / 15.0f) : 0;
+  *sample_out = apu_wave->state.enabled ? (get_current_amplitude(apu_wave) >> volume_shift) : 0;
   return STATUS_OK;
 }
 
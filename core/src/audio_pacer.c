@@ -0,0 +1,57 @@
+#include "audio_pacer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "status_code.h"
+
+#define RATE_ADJUST_SMOOTHING (8) /** Fraction of the way to the desired adjustment taken each frame */
+
+status_code_t audio_pacer_init(audio_pacer_t *const pacer, uint32_t const device_buffer_frames)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(pacer);
+
+  pacer->device_buffer_frames = device_buffer_frames;
+  pacer->target_buffered_frames = 2 * device_buffer_frames;
+  pacer->rate_adjust_ppm = 0;
+
+  return STATUS_OK;
+}
+
+bool audio_pacer_must_wait(audio_pacer_t const *const pacer, uint32_t const buffered_frames)
+{
+  return (pacer != NULL) && (pacer->device_buffer_frames > 0) && (buffered_frames > pacer->target_buffered_frames);
+}
+
+status_code_t audio_pacer_update(audio_pacer_t *const pacer, uint32_t const buffered_frames, bool *const paced)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(pacer);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(paced);
+
+  if (pacer->device_buffer_frames == 0)
+  {
+    pacer->rate_adjust_ppm = 0;
+    *paced = false;
+    return STATUS_OK;
+  }
+
+  uint32_t const low_level = pacer->target_buffered_frames - pacer->device_buffer_frames;
+  uint32_t const shortfall = (buffered_frames < low_level) ? (low_level - buffered_frames) : 0;
+  int32_t const desired_ppm = (shortfall * AUDIO_PACER_MAX_RATE_ADJUST_PPM) / low_level;
+
+  int32_t const gap_ppm = desired_ppm - pacer->rate_adjust_ppm;
+
+  /** The smoothed step truncates to nothing once the gap is small, so the rest is closed in one go */
+  if ((gap_ppm < RATE_ADJUST_SMOOTHING) && (gap_ppm > -RATE_ADJUST_SMOOTHING))
+  {
+    pacer->rate_adjust_ppm = desired_ppm;
+  }
+  else
+  {
+    pacer->rate_adjust_ppm += gap_ppm / RATE_ADJUST_SMOOTHING;
+  }
+
+  *paced = true;
+
+  return STATUS_OK;
+}
@@ -0,0 +1,137 @@
+#include "blip_buffer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "status_code.h"
+
+#define BLIP_PHASE_BITS (5)
+#define BLIP_PHASE_COUNT (1 << BLIP_PHASE_BITS)
+#define BLIP_DELTA_BITS (15) /** Kernel taps of each phase add up to 1 << BLIP_DELTA_BITS */
+#define BLIP_BASS_SHIFT (9)  /** High-pass filter strength; about 14 Hz at 44 kHz */
+
+/**
+ * Band-limited impulse, a Blackman-windowed sinc cut off at 0.45 of the output sample rate, sampled at
+ * each phase between two output samples. The taps of each phase add up to exactly 1 << BLIP_DELTA_BITS
+ * so that changes that cancel out don't leave a DC offset behind. Each phase is stored in full, rather
+ * than as mirrored halves, so that applying it is a straight multiply-add over contiguous taps that the
+ * compiler turns into vector instructions.
+ */
+static const int16_t blip_kernels[BLIP_PHASE_COUNT][BLIP_KERNEL_WIDTH] = {
+    {18, -110, 359, -843, 1561, -2371, 3025, 29490, 3025, -2371, 1561, -843, 359, -110, 18, 0},
+    {17, -108, 347, -795, 1421, -2025, 2117, 29452, 3974, -2714, 1693, -887, 369, -111, 18, 0},
+    {17, -105, 332, -742, 1276, -1679, 1252, 29332, 4960, -3051, 1818, -925, 376, -110, 17, 0},
+    {16, -102, 315, -686, 1128, -1335, 434, 29131, 5981, -3378, 1932, -956, 380, -109, 17, 0},
+    {16, -98, 297, -627, 977, -997, -336, 28853, 7031, -3693, 2036, -982, 381, -106, 16, 0},
+    {15, -93, 277, -566, 824, -665, -1055, 28499, 8106, -3992, 2127, -999, 378, -103, 15, 0},
+    {14, -87, 256, -503, 672, -343, -1721, 28067, 9203, -4273, 2204, -1009, 372, -97, 13, 0},
+    {13, -82, 234, -439, 522, -34, -2334, 27565, 10317, -4531, 2266, -1011, 362, -91, 11, 0},
+    {12, -76, 211, -375, 374, 262, -2891, 26992, 11444, -4765, 2311, -1004, 348, -83, 8, 0},
+    {10, -69, 188, -311, 229, 543, -3394, 26350, 12577, -4970, 2339, -987, 330, -73, 6, 0},
+    {9, -63, 165, -248, 90, 807, -3840, 25646, 13712, -5144, 2348, -962, 308, -62, 2, 0},
+    {8, -56, 142, -186, -44, 1052, -4231, 24877, 14845, -5283, 2338, -926, 282, -50, -1, 1},
+    {7, -50, 119, -126, -171, 1277, -4566, 24057, 15970, -5386, 2307, -881, 251, -36, -5, 1},
+    {6, -44, 96, -68, -291, 1482, -4846, 23182, 17081, -5448, 2255, -825, 217, -21, -10, 2},
+    {5, -37, 74, -12, -403, 1666, -5072, 22257, 18174, -5467, 2182, -760, 178, -4, -15, 2},
+    {4, -31, 53, 41, -506, 1828, -5246, 21289, 19243, -5441, 2086, -685, 136, 14, -20, 3},
+    {3, -25, 33, 90, -600, 1968, -5368, 20283, 20283, -5368, 1968, -600, 90, 33, -25, 3},
+    {3, -20, 14, 136, -685, 2086, -5441, 19243, 21289, -5246, 1828, -506, 41, 53, -31, 4},
+    {2, -15, -4, 178, -760, 2182, -5467, 18174, 22257, -5072, 1666, -403, -12, 74, -37, 5},
+    {2, -10, -21, 217, -825, 2255, -5448, 17081, 23182, -4846, 1482, -291, -68, 96, -44, 6},
+    {1, -5, -36, 251, -881, 2307, -5386, 15970, 24057, -4566, 1277, -171, -126, 119, -50, 7},
+    {1, -1, -50, 282, -926, 2338, -5283, 14845, 24877, -4231, 1052, -44, -186, 142, -56, 8},
+    {0, 2, -62, 308, -962, 2348, -5144, 13712, 25646, -3840, 807, 90, -248, 165, -63, 9},
+    {0, 6, -73, 330, -987, 2339, -4970, 12577, 26350, -3394, 543, 229, -311, 188, -69, 10},
+    {0, 8, -83, 348, -1004, 2311, -4765, 11444, 26992, -2891, 262, 374, -375, 211, -76, 12},
+    {0, 11, -91, 362, -1011, 2266, -4531, 10317, 27565, -2334, -34, 522, -439, 234, -82, 13},
+    {0, 13, -97, 372, -1009, 2204, -4273, 9203, 28067, -1721, -343, 672, -503, 256, -87, 14},
+    {0, 15, -103, 378, -999, 2127, -3992, 8106, 28499, -1055, -665, 824, -566, 277, -93, 15},
+    {0, 16, -106, 381, -982, 2036, -3693, 7031, 28853, -336, -997, 977, -627, 297, -98, 16},
+    {0, 17, -109, 380, -956, 1932, -3378, 5981, 29131, 434, -1335, 1128, -686, 315, -102, 16},
+    {0, 17, -110, 376, -925, 1818, -3051, 4960, 29332, 1252, -1679, 1276, -742, 332, -105, 17},
+    {0, 18, -111, 369, -887, 1693, -2714, 3974, 29452, 2117, -2025, 1421, -795, 347, -108, 17},
+};
+
+status_code_t blip_buffer_init(blip_buffer_t *const blip_buffer, uint32_t const clock_rate_hz, uint32_t const sample_rate_hz)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(blip_buffer);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE((sample_rate_hz == 0) || (sample_rate_hz > clock_rate_hz), STATUS_ERR_INVALID_ARG);
+
+  /** Rounded up so that a frame never covers fewer samples than it should */
+  uint64_t const scaled_rate = (uint64_t)sample_rate_hz << BLIP_TIME_BITS;
+  blip_buffer->nominal_factor = (scaled_rate + clock_rate_hz - 1) / clock_rate_hz;
+  blip_buffer->factor = blip_buffer->nominal_factor;
+  blip_buffer->offset = 0;
+  blip_buffer->integrator = 0;
+  memset(blip_buffer->deltas, 0, sizeof(blip_buffer->deltas));
+
+  return STATUS_OK;
+}
+
+status_code_t blip_buffer_set_rate_adjust(blip_buffer_t *const blip_buffer, int32_t const adjust_ppm)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(blip_buffer);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE((adjust_ppm > BLIP_MAX_RATE_ADJUST_PPM) || (adjust_ppm < -BLIP_MAX_RATE_ADJUST_PPM), STATUS_ERR_INVALID_ARG);
+
+  /** Only the frames that follow are affected; the changes already added stay where they were placed */
+  int64_t const adjustment = ((int64_t)blip_buffer->nominal_factor * adjust_ppm) / 1000000;
+  blip_buffer->factor = blip_buffer->nominal_factor + adjustment;
+
+  return STATUS_OK;
+}
+
+void blip_buffer_add_delta(blip_buffer_t *const blip_buffer, uint32_t const time, int32_t const delta)
+{
+  uint64_t const position = blip_buffer->offset + (time * blip_buffer->factor);
+  uint32_t const phase = (position >> (BLIP_TIME_BITS - BLIP_PHASE_BITS)) & (BLIP_PHASE_COUNT - 1);
+  int16_t const *const kernel = blip_kernels[phase];
+  int32_t *const deltas = &blip_buffer->deltas[position >> BLIP_TIME_BITS];
+
+  for (uint8_t i = 0; i < BLIP_KERNEL_WIDTH; i++)
+  {
+    deltas[i] += kernel[i] * delta;
+  }
+}
+
+void blip_buffer_end_frame(blip_buffer_t *const blip_buffer, uint32_t const duration)
+{
+  blip_buffer->offset += duration * blip_buffer->factor;
+}
+
+uint32_t blip_buffer_samples_avail(blip_buffer_t const *const blip_buffer)
+{
+  return blip_buffer->offset >> BLIP_TIME_BITS;
+}
+
+uint32_t blip_buffer_read_samples(blip_buffer_t *const blip_buffer, int16_t *const samples, uint32_t const count)
+{
+  if ((blip_buffer == NULL) || (samples == NULL))
+  {
+    return 0;
+  }
+
+  uint32_t const avail = blip_buffer_samples_avail(blip_buffer);
+  uint32_t const taken = (count < avail) ? count : avail;
+  int32_t sum = blip_buffer->integrator;
+
+  for (uint32_t i = 0; i < taken; i++)
+  {
+    int32_t sample = sum >> BLIP_DELTA_BITS;
+    sample = (sample > INT16_MAX) ? INT16_MAX : ((sample < INT16_MIN) ? INT16_MIN : sample);
+    samples[i] = sample;
+
+    sum += blip_buffer->deltas[i];
+    /** Leaks a little of the sum on every sample */
+    sum -= sample * (1 << (BLIP_DELTA_BITS - BLIP_BASS_SHIFT));
+  }
+
+  blip_buffer->integrator = sum;
+
+  /** Shift the remaining changes, including the tails of the kernels past the last available sample, to the front */
+  uint32_t const remaining = avail - taken + BLIP_KERNEL_WIDTH;
+  memmove(blip_buffer->deltas, &blip_buffer->deltas[taken], remaining * sizeof(int32_t));
+  memset(&blip_buffer->deltas[remaining], 0, taken * sizeof(int32_t));
+  blip_buffer->offset -= (uint64_t)taken << BLIP_TIME_BITS;
+
+  return taken;
+}
@@ -2,6 +2,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include "status_code.h"
@@ -10,143 +11,63 @@
 #include "bus_interface.h"
 #include "debug_serial.h"
 
-#define INST(handler_fn, dest_operand, src_operand, inst_length, cycle, alt_cycle) \
-  ((instruction_t){                                                                \
-      .handler = handler_fn,                                                       \
-      .operands = {                                                                \
-          .op_1 = (uint16_t)dest_operand,                                          \
-          .op_2 = (uint16_t)src_operand,                                           \
-      },                                                                           \
-      .length = inst_length,                                                       \
-      .cycle_duration = cycle,                                                     \
-      .alt_cycle_duration = alt_cycle,                                             \
+#define INST(handler_fn, cycle)   \
+  ((instruction_t){               \
+      .handler = handler_fn,      \
+      .cycle_duration = cycle,    \
   })
 
-/* Addressing mode enum */
-typedef enum
-{
-  AM_NONE,
-  AM_IMM_S_8,
-  AM_IMM_D_8,
-  AM_IMM_D_16,
-  AM_IMM_A_16,
-  AM_REG_AF,
-  AM_REG_BC,
-  AM_REG_DE,
-  AM_REG_HL,
-  AM_REG_SP,
-  AM_REG_A,
-  AM_REG_B,
-  AM_REG_C,
-  AM_REG_D,
-  AM_REG_E,
-  AM_REG_F,
-  AM_REG_H,
-  AM_REG_L,
-  AM_MEM_AF,
-  AM_MEM_BC,
-  AM_MEM_DE,
-  AM_MEM_HL,
-  AM_MEM_HL_INC,
-  AM_MEM_HL_DEC,
-  AM_IMM_FF_A_8,
-  AM_MEM_FF_REG_C,
-  AM_REG_SP_IMM_S8,
-} addressing_mode_t;
-
-typedef enum
-{
-  JM_UNCOND,
-  JM_COND_Z,
-  JM_COND_C,
-  JM_COND_NZ,
-  JM_COND_NC,
-} jump_mode_t;
-
-typedef enum
-{
-  RST_VEC_0 = 0x00,
-  RST_VEC_1 = 0x08,
-  RST_VEC_2 = 0x10,
-  RST_VEC_3 = 0x18,
-  RST_VEC_4 = 0x20,
-  RST_VEC_5 = 0x28,
-  RST_VEC_6 = 0x30,
-  RST_VEC_7 = 0x38,
-} reset_vector_t;
-
-typedef struct
-{
-  union
-  {
-    uint16_t op_1;
-    addressing_mode_t dest;
-    jump_mode_t jump_mode;
-    reset_vector_t reset_vector;
-  };
-  union
-  {
-    uint16_t op_2;
-    addressing_mode_t source;
-  };
-} inst_operands_t;
-
-typedef enum
-{
-  F_CLEAR = 0,
-  F_SET,
-  F_INVERT,
-} flag_mode_t;
-
-typedef union
-{
-  struct
-  {
-    uint8_t lsb;
-    uint8_t msb;
-  };
-  uint16_t val;
-} address_t;
-
-typedef union
-{
-  uint8_t u_data;
-  int8_t s_data;
-} data8_t;
-
-typedef uint8_t *reg_8_ptr_t;
-typedef uint16_t *reg_16_ptr_t;
-typedef status_code_t (*opcode_handler_fn)(cpu_state_t *const state, inst_operands_t *const operands);
+/* Serial transfer control register */
+#define SERIAL_CONTROL_ADDR (0xFF02)
+
+/* Address ranges whose contents depend on device state */
+#define VRAM_START_ADDR (0x8000)
+#define EXT_RAM_START_ADDR (0xA000)
+#define OAM_START_ADDR (0xFE00)
+#define HRAM_START_ADDR (0xFF80)
+#define IE_REG_ADDR (0xFFFF)
+
+/**
+ * Register tokens used by the opcode generator macros below.
+ * Each opcode handler is specialized at compile time for its operands,
+ * so no addressing mode has to be decoded while executing an instruction.
+ */
+#define REG_A a
+#define REG_B b
+#define REG_C c
+#define REG_D d
+#define REG_E e
+#define REG_H h
+#define REG_L l
+#define REG_AF af
+#define REG_BC bc
+#define REG_DE de
+#define REG_HL hl
+#define REG_SP sp
+
+/* Branch conditions used by the opcode generator macros below */
+#define COND_NZ(regs) (!((regs)->f & FLAG_Z))
+#define COND_Z(regs) ((regs)->f & FLAG_Z)
+#define COND_NC(regs) (!((regs)->f & FLAG_C))
+#define COND_C(regs) ((regs)->f & FLAG_C)
+
+typedef status_code_t (*opcode_handler_fn)(cpu_state_t *const state, registers_t *const regs);
 
 typedef struct instruction_s
 {
   opcode_handler_fn handler;
-  inst_operands_t operands;
-  uint8_t length;
+
+  /**
+   * Duration of the instruction in M-cycles. For conditional branches this is the
+   * duration of the branch not taken; the handler syncs the extra cycles of a taken branch.
+   */
   uint8_t cycle_duration;
-  uint8_t alt_cycle_duration;
 } instruction_t;
 
-typedef union
-{
-  status_code_t (*rot_shf_swap_handler_fn)(cpu_state_t *const state, addressing_mode_t const addr_mode);
-  status_code_t (*test_set_rst_handler_fn)(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t bit_index);
-} cb_opcode_handler_t;
-
-reg_8_ptr_t reg_8_select(cpu_state_t *const state, addressing_mode_t const addr_mode);
-reg_16_ptr_t reg_16_select(cpu_state_t *const state, addressing_mode_t const addr_mode);
-uint8_t calc_cycle(uint8_t opcode, cpu_state_t *const state);
-static inline void update_flags(cpu_state_t *const state, uint8_t mask, flag_mode_t mode);
-static inline uint8_t check_cond(cpu_state_t *const state, jump_mode_t mode);
-
-static status_code_t fetch(cpu_state_t *const state, uint8_t *const data);
-status_code_t read_8(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t *const data);
-status_code_t write_8(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t const data);
-status_code_t read_16(cpu_state_t *const state, addressing_mode_t const addr_mode, uint16_t *const data);
-status_code_t write_16(cpu_state_t *const state, addressing_mode_t const addr_mode, uint16_t const data);
-status_code_t push_reg_16(cpu_state_t *const state, reg_16_ptr_t reg);
-status_code_t pop_reg_16(cpu_state_t *const state, reg_16_ptr_t reg);
-status_code_t read_reg_16_plus_offset(cpu_state_t *const state, addressing_mode_t const addr_mode, uint16_t *const data);
+static status_code_t fetch(cpu_state_t *const state, registers_t *const regs, uint8_t *const data);
+static status_code_t fetch_16(cpu_state_t *const state, registers_t *const regs, uint16_t *const data);
+static status_code_t push_16(cpu_state_t *const state, registers_t *const regs, uint16_t const data);
+static status_code_t pop_16(cpu_state_t *const state, registers_t *const regs, uint16_t *const data);
 
 static inline status_code_t bus_read_8(cpu_state_t *const state, uint16_t address, uint8_t *const data);
 static inline status_code_t bus_write_8(cpu_state_t *const state, uint16_t address, uint8_t const data);
@@ -155,396 +76,8 @@ static inline status_code_t bus_write_16(cpu_state_t *const state, uint16_t addr
 
 static status_code_t handle_interrupt(void *const ctx, const void *arg);
 static status_code_t sync_cycles(cpu_state_t *const state, uint8_t const m_cycle_count);
-
-static status_code_t op_NOT_IMPL(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_NOP(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_STOP(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_HALT(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_JR(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_JP(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_LD_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_LD_16(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_INC_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_INC_16(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_DEC_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_DEC_16(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_ADD_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_ADC_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_SUB_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_SBC_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_AND_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_XOR_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_OR_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_CP_8(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_ADD_16(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_RLCA(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_RRCA(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_RLA(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_RRA(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_CPL(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_SCF(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_CCF(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_RET(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_CALL(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_POP(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_PUSH(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_RST(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_DAA(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_RETI(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_DI(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_EI(cpu_state_t *const state, inst_operands_t *const operands);
-static status_code_t op_PRCB(cpu_state_t *const state, inst_operands_t *const operands);
-
-/* Ops for CB-prefixed opcodes */
-static status_code_t op_RLC(cpu_state_t *const state, addressing_mode_t const addr_mode);
-static status_code_t op_RRC(cpu_state_t *const state, addressing_mode_t const addr_mode);
-static status_code_t op_RL(cpu_state_t *const state, addressing_mode_t const addr_mode);
-static status_code_t op_RR(cpu_state_t *const state, addressing_mode_t const addr_mode);
-static status_code_t op_SLA(cpu_state_t *const state, addressing_mode_t const addr_mode);
-static status_code_t op_SRA(cpu_state_t *const state, addressing_mode_t const addr_mode);
-static status_code_t op_SWAP(cpu_state_t *const state, addressing_mode_t const addr_mode);
-static status_code_t op_SRL(cpu_state_t *const state, addressing_mode_t const addr_mode);
-static status_code_t op_BIT(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t const bit_index);
-static status_code_t op_RES(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t const bit_index);
-static status_code_t op_SET(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t const bit_index);
-
-static instruction_t inst_table[] = {
-    /* 0x00 - 0x0F */
-    [0x00] = INST(op_NOP, AM_NONE, AM_NONE, 1, 1, 0),
-    [0x01] = INST(op_LD_16, AM_REG_BC, AM_IMM_D_16, 3, 3, 0),
-    [0x02] = INST(op_LD_8, AM_MEM_BC, AM_REG_A, 1, 2, 0),
-    [0x03] = INST(op_INC_16, AM_REG_BC, AM_NONE, 1, 2, 0),
-
-    [0x04] = INST(op_INC_8, AM_REG_B, AM_NONE, 1, 1, 0),
-    [0x05] = INST(op_DEC_8, AM_REG_B, AM_NONE, 1, 1, 0),
-    [0x06] = INST(op_LD_8, AM_REG_B, AM_IMM_D_8, 2, 2, 0),
-    [0x07] = INST(op_RLCA, AM_NONE, AM_NONE, 1, 1, 0),
-
-    [0x08] = INST(op_LD_16, AM_IMM_A_16, AM_REG_SP, 3, 5, 0),
-    [0x09] = INST(op_ADD_16, AM_REG_HL, AM_REG_BC, 1, 2, 0),
-    [0x0A] = INST(op_LD_8, AM_REG_A, AM_MEM_BC, 1, 2, 0),
-    [0x0B] = INST(op_DEC_16, AM_REG_BC, AM_NONE, 1, 2, 0),
-
-    [0x0C] = INST(op_INC_8, AM_REG_C, AM_NONE, 1, 1, 0),
-    [0x0D] = INST(op_DEC_8, AM_REG_C, AM_NONE, 1, 1, 0),
-    [0x0E] = INST(op_LD_8, AM_REG_C, AM_IMM_D_8, 2, 2, 0),
-    [0x0F] = INST(op_RRCA, AM_NONE, AM_NONE, 1, 1, 0),
-
-    /* 0x10 - 0x1F */
-    [0x10] = INST(op_STOP, AM_NONE, AM_NONE, 2, 1, 0),
-    [0x11] = INST(op_LD_16, AM_REG_DE, AM_IMM_D_16, 3, 3, 0),
-    [0x12] = INST(op_LD_8, AM_MEM_DE, AM_REG_A, 1, 2, 0),
-    [0x13] = INST(op_INC_16, AM_REG_DE, AM_NONE, 1, 2, 0),
-
-    [0x14] = INST(op_INC_8, AM_REG_D, AM_NONE, 1, 1, 0),
-    [0x15] = INST(op_DEC_8, AM_REG_D, AM_NONE, 1, 1, 0),
-    [0x16] = INST(op_LD_8, AM_REG_D, AM_IMM_D_8, 2, 2, 0),
-    [0x17] = INST(op_RLA, AM_NONE, AM_NONE, 1, 1, 0),
-
-    [0x18] = INST(op_JR, JM_UNCOND, AM_IMM_S_8, 2, 3, 0),
-    [0x19] = INST(op_ADD_16, AM_REG_HL, AM_REG_DE, 1, 2, 0),
-    [0x1A] = INST(op_LD_8, AM_REG_A, AM_MEM_DE, 1, 2, 0),
-    [0x1B] = INST(op_DEC_16, AM_REG_DE, AM_NONE, 1, 2, 0),
-
-    [0x1C] = INST(op_INC_8, AM_REG_E, AM_NONE, 1, 1, 0),
-    [0x1D] = INST(op_DEC_8, AM_REG_E, AM_NONE, 1, 1, 0),
-    [0x1E] = INST(op_LD_8, AM_REG_E, AM_IMM_D_8, 2, 2, 0),
-    [0x1F] = INST(op_RRA, AM_NONE, AM_NONE, 1, 1, 0),
-
-    /* 0x20 - 0x2F */
-    [0x20] = INST(op_JR, JM_COND_NZ, AM_IMM_S_8, 2, 3, 2),
-    [0x21] = INST(op_LD_16, AM_REG_HL, AM_IMM_D_16, 3, 3, 0),
-    [0x22] = INST(op_LD_8, AM_MEM_HL_INC, AM_REG_A, 1, 2, 0),
-    [0x23] = INST(op_INC_16, AM_REG_HL, AM_NONE, 1, 2, 0),
-
-    [0x24] = INST(op_INC_8, AM_REG_H, AM_NONE, 1, 1, 0),
-    [0x25] = INST(op_DEC_8, AM_REG_H, AM_NONE, 1, 1, 0),
-    [0x26] = INST(op_LD_8, AM_REG_H, AM_IMM_D_8, 2, 2, 0),
-    [0x27] = INST(op_DAA, AM_NONE, AM_NONE, 1, 1, 0),
-
-    [0x28] = INST(op_JR, JM_COND_Z, AM_IMM_S_8, 2, 3, 2),
-    [0x29] = INST(op_ADD_16, AM_REG_HL, AM_REG_HL, 1, 2, 0),
-    [0x2A] = INST(op_LD_8, AM_REG_A, AM_MEM_HL_INC, 1, 2, 0),
-    [0x2B] = INST(op_DEC_16, AM_REG_HL, AM_NONE, 1, 2, 0),
-
-    [0x2C] = INST(op_INC_8, AM_REG_L, AM_NONE, 1, 1, 0),
-    [0x2D] = INST(op_DEC_8, AM_REG_L, AM_NONE, 1, 1, 0),
-    [0x2E] = INST(op_LD_8, AM_REG_L, AM_IMM_D_8, 2, 2, 0),
-    [0x2F] = INST(op_CPL, AM_NONE, AM_NONE, 1, 1, 0),
-
-    /* 0x30 - 0x3F */
-    [0x30] = INST(op_JR, JM_COND_NC, AM_IMM_S_8, 2, 3, 2),
-    [0x31] = INST(op_LD_16, AM_REG_SP, AM_IMM_D_16, 3, 3, 0),
-    [0x32] = INST(op_LD_8, AM_MEM_HL_DEC, AM_REG_A, 1, 2, 0),
-    [0x33] = INST(op_INC_16, AM_REG_SP, AM_NONE, 1, 2, 0),
-
-    [0x34] = INST(op_INC_8, AM_MEM_HL, AM_NONE, 1, 3, 0),
-    [0x35] = INST(op_DEC_8, AM_MEM_HL, AM_NONE, 1, 3, 0),
-    [0x36] = INST(op_LD_8, AM_MEM_HL, AM_IMM_D_8, 2, 3, 0),
-    [0x37] = INST(op_SCF, AM_NONE, AM_NONE, 1, 1, 0),
-
-    [0x38] = INST(op_JR, JM_COND_C, AM_IMM_S_8, 2, 3, 2),
-    [0x39] = INST(op_ADD_16, AM_REG_HL, AM_REG_SP, 1, 2, 0),
-    [0x3A] = INST(op_LD_8, AM_REG_A, AM_MEM_HL_DEC, 1, 2, 0),
-    [0x3B] = INST(op_DEC_16, AM_REG_SP, AM_NONE, 1, 2, 0),
-
-    [0x3C] = INST(op_INC_8, AM_REG_A, AM_NONE, 1, 1, 0),
-    [0x3D] = INST(op_DEC_8, AM_REG_A, AM_NONE, 1, 1, 0),
-    [0x3E] = INST(op_LD_8, AM_REG_A, AM_IMM_D_8, 2, 2, 0),
-    [0x3F] = INST(op_CCF, AM_NONE, AM_NONE, 1, 1, 0),
-
-    /* 0x40 - 0x4F */
-    [0x40] = INST(op_LD_8, AM_REG_B, AM_REG_B, 1, 1, 0),
-    [0x41] = INST(op_LD_8, AM_REG_B, AM_REG_C, 1, 1, 0),
-    [0x42] = INST(op_LD_8, AM_REG_B, AM_REG_D, 1, 1, 0),
-    [0x43] = INST(op_LD_8, AM_REG_B, AM_REG_E, 1, 1, 0),
-
-    [0x44] = INST(op_LD_8, AM_REG_B, AM_REG_H, 1, 1, 0),
-    [0x45] = INST(op_LD_8, AM_REG_B, AM_REG_L, 1, 1, 0),
-    [0x46] = INST(op_LD_8, AM_REG_B, AM_MEM_HL, 1, 2, 0),
-    [0x47] = INST(op_LD_8, AM_REG_B, AM_REG_A, 1, 1, 0),
-
-    [0x48] = INST(op_LD_8, AM_REG_C, AM_REG_B, 1, 1, 0),
-    [0x49] = INST(op_LD_8, AM_REG_C, AM_REG_C, 1, 1, 0),
-    [0x4A] = INST(op_LD_8, AM_REG_C, AM_REG_D, 1, 1, 0),
-    [0x4B] = INST(op_LD_8, AM_REG_C, AM_REG_E, 1, 1, 0),
-
-    [0x4C] = INST(op_LD_8, AM_REG_C, AM_REG_H, 1, 1, 0),
-    [0x4D] = INST(op_LD_8, AM_REG_C, AM_REG_L, 1, 1, 0),
-    [0x4E] = INST(op_LD_8, AM_REG_C, AM_MEM_HL, 1, 2, 0),
-    [0x4F] = INST(op_LD_8, AM_REG_C, AM_REG_A, 1, 1, 0),
-
-    /* 0x50 - 0x5F */
-    [0x50] = INST(op_LD_8, AM_REG_D, AM_REG_B, 1, 1, 0),
-    [0x51] = INST(op_LD_8, AM_REG_D, AM_REG_C, 1, 1, 0),
-    [0x52] = INST(op_LD_8, AM_REG_D, AM_REG_D, 1, 1, 0),
-    [0x53] = INST(op_LD_8, AM_REG_D, AM_REG_E, 1, 1, 0),
-
-    [0x54] = INST(op_LD_8, AM_REG_D, AM_REG_H, 1, 1, 0),
-    [0x55] = INST(op_LD_8, AM_REG_D, AM_REG_L, 1, 1, 0),
-    [0x56] = INST(op_LD_8, AM_REG_D, AM_MEM_HL, 1, 2, 0),
-    [0x57] = INST(op_LD_8, AM_REG_D, AM_REG_A, 1, 1, 0),
-
-    [0x58] = INST(op_LD_8, AM_REG_E, AM_REG_B, 1, 1, 0),
-    [0x59] = INST(op_LD_8, AM_REG_E, AM_REG_C, 1, 1, 0),
-    [0x5A] = INST(op_LD_8, AM_REG_E, AM_REG_D, 1, 1, 0),
-    [0x5B] = INST(op_LD_8, AM_REG_E, AM_REG_E, 1, 1, 0),
-
-    [0x5C] = INST(op_LD_8, AM_REG_E, AM_REG_H, 1, 1, 0),
-    [0x5D] = INST(op_LD_8, AM_REG_E, AM_REG_L, 1, 1, 0),
-    [0x5E] = INST(op_LD_8, AM_REG_E, AM_MEM_HL, 1, 2, 0),
-    [0x5F] = INST(op_LD_8, AM_REG_E, AM_REG_A, 1, 1, 0),
-
-    /* 0x60 - 0x6F */
-    [0x60] = INST(op_LD_8, AM_REG_H, AM_REG_B, 1, 1, 0),
-    [0x61] = INST(op_LD_8, AM_REG_H, AM_REG_C, 1, 1, 0),
-    [0x62] = INST(op_LD_8, AM_REG_H, AM_REG_D, 1, 1, 0),
-    [0x63] = INST(op_LD_8, AM_REG_H, AM_REG_E, 1, 1, 0),
-
-    [0x64] = INST(op_LD_8, AM_REG_H, AM_REG_H, 1, 1, 0),
-    [0x65] = INST(op_LD_8, AM_REG_H, AM_REG_L, 1, 1, 0),
-    [0x66] = INST(op_LD_8, AM_REG_H, AM_MEM_HL, 1, 2, 0),
-    [0x67] = INST(op_LD_8, AM_REG_H, AM_REG_A, 1, 1, 0),
-
-    [0x68] = INST(op_LD_8, AM_REG_L, AM_REG_B, 1, 1, 0),
-    [0x69] = INST(op_LD_8, AM_REG_L, AM_REG_C, 1, 1, 0),
-    [0x6A] = INST(op_LD_8, AM_REG_L, AM_REG_D, 1, 1, 0),
-    [0x6B] = INST(op_LD_8, AM_REG_L, AM_REG_E, 1, 1, 0),
-
-    [0x6C] = INST(op_LD_8, AM_REG_L, AM_REG_H, 1, 1, 0),
-    [0x6D] = INST(op_LD_8, AM_REG_L, AM_REG_L, 1, 1, 0),
-    [0x6E] = INST(op_LD_8, AM_REG_L, AM_MEM_HL, 1, 2, 0),
-    [0x6F] = INST(op_LD_8, AM_REG_L, AM_REG_A, 1, 1, 0),
-
-    /* 0x70 - 0x7F */
-    [0x70] = INST(op_LD_8, AM_MEM_HL, AM_REG_B, 1, 2, 0),
-    [0x71] = INST(op_LD_8, AM_MEM_HL, AM_REG_C, 1, 2, 0),
-    [0x72] = INST(op_LD_8, AM_MEM_HL, AM_REG_D, 1, 2, 0),
-    [0x73] = INST(op_LD_8, AM_MEM_HL, AM_REG_E, 1, 2, 0),
-
-    [0x74] = INST(op_LD_8, AM_MEM_HL, AM_REG_H, 1, 2, 0),
-    [0x75] = INST(op_LD_8, AM_MEM_HL, AM_REG_L, 1, 2, 0),
-    [0x76] = INST(op_HALT, AM_NONE, AM_NONE, 1, 1, 0),
-    [0x77] = INST(op_LD_8, AM_MEM_HL, AM_REG_A, 1, 2, 0),
-
-    [0x78] = INST(op_LD_8, AM_REG_A, AM_REG_B, 1, 1, 0),
-    [0x79] = INST(op_LD_8, AM_REG_A, AM_REG_C, 1, 1, 0),
-    [0x7A] = INST(op_LD_8, AM_REG_A, AM_REG_D, 1, 1, 0),
-    [0x7B] = INST(op_LD_8, AM_REG_A, AM_REG_E, 1, 1, 0),
-
-    [0x7C] = INST(op_LD_8, AM_REG_A, AM_REG_H, 1, 1, 0),
-    [0x7D] = INST(op_LD_8, AM_REG_A, AM_REG_L, 1, 1, 0),
-    [0x7E] = INST(op_LD_8, AM_REG_A, AM_MEM_HL, 1, 2, 0),
-    [0x7F] = INST(op_LD_8, AM_REG_A, AM_REG_A, 1, 1, 0),
-
-    /* 0x80 - 0x8F */
-    [0x80] = INST(op_ADD_8, AM_REG_A, AM_REG_B, 1, 1, 0),
-    [0x81] = INST(op_ADD_8, AM_REG_A, AM_REG_C, 1, 1, 0),
-    [0x82] = INST(op_ADD_8, AM_REG_A, AM_REG_D, 1, 1, 0),
-    [0x83] = INST(op_ADD_8, AM_REG_A, AM_REG_E, 1, 1, 0),
-
-    [0x84] = INST(op_ADD_8, AM_REG_A, AM_REG_H, 1, 1, 0),
-    [0x85] = INST(op_ADD_8, AM_REG_A, AM_REG_L, 1, 1, 0),
-    [0x86] = INST(op_ADD_8, AM_REG_A, AM_MEM_HL, 1, 2, 0),
-    [0x87] = INST(op_ADD_8, AM_REG_A, AM_REG_A, 1, 1, 0),
-
-    [0x88] = INST(op_ADC_8, AM_REG_A, AM_REG_B, 1, 1, 0),
-    [0x89] = INST(op_ADC_8, AM_REG_A, AM_REG_C, 1, 1, 0),
-    [0x8A] = INST(op_ADC_8, AM_REG_A, AM_REG_D, 1, 1, 0),
-    [0x8B] = INST(op_ADC_8, AM_REG_A, AM_REG_E, 1, 1, 0),
-
-    [0x8C] = INST(op_ADC_8, AM_REG_A, AM_REG_H, 1, 1, 0),
-    [0x8D] = INST(op_ADC_8, AM_REG_A, AM_REG_L, 1, 1, 0),
-    [0x8E] = INST(op_ADC_8, AM_REG_A, AM_MEM_HL, 1, 2, 0),
-    [0x8F] = INST(op_ADC_8, AM_REG_A, AM_REG_A, 1, 1, 0),
-
-    /* 0x90 - 0x9F */
-    [0x90] = INST(op_SUB_8, AM_REG_A, AM_REG_B, 1, 1, 0),
-    [0x91] = INST(op_SUB_8, AM_REG_A, AM_REG_C, 1, 1, 0),
-    [0x92] = INST(op_SUB_8, AM_REG_A, AM_REG_D, 1, 1, 0),
-    [0x93] = INST(op_SUB_8, AM_REG_A, AM_REG_E, 1, 1, 0),
-
-    [0x94] = INST(op_SUB_8, AM_REG_A, AM_REG_H, 1, 1, 0),
-    [0x95] = INST(op_SUB_8, AM_REG_A, AM_REG_L, 1, 1, 0),
-    [0x96] = INST(op_SUB_8, AM_REG_A, AM_MEM_HL, 1, 2, 0),
-    [0x97] = INST(op_SUB_8, AM_REG_A, AM_REG_A, 1, 1, 0),
-
-    [0x98] = INST(op_SBC_8, AM_REG_A, AM_REG_B, 1, 1, 0),
-    [0x99] = INST(op_SBC_8, AM_REG_A, AM_REG_C, 1, 1, 0),
-    [0x9A] = INST(op_SBC_8, AM_REG_A, AM_REG_D, 1, 1, 0),
-    [0x9B] = INST(op_SBC_8, AM_REG_A, AM_REG_E, 1, 1, 0),
-
-    [0x9C] = INST(op_SBC_8, AM_REG_A, AM_REG_H, 1, 1, 0),
-    [0x9D] = INST(op_SBC_8, AM_REG_A, AM_REG_L, 1, 1, 0),
-    [0x9E] = INST(op_SBC_8, AM_REG_A, AM_MEM_HL, 1, 2, 0),
-    [0x9F] = INST(op_SBC_8, AM_REG_A, AM_REG_A, 1, 1, 0),
-
-    /* 0xA0 - 0xAF */
-    [0xA0] = INST(op_AND_8, AM_REG_A, AM_REG_B, 1, 1, 0),
-    [0xA1] = INST(op_AND_8, AM_REG_A, AM_REG_C, 1, 1, 0),
-    [0xA2] = INST(op_AND_8, AM_REG_A, AM_REG_D, 1, 1, 0),
-    [0xA3] = INST(op_AND_8, AM_REG_A, AM_REG_E, 1, 1, 0),
-
-    [0xA4] = INST(op_AND_8, AM_REG_A, AM_REG_H, 1, 1, 0),
-    [0xA5] = INST(op_AND_8, AM_REG_A, AM_REG_L, 1, 1, 0),
-    [0xA6] = INST(op_AND_8, AM_REG_A, AM_MEM_HL, 1, 2, 0),
-    [0xA7] = INST(op_AND_8, AM_REG_A, AM_REG_A, 1, 1, 0),
-
-    [0xA8] = INST(op_XOR_8, AM_REG_A, AM_REG_B, 1, 1, 0),
-    [0xA9] = INST(op_XOR_8, AM_REG_A, AM_REG_C, 1, 1, 0),
-    [0xAA] = INST(op_XOR_8, AM_REG_A, AM_REG_D, 1, 1, 0),
-    [0xAB] = INST(op_XOR_8, AM_REG_A, AM_REG_E, 1, 1, 0),
-
-    [0xAC] = INST(op_XOR_8, AM_REG_A, AM_REG_H, 1, 1, 0),
-    [0xAD] = INST(op_XOR_8, AM_REG_A, AM_REG_L, 1, 1, 0),
-    [0xAE] = INST(op_XOR_8, AM_REG_A, AM_MEM_HL, 1, 2, 0),
-    [0xAF] = INST(op_XOR_8, AM_REG_A, AM_REG_A, 1, 1, 0),
-
-    /* 0xB0 - 0xBF */
-    [0xB0] = INST(op_OR_8, AM_REG_A, AM_REG_B, 1, 1, 0),
-    [0xB1] = INST(op_OR_8, AM_REG_A, AM_REG_C, 1, 1, 0),
-    [0xB2] = INST(op_OR_8, AM_REG_A, AM_REG_D, 1, 1, 0),
-    [0xB3] = INST(op_OR_8, AM_REG_A, AM_REG_E, 1, 1, 0),
-
-    [0xB4] = INST(op_OR_8, AM_REG_A, AM_REG_H, 1, 1, 0),
-    [0xB5] = INST(op_OR_8, AM_REG_A, AM_REG_L, 1, 1, 0),
-    [0xB6] = INST(op_OR_8, AM_REG_A, AM_MEM_HL, 1, 2, 0),
-    [0xB7] = INST(op_OR_8, AM_REG_A, AM_REG_A, 1, 1, 0),
-
-    [0xB8] = INST(op_CP_8, AM_REG_A, AM_REG_B, 1, 1, 0),
-    [0xB9] = INST(op_CP_8, AM_REG_A, AM_REG_C, 1, 1, 0),
-    [0xBA] = INST(op_CP_8, AM_REG_A, AM_REG_D, 1, 1, 0),
-    [0xBB] = INST(op_CP_8, AM_REG_A, AM_REG_E, 1, 1, 0),
-
-    [0xBC] = INST(op_CP_8, AM_REG_A, AM_REG_H, 1, 1, 0),
-    [0xBD] = INST(op_CP_8, AM_REG_A, AM_REG_L, 1, 1, 0),
-    [0xBE] = INST(op_CP_8, AM_REG_A, AM_MEM_HL, 1, 2, 0),
-    [0xBF] = INST(op_CP_8, AM_REG_A, AM_REG_A, 1, 1, 0),
-
-    /* 0xC0 - 0xCF */
-    [0xC0] = INST(op_RET, JM_COND_NZ, AM_NONE, 1, 5, 2),
-    [0xC1] = INST(op_POP, AM_REG_BC, AM_NONE, 1, 3, 0),
-    [0xC2] = INST(op_JP, JM_COND_NZ, AM_IMM_A_16, 3, 4, 3),
-    [0xC3] = INST(op_JP, JM_UNCOND, AM_IMM_A_16, 3, 4, 0),
-
-    [0xC4] = INST(op_CALL, JM_COND_NZ, AM_IMM_A_16, 3, 6, 3),
-    [0xC5] = INST(op_PUSH, AM_REG_BC, AM_NONE, 1, 4, 0),
-    [0xC6] = INST(op_ADD_8, AM_REG_A, AM_IMM_D_8, 2, 2, 0),
-    [0xC7] = INST(op_RST, RST_VEC_0, AM_NONE, 1, 4, 0),
-
-    [0xC8] = INST(op_RET, JM_COND_Z, AM_NONE, 1, 5, 2),
-    [0xC9] = INST(op_RET, JM_UNCOND, AM_NONE, 1, 4, 0),
-    [0xCA] = INST(op_JP, JM_COND_Z, AM_IMM_A_16, 3, 4, 3),
-    [0xCB] = INST(op_PRCB, AM_NONE, AM_NONE, 1, 0, 0),
-
-    [0xCC] = INST(op_CALL, JM_COND_Z, AM_IMM_A_16, 3, 6, 3),
-    [0xCD] = INST(op_CALL, JM_UNCOND, AM_IMM_A_16, 3, 6, 0),
-    [0xCE] = INST(op_ADC_8, AM_REG_A, AM_IMM_D_8, 2, 2, 0),
-    [0xCF] = INST(op_RST, RST_VEC_1, AM_NONE, 1, 4, 0),
-
-    /* 0xD0 - 0xDF */
-    [0xD0] = INST(op_RET, JM_COND_NC, AM_NONE, 1, 5, 2),
-    [0xD1] = INST(op_POP, AM_REG_DE, AM_NONE, 1, 3, 0),
-    [0xD2] = INST(op_JP, JM_COND_NC, AM_IMM_A_16, 3, 4, 3),
-    [0xD3] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-
-    [0xD4] = INST(op_CALL, JM_COND_NC, AM_IMM_A_16, 3, 6, 3),
-    [0xD5] = INST(op_PUSH, AM_REG_DE, AM_NONE, 1, 4, 0),
-    [0xD6] = INST(op_SUB_8, AM_REG_A, AM_IMM_D_8, 2, 2, 0),
-    [0xD7] = INST(op_RST, RST_VEC_2, AM_NONE, 1, 4, 0),
-
-    [0xD8] = INST(op_RET, JM_COND_C, AM_NONE, 1, 5, 2),
-    [0xD9] = INST(op_RETI, AM_NONE, AM_NONE, 1, 4, 0),
-    [0xDA] = INST(op_JP, JM_COND_C, AM_IMM_A_16, 3, 4, 3),
-    [0xDB] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-
-    [0xDC] = INST(op_CALL, JM_COND_C, AM_IMM_A_16, 3, 6, 3),
-    [0xDD] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-    [0xDE] = INST(op_SBC_8, AM_REG_A, AM_IMM_D_8, 2, 2, 0),
-    [0xDF] = INST(op_RST, RST_VEC_3, AM_NONE, 1, 4, 0),
-
-    /* 0xE0 - 0xEF */
-    [0xE0] = INST(op_LD_8, AM_IMM_FF_A_8, AM_REG_A, 2, 3, 0),
-    [0xE1] = INST(op_POP, AM_REG_HL, AM_NONE, 1, 3, 0),
-    [0xE2] = INST(op_LD_8, AM_MEM_FF_REG_C, AM_REG_A, 1, 2, 0),
-    [0xE3] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-
-    [0xE4] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-    [0xE5] = INST(op_PUSH, AM_REG_HL, AM_NONE, 1, 4, 0),
-    [0xE6] = INST(op_AND_8, AM_REG_A, AM_IMM_D_8, 2, 2, 0),
-    [0xE7] = INST(op_RST, RST_VEC_4, AM_NONE, 1, 4, 0),
-
-    [0xE8] = INST(op_ADD_16, AM_REG_SP, AM_IMM_S_8, 2, 4, 0),
-    [0xE9] = INST(op_JP, JM_UNCOND, AM_REG_HL, 1, 1, 0),
-    [0xEA] = INST(op_LD_8, AM_IMM_A_16, AM_REG_A, 3, 4, 0),
-    [0xEB] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-
-    [0xEC] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-    [0xED] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-    [0xEE] = INST(op_XOR_8, AM_REG_A, AM_IMM_D_8, 2, 2, 0),
-    [0xEF] = INST(op_RST, RST_VEC_5, AM_NONE, 1, 4, 0),
-
-    /* 0xF0 - 0xFF */
-    [0xF0] = INST(op_LD_8, AM_REG_A, AM_IMM_FF_A_8, 2, 3, 0),
-    [0xF1] = INST(op_POP, AM_REG_AF, AM_NONE, 1, 3, 0),
-    [0xF2] = INST(op_LD_8, AM_REG_A, AM_MEM_FF_REG_C, 1, 2, 0),
-    [0xF3] = INST(op_DI, AM_NONE, AM_NONE, 1, 1, 0),
-
-    [0xF4] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-    [0xF5] = INST(op_PUSH, AM_REG_AF, AM_NONE, 1, 4, 0),
-    [0xF6] = INST(op_OR_8, AM_REG_A, AM_IMM_D_8, 2, 2, 0),
-    [0xF7] = INST(op_RST, RST_VEC_6, AM_NONE, 1, 4, 0),
-
-    [0xF8] = INST(op_LD_16, AM_REG_HL, AM_REG_SP_IMM_S8, 2, 3, 0),
-    [0xF9] = INST(op_LD_16, AM_REG_SP, AM_REG_HL, 1, 2, 0),
-    [0xFA] = INST(op_LD_8, AM_REG_A, AM_IMM_A_16, 3, 4, 0),
-    [0xFB] = INST(op_EI, AM_NONE, AM_NONE, 1, 1, 0),
-
-    [0xFC] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-    [0xFD] = INST(op_NOT_IMPL, AM_NONE, AM_NONE, 1, 0, 0),
-    [0xFE] = INST(op_CP_8, AM_REG_A, AM_IMM_D_8, 2, 2, 0),
-    [0xFF] = INST(op_RST, RST_VEC_7, AM_NONE, 1, 4, 0),
-};
+static status_code_t catch_up_devices(cpu_state_t *const state);
+static status_code_t sync_halted_cycles(cpu_state_t *const state);
 
 status_code_t cpu_init(cpu_state_t *const state, cpu_init_param_t *const param)
 {
@@ -571,6 +104,7 @@ status_code_t cpu_init(cpu_state_t *const state, cpu_init_param_t *const param)
 
   memcpy(&state->bus_interface, param->bus_interface, sizeof(bus_interface_t));
   state->cycle_sync_callback = param->cycle_sync_callback;
+  state->halt_wake_callback = param->halt_wake_callback;
 
   status = callback_init(&state->interrupt_callback, handle_interrupt, state);
   RETURN_STATUS_IF_NOT_OK(status);
@@ -581,103 +115,132 @@ status_code_t cpu_init(cpu_state_t *const state, cpu_init_param_t *const param)
   return STATUS_OK;
 }
 
-status_code_t cpu_emulation_cycle(cpu_state_t *const state)
+static status_code_t fetch(cpu_state_t *const state, registers_t *const regs, uint8_t *const data)
 {
-  VERIFY_PTR_RETURN_ERROR_IF_NULL(state);
-
-  status_code_t status = STATUS_OK;
-  // registers_t *const regs = &state->registers;
-
-  // static uint64_t count = 0;
-  // char flags[16];
+  return bus_read_8(state, regs->pc++, data);
+}
 
-  if (state->run_mode == RUN_MODE_NORMAL)
-  {
-    uint8_t opcode;
-    // uint16_t pc = regs->pc;
-    state->current_inst_m_cycle_count = 0;
+static status_code_t fetch_16(cpu_state_t *const state, registers_t *const regs, uint16_t *const data)
+{
+  status_code_t status = bus_read_16(state, regs->pc, data);
+  regs->pc += 2;
+  return status;
+}
 
-    status = fetch(state, &opcode);
-    RETURN_STATUS_IF_NOT_OK(status);
+static status_code_t push_16(cpu_state_t *const state, registers_t *const regs, uint16_t const data)
+{
+  regs->sp -= 2;
+  return bus_write_16(state, regs->sp, data);
+}
 
-    instruction_t *const inst = &inst_table[opcode];
+static status_code_t pop_16(cpu_state_t *const state, registers_t *const regs, uint16_t *const data)
+{
+  status_code_t status = bus_read_16(state, regs->sp, data);
+  regs->sp += 2;
+  return status;
+}
 
-    // sprintf(flags, "%c%c%c%c",
-    //         regs->f & FLAG_Z ? 'Z' : '-',
-    //         regs->f & FLAG_N ? 'N' : '-',
-    //         regs->f & FLAG_H ? 'H' : '-',
-    //         regs->f & FLAG_C ? 'C' : '-');
-    // Log_D(
-    //     "%llu - %04X: %02X A: %02X F: %s BC: %02X%02X DE: %02X%02X HL: %02X%02X",
-    //     ++count, pc, opcode, regs->a, flags, regs->b, regs->c, regs->d, regs->e, regs->h, regs->l);
+static status_code_t sync_cycles(cpu_state_t *const state, uint8_t const m_cycle_count)
+{
+  state->m_cycles += m_cycle_count;
+  state->current_inst_m_cycle_count += m_cycle_count;
 
-    status = inst->handler(state, &inst->operands);
-    RETURN_STATUS_IF_NOT_OK(status);
+  if (state->batched_sync)
+  {
+    /* Devices are caught up lazily; see cpu_run_cycles() */
+    state->owed_m_cycles += m_cycle_count;
 
-    int8_t owed_cycles = calc_cycle(opcode, state) - state->current_inst_m_cycle_count;
-    if (owed_cycles > 0)
+    if (m_cycle_count >= state->cycle_budget)
     {
-      status = sync_cycles(state, owed_cycles);
-      RETURN_STATUS_IF_NOT_OK(status);
+      state->cycle_budget = 0;
+      state->exit_requested = 1;
+    }
+    else
+    {
+      state->cycle_budget -= m_cycle_count;
     }
 
-    /**
-     * Hacky way to ensure the lower bytes of the flag registers
-     * to remain 0. TODO
-     */
-    state->registers.f &= 0xF0;
+    return STATUS_OK;
+  }
 
-    serial_check();
+  if (state->cycle_sync_callback)
+  {
+    return callback_call(state->cycle_sync_callback, &m_cycle_count);
   }
-  else if (state->run_mode == RUN_MODE_HALTED)
+
+  return STATUS_OK;
+}
+
+static status_code_t catch_up_devices(cpu_state_t *const state)
+{
+  status_code_t status = STATUS_OK;
+
+  while (state->owed_m_cycles > 0)
   {
-    status = sync_cycles(state, 1);
-    RETURN_STATUS_IF_NOT_OK(status);
+    uint8_t const m_cycle_count = (state->owed_m_cycles > UINT8_MAX) ? UINT8_MAX : state->owed_m_cycles;
+    state->owed_m_cycles -= m_cycle_count;
 
-    if (has_pending_interrupts(&state->interrupt))
+    if (state->cycle_sync_callback)
     {
-      state->run_mode = RUN_MODE_NORMAL;
+      status = callback_call(state->cycle_sync_callback, &m_cycle_count);
+      RETURN_STATUS_IF_NOT_OK(status);
     }
   }
-  else
+
+  return STATUS_OK;
+}
+
+/**
+ * Nothing happens while the CPU is halted until a device raises an interrupt, so
+ * rather than syncing one M-cycle at a time, skip ahead to the next device event.
+ */
+static status_code_t sync_halted_cycles(cpu_state_t *const state)
+{
+  status_code_t status = STATUS_OK;
+  uint32_t m_cycle_count = 1;
+
+  if (!state->halt_wake_callback)
   {
-    Log_D("Unknown run mode: %d", state->run_mode);
-    return STATUS_ERR_GENERIC;
+    return sync_cycles(state, 1);
   }
 
-  if (interrupt_globally_enabled(&state->interrupt))
+  /* Devices must be up to date for the wake-up time to be relative to the CPU */
+  status = catch_up_devices(state);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = callback_call(state->halt_wake_callback, &m_cycle_count);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  if (m_cycle_count > UINT8_MAX)
   {
-    status = service_interrupt(&state->interrupt);
-    RETURN_STATUS_IF_NOT_OK(status);
+    m_cycle_count = UINT8_MAX;
+  }
 
-    state->next_ime_flag = 0;
+  if (state->batched_sync && (m_cycle_count > state->cycle_budget))
+  {
+    m_cycle_count = state->cycle_budget;
   }
 
-  if (state->next_ime_flag)
+  if (m_cycle_count == 0)
   {
-    status = global_interrupt_enable(&state->interrupt, true);
-    RETURN_STATUS_IF_NOT_OK(status);
+    m_cycle_count = 1;
   }
 
-  return STATUS_OK;
-}
+  status = sync_cycles(state, m_cycle_count);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-static status_code_t fetch(cpu_state_t *const state, uint8_t *const data)
-{
-  return bus_read_8(state, state->registers.pc++, data);
+  /* Bring the devices up to the wake-up time so a raised interrupt is seen right away */
+  return catch_up_devices(state);
 }
 
-static status_code_t sync_cycles(cpu_state_t *const state, uint8_t const m_cycle_count)
+/**
+ * Returns true if the value at the given address depends on the state of the devices
+ * ticked by the cycle sync callback (VRAM, OAM, I/O registers, and the IE register).
+ */
+static inline bool depends_on_device_state(uint16_t const address)
 {
-  state->m_cycles += m_cycle_count;
-  state->current_inst_m_cycle_count += m_cycle_count;
-
-  if (state->cycle_sync_callback)
-  {
-    return callback_call(state->cycle_sync_callback, &m_cycle_count);
-  }
-
-  return STATUS_OK;
+  return ((address >= VRAM_START_ADDR) && (address < EXT_RAM_START_ADDR)) ||
+         ((address >= OAM_START_ADDR) && ((address < HRAM_START_ADDR) || (address == IE_REG_ADDR)));
 }
 
 static status_code_t handle_interrupt(void *const ctx, const void *arg)
@@ -690,7 +253,7 @@ static status_code_t handle_interrupt(void *const ctx, const void *arg)
    * Save current instruction to the stack and go to
    * the address specified by the interrupt vector
    */
-  status = push_reg_16(state, &state->registers.pc);
+  status = push_16(state, &state->registers, state->registers.pc);
   RETURN_STATUS_IF_NOT_OK(status);
 
   status = sync_cycles(state, 2);
@@ -709,57 +272,6 @@ static status_code_t handle_interrupt(void *const ctx, const void *arg)
   return STATUS_OK;
 }
 
-reg_8_ptr_t reg_8_select(cpu_state_t *const state, addressing_mode_t const addr_mode)
-{
-  registers_t *const regs = &state->registers;
-
-  switch (addr_mode)
-  {
-  case AM_REG_A:
-    return &regs->a;
-  case AM_REG_B:
-    return &regs->b;
-  case AM_REG_C:
-    return &regs->c;
-  case AM_REG_D:
-    return &regs->d;
-  case AM_REG_E:
-    return &regs->e;
-  case AM_REG_H:
-    return &regs->h;
-  case AM_REG_L:
-    return &regs->l;
-  default:
-    break;
-  }
-
-  return NULL;
-}
-
-reg_16_ptr_t reg_16_select(cpu_state_t *const state, addressing_mode_t const addr_mode)
-{
-  registers_t *const regs = &state->registers;
-
-  switch (addr_mode)
-  {
-  case AM_REG_AF:
-    return &regs->af;
-  case AM_REG_BC:
-    return &regs->bc;
-  case AM_REG_DE:
-    return &regs->de;
-  case AM_REG_HL:
-    return &regs->hl;
-  case AM_REG_SP:
-  case AM_REG_SP_IMM_S8:
-    return &regs->sp;
-  default:
-    break;
-  }
-
-  return NULL;
-}
-
 static inline status_code_t bus_read_8(cpu_state_t *const state, uint16_t address, uint8_t *const data)
 {
   status_code_t status;
@@ -767,6 +279,12 @@ static inline status_code_t bus_read_8(cpu_state_t *const state, uint16_t addres
   status = sync_cycles(state, 1);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  if (state->owed_m_cycles && depends_on_device_state(address))
+  {
+    status = catch_up_devices(state);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
   return bus_interface_read(&state->bus_interface, address, data);
 }
 
@@ -777,7 +295,22 @@ static inline status_code_t bus_write_8(cpu_state_t *const state, uint16_t addre
   status = sync_cycles(state, 1);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  return bus_interface_write(&state->bus_interface, address, data);
+  if (state->owed_m_cycles && depends_on_device_state(address))
+  {
+    status = catch_up_devices(state);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  status = bus_interface_write(&state->bus_interface, address, data);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  /* Serial output can only change when a transfer is started */
+  if (address == SERIAL_CONTROL_ADDR)
+  {
+    serial_check();
+  }
+
+  return STATUS_OK;
 }
 
 static inline status_code_t bus_read_16(cpu_state_t *const state, uint16_t address, uint16_t *const data)
@@ -807,771 +340,724 @@ static inline status_code_t bus_write_16(cpu_state_t *const state, uint16_t addr
   return STATUS_OK;
 }
 
-status_code_t read_8(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t *const data)
-{
-  address_t address;
-  reg_8_ptr_t source;
-  registers_t *const regs = &state->registers;
-  status_code_t status = STATUS_OK;
+/* 8-bit arithmetic and logic operations on the accumulator */
 
-  switch (addr_mode)
-  {
-  case AM_IMM_D_8:
-  case AM_IMM_S_8:
-    return fetch(state, data);
-  case AM_MEM_HL:
-  case AM_MEM_HL_INC:
-  case AM_MEM_HL_DEC:
-    return bus_read_8(state, regs->hl, data);
-  case AM_MEM_BC:
-    return bus_read_8(state, regs->bc, data);
-  case AM_MEM_DE:
-    return bus_read_8(state, regs->de, data);
-  case AM_MEM_FF_REG_C:
-    return bus_read_8(state, (0xFF00 | regs->c), data);
-  case AM_IMM_FF_A_8:
-    status = fetch(state, &address.lsb);
-    RETURN_STATUS_IF_NOT_OK(status);
-    return bus_read_8(state, (0xFF00 | address.lsb), data);
-  case AM_IMM_A_16:
-    status = read_16(state, addr_mode, &address.val);
-    RETURN_STATUS_IF_NOT_OK(status);
-    return bus_read_8(state, address.val, data);
-  default:
-    if ((source = reg_8_select(state, addr_mode)) == NULL)
-    {
-      return STATUS_ERR_INVALID_ARG;
-    }
-    *data = *source;
-    break;
-  }
+static inline void alu_add(registers_t *const regs, uint8_t const data)
+{
+  uint8_t const half_carry = ((regs->a & 0x0F) + (data & 0x0F)) & 0x10;
+  uint16_t const full_carry = (regs->a + data) & 0x100;
 
-  return STATUS_OK;
+  regs->a += data;
+  regs->f = (regs->a == 0 ? FLAG_Z : 0) | (half_carry ? FLAG_H : 0) | (full_carry ? FLAG_C : 0);
 }
 
-status_code_t write_8(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t const data)
+static inline void alu_adc(registers_t *const regs, uint8_t const data)
 {
-  address_t address;
-  reg_8_ptr_t source;
-  registers_t *const regs = &state->registers;
-  status_code_t status = STATUS_OK;
-
-  switch (addr_mode)
-  {
-  case AM_MEM_HL:
-  case AM_MEM_HL_INC:
-  case AM_MEM_HL_DEC:
-    return bus_write_8(state, regs->hl, data);
-  case AM_MEM_BC:
-    return bus_write_8(state, regs->bc, data);
-  case AM_MEM_DE:
-    return bus_write_8(state, regs->de, data);
-  case AM_MEM_FF_REG_C:
-    return bus_write_8(state, (0xFF00 | regs->c), data);
-  case AM_IMM_FF_A_8:
-    status = fetch(state, &address.lsb);
-    RETURN_STATUS_IF_NOT_OK(status);
-    return bus_write_8(state, (0xFF00 | address.lsb), data);
-  case AM_IMM_A_16:
-    status = read_16(state, addr_mode, &address.val);
-    RETURN_STATUS_IF_NOT_OK(status);
-    return bus_write_8(state, address.val, data);
-  default:
-    if ((source = reg_8_select(state, addr_mode)) == NULL)
-    {
-      return STATUS_ERR_INVALID_ARG;
-    }
-    *source = data;
-    break;
-  }
+  uint8_t const carry_bit = (regs->f & FLAG_C) ? 1 : 0;
+  uint8_t const half_carry = ((regs->a & 0x0F) + (data & 0x0F) + carry_bit) & 0x10;
+  uint16_t const full_carry = (regs->a + data + carry_bit) & 0x100;
 
-  return STATUS_OK;
+  regs->a += data + carry_bit;
+  regs->f = (regs->a == 0 ? FLAG_Z : 0) | (half_carry ? FLAG_H : 0) | (full_carry ? FLAG_C : 0);
 }
 
-status_code_t read_16(cpu_state_t *const state, addressing_mode_t const addr_mode, uint16_t *const data)
+static inline void alu_sub(registers_t *const regs, uint8_t const data)
 {
-  reg_16_ptr_t source;
-  registers_t *const regs = &state->registers;
-  status_code_t status = STATUS_OK;
-
-  switch (addr_mode)
-  {
-  case AM_IMM_A_16:
-  case AM_IMM_D_16:
-    status = bus_read_16(state, regs->pc, data);
-    regs->pc += 2;
-    return status;
-  default:
-    if ((source = reg_16_select(state, addr_mode)) == NULL)
-    {
-      return STATUS_ERR_INVALID_ARG;
-    }
-    *data = *source;
-    break;
-  }
+  uint8_t const half_carry = (regs->a & 0x0F) < (data & 0x0F);
+  uint8_t const full_carry = regs->a < data;
 
-  return STATUS_OK;
+  regs->a -= data;
+  regs->f = (regs->a == 0 ? FLAG_Z : 0) | FLAG_N | (half_carry ? FLAG_H : 0) | (full_carry ? FLAG_C : 0);
 }
 
-status_code_t write_16(cpu_state_t *const state, addressing_mode_t const addr_mode, uint16_t const data)
+static inline void alu_sbc(registers_t *const regs, uint8_t const data)
 {
-  uint16_t address;
-  status_code_t status = STATUS_OK;
-
-  if (addr_mode == AM_IMM_A_16)
-  {
-    status = bus_read_16(state, state->registers.pc, &address);
-    RETURN_STATUS_IF_NOT_OK(status);
-
-    status = bus_write_16(state, address, data);
-    RETURN_STATUS_IF_NOT_OK(status);
-
-    state->registers.pc += 2;
-  }
-  else
-  {
-    reg_16_ptr_t dest = reg_16_select(state, addr_mode);
-    if (dest == NULL)
-    {
-      return STATUS_ERR_INVALID_ARG;
-    }
-    *dest = data;
-  }
+  uint8_t const carry_bit = (regs->f & FLAG_C) ? 1 : 0;
+  uint8_t const half_carry = (regs->a & 0x0F) < ((data & 0x0F) + carry_bit);
+  uint8_t const full_carry = regs->a < (data + carry_bit);
 
-  return STATUS_OK;
+  regs->a -= data + carry_bit;
+  regs->f = (regs->a == 0 ? FLAG_Z : 0) | FLAG_N | (half_carry ? FLAG_H : 0) | (full_carry ? FLAG_C : 0);
 }
 
-status_code_t pop_reg_16(cpu_state_t *const state, reg_16_ptr_t reg)
+static inline void alu_and(registers_t *const regs, uint8_t const data)
 {
-  status_code_t status = STATUS_OK;
-  status = bus_read_16(state, state->registers.sp, reg);
-  state->registers.sp += 2;
+  regs->a &= data;
+  regs->f = (regs->a == 0 ? FLAG_Z : 0) | FLAG_H;
+}
 
-  return status;
+static inline void alu_xor(registers_t *const regs, uint8_t const data)
+{
+  regs->a ^= data;
+  regs->f = (regs->a == 0 ? FLAG_Z : 0);
 }
 
-status_code_t push_reg_16(cpu_state_t *const state, reg_16_ptr_t reg)
+static inline void alu_or(registers_t *const regs, uint8_t const data)
 {
-  state->registers.sp -= 2;
-  return bus_write_16(state, state->registers.sp, *reg);
+  regs->a |= data;
+  regs->f = (regs->a == 0 ? FLAG_Z : 0);
 }
 
-static inline void update_flags(cpu_state_t *const state, uint8_t mask, flag_mode_t mode)
+static inline void alu_cp(registers_t *const regs, uint8_t const data)
 {
-  registers_t *const regs = &state->registers;
+  uint8_t const half_carry = (regs->a & 0x0F) < (data & 0x0F);
+  uint8_t const full_carry = regs->a < data;
 
-  switch (mode)
-  {
-  case F_SET:
-    regs->f |= mask;
-    break;
-  case F_CLEAR:
-    regs->f &= ~mask;
-    break;
-  case F_INVERT:
-    regs->f ^= mask;
-    break;
-  default:
-    break;
-  }
+  regs->f = (regs->a == data ? FLAG_Z : 0) | FLAG_N | (half_carry ? FLAG_H : 0) | (full_carry ? FLAG_C : 0);
 }
 
-static inline uint8_t check_cond(cpu_state_t *const state, jump_mode_t mode)
+static inline uint8_t alu_inc(registers_t *const regs, uint8_t data)
 {
-  registers_t *const regs = &state->registers;
+  data++;
+  regs->f = (regs->f & FLAG_C) | (data == 0 ? FLAG_Z : 0) | ((data & 0xF) == 0x0 ? FLAG_H : 0);
+  return data;
+}
 
-  switch (mode)
-  {
-  case JM_UNCOND:
-    return 1;
-  case JM_COND_NZ:
-    return (regs->f & FLAG_Z) ? 0 : 1;
-  case JM_COND_Z:
-    return (regs->f & FLAG_Z) ? 1 : 0;
-  case JM_COND_NC:
-    return (regs->f & FLAG_C) ? 0 : 1;
-  case JM_COND_C:
-    return (regs->f & FLAG_C) ? 1 : 0;
-  default:
-    break;
-  }
-  return 0;
+static inline uint8_t alu_dec(registers_t *const regs, uint8_t data)
+{
+  data--;
+  regs->f = (regs->f & FLAG_C) | (data == 0 ? FLAG_Z : 0) | FLAG_N | ((data & 0xF) == 0xF ? FLAG_H : 0);
+  return data;
 }
 
-uint8_t calc_cycle(uint8_t opcode, cpu_state_t *const state)
+static inline void alu_add_16(registers_t *const regs, uint16_t const data)
 {
-  registers_t *const regs = &state->registers;
-  instruction_t *const inst = &inst_table[opcode];
-  switch (opcode)
-  {
-  case 0x20: /* JR NZ, s8 */
-  case 0xC0: /* RET NZ */
-  case 0xC2: /* JP NZ, a16 */
-  case 0xC4: /* CALL NZ, a16 */
-    return (regs->f & FLAG_Z) ? inst->alt_cycle_duration : inst->cycle_duration;
-  case 0x28: /* JR Z, s8 */
-  case 0xC8: /* RET Z */
-  case 0xCA: /* JP Z, a16 */
-  case 0xCC: /* CALL Z, a16 */
-    return (regs->f & FLAG_Z) ? inst->cycle_duration : inst->alt_cycle_duration;
-  case 0x30: /* JR NC, s8 */
-  case 0xD0: /* RET NC */
-  case 0xD2: /* JP NC, a16 */
-  case 0xD4: /* CALL NC, a16 */
-    return (regs->f & FLAG_C) ? inst->alt_cycle_duration : inst->cycle_duration;
-  case 0x38: /* JR C, s8 */
-  case 0xD8: /* RET C */
-  case 0xDA: /* JP C, a16 */
-  case 0xDC: /* CALL C, a16 */
-    return (regs->f & FLAG_C) ? inst->cycle_duration : inst->alt_cycle_duration;
-  default:
-    break;
-  }
+  uint16_t const half_carry = ((regs->hl & 0x0FFF) + (data & 0x0FFF)) & 0x1000;
+  uint32_t const full_carry = (regs->hl + data) & 0x10000;
 
-  return inst->cycle_duration;
+  regs->hl += data;
+  regs->f = (regs->f & FLAG_Z) | (half_carry ? FLAG_H : 0) | (full_carry ? FLAG_C : 0);
 }
 
-status_code_t read_reg_16_plus_offset(cpu_state_t *const state, addressing_mode_t const addr_mode, uint16_t *const data)
+/**
+ * Computes SP + s8 for ADD SP, s8 and LD HL, SP + s8, which share the same flag
+ * behavior and internal delay cycle.
+ */
+static inline status_code_t sp_plus_offset(cpu_state_t *const state, registers_t *const regs, uint16_t *const data)
 {
   int8_t offset;
   status_code_t status = STATUS_OK;
 
-  status = read_8(state, AM_IMM_S_8, (uint8_t *)&offset);
+  status = fetch(state, regs, (uint8_t *)&offset);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = read_16(state, addr_mode, data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  uint8_t half_carry = ((*data & 0x0F) + (offset & 0x0F)) & 0x10;
-  uint16_t full_carry = ((*data & 0xFF) + (offset & 0xFF)) & 0x100;
+  uint8_t const half_carry = ((regs->sp & 0x0F) + (offset & 0x0F)) & 0x10;
+  uint16_t const full_carry = ((regs->sp & 0xFF) + (offset & 0xFF)) & 0x100;
 
-  *data = *data + offset;
+  *data = regs->sp + offset;
+  regs->f = (half_carry ? FLAG_H : 0) | (full_carry ? FLAG_C : 0);
 
-  update_flags(state, FLAG_Z | FLAG_N, F_CLEAR);
-  update_flags(state, FLAG_H, half_carry ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_C, full_carry ? F_SET : F_CLEAR);
+  return sync_cycles(state, 1);
+}
 
-  status = sync_cycles(state, 1);
-  RETURN_STATUS_IF_NOT_OK(status);
+/* Operations for CB-prefixed opcodes */
 
-  return STATUS_OK;
+static inline uint8_t cb_rlc(registers_t *const regs, uint8_t data)
+{
+  uint8_t const msb = (data >> 7) & 0x1;
+  data = (data << 1) | msb;
+  regs->f = (data == 0 ? FLAG_Z : 0) | (msb ? FLAG_C : 0);
+  return data;
 }
 
-static status_code_t op_NOT_IMPL(cpu_state_t *const __attribute__((unused)) state, inst_operands_t *const __attribute__((unused)) operands)
+static inline uint8_t cb_rrc(registers_t *const regs, uint8_t data)
 {
-  return STATUS_ERR_UNDEFINED_INST;
+  uint8_t const lsb = data & 0x1;
+  data = (data >> 1) | (lsb << 7);
+  regs->f = (data == 0 ? FLAG_Z : 0) | (lsb ? FLAG_C : 0);
+  return data;
 }
 
-static status_code_t op_NOP(cpu_state_t *const __attribute__((unused)) state, inst_operands_t *const __attribute__((unused)) operands)
+static inline uint8_t cb_rl(registers_t *const regs, uint8_t data)
 {
-  return STATUS_OK;
+  uint8_t const msb = (data >> 7) & 0x1;
+  data = (data << 1) | ((regs->f & FLAG_C) ? 1 : 0);
+  regs->f = (data == 0 ? FLAG_Z : 0) | (msb ? FLAG_C : 0);
+  return data;
 }
 
-static status_code_t op_STOP(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static inline uint8_t cb_rr(registers_t *const regs, uint8_t data)
 {
-  state->registers.pc++;
-  // state->run_mode = RUN_MODE_STOPPED; // TODO: reenable
-  return STATUS_OK;
+  uint8_t const lsb = data & 0x1;
+  data = (data >> 1) | ((regs->f & FLAG_C) ? (1 << 7) : 0);
+  regs->f = (data == 0 ? FLAG_Z : 0) | (lsb ? FLAG_C : 0);
+  return data;
 }
 
-static status_code_t op_HALT(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static inline uint8_t cb_sla(registers_t *const regs, uint8_t data)
 {
-  state->run_mode = RUN_MODE_HALTED;
-  return STATUS_OK;
+  uint8_t const msb = (data >> 7) & 0x1;
+  data <<= 1;
+  regs->f = (data == 0 ? FLAG_Z : 0) | (msb ? FLAG_C : 0);
+  return data;
 }
 
-static status_code_t op_JR(cpu_state_t *const state, inst_operands_t *const operands)
+static inline uint8_t cb_sra(registers_t *const regs, uint8_t data)
 {
-  int8_t offset;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->source, (uint8_t *)&offset);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  if (check_cond(state, operands->jump_mode))
-  {
-    state->registers.pc += offset;
-    status = sync_cycles(state, 1);
-    RETURN_STATUS_IF_NOT_OK(status);
-  }
+  uint8_t const lsb = data & 0x1;
+  data = (data & (1 << 7)) | (data >> 1);
+  regs->f = (data == 0 ? FLAG_Z : 0) | (lsb ? FLAG_C : 0);
+  return data;
+}
 
-  return STATUS_OK;
+static inline uint8_t cb_swap(registers_t *const regs, uint8_t data)
+{
+  data = ((data & 0xF) << 4) | ((data >> 4) & 0xF);
+  regs->f = (data == 0 ? FLAG_Z : 0);
+  return data;
 }
 
-static status_code_t op_JP(cpu_state_t *const state, inst_operands_t *const operands)
+static inline uint8_t cb_srl(registers_t *const regs, uint8_t data)
 {
-  uint16_t address;
-  status_code_t status = STATUS_OK;
+  uint8_t const lsb = data & 0x1;
+  data >>= 1;
+  regs->f = (data == 0 ? FLAG_Z : 0) | (lsb ? FLAG_C : 0);
+  return data;
+}
+
+static inline void cb_bit(registers_t *const regs, uint8_t const data, uint8_t const bit_index)
+{
+  regs->f = (regs->f & FLAG_C) | ((data & (1 << bit_index)) ? 0 : FLAG_Z) | FLAG_H;
+}
+
+/**
+ * Opcode handler generators. Every handler is fully specialized for its operands:
+ * the register or memory location it touches is fixed when the handler is generated.
+ */
+
+/* LD r, r' / LD r, (HL) / LD r, d8 / LD (HL), r */
+#define DEFINE_LD_8_OPS_FOR(dest)                                                     \
+  DEFINE_LD_R_R(dest, B)                                                              \
+  DEFINE_LD_R_R(dest, C)                                                              \
+  DEFINE_LD_R_R(dest, D)                                                              \
+  DEFINE_LD_R_R(dest, E)                                                              \
+  DEFINE_LD_R_R(dest, H)                                                              \
+  DEFINE_LD_R_R(dest, L)                                                              \
+  DEFINE_LD_R_R(dest, A)                                                              \
+  static status_code_t op_LD_##dest##_MEM_HL(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    return bus_read_8(state, regs->hl, &regs->REG_##dest);                            \
+  }                                                                                   \
+  static status_code_t op_LD_##dest##_D8(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    return fetch(state, regs, &regs->REG_##dest);                                     \
+  }                                                                                   \
+  static status_code_t op_LD_MEM_HL_##dest(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    return bus_write_8(state, regs->hl, regs->REG_##dest);                            \
+  }
 
-  status = read_16(state, operands->source, &address);
-  RETURN_STATUS_IF_NOT_OK(status);
+#define DEFINE_LD_R_R(dest, src)                                                      \
+  static status_code_t op_LD_##dest##_##src(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs) \
+  {                                                                                   \
+    regs->REG_##dest = regs->REG_##src;                                               \
+    return STATUS_OK;                                                                 \
+  }
 
-  if (check_cond(state, operands->jump_mode))
-  {
-    state->registers.pc = address;
+/* LD (rr), A / LD A, (rr) for BC and DE */
+#define DEFINE_LD_8_INDIRECT_OPS(reg_pair)                                            \
+  static status_code_t op_LD_MEM_##reg_pair##_A(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    return bus_write_8(state, regs->REG_##reg_pair, regs->a);                         \
+  }                                                                                   \
+  static status_code_t op_LD_A_MEM_##reg_pair(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    return bus_read_8(state, regs->REG_##reg_pair, &regs->a);                         \
   }
 
-  return status;
-}
+/* INC r / DEC r */
+#define DEFINE_INC_DEC_8_OPS(reg)                                                     \
+  static status_code_t op_INC_##reg(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs) \
+  {                                                                                   \
+    regs->REG_##reg = alu_inc(regs, regs->REG_##reg);                                 \
+    return STATUS_OK;                                                                 \
+  }                                                                                   \
+  static status_code_t op_DEC_##reg(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs) \
+  {                                                                                   \
+    regs->REG_##reg = alu_dec(regs, regs->REG_##reg);                                 \
+    return STATUS_OK;                                                                 \
+  }
 
-static status_code_t op_LD_8(cpu_state_t *const state, inst_operands_t *const operands)
-{
-  uint8_t data = 0;
-  status_code_t status = STATUS_OK;
+/* ALU A, r / ALU A, (HL) / ALU A, d8 */
+#define DEFINE_ALU_8_OPS(name, alu_fn)                                                \
+  DEFINE_ALU_8_R(name, alu_fn, B)                                                     \
+  DEFINE_ALU_8_R(name, alu_fn, C)                                                     \
+  DEFINE_ALU_8_R(name, alu_fn, D)                                                     \
+  DEFINE_ALU_8_R(name, alu_fn, E)                                                     \
+  DEFINE_ALU_8_R(name, alu_fn, H)                                                     \
+  DEFINE_ALU_8_R(name, alu_fn, L)                                                     \
+  DEFINE_ALU_8_R(name, alu_fn, A)                                                     \
+  static status_code_t op_##name##_A_MEM_HL(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint8_t data;                                                                     \
+    status_code_t status = bus_read_8(state, regs->hl, &data);                        \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    alu_fn(regs, data);                                                               \
+    return STATUS_OK;                                                                 \
+  }                                                                                   \
+  static status_code_t op_##name##_A_D8(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint8_t data;                                                                     \
+    status_code_t status = fetch(state, regs, &data);                                 \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    alu_fn(regs, data);                                                               \
+    return STATUS_OK;                                                                 \
+  }
 
-  status = read_8(state, operands->source, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
+#define DEFINE_ALU_8_R(name, alu_fn, src)                                             \
+  static status_code_t op_##name##_A_##src(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs) \
+  {                                                                                   \
+    alu_fn(regs, regs->REG_##src);                                                    \
+    return STATUS_OK;                                                                 \
+  }
 
-  status = write_8(state, operands->dest, data);
-  RETURN_STATUS_IF_NOT_OK(status);
+/* LD rr, d16 / INC rr / DEC rr / ADD HL, rr */
+#define DEFINE_16_BIT_OPS(reg_pair)                                                   \
+  static status_code_t op_LD_##reg_pair##_D16(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint16_t data = 0;                                                                \
+    status_code_t status = fetch_16(state, regs, &data);                              \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    regs->REG_##reg_pair = data;                                                      \
+    return STATUS_OK;                                                                 \
+  }                                                                                   \
+  static status_code_t op_INC_##reg_pair(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    regs->REG_##reg_pair++;                                                           \
+    return sync_cycles(state, 1);                                                     \
+  }                                                                                   \
+  static status_code_t op_DEC_##reg_pair(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    regs->REG_##reg_pair--;                                                           \
+    return sync_cycles(state, 1);                                                     \
+  }                                                                                   \
+  static status_code_t op_ADD_HL_##reg_pair(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    alu_add_16(regs, regs->REG_##reg_pair);                                           \
+    return sync_cycles(state, 1);                                                     \
+  }
 
-  if ((operands->dest == AM_MEM_HL_INC) || (operands->source == AM_MEM_HL_INC))
-  {
-    state->registers.hl++;
+/* PUSH rr / POP rr */
+#define DEFINE_STACK_OPS(reg_pair)                                                    \
+  static status_code_t op_PUSH_##reg_pair(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    status_code_t status = push_16(state, regs, regs->REG_##reg_pair);                \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    return sync_cycles(state, 1);                                                     \
+  }                                                                                   \
+  static status_code_t op_POP_##reg_pair(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint16_t data = 0;                                                                \
+    status_code_t status = pop_16(state, regs, &data);                                \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    regs->REG_##reg_pair = data;                                                      \
+    return STATUS_OK;                                                                 \
   }
-  else if ((operands->dest == AM_MEM_HL_DEC) || (operands->source == AM_MEM_HL_DEC))
-  {
-    state->registers.hl--;
+
+/* JR cc, s8 / JP cc, a16 / CALL cc, a16 / RET cc */
+#define DEFINE_COND_BRANCH_OPS(cond)                                                  \
+  static status_code_t op_JR_##cond(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    int8_t offset;                                                                    \
+    status_code_t status = fetch(state, regs, (uint8_t *)&offset);                    \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    if (COND_##cond(regs))                                                            \
+    {                                                                                 \
+      regs->pc += offset;                                                             \
+      return sync_cycles(state, 1);                                                   \
+    }                                                                                 \
+    return STATUS_OK;                                                                 \
+  }                                                                                   \
+  static status_code_t op_JP_##cond(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint16_t address;                                                                 \
+    status_code_t status = fetch_16(state, regs, &address);                           \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    if (COND_##cond(regs))                                                            \
+    {                                                                                 \
+      regs->pc = address;                                                             \
+      return sync_cycles(state, 1);                                                   \
+    }                                                                                 \
+    return STATUS_OK;                                                                 \
+  }                                                                                   \
+  static status_code_t op_CALL_##cond(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint16_t address;                                                                 \
+    status_code_t status = fetch_16(state, regs, &address);                           \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    if (COND_##cond(regs))                                                            \
+    {                                                                                 \
+      status = push_16(state, regs, regs->pc);                                        \
+      RETURN_STATUS_IF_NOT_OK(status);                                                \
+      regs->pc = address;                                                             \
+      return sync_cycles(state, 1);                                                   \
+    }                                                                                 \
+    return STATUS_OK;                                                                 \
+  }                                                                                   \
+  static status_code_t op_RET_##cond(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    status_code_t status = sync_cycles(state, 1);                                     \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    if (COND_##cond(regs))                                                            \
+    {                                                                                 \
+      status = pop_16(state, regs, &regs->pc);                                        \
+      RETURN_STATUS_IF_NOT_OK(status);                                                \
+      return sync_cycles(state, 1);                                                   \
+    }                                                                                 \
+    return STATUS_OK;                                                                 \
   }
 
-  return STATUS_OK;
-}
+/* RST n */
+#define DEFINE_RST_OP(vector)                                                         \
+  static status_code_t op_RST_##vector(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    status_code_t status = push_16(state, regs, regs->pc);                            \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    regs->pc = 0x##vector;                                                            \
+    return sync_cycles(state, 1);                                                     \
+  }
 
-static status_code_t op_LD_16(cpu_state_t *const state, inst_operands_t *const operands)
-{
-  uint16_t data = 0;
-  status_code_t status = STATUS_OK;
+/* CB-prefixed rotate/shift/swap on every target */
+#define DEFINE_CB_OPS(name, cb_fn)                                                    \
+  DEFINE_CB_R(name, cb_fn, B)                                                         \
+  DEFINE_CB_R(name, cb_fn, C)                                                         \
+  DEFINE_CB_R(name, cb_fn, D)                                                         \
+  DEFINE_CB_R(name, cb_fn, E)                                                         \
+  DEFINE_CB_R(name, cb_fn, H)                                                         \
+  DEFINE_CB_R(name, cb_fn, L)                                                         \
+  DEFINE_CB_R(name, cb_fn, A)                                                         \
+  static status_code_t op_CB_##name##_MEM_HL(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint8_t data;                                                                     \
+    status_code_t status = bus_read_8(state, regs->hl, &data);                        \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    data = cb_fn(regs, data);                                                         \
+    return bus_write_8(state, regs->hl, data);                                        \
+  }
 
-  if (operands->source == AM_REG_SP_IMM_S8)
-  {
-    status = read_reg_16_plus_offset(state, operands->source, &data);
+#define DEFINE_CB_R(name, cb_fn, reg)                                                 \
+  static status_code_t op_CB_##name##_##reg(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs) \
+  {                                                                                   \
+    regs->REG_##reg = cb_fn(regs, regs->REG_##reg);                                   \
+    return STATUS_OK;                                                                 \
   }
-  else
-  {
-    status = read_16(state, operands->source, &data);
+
+/* CB-prefixed BIT/RES/SET n on every target */
+#define DEFINE_CB_BIT_OPS(bit_index)                                                  \
+  DEFINE_CB_BIT_R(bit_index, B)                                                       \
+  DEFINE_CB_BIT_R(bit_index, C)                                                       \
+  DEFINE_CB_BIT_R(bit_index, D)                                                       \
+  DEFINE_CB_BIT_R(bit_index, E)                                                       \
+  DEFINE_CB_BIT_R(bit_index, H)                                                       \
+  DEFINE_CB_BIT_R(bit_index, L)                                                       \
+  DEFINE_CB_BIT_R(bit_index, A)                                                       \
+  static status_code_t op_CB_BIT_##bit_index##_MEM_HL(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint8_t data;                                                                     \
+    status_code_t status = bus_read_8(state, regs->hl, &data);                        \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    cb_bit(regs, data, bit_index);                                                    \
+    return STATUS_OK;                                                                 \
+  }                                                                                   \
+  static status_code_t op_CB_RES_##bit_index##_MEM_HL(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint8_t data;                                                                     \
+    status_code_t status = bus_read_8(state, regs->hl, &data);                        \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    return bus_write_8(state, regs->hl, data & ~(1 << bit_index));                    \
+  }                                                                                   \
+  static status_code_t op_CB_SET_##bit_index##_MEM_HL(cpu_state_t *const state, registers_t *const regs) \
+  {                                                                                   \
+    uint8_t data;                                                                     \
+    status_code_t status = bus_read_8(state, regs->hl, &data);                        \
+    RETURN_STATUS_IF_NOT_OK(status);                                                  \
+    return bus_write_8(state, regs->hl, data | (1 << bit_index));                     \
   }
-  RETURN_STATUS_IF_NOT_OK(status);
 
-  status = write_16(state, operands->dest, data);
-  return status;
+#define DEFINE_CB_BIT_R(bit_index, reg)                                               \
+  static status_code_t op_CB_BIT_##bit_index##_##reg(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs) \
+  {                                                                                   \
+    cb_bit(regs, regs->REG_##reg, bit_index);                                         \
+    return STATUS_OK;                                                                 \
+  }                                                                                   \
+  static status_code_t op_CB_RES_##bit_index##_##reg(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs) \
+  {                                                                                   \
+    regs->REG_##reg &= ~(1 << bit_index);                                             \
+    return STATUS_OK;                                                                 \
+  }                                                                                   \
+  static status_code_t op_CB_SET_##bit_index##_##reg(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs) \
+  {                                                                                   \
+    regs->REG_##reg |= (1 << bit_index);                                              \
+    return STATUS_OK;                                                                 \
+  }
+
+/* Entries of the CB table, ordered by target register as encoded in the lower 3 bits of the opcode */
+#define CB_TABLE_ROW(name) \
+  op_CB_##name##_B, op_CB_##name##_C, op_CB_##name##_D, op_CB_##name##_E, \
+  op_CB_##name##_H, op_CB_##name##_L, op_CB_##name##_MEM_HL, op_CB_##name##_A
+
+DEFINE_LD_8_OPS_FOR(B)
+DEFINE_LD_8_OPS_FOR(C)
+DEFINE_LD_8_OPS_FOR(D)
+DEFINE_LD_8_OPS_FOR(E)
+DEFINE_LD_8_OPS_FOR(H)
+DEFINE_LD_8_OPS_FOR(L)
+DEFINE_LD_8_OPS_FOR(A)
+
+DEFINE_LD_8_INDIRECT_OPS(BC)
+DEFINE_LD_8_INDIRECT_OPS(DE)
+
+DEFINE_INC_DEC_8_OPS(B)
+DEFINE_INC_DEC_8_OPS(C)
+DEFINE_INC_DEC_8_OPS(D)
+DEFINE_INC_DEC_8_OPS(E)
+DEFINE_INC_DEC_8_OPS(H)
+DEFINE_INC_DEC_8_OPS(L)
+DEFINE_INC_DEC_8_OPS(A)
+
+DEFINE_ALU_8_OPS(ADD, alu_add)
+DEFINE_ALU_8_OPS(ADC, alu_adc)
+DEFINE_ALU_8_OPS(SUB, alu_sub)
+DEFINE_ALU_8_OPS(SBC, alu_sbc)
+DEFINE_ALU_8_OPS(AND, alu_and)
+DEFINE_ALU_8_OPS(XOR, alu_xor)
+DEFINE_ALU_8_OPS(OR, alu_or)
+DEFINE_ALU_8_OPS(CP, alu_cp)
+
+DEFINE_16_BIT_OPS(BC)
+DEFINE_16_BIT_OPS(DE)
+DEFINE_16_BIT_OPS(HL)
+DEFINE_16_BIT_OPS(SP)
+
+DEFINE_STACK_OPS(BC)
+DEFINE_STACK_OPS(DE)
+DEFINE_STACK_OPS(HL)
+DEFINE_STACK_OPS(AF)
+
+DEFINE_COND_BRANCH_OPS(NZ)
+DEFINE_COND_BRANCH_OPS(Z)
+DEFINE_COND_BRANCH_OPS(NC)
+DEFINE_COND_BRANCH_OPS(C)
+
+DEFINE_RST_OP(00)
+DEFINE_RST_OP(08)
+DEFINE_RST_OP(10)
+DEFINE_RST_OP(18)
+DEFINE_RST_OP(20)
+DEFINE_RST_OP(28)
+DEFINE_RST_OP(30)
+DEFINE_RST_OP(38)
+
+DEFINE_CB_OPS(RLC, cb_rlc)
+DEFINE_CB_OPS(RRC, cb_rrc)
+DEFINE_CB_OPS(RL, cb_rl)
+DEFINE_CB_OPS(RR, cb_rr)
+DEFINE_CB_OPS(SLA, cb_sla)
+DEFINE_CB_OPS(SRA, cb_sra)
+DEFINE_CB_OPS(SWAP, cb_swap)
+DEFINE_CB_OPS(SRL, cb_srl)
+
+DEFINE_CB_BIT_OPS(0)
+DEFINE_CB_BIT_OPS(1)
+DEFINE_CB_BIT_OPS(2)
+DEFINE_CB_BIT_OPS(3)
+DEFINE_CB_BIT_OPS(4)
+DEFINE_CB_BIT_OPS(5)
+DEFINE_CB_BIT_OPS(6)
+DEFINE_CB_BIT_OPS(7)
+
+/* Opcodes with a single encoding */
+
+static status_code_t op_NOT_IMPL(cpu_state_t __attribute__((unused)) *const state, registers_t __attribute__((unused)) *const regs)
+{
+  return STATUS_ERR_UNDEFINED_INST;
 }
 
-static status_code_t op_INC_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_NOP(cpu_state_t __attribute__((unused)) *const state, registers_t __attribute__((unused)) *const regs)
 {
-  uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->dest, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  status = write_8(state, operands->dest, ++data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N, F_CLEAR);
-  update_flags(state, FLAG_H, ((data & 0xF) == 0x0) ? F_SET : F_CLEAR);
-
   return STATUS_OK;
 }
 
-static status_code_t op_INC_16(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_STOP(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  status_code_t status = STATUS_OK;
-  reg_16_ptr_t dest = reg_16_select(state, operands->dest);
-  if (dest != NULL)
-  {
-    ++(*dest);
-  }
-
-  status = sync_cycles(state, 1);
-  RETURN_STATUS_IF_NOT_OK(status);
-
+  regs->pc++;
+  // state->run_mode = RUN_MODE_STOPPED; // TODO: reenable
   return STATUS_OK;
 }
 
-static status_code_t op_DEC_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_HALT(cpu_state_t *const state, registers_t __attribute__((unused)) *const regs)
 {
-  uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->dest, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  status = write_8(state, operands->dest, --data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N, F_SET);
-  update_flags(state, FLAG_H, ((data & 0xF) == 0xF) ? F_SET : F_CLEAR);
-
+  state->run_mode = RUN_MODE_HALTED;
   return STATUS_OK;
 }
 
-static status_code_t op_DEC_16(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_LD_MEM_HLI_A(cpu_state_t *const state, registers_t *const regs)
 {
-  status_code_t status = STATUS_OK;
-  reg_16_ptr_t dest = reg_16_select(state, operands->dest);
-  if (dest != NULL)
-  {
-    --(*dest);
-  }
-
-  status = sync_cycles(state, 1);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  return STATUS_OK;
+  return bus_write_8(state, regs->hl++, regs->a);
 }
 
-static status_code_t op_ADD_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_LD_MEM_HLD_A(cpu_state_t *const state, registers_t *const regs)
 {
-
-  uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->source, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  reg_8_ptr_t dest = reg_8_select(state, operands->dest);
-  uint8_t half_carry = ((*dest & 0x0F) + (data & 0x0F)) & 0x10;
-  uint16_t full_carry = ((*dest & 0xFF) + (data & 0xFF)) & 0x100;
-
-  *dest += data;
-
-  update_flags(state, FLAG_Z, *dest == 0 ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N, F_CLEAR);
-  update_flags(state, FLAG_H, half_carry ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_C, full_carry ? F_SET : F_CLEAR);
-
-  return status;
+  return bus_write_8(state, regs->hl--, regs->a);
 }
 
-static status_code_t op_ADC_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_LD_A_MEM_HLI(cpu_state_t *const state, registers_t *const regs)
 {
-
-  uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->source, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  reg_8_ptr_t dest = reg_8_select(state, operands->dest);
-  uint8_t carry_bit = (state->registers.f & FLAG_C) ? 1 : 0;
-  uint8_t half_carry = ((*dest & 0x0F) + (data & 0x0F) + carry_bit) & 0x10;
-  uint16_t full_carry = ((*dest & 0xFF) + (data & 0xFF) + carry_bit) & 0x100;
-
-  *dest += data + carry_bit;
-
-  update_flags(state, FLAG_Z, *dest == 0 ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N, F_CLEAR);
-  update_flags(state, FLAG_H, half_carry ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_C, full_carry ? F_SET : F_CLEAR);
-
-  return status;
+  return bus_read_8(state, regs->hl++, &regs->a);
 }
 
-static status_code_t op_SUB_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_LD_A_MEM_HLD(cpu_state_t *const state, registers_t *const regs)
 {
-  uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->source, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  reg_8_ptr_t dest = reg_8_select(state, operands->dest);
-  uint8_t half_carry = ((*dest & 0x0F) < (data & 0x0F)) ? 1 : 0;
-  uint8_t full_carry = (*dest < data) ? 1 : 0;
-
-  *dest -= data;
-
-  update_flags(state, FLAG_Z, *dest == 0 ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N, F_SET);
-  update_flags(state, FLAG_H, half_carry ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_C, full_carry ? F_SET : F_CLEAR);
-
-  return status;
+  return bus_read_8(state, regs->hl--, &regs->a);
 }
 
-static status_code_t op_SBC_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_LD_MEM_HL_D8(cpu_state_t *const state, registers_t *const regs)
 {
   uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->source, &data);
+  status_code_t status = fetch(state, regs, &data);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  reg_8_ptr_t dest = reg_8_select(state, operands->dest);
-  uint8_t carry_bit = (state->registers.f & FLAG_C) ? 1 : 0;
-  uint8_t half_carry = ((*dest & 0x0F) < ((data & 0x0F) + carry_bit)) ? 1 : 0;
-  uint16_t full_carry = (*dest < (data + carry_bit)) ? 1 : 0;
-
-  *dest -= data;
-  *dest -= carry_bit;
-
-  update_flags(state, FLAG_Z, *dest == 0 ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N, F_SET);
-  update_flags(state, FLAG_H, half_carry ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_C, full_carry ? F_SET : F_CLEAR);
-
-  return status;
+  return bus_write_8(state, regs->hl, data);
 }
 
-static status_code_t op_AND_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_INC_MEM_HL(cpu_state_t *const state, registers_t *const regs)
 {
   uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->source, &data);
+  status_code_t status = bus_read_8(state, regs->hl, &data);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  reg_8_ptr_t dest = reg_8_select(state, operands->dest);
-
-  *dest &= data;
-
-  update_flags(state, FLAG_Z, *dest == 0 ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_H, F_SET);
-  update_flags(state, FLAG_N | FLAG_C, F_CLEAR);
-
-  return STATUS_OK;
+  return bus_write_8(state, regs->hl, alu_inc(regs, data));
 }
 
-static status_code_t op_XOR_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_DEC_MEM_HL(cpu_state_t *const state, registers_t *const regs)
 {
   uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->source, &data);
+  status_code_t status = bus_read_8(state, regs->hl, &data);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  reg_8_ptr_t dest = reg_8_select(state, operands->dest);
-
-  *dest ^= data;
-
-  update_flags(state, FLAG_Z, *dest == 0 ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H | FLAG_C, F_CLEAR);
-
-  return STATUS_OK;
+  return bus_write_8(state, regs->hl, alu_dec(regs, data));
 }
 
-static status_code_t op_OR_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_LDH_MEM_A8_A(cpu_state_t *const state, registers_t *const regs)
 {
-  uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->source, &data);
+  uint8_t offset;
+  status_code_t status = fetch(state, regs, &offset);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  reg_8_ptr_t dest = reg_8_select(state, operands->dest);
-
-  *dest |= data;
-
-  update_flags(state, FLAG_Z, *dest == 0 ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H | FLAG_C, F_CLEAR);
-
-  return STATUS_OK;
+  return bus_write_8(state, 0xFF00 | offset, regs->a);
 }
 
-static status_code_t op_CP_8(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_LDH_A_MEM_A8(cpu_state_t *const state, registers_t *const regs)
 {
-  uint8_t data;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, operands->source, &data);
+  uint8_t offset;
+  status_code_t status = fetch(state, regs, &offset);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  reg_8_ptr_t dest = reg_8_select(state, operands->dest);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  uint8_t half_carry = ((*dest & 0x0F) < (data & 0x0F)) ? 1 : 0;
-  uint8_t full_carry = (*dest < data) ? 1 : 0;
-
-  update_flags(state, FLAG_Z, (*dest == data) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N, F_SET);
-  update_flags(state, FLAG_H, half_carry ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_C, full_carry ? F_SET : F_CLEAR);
-
-  return STATUS_OK;
+  return bus_read_8(state, 0xFF00 | offset, &regs->a);
 }
 
-static status_code_t op_ADD_16(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_LD_MEM_C_A(cpu_state_t *const state, registers_t *const regs)
 {
-  status_code_t status = STATUS_OK;
-
-  reg_16_ptr_t source = reg_16_select(state, operands->source);
-  reg_16_ptr_t dest = reg_16_select(state, operands->dest);
-
-  if (operands->source == AM_IMM_S_8)
-  {
-    return read_reg_16_plus_offset(state, operands->dest, dest);
-  }
-
-  uint16_t half_carry = ((*dest & 0x0FFF) + (*source & 0x0FFF)) & 0x1000;
-  uint32_t full_carry = ((*dest & 0xFFFF) + (*source & 0xFFFF)) & 0x10000;
-
-  *dest += *source;
-
-  update_flags(state, FLAG_N, F_CLEAR);
-  update_flags(state, FLAG_H, half_carry ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_C, full_carry ? F_SET : F_CLEAR);
-
-  status = sync_cycles(state, 1);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  return STATUS_OK;
+  return bus_write_8(state, 0xFF00 | regs->c, regs->a);
 }
 
-static status_code_t op_RLCA(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_LD_A_MEM_C(cpu_state_t *const state, registers_t *const regs)
 {
-  registers_t *const regs = &state->registers;
-
-  uint8_t msb = (regs->a & (1 << 7)) ? 1 : 0;
-  regs->a = (regs->a << 1) | msb;
-
-  update_flags(state, FLAG_Z | FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, msb ? F_SET : F_CLEAR);
-
-  return STATUS_OK;
+  return bus_read_8(state, 0xFF00 | regs->c, &regs->a);
 }
 
-static status_code_t op_RRCA(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_LD_MEM_A16_A(cpu_state_t *const state, registers_t *const regs)
 {
-  registers_t *const regs = &state->registers;
-
-  uint8_t lsb = regs->a & 0x1;
-  regs->a = (regs->a >> 1) | (lsb << 7);
-
-  update_flags(state, FLAG_Z | FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, lsb ? F_SET : F_CLEAR);
+  uint16_t address;
+  status_code_t status = fetch_16(state, regs, &address);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  return STATUS_OK;
+  return bus_write_8(state, address, regs->a);
 }
 
-static status_code_t op_RLA(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_LD_A_MEM_A16(cpu_state_t *const state, registers_t *const regs)
 {
-  registers_t *const regs = &state->registers;
-
-  uint8_t msb = (regs->a & (1 << 7)) ? 1 : 0;
-  regs->a = (regs->a << 1);
-  regs->a |= ((regs->f & FLAG_C) ? 1 : 0);
-
-  update_flags(state, FLAG_Z | FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, msb ? F_SET : F_CLEAR);
+  uint16_t address;
+  status_code_t status = fetch_16(state, regs, &address);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  return STATUS_OK;
+  return bus_read_8(state, address, &regs->a);
 }
 
-static status_code_t op_RRA(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_LD_MEM_A16_SP(cpu_state_t *const state, registers_t *const regs)
 {
-  registers_t *const regs = &state->registers;
+  uint16_t address;
+  status_code_t status = bus_read_16(state, regs->pc, &address);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  uint8_t lsb = regs->a & 0x1;
-  regs->a = (regs->a >> 1);
-  regs->a |= ((regs->f & FLAG_C) ? (1 << 7) : 0);
+  status = bus_write_16(state, address, regs->sp);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  update_flags(state, FLAG_Z | FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, lsb ? F_SET : F_CLEAR);
+  regs->pc += 2;
 
   return STATUS_OK;
 }
 
-static status_code_t op_CPL(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_LD_SP_HL(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  registers_t *const regs = &state->registers;
-  regs->a = ~(regs->a);
-  update_flags(state, FLAG_N | FLAG_H, F_SET);
+  regs->sp = regs->hl;
   return STATUS_OK;
 }
 
-static status_code_t op_SCF(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_LD_HL_SP_S8(cpu_state_t *const state, registers_t *const regs)
 {
-  update_flags(state, FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, F_SET);
-  return STATUS_OK;
-}
-
-static status_code_t op_CCF(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
-{
-  update_flags(state, FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, F_INVERT);
+  uint16_t data = 0;
+  status_code_t status = sp_plus_offset(state, regs, &data);
+  RETURN_STATUS_IF_NOT_OK(status);
+  regs->hl = data;
   return STATUS_OK;
 }
 
-static status_code_t op_RET(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_ADD_SP_S8(cpu_state_t *const state, registers_t *const regs)
 {
-  status_code_t status = STATUS_OK;
-
-  status = sync_cycles(state, 1);
+  uint16_t data = 0;
+  status_code_t status = sp_plus_offset(state, regs, &data);
   RETURN_STATUS_IF_NOT_OK(status);
-
-  if (check_cond(state, operands->jump_mode))
-  {
-    return pop_reg_16(state, &state->registers.pc);
-  }
+  regs->sp = data;
   return STATUS_OK;
 }
 
-static status_code_t op_CALL(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_RLCA(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  uint16_t address;
-  status_code_t status = STATUS_OK;
-
-  status = read_16(state, operands->source, &address);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  if (check_cond(state, operands->jump_mode))
-  {
-    status = push_reg_16(state, &state->registers.pc);
-    RETURN_STATUS_IF_NOT_OK(status);
-
-    state->registers.pc = address;
-
-    status = sync_cycles(state, 1);
-    RETURN_STATUS_IF_NOT_OK(status);
-  }
-
+  regs->a = cb_rlc(regs, regs->a);
+  regs->f &= FLAG_C;
   return STATUS_OK;
 }
 
-static status_code_t op_POP(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_RRCA(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  return pop_reg_16(state, reg_16_select(state, operands->dest));
+  regs->a = cb_rrc(regs, regs->a);
+  regs->f &= FLAG_C;
+  return STATUS_OK;
 }
 
-static status_code_t op_PUSH(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_RLA(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  status_code_t status = STATUS_OK;
-  status = push_reg_16(state, reg_16_select(state, operands->dest));
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  status = sync_cycles(state, 1);
-  RETURN_STATUS_IF_NOT_OK(status);
-
+  regs->a = cb_rl(regs, regs->a);
+  regs->f &= FLAG_C;
   return STATUS_OK;
 }
 
-static status_code_t op_RST(cpu_state_t *const state, inst_operands_t *const operands)
+static status_code_t op_RRA(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  status_code_t status = STATUS_OK;
-  status = push_reg_16(state, &state->registers.pc);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  state->registers.pc = operands->reset_vector;
-
-  status = sync_cycles(state, 1);
-  RETURN_STATUS_IF_NOT_OK(status);
-
+  regs->a = cb_rr(regs, regs->a);
+  regs->f &= FLAG_C;
   return STATUS_OK;
 }
 
-static status_code_t op_DAA(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_DAA(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  registers_t *const regs = &state->registers;
-
   if (!(regs->f & FLAG_N))
   {
     if ((regs->f & FLAG_C) || (regs->a > 0x99))
     {
       regs->a += 0x60;
-      update_flags(state, FLAG_C, F_SET);
+      regs->f |= FLAG_C;
     }
     if ((regs->f & FLAG_H) || ((regs->a & 0x0F) > 0x09))
     {
@@ -1590,295 +1076,676 @@ static status_code_t op_DAA(cpu_state_t *const state, inst_operands_t *const __a
     }
   }
 
-  update_flags(state, FLAG_Z, (regs->a == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_H, F_CLEAR);
+  regs->f = (regs->f & (FLAG_N | FLAG_C)) | (regs->a == 0 ? FLAG_Z : 0);
 
   return STATUS_OK;
 }
 
-static status_code_t op_RETI(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_CPL(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  status_code_t status = STATUS_OK;
-  status = global_interrupt_enable(&state->interrupt, true);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  return pop_reg_16(state, &state->registers.pc);
+  regs->a = ~(regs->a);
+  regs->f |= FLAG_N | FLAG_H;
+  return STATUS_OK;
 }
 
-static status_code_t op_DI(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_SCF(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  state->next_ime_flag = 0;
-  return global_interrupt_enable(&state->interrupt, false);
+  regs->f = (regs->f & FLAG_Z) | FLAG_C;
+  return STATUS_OK;
 }
 
-static status_code_t op_EI(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_CCF(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  state->next_ime_flag = 1;
+  regs->f = (regs->f & (FLAG_Z | FLAG_C)) ^ FLAG_C;
   return STATUS_OK;
 }
 
-static status_code_t op_PRCB(cpu_state_t *const state, inst_operands_t *const __attribute__((unused)) operands)
+static status_code_t op_JR(cpu_state_t *const state, registers_t *const regs)
 {
-  static addressing_mode_t const target_lookup_table[] = {
-      AM_REG_B,
-      AM_REG_C,
-      AM_REG_D,
-      AM_REG_E,
-      AM_REG_H,
-      AM_REG_L,
-      AM_MEM_HL,
-      AM_REG_A,
-  };
-
-  static cb_opcode_handler_t const handlers[] = {
-      {op_RLC},
-      {op_RRC},
-      {op_RL},
-      {op_RR},
-      {op_SLA},
-      {op_SRA},
-      {op_SWAP},
-      {op_SRL},
-  };
-
-  uint8_t cb_opcode;
-  status_code_t status = STATUS_OK;
-
-  status = fetch(state, &cb_opcode);
+  int8_t offset;
+  status_code_t status = fetch(state, regs, (uint8_t *)&offset);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  uint8_t target_type = (cb_opcode & 0x7);
-  uint8_t bit_index = ((cb_opcode >> 3) & 0x7);
-  uint8_t handler_family = ((cb_opcode >> 6) & 0x3);
+  regs->pc += offset;
 
-  addressing_mode_t target = target_lookup_table[target_type];
-
-  switch (handler_family)
-  {
-  case 0:
-    status = handlers[bit_index].rot_shf_swap_handler_fn(state, target);
-    break;
-  case 1:
-    status = op_BIT(state, target, bit_index);
-    break;
-  case 2:
-    status = op_RES(state, target, bit_index);
-    break;
-  case 3:
-    status = op_SET(state, target, bit_index);
-    break;
-  default:
-    break;
-  }
-
-  return status;
+  return sync_cycles(state, 1);
 }
 
-/* Ops for CB-prefixed opcodes */
-static status_code_t op_RLC(cpu_state_t *const state, addressing_mode_t const addr_mode)
+static status_code_t op_JP(cpu_state_t *const state, registers_t *const regs)
 {
-  uint8_t data, msb;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, addr_mode, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  msb = data & (1 << 7) ? 1 : 0;
-  data <<= 1;
-  data |= msb ? 1 : 0;
-
-  status = write_8(state, addr_mode, data);
+  uint16_t address;
+  status_code_t status = fetch_16(state, regs, &address);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, msb ? F_SET : F_CLEAR);
+  regs->pc = address;
 
   return STATUS_OK;
 }
 
-static status_code_t op_RRC(cpu_state_t *const state, addressing_mode_t const addr_mode)
+static status_code_t op_JP_HL(cpu_state_t __attribute__((unused)) *const state, registers_t *const regs)
 {
-  uint8_t data, lsb;
-  status_code_t status = STATUS_OK;
+  regs->pc = regs->hl;
+  return STATUS_OK;
+}
 
-  status = read_8(state, addr_mode, &data);
+static status_code_t op_CALL(cpu_state_t *const state, registers_t *const regs)
+{
+  uint16_t address;
+  status_code_t status = fetch_16(state, regs, &address);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  lsb = data & 0x1;
-  data >>= 1;
-  data |= lsb ? (1 << 7) : 0;
-
-  status = write_8(state, addr_mode, data);
+  status = push_16(state, regs, regs->pc);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, lsb ? F_SET : F_CLEAR);
+  regs->pc = address;
 
-  return STATUS_OK;
+  return sync_cycles(state, 1);
 }
 
-static status_code_t op_RL(cpu_state_t *const state, addressing_mode_t const addr_mode)
+static status_code_t op_RET(cpu_state_t *const state, registers_t *const regs)
 {
-  uint8_t data, msb;
-  status_code_t status = STATUS_OK;
-
-  status = read_8(state, addr_mode, &data);
+  status_code_t status = sync_cycles(state, 1);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  msb = data & (1 << 7) ? 1 : 0;
-  data <<= 1;
-  data |= (state->registers.f & FLAG_C) ? 1 : 0;
+  return pop_16(state, regs, &regs->pc);
+}
 
-  status = write_8(state, addr_mode, data);
+static status_code_t op_RETI(cpu_state_t *const state, registers_t *const regs)
+{
+  status_code_t status = global_interrupt_enable(&state->interrupt, true);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, msb ? F_SET : F_CLEAR);
-
-  return STATUS_OK;
+  return pop_16(state, regs, &regs->pc);
 }
 
-static status_code_t op_RR(cpu_state_t *const state, addressing_mode_t const addr_mode)
+static status_code_t op_DI(cpu_state_t *const state, registers_t __attribute__((unused)) *const regs)
 {
-  uint8_t data, lsb;
-  status_code_t status = STATUS_OK;
+  state->next_ime_flag = 0;
+  return global_interrupt_enable(&state->interrupt, false);
+}
 
-  status = read_8(state, addr_mode, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
+static status_code_t op_EI(cpu_state_t *const state, registers_t __attribute__((unused)) *const regs)
+{
+  state->next_ime_flag = 1;
+  return STATUS_OK;
+}
 
-  lsb = data & 0x1;
-  data >>= 1;
-  data |= (state->registers.f & FLAG_C) ? (1 << 7) : 0;
+static opcode_handler_fn const cb_inst_table[256] = {
+    /* 0x00 - 0x3F: Rotate, shift, and swap */
+    CB_TABLE_ROW(RLC),
+    CB_TABLE_ROW(RRC),
+    CB_TABLE_ROW(RL),
+    CB_TABLE_ROW(RR),
+    CB_TABLE_ROW(SLA),
+    CB_TABLE_ROW(SRA),
+    CB_TABLE_ROW(SWAP),
+    CB_TABLE_ROW(SRL),
+
+    /* 0x40 - 0x7F: Bit test */
+    CB_TABLE_ROW(BIT_0),
+    CB_TABLE_ROW(BIT_1),
+    CB_TABLE_ROW(BIT_2),
+    CB_TABLE_ROW(BIT_3),
+    CB_TABLE_ROW(BIT_4),
+    CB_TABLE_ROW(BIT_5),
+    CB_TABLE_ROW(BIT_6),
+    CB_TABLE_ROW(BIT_7),
+
+    /* 0x80 - 0xBF: Bit reset */
+    CB_TABLE_ROW(RES_0),
+    CB_TABLE_ROW(RES_1),
+    CB_TABLE_ROW(RES_2),
+    CB_TABLE_ROW(RES_3),
+    CB_TABLE_ROW(RES_4),
+    CB_TABLE_ROW(RES_5),
+    CB_TABLE_ROW(RES_6),
+    CB_TABLE_ROW(RES_7),
+
+    /* 0xC0 - 0xFF: Bit set */
+    CB_TABLE_ROW(SET_0),
+    CB_TABLE_ROW(SET_1),
+    CB_TABLE_ROW(SET_2),
+    CB_TABLE_ROW(SET_3),
+    CB_TABLE_ROW(SET_4),
+    CB_TABLE_ROW(SET_5),
+    CB_TABLE_ROW(SET_6),
+    CB_TABLE_ROW(SET_7),
+};
 
-  status = write_8(state, addr_mode, data);
+static status_code_t op_PRCB(cpu_state_t *const state, registers_t *const regs)
+{
+  uint8_t cb_opcode;
+  status_code_t status = fetch(state, regs, &cb_opcode);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, lsb ? F_SET : F_CLEAR);
-
-  return STATUS_OK;
-}
+  return cb_inst_table[cb_opcode](state, regs);
+}
+
+/**
+ * Opcode table: opcode, handler, and duration in M-cycles. Expanded into the
+ * handler table used by single stepping and into the dispatch labels of the threaded interpreter.
+ */
+#define CPU_OPCODE_LIST(X) \
+  /* 0x00 - 0x0F */ \
+  X(0x00, op_NOP, 1) \
+  X(0x01, op_LD_BC_D16, 3) \
+  X(0x02, op_LD_MEM_BC_A, 2) \
+  X(0x03, op_INC_BC, 2) \
+  X(0x04, op_INC_B, 1) \
+  X(0x05, op_DEC_B, 1) \
+  X(0x06, op_LD_B_D8, 2) \
+  X(0x07, op_RLCA, 1) \
+  X(0x08, op_LD_MEM_A16_SP, 5) \
+  X(0x09, op_ADD_HL_BC, 2) \
+  X(0x0A, op_LD_A_MEM_BC, 2) \
+  X(0x0B, op_DEC_BC, 2) \
+  X(0x0C, op_INC_C, 1) \
+  X(0x0D, op_DEC_C, 1) \
+  X(0x0E, op_LD_C_D8, 2) \
+  X(0x0F, op_RRCA, 1) \
+  /* 0x10 - 0x1F */ \
+  X(0x10, op_STOP, 1) \
+  X(0x11, op_LD_DE_D16, 3) \
+  X(0x12, op_LD_MEM_DE_A, 2) \
+  X(0x13, op_INC_DE, 2) \
+  X(0x14, op_INC_D, 1) \
+  X(0x15, op_DEC_D, 1) \
+  X(0x16, op_LD_D_D8, 2) \
+  X(0x17, op_RLA, 1) \
+  X(0x18, op_JR, 3) \
+  X(0x19, op_ADD_HL_DE, 2) \
+  X(0x1A, op_LD_A_MEM_DE, 2) \
+  X(0x1B, op_DEC_DE, 2) \
+  X(0x1C, op_INC_E, 1) \
+  X(0x1D, op_DEC_E, 1) \
+  X(0x1E, op_LD_E_D8, 2) \
+  X(0x1F, op_RRA, 1) \
+  /* 0x20 - 0x2F */ \
+  X(0x20, op_JR_NZ, 2) \
+  X(0x21, op_LD_HL_D16, 3) \
+  X(0x22, op_LD_MEM_HLI_A, 2) \
+  X(0x23, op_INC_HL, 2) \
+  X(0x24, op_INC_H, 1) \
+  X(0x25, op_DEC_H, 1) \
+  X(0x26, op_LD_H_D8, 2) \
+  X(0x27, op_DAA, 1) \
+  X(0x28, op_JR_Z, 2) \
+  X(0x29, op_ADD_HL_HL, 2) \
+  X(0x2A, op_LD_A_MEM_HLI, 2) \
+  X(0x2B, op_DEC_HL, 2) \
+  X(0x2C, op_INC_L, 1) \
+  X(0x2D, op_DEC_L, 1) \
+  X(0x2E, op_LD_L_D8, 2) \
+  X(0x2F, op_CPL, 1) \
+  /* 0x30 - 0x3F */ \
+  X(0x30, op_JR_NC, 2) \
+  X(0x31, op_LD_SP_D16, 3) \
+  X(0x32, op_LD_MEM_HLD_A, 2) \
+  X(0x33, op_INC_SP, 2) \
+  X(0x34, op_INC_MEM_HL, 3) \
+  X(0x35, op_DEC_MEM_HL, 3) \
+  X(0x36, op_LD_MEM_HL_D8, 3) \
+  X(0x37, op_SCF, 1) \
+  X(0x38, op_JR_C, 2) \
+  X(0x39, op_ADD_HL_SP, 2) \
+  X(0x3A, op_LD_A_MEM_HLD, 2) \
+  X(0x3B, op_DEC_SP, 2) \
+  X(0x3C, op_INC_A, 1) \
+  X(0x3D, op_DEC_A, 1) \
+  X(0x3E, op_LD_A_D8, 2) \
+  X(0x3F, op_CCF, 1) \
+  /* 0x40 - 0x4F */ \
+  X(0x40, op_LD_B_B, 1) \
+  X(0x41, op_LD_B_C, 1) \
+  X(0x42, op_LD_B_D, 1) \
+  X(0x43, op_LD_B_E, 1) \
+  X(0x44, op_LD_B_H, 1) \
+  X(0x45, op_LD_B_L, 1) \
+  X(0x46, op_LD_B_MEM_HL, 2) \
+  X(0x47, op_LD_B_A, 1) \
+  X(0x48, op_LD_C_B, 1) \
+  X(0x49, op_LD_C_C, 1) \
+  X(0x4A, op_LD_C_D, 1) \
+  X(0x4B, op_LD_C_E, 1) \
+  X(0x4C, op_LD_C_H, 1) \
+  X(0x4D, op_LD_C_L, 1) \
+  X(0x4E, op_LD_C_MEM_HL, 2) \
+  X(0x4F, op_LD_C_A, 1) \
+  /* 0x50 - 0x5F */ \
+  X(0x50, op_LD_D_B, 1) \
+  X(0x51, op_LD_D_C, 1) \
+  X(0x52, op_LD_D_D, 1) \
+  X(0x53, op_LD_D_E, 1) \
+  X(0x54, op_LD_D_H, 1) \
+  X(0x55, op_LD_D_L, 1) \
+  X(0x56, op_LD_D_MEM_HL, 2) \
+  X(0x57, op_LD_D_A, 1) \
+  X(0x58, op_LD_E_B, 1) \
+  X(0x59, op_LD_E_C, 1) \
+  X(0x5A, op_LD_E_D, 1) \
+  X(0x5B, op_LD_E_E, 1) \
+  X(0x5C, op_LD_E_H, 1) \
+  X(0x5D, op_LD_E_L, 1) \
+  X(0x5E, op_LD_E_MEM_HL, 2) \
+  X(0x5F, op_LD_E_A, 1) \
+  /* 0x60 - 0x6F */ \
+  X(0x60, op_LD_H_B, 1) \
+  X(0x61, op_LD_H_C, 1) \
+  X(0x62, op_LD_H_D, 1) \
+  X(0x63, op_LD_H_E, 1) \
+  X(0x64, op_LD_H_H, 1) \
+  X(0x65, op_LD_H_L, 1) \
+  X(0x66, op_LD_H_MEM_HL, 2) \
+  X(0x67, op_LD_H_A, 1) \
+  X(0x68, op_LD_L_B, 1) \
+  X(0x69, op_LD_L_C, 1) \
+  X(0x6A, op_LD_L_D, 1) \
+  X(0x6B, op_LD_L_E, 1) \
+  X(0x6C, op_LD_L_H, 1) \
+  X(0x6D, op_LD_L_L, 1) \
+  X(0x6E, op_LD_L_MEM_HL, 2) \
+  X(0x6F, op_LD_L_A, 1) \
+  /* 0x70 - 0x7F */ \
+  X(0x70, op_LD_MEM_HL_B, 2) \
+  X(0x71, op_LD_MEM_HL_C, 2) \
+  X(0x72, op_LD_MEM_HL_D, 2) \
+  X(0x73, op_LD_MEM_HL_E, 2) \
+  X(0x74, op_LD_MEM_HL_H, 2) \
+  X(0x75, op_LD_MEM_HL_L, 2) \
+  X(0x76, op_HALT, 1) \
+  X(0x77, op_LD_MEM_HL_A, 2) \
+  X(0x78, op_LD_A_B, 1) \
+  X(0x79, op_LD_A_C, 1) \
+  X(0x7A, op_LD_A_D, 1) \
+  X(0x7B, op_LD_A_E, 1) \
+  X(0x7C, op_LD_A_H, 1) \
+  X(0x7D, op_LD_A_L, 1) \
+  X(0x7E, op_LD_A_MEM_HL, 2) \
+  X(0x7F, op_LD_A_A, 1) \
+  /* 0x80 - 0x8F */ \
+  X(0x80, op_ADD_A_B, 1) \
+  X(0x81, op_ADD_A_C, 1) \
+  X(0x82, op_ADD_A_D, 1) \
+  X(0x83, op_ADD_A_E, 1) \
+  X(0x84, op_ADD_A_H, 1) \
+  X(0x85, op_ADD_A_L, 1) \
+  X(0x86, op_ADD_A_MEM_HL, 2) \
+  X(0x87, op_ADD_A_A, 1) \
+  X(0x88, op_ADC_A_B, 1) \
+  X(0x89, op_ADC_A_C, 1) \
+  X(0x8A, op_ADC_A_D, 1) \
+  X(0x8B, op_ADC_A_E, 1) \
+  X(0x8C, op_ADC_A_H, 1) \
+  X(0x8D, op_ADC_A_L, 1) \
+  X(0x8E, op_ADC_A_MEM_HL, 2) \
+  X(0x8F, op_ADC_A_A, 1) \
+  /* 0x90 - 0x9F */ \
+  X(0x90, op_SUB_A_B, 1) \
+  X(0x91, op_SUB_A_C, 1) \
+  X(0x92, op_SUB_A_D, 1) \
+  X(0x93, op_SUB_A_E, 1) \
+  X(0x94, op_SUB_A_H, 1) \
+  X(0x95, op_SUB_A_L, 1) \
+  X(0x96, op_SUB_A_MEM_HL, 2) \
+  X(0x97, op_SUB_A_A, 1) \
+  X(0x98, op_SBC_A_B, 1) \
+  X(0x99, op_SBC_A_C, 1) \
+  X(0x9A, op_SBC_A_D, 1) \
+  X(0x9B, op_SBC_A_E, 1) \
+  X(0x9C, op_SBC_A_H, 1) \
+  X(0x9D, op_SBC_A_L, 1) \
+  X(0x9E, op_SBC_A_MEM_HL, 2) \
+  X(0x9F, op_SBC_A_A, 1) \
+  /* 0xA0 - 0xAF */ \
+  X(0xA0, op_AND_A_B, 1) \
+  X(0xA1, op_AND_A_C, 1) \
+  X(0xA2, op_AND_A_D, 1) \
+  X(0xA3, op_AND_A_E, 1) \
+  X(0xA4, op_AND_A_H, 1) \
+  X(0xA5, op_AND_A_L, 1) \
+  X(0xA6, op_AND_A_MEM_HL, 2) \
+  X(0xA7, op_AND_A_A, 1) \
+  X(0xA8, op_XOR_A_B, 1) \
+  X(0xA9, op_XOR_A_C, 1) \
+  X(0xAA, op_XOR_A_D, 1) \
+  X(0xAB, op_XOR_A_E, 1) \
+  X(0xAC, op_XOR_A_H, 1) \
+  X(0xAD, op_XOR_A_L, 1) \
+  X(0xAE, op_XOR_A_MEM_HL, 2) \
+  X(0xAF, op_XOR_A_A, 1) \
+  /* 0xB0 - 0xBF */ \
+  X(0xB0, op_OR_A_B, 1) \
+  X(0xB1, op_OR_A_C, 1) \
+  X(0xB2, op_OR_A_D, 1) \
+  X(0xB3, op_OR_A_E, 1) \
+  X(0xB4, op_OR_A_H, 1) \
+  X(0xB5, op_OR_A_L, 1) \
+  X(0xB6, op_OR_A_MEM_HL, 2) \
+  X(0xB7, op_OR_A_A, 1) \
+  X(0xB8, op_CP_A_B, 1) \
+  X(0xB9, op_CP_A_C, 1) \
+  X(0xBA, op_CP_A_D, 1) \
+  X(0xBB, op_CP_A_E, 1) \
+  X(0xBC, op_CP_A_H, 1) \
+  X(0xBD, op_CP_A_L, 1) \
+  X(0xBE, op_CP_A_MEM_HL, 2) \
+  X(0xBF, op_CP_A_A, 1) \
+  /* 0xC0 - 0xCF */ \
+  X(0xC0, op_RET_NZ, 2) \
+  X(0xC1, op_POP_BC, 3) \
+  X(0xC2, op_JP_NZ, 3) \
+  X(0xC3, op_JP, 4) \
+  X(0xC4, op_CALL_NZ, 3) \
+  X(0xC5, op_PUSH_BC, 4) \
+  X(0xC6, op_ADD_A_D8, 2) \
+  X(0xC7, op_RST_00, 4) \
+  X(0xC8, op_RET_Z, 2) \
+  X(0xC9, op_RET, 4) \
+  X(0xCA, op_JP_Z, 3) \
+  X(0xCB, op_PRCB, 2) \
+  X(0xCC, op_CALL_Z, 3) \
+  X(0xCD, op_CALL, 6) \
+  X(0xCE, op_ADC_A_D8, 2) \
+  X(0xCF, op_RST_08, 4) \
+  /* 0xD0 - 0xDF */ \
+  X(0xD0, op_RET_NC, 2) \
+  X(0xD1, op_POP_DE, 3) \
+  X(0xD2, op_JP_NC, 3) \
+  X(0xD3, op_NOT_IMPL, 0) \
+  X(0xD4, op_CALL_NC, 3) \
+  X(0xD5, op_PUSH_DE, 4) \
+  X(0xD6, op_SUB_A_D8, 2) \
+  X(0xD7, op_RST_10, 4) \
+  X(0xD8, op_RET_C, 2) \
+  X(0xD9, op_RETI, 4) \
+  X(0xDA, op_JP_C, 3) \
+  X(0xDB, op_NOT_IMPL, 0) \
+  X(0xDC, op_CALL_C, 3) \
+  X(0xDD, op_NOT_IMPL, 0) \
+  X(0xDE, op_SBC_A_D8, 2) \
+  X(0xDF, op_RST_18, 4) \
+  /* 0xE0 - 0xEF */ \
+  X(0xE0, op_LDH_MEM_A8_A, 3) \
+  X(0xE1, op_POP_HL, 3) \
+  X(0xE2, op_LD_MEM_C_A, 2) \
+  X(0xE3, op_NOT_IMPL, 0) \
+  X(0xE4, op_NOT_IMPL, 0) \
+  X(0xE5, op_PUSH_HL, 4) \
+  X(0xE6, op_AND_A_D8, 2) \
+  X(0xE7, op_RST_20, 4) \
+  X(0xE8, op_ADD_SP_S8, 4) \
+  X(0xE9, op_JP_HL, 1) \
+  X(0xEA, op_LD_MEM_A16_A, 4) \
+  X(0xEB, op_NOT_IMPL, 0) \
+  X(0xEC, op_NOT_IMPL, 0) \
+  X(0xED, op_NOT_IMPL, 0) \
+  X(0xEE, op_XOR_A_D8, 2) \
+  X(0xEF, op_RST_28, 4) \
+  /* 0xF0 - 0xFF */ \
+  X(0xF0, op_LDH_A_MEM_A8, 3) \
+  X(0xF1, op_POP_AF, 3) \
+  X(0xF2, op_LD_A_MEM_C, 2) \
+  X(0xF3, op_DI, 1) \
+  X(0xF4, op_NOT_IMPL, 0) \
+  X(0xF5, op_PUSH_AF, 4) \
+  X(0xF6, op_OR_A_D8, 2) \
+  X(0xF7, op_RST_30, 4) \
+  X(0xF8, op_LD_HL_SP_S8, 3) \
+  X(0xF9, op_LD_SP_HL, 2) \
+  X(0xFA, op_LD_A_MEM_A16, 4) \
+  X(0xFB, op_EI, 1) \
+  X(0xFC, op_NOT_IMPL, 0) \
+  X(0xFD, op_NOT_IMPL, 0) \
+  X(0xFE, op_CP_A_D8, 2) \
+  X(0xFF, op_RST_38, 4)
+
+#define INST_TABLE_ENTRY(opcode, handler, cycle) [opcode] = INST(handler, cycle),
+
+static instruction_t const inst_table[256] = {
+    CPU_OPCODE_LIST(INST_TABLE_ENTRY)
+};
 
-static status_code_t op_SLA(cpu_state_t *const state, addressing_mode_t const addr_mode)
+static inline status_code_t update_interrupt_state(cpu_state_t *const state)
 {
-  uint8_t data, msb;
   status_code_t status = STATUS_OK;
 
-  status = read_8(state, addr_mode, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
-
-  msb = (data & (1 << 7)) ? 1 : 0;
-  data <<= 1;
+  if (interrupt_globally_enabled(&state->interrupt))
+  {
+    status = service_interrupt(&state->interrupt);
+    RETURN_STATUS_IF_NOT_OK(status);
 
-  status = write_8(state, addr_mode, data);
-  RETURN_STATUS_IF_NOT_OK(status);
+    state->next_ime_flag = 0;
+  }
 
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, msb ? F_SET : F_CLEAR);
+  if (state->next_ime_flag)
+  {
+    status = global_interrupt_enable(&state->interrupt, true);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
 
   return STATUS_OK;
 }
 
-static status_code_t op_SRA(cpu_state_t *const state, addressing_mode_t const addr_mode)
+status_code_t cpu_emulation_cycle(cpu_state_t *const state)
 {
-  uint8_t data, msb, lsb;
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(state);
+
   status_code_t status = STATUS_OK;
 
-  status = read_8(state, addr_mode, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
+  if (state->run_mode == RUN_MODE_NORMAL)
+  {
+    uint8_t opcode;
+    state->current_inst_m_cycle_count = 0;
 
-  msb = data & (1 << 7);
-  lsb = data & 0x1;
-  data = msb | (data >> 1);
+    status = fetch(state, &state->registers, &opcode);
+    RETURN_STATUS_IF_NOT_OK(status);
 
-  status = write_8(state, addr_mode, data);
-  RETURN_STATUS_IF_NOT_OK(status);
+    instruction_t const *const inst = &inst_table[opcode];
 
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, lsb ? F_SET : F_CLEAR);
+    status = inst->handler(state, &state->registers);
+    RETURN_STATUS_IF_NOT_OK(status);
 
-  return STATUS_OK;
-}
+    int8_t owed_cycles = inst->cycle_duration - state->current_inst_m_cycle_count;
+    if (owed_cycles > 0)
+    {
+      status = sync_cycles(state, owed_cycles);
+      RETURN_STATUS_IF_NOT_OK(status);
+    }
 
-static status_code_t op_SWAP(cpu_state_t *const state, addressing_mode_t const addr_mode)
-{
-  uint8_t data;
-  status_code_t status = STATUS_OK;
+    /**
+     * Hacky way to ensure the lower bytes of the flag registers
+     * to remain 0. TODO
+     */
+    state->registers.f &= 0xF0;
+  }
+  else if (state->run_mode == RUN_MODE_HALTED)
+  {
+    status = sync_halted_cycles(state);
+    RETURN_STATUS_IF_NOT_OK(status);
 
-  status = read_8(state, addr_mode, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
+    if (has_pending_interrupts(&state->interrupt))
+    {
+      state->run_mode = RUN_MODE_NORMAL;
+    }
+  }
+  else
+  {
+    Log_D("Unknown run mode: %d", state->run_mode);
+    return STATUS_ERR_GENERIC;
+  }
 
-  data = ((data & 0xF) << 4) | ((data >> 4) & 0xF);
+  return update_interrupt_state(state);
+}
+
+/**
+ * Threaded interpreter. Each opcode gets its own dispatch label so the handler can be
+ * inlined and the next instruction is dispatched from the end of the current one.
+ * Compilers without the labels-as-values extension fall back to a switch.
+ */
+#if defined(__GNUC__) && !defined(CPU_DISABLE_COMPUTED_GOTO)
+#define CPU_COMPUTED_GOTO (1)
+#define THREADED_LABEL(opcode) exec_##opcode
+#define THREADED_DISPATCH_ENTRY(opcode, handler, cycle) [opcode] = &&exec_##opcode,
+#define THREADED_NEXT() goto *dispatch_table[opcode]
+#else
+#define CPU_COMPUTED_GOTO (0)
+#define THREADED_LABEL(opcode) case opcode
+#define THREADED_NEXT() break
+#endif
+
+#define THREADED_OP(opcode, handler, cycle)                                       \
+  THREADED_LABEL(opcode) :                                                        \
+  {                                                                               \
+    status = handler(state, &regs);                                               \
+    THREADED_COMPLETE_INSTRUCTION(cycle);                                         \
+    THREADED_FETCH();                                                             \
+    THREADED_NEXT();                                                              \
+  }
 
-  status = write_8(state, addr_mode, data);
-  RETURN_STATUS_IF_NOT_OK(status);
+/**
+ * Settle the cycle count of the instruction just executed. Interrupts that would be serviced,
+ * pending EI, HALT/STOP, and exit requests leave the threaded instructions through the slow path.
+ * With IME set and nothing to service, this mirrors what update_interrupt_state() would do.
+ */
+#define THREADED_COMPLETE_INSTRUCTION(cycle)                                                        \
+  do                                                                                                \
+  {                                                                                                 \
+    if (status != STATUS_OK)                                                                        \
+    {                                                                                               \
+      goto exit_loop;                                                                               \
+    }                                                                                               \
+    if ((cycle) > state->current_inst_m_cycle_count)                                                \
+    {                                                                                               \
+      status = sync_cycles(state, (cycle) - state->current_inst_m_cycle_count);                     \
+      if (status != STATUS_OK)                                                                      \
+      {                                                                                             \
+        goto exit_loop;                                                                             \
+      }                                                                                             \
+    }                                                                                               \
+    regs.f &= 0xF0;                                                                                 \
+    if (interrupt_globally_enabled(&state->interrupt))                                              \
+    {                                                                                               \
+      if (has_serviceable_interrupts(&state->interrupt))                                            \
+      {                                                                                             \
+        goto slow_path;                                                                             \
+      }                                                                                             \
+      state->next_ime_flag = 0;                                                                     \
+    }                                                                                               \
+    if (state->next_ime_flag || state->run_mode != RUN_MODE_NORMAL || state->exit_requested)        \
+    {                                                                                               \
+      goto slow_path;                                                                               \
+    }                                                                                               \
+  } while (0)
+
+#define THREADED_FETCH()                                                          \
+  do                                                                              \
+  {                                                                               \
+    state->current_inst_m_cycle_count = 0;                                        \
+    status = fetch(state, &regs, &opcode);                                        \
+    if (status != STATUS_OK)                                                      \
+    {                                                                             \
+      goto exit_loop;                                                             \
+    }                                                                             \
+  } while (0)
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+status_code_t cpu_run_threaded(cpu_state_t *const state)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(state);
 
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H | FLAG_C, F_CLEAR);
+  status_code_t status = STATUS_OK;
+  registers_t regs = state->registers;
+  uint8_t opcode = 0;
 
-  return STATUS_OK;
-}
+#if CPU_COMPUTED_GOTO
+  static void *const dispatch_table[256] = {
+      CPU_OPCODE_LIST(THREADED_DISPATCH_ENTRY)
+  };
+#endif
 
-static status_code_t op_SRL(cpu_state_t *const state, addressing_mode_t const addr_mode)
-{
-  uint8_t data, lsb;
-  status_code_t status = STATUS_OK;
+  state->exit_requested = 0;
+  goto resume;
+
+slow_path:
+  /**
+   * Interrupt servicing and HALT are handled outside of the threaded instructions.
+   * The interrupt handler works on the register file in the CPU state, so the
+   * local copy is written back while these are handled.
+   */
+  state->registers = regs;
 
-  status = read_8(state, addr_mode, &data);
+  status = update_interrupt_state(state);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  lsb = data & 0x1;
-  data >>= 1;
+resume:
+  while (state->run_mode != RUN_MODE_NORMAL)
+  {
+    if (state->exit_requested || state->run_mode == RUN_MODE_STOPPED)
+    {
+      return STATUS_OK;
+    }
 
-  status = write_8(state, addr_mode, data);
-  RETURN_STATUS_IF_NOT_OK(status);
+    status = cpu_emulation_cycle(state);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
 
-  update_flags(state, FLAG_Z, (data == 0) ? F_SET : F_CLEAR);
-  update_flags(state, FLAG_N | FLAG_H, F_CLEAR);
-  update_flags(state, FLAG_C, lsb ? F_SET : F_CLEAR);
+  if (state->exit_requested)
+  {
+    return STATUS_OK;
+  }
 
-  return STATUS_OK;
-}
+  regs = state->registers;
+  THREADED_FETCH();
 
-static status_code_t op_BIT(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t const bit_index)
-{
-  uint8_t data;
-  status_code_t status = STATUS_OK;
+#if CPU_COMPUTED_GOTO
+  THREADED_NEXT();
+  CPU_OPCODE_LIST(THREADED_OP)
+#else
+  for (;;)
+  {
+    switch (opcode)
+    {
+      CPU_OPCODE_LIST(THREADED_OP)
+    }
+  }
+#endif
 
-  status = read_8(state, addr_mode, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
+exit_loop:
+  state->registers = regs;
+  return status;
+}
 
-  update_flags(state, FLAG_Z, (data & (1 << bit_index)) ? F_CLEAR : F_SET);
-  update_flags(state, FLAG_N, F_CLEAR);
-  update_flags(state, FLAG_H, F_SET);
+#pragma GCC diagnostic pop
 
-  return STATUS_OK;
+void cpu_request_exit(cpu_state_t *const state)
+{
+  if (state)
+  {
+    state->exit_requested = 1;
+  }
 }
 
-static status_code_t op_RES(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t const bit_index)
+status_code_t cpu_run_cycles(cpu_state_t *const state, uint32_t const budget)
 {
-  uint8_t data;
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(state);
+
   status_code_t status = STATUS_OK;
 
-  status = read_8(state, addr_mode, &data);
-  RETURN_STATUS_IF_NOT_OK(status);
+  if (budget == 0)
+  {
+    return STATUS_OK;
+  }
 
-  return write_8(state, addr_mode, (data & ~(1 << bit_index)));
-}
+  state->batched_sync = 1;
+  state->cycle_budget = budget;
 
-static status_code_t op_SET(cpu_state_t *const state, addressing_mode_t const addr_mode, uint8_t const bit_index)
-{
-  uint8_t data;
-  status_code_t status = STATUS_OK;
+  status = cpu_run_threaded(state);
 
-  status = read_8(state, addr_mode, &data);
+  state->batched_sync = 0;
+  state->cycle_budget = 0;
   RETURN_STATUS_IF_NOT_OK(status);
 
-  return write_8(state, addr_mode, (data | (1 << bit_index)));
+  return catch_up_devices(state);
 }
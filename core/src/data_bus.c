@@ -86,6 +86,8 @@ status_code_t data_bus_init(data_bus_handle_t *const bus_handle)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(bus_handle);
 
+  memset(&bus_handle->memory_map, 0, sizeof(memory_map_t));
+
   return bus_interface_init(&bus_handle->bus_interface, data_bus_read, data_bus_write, bus_handle);
 }
 
@@ -111,6 +113,19 @@ static status_code_t data_bus_read(void *const resource, uint16_t const address,
   VERIFY_PTR_RETURN_ERROR_IF_NULL(bus_handle);
   VERIFY_PTR_RETURN_ERROR_IF_NULL(data);
 
+  /** Fast path: plain memory pages are read straight from host memory */
+  uint8_t const *const page = bus_handle->memory_map.read[address >> MEMORY_MAP_PAGE_SHIFT];
+  if (page)
+  {
+    *data = page[address & MEMORY_MAP_PAGE_MASK];
+    return STATUS_OK;
+  }
+  if ((address >= 0xFF80) && (address < 0xFFFF) && bus_handle->memory_map.hram)
+  {
+    *data = bus_handle->memory_map.hram[address - 0xFF80];
+    return STATUS_OK;
+  }
+
   data_bus_segment_t *bus_segment = get_bus_segment(bus_handle, address);
 
   if (bus_segment == NULL || bus_segment->interface.read == NULL)
@@ -128,6 +143,19 @@ static status_code_t data_bus_write(void *const resource, uint16_t const address
 
   VERIFY_PTR_RETURN_ERROR_IF_NULL(bus_handle);
 
+  /** Fast path: plain memory pages are written straight to host memory */
+  uint8_t *const page = bus_handle->memory_map.write[address >> MEMORY_MAP_PAGE_SHIFT];
+  if (page)
+  {
+    page[address & MEMORY_MAP_PAGE_MASK] = data;
+    return STATUS_OK;
+  }
+  if ((address >= 0xFF80) && (address < 0xFFFF) && bus_handle->memory_map.hram)
+  {
+    bus_handle->memory_map.hram[address - 0xFF80] = data;
+    return STATUS_OK;
+  }
+
   data_bus_segment_t *bus_segment = get_bus_segment(bus_handle, address);
 
   if (bus_segment == NULL || bus_segment->interface.write == NULL)
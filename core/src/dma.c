@@ -69,3 +69,28 @@ status_code_t dma_start(dma_handle_t *const handle, uint8_t const offset)
 
   return STATUS_OK;
 }
+
+status_code_t dma_advance(dma_handle_t *const handle, uint32_t const m_cycles)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(handle);
+
+  status_code_t status = STATUS_OK;
+
+  for (uint32_t m = 0; (m < m_cycles) && (handle->state != DMA_IDLE); m++)
+  {
+    status = dma_tick(handle);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  return STATUS_OK;
+}
+
+uint32_t dma_m_cycles_until_event(dma_handle_t const *const handle)
+{
+  if (!handle || (handle->state == DMA_IDLE))
+  {
+    return UINT32_MAX;
+  }
+
+  return 1;
+}
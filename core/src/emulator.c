@@ -1,9 +1,12 @@
 #include "emulator.h"
 
 #include <stdint.h>
+#include <string.h>
 
 #include "cpu.h"
 #include "data_bus.h"
+#include "memory_map.h"
+#include "pixel_kernels.h"
 #include "rom.h"
 #include "ram.h"
 #include "oam.h"
@@ -14,13 +17,34 @@
 #include "ppu.h"
 #include "apu.h"
 #include "timer.h"
+#include "scheduler.h"
+#include "tile_cache.h"
 #include "logging.h"
 #include "bus_interface.h"
 #include "status_code.h"
 #include "callback.h"
 #include "logging.h"
 
+typedef status_code_t (*device_sync_fn)(emulator_t *const emulator, uint64_t const timestamp);
+typedef status_code_t (*device_schedule_fn)(emulator_t *const emulator);
+
 static status_code_t sync_callback_handler(void *const ctx, const void *arg);
+static status_code_t halt_wake_handler(void *const ctx, const void *arg);
+static status_code_t timer_event_handler(void *const ctx, const void *arg);
+static status_code_t ppu_event_handler(void *const ctx, const void *arg);
+static status_code_t dma_event_handler(void *const ctx, const void *arg);
+static status_code_t apu_event_handler(void *const ctx, const void *arg);
+static status_code_t sync_timer(emulator_t *const emulator, uint64_t const timestamp);
+static status_code_t sync_ppu(emulator_t *const emulator, uint64_t const timestamp);
+static status_code_t sync_dma(emulator_t *const emulator, uint64_t const timestamp);
+static status_code_t sync_apu(emulator_t *const emulator, uint64_t const timestamp);
+static status_code_t schedule_timer_event(emulator_t *const emulator);
+static status_code_t schedule_ppu_event(emulator_t *const emulator);
+static status_code_t schedule_dma_event(emulator_t *const emulator);
+static status_code_t schedule_apu_event(emulator_t *const emulator);
+static status_code_t io_bus_read(void *const resource, uint16_t const address, uint8_t *const data);
+static status_code_t io_bus_write(void *const resource, uint16_t const address, uint8_t const data);
+static status_code_t advance_devices(emulator_t *const emulator, uint64_t const target);
 static inline status_code_t module_init(emulator_t *const emulator);
 static inline status_code_t configure_data_bus(emulator_t *const emulator);
 
@@ -31,21 +55,30 @@ status_code_t emulator_init(emulator_t *const emulator)
   status_code_t status = STATUS_OK;
 
   emulator->ram.wram.offset = 0xC000;
-  emulator->ram.vram.offset = 0x8000;
+  emulator->ram.vram.offset = VRAM_ADDR;
   emulator->ram.hram.offset = 0xFF80;
   emulator->ram.bus_interface.offset = 0x0000;
   emulator->ppu.oam.bus_interface.offset = 0xFE00;
   emulator->io.bus_interface.offset = 0xFF00;
+  emulator->io_bus_interface.offset = 0xFF00;
   emulator->cpu_state.interrupt.bus_interface.offset = 0xFF00;
   emulator->state = EMU_MODE_RUNNING;
+  emulator->master_cycles = 0;
+  memset(emulator->device_cycles, 0, sizeof(emulator->device_cycles));
   emulator->prev_frame_count = emulator->ppu.current_frame;
 
+  status = pixel_kernels_init();
+  RETURN_STATUS_IF_NOT_OK(status);
+
   status = module_init(emulator);
   RETURN_STATUS_IF_NOT_OK(status);
 
   status = configure_data_bus(emulator);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  status = emulator_sync_devices(emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   return STATUS_OK;
 }
 
@@ -88,28 +121,350 @@ status_code_t emulator_cleanup(emulator_t *const emulator)
   return mbc_cleanup(&emulator->mbc);
 }
 
+/** How each device is brought up to a master cycle count, and how its next event is scheduled */
+static const struct
+{
+  device_sync_fn sync;
+  device_schedule_fn schedule;
+} device_ops[SCHEDULER_EVENT_COUNT] = {
+    [SCHEDULER_EVENT_TIMER] = {sync_timer, schedule_timer_event},
+    [SCHEDULER_EVENT_PPU] = {sync_ppu, schedule_ppu_event},
+    [SCHEDULER_EVENT_DMA] = {sync_dma, schedule_dma_event},
+    [SCHEDULER_EVENT_APU] = {sync_apu, schedule_apu_event},
+};
+
+status_code_t emulator_sync_devices(emulator_t *const emulator)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(emulator);
+
+  status_code_t status = STATUS_OK;
+
+  for (scheduler_event_t device = 0; device < SCHEDULER_EVENT_COUNT; device++)
+  {
+    status = device_ops[device].sync(emulator, emulator->master_cycles);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    status = device_ops[device].schedule(emulator);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  return STATUS_OK;
+}
+
+/**
+ * Both timing modes drive the devices through the scheduler; they only differ in how often
+ * the CPU hands control back to the devices.
+ */
 static status_code_t sync_callback_handler(void *const ctx, const void *arg)
 {
   emulator_t *const emulator = (emulator_t *)ctx;
   uint8_t const m_cycle_count = *(uint8_t *)arg;
   status_code_t status = STATUS_OK;
 
-  for (uint8_t m = 0; m < m_cycle_count; m++)
+  status = advance_devices(emulator, emulator->master_cycles + (m_cycle_count * 4));
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  /* Hand control back to the frame loop once the PPU has completed a frame */
+  if (emulator->prev_frame_count != emulator->ppu.current_frame)
   {
-    for (uint8_t t = 0; t < 4; t++)
-    {
-      status = timer_tick(&emulator->tmr);
-      RETURN_STATUS_IF_NOT_OK(status);
+    cpu_request_exit(&emulator->cpu_state);
+  }
 
-      status = ppu_tick(&emulator->ppu);
-      RETURN_STATUS_IF_NOT_OK(status);
-    }
+  return STATUS_OK;
+}
+
+/**
+ * Report the number of M-cycles a halted CPU can skip. Only the timer and the PPU raise
+ * interrupts on their own, so nothing can wake the CPU before whichever of their next
+ * events comes first.
+ */
+static status_code_t halt_wake_handler(void *const ctx, const void *arg)
+{
+  emulator_t *const emulator = (emulator_t *)ctx;
+  uint32_t *const m_cycle_count = (uint32_t *)arg;
+  interrupt_registers_t const *const int_regs = &emulator->cpu_state.interrupt.registers;
+
+  if (int_regs->ien & int_regs->irf)
+  {
+    *m_cycle_count = 1;
+    return STATUS_OK;
+  }
+
+  uint64_t wake_timestamp = scheduler_event_timestamp(&emulator->scheduler, SCHEDULER_EVENT_PPU);
+  uint64_t const timer_timestamp = scheduler_event_timestamp(&emulator->scheduler, SCHEDULER_EVENT_TIMER);
+
+  if (timer_timestamp < wake_timestamp)
+  {
+    wake_timestamp = timer_timestamp;
+  }
+
+  uint64_t const ticks = wake_timestamp - emulator->master_cycles;
+
+  /* Round up so the M-cycle in which the event happens is included */
+  *m_cycle_count = (ticks < (UINT32_MAX - 3)) ? ((ticks + 3) >> 2) : (UINT32_MAX >> 2);
+
+  return STATUS_OK;
+}
+
+/**
+ * TIMA overflow: the timer requests its interrupt as it is advanced past the overflow
+ */
+static status_code_t timer_event_handler(void *const ctx, const void *arg)
+{
+  emulator_t *const emulator = (emulator_t *)ctx;
+  uint64_t const timestamp = *(uint64_t *)arg;
+  status_code_t status = STATUS_OK;
+
+  status = sync_timer(emulator, timestamp);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  return schedule_timer_event(emulator);
+}
+
+/**
+ * PPU mode transition or LY change
+ */
+static status_code_t ppu_event_handler(void *const ctx, const void *arg)
+{
+  emulator_t *const emulator = (emulator_t *)ctx;
+  uint64_t const timestamp = *(uint64_t *)arg;
+  status_code_t status = STATUS_OK;
+
+  status = sync_ppu(emulator, timestamp);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  return schedule_ppu_event(emulator);
+}
+
+/**
+ * OAM DMA byte transfer
+ */
+static status_code_t dma_event_handler(void *const ctx, const void *arg)
+{
+  emulator_t *const emulator = (emulator_t *)ctx;
+  uint64_t const timestamp = *(uint64_t *)arg;
+  status_code_t status = STATUS_OK;
+
+  /* The PPU must see OAM as it was up to the M-cycle in which this byte is written */
+  status = sync_ppu(emulator, timestamp);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = sync_dma(emulator, timestamp);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  return schedule_dma_event(emulator);
+}
+
+/**
+ * APU frame sequencer step or channel step
+ */
+static status_code_t apu_event_handler(void *const ctx, const void *arg)
+{
+  emulator_t *const emulator = (emulator_t *)ctx;
+  uint64_t const timestamp = *(uint64_t *)arg;
+  status_code_t status = STATUS_OK;
+
+  status = sync_apu(emulator, timestamp);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  return schedule_apu_event(emulator);
+}
+
+static status_code_t sync_timer(emulator_t *const emulator, uint64_t const timestamp)
+{
+  uint64_t *const device_cycles = &emulator->device_cycles[SCHEDULER_EVENT_TIMER];
+
+  if (timestamp <= *device_cycles)
+  {
+    return STATUS_OK;
+  }
+
+  uint32_t const ticks = timestamp - *device_cycles;
+  *device_cycles = timestamp;
+
+  return timer_advance(&emulator->tmr, ticks);
+}
+
+static status_code_t sync_ppu(emulator_t *const emulator, uint64_t const timestamp)
+{
+  uint64_t *const device_cycles = &emulator->device_cycles[SCHEDULER_EVENT_PPU];
+
+  if (timestamp <= *device_cycles)
+  {
+    return STATUS_OK;
+  }
+
+  uint32_t const ticks = timestamp - *device_cycles;
+  *device_cycles = timestamp;
+
+  return ppu_advance(&emulator->ppu, ticks);
+}
+
+/**
+ * The DMA only acts on M-cycle boundaries, so it is advanced by the number of boundaries crossed
+ */
+static status_code_t sync_dma(emulator_t *const emulator, uint64_t const timestamp)
+{
+  uint64_t *const device_cycles = &emulator->device_cycles[SCHEDULER_EVENT_DMA];
+
+  if (timestamp <= *device_cycles)
+  {
+    return STATUS_OK;
+  }
+
+  uint32_t const m_cycles = (timestamp >> 2) - (*device_cycles >> 2);
+  *device_cycles = timestamp;
 
-    status = dma_tick(&emulator->dma);
+  return dma_advance(&emulator->dma, m_cycles);
+}
+
+/**
+ * The APU is ticked once per M-cycle, and is caught up in short stretches, so its output
+ * is only handed over on frame sequencer steps
+ */
+static status_code_t sync_apu(emulator_t *const emulator, uint64_t const timestamp)
+{
+  uint64_t *const device_cycles = &emulator->device_cycles[SCHEDULER_EVENT_APU];
+
+  if (timestamp <= *device_cycles)
+  {
+    return STATUS_OK;
+  }
+
+  uint32_t const m_cycles = (timestamp >> 2) - (*device_cycles >> 2);
+  *device_cycles = timestamp;
+
+  return apu_catch_up(&emulator->apu, m_cycles);
+}
+
+/**
+ * Each device reports its next event relative to the point it has been advanced to
+ */
+static status_code_t schedule_timer_event(emulator_t *const emulator)
+{
+  uint32_t const ticks = timer_ticks_until_event(&emulator->tmr);
+
+  if (ticks == UINT32_MAX)
+  {
+    return scheduler_cancel(&emulator->scheduler, SCHEDULER_EVENT_TIMER);
+  }
+
+  return scheduler_schedule(&emulator->scheduler, SCHEDULER_EVENT_TIMER, emulator->device_cycles[SCHEDULER_EVENT_TIMER] + ticks);
+}
+
+static status_code_t schedule_ppu_event(emulator_t *const emulator)
+{
+  uint32_t const ticks = ppu_ticks_until_event(&emulator->ppu);
+
+  return scheduler_schedule(&emulator->scheduler, SCHEDULER_EVENT_PPU, emulator->device_cycles[SCHEDULER_EVENT_PPU] + ticks);
+}
+
+static status_code_t schedule_dma_event(emulator_t *const emulator)
+{
+  uint32_t const m_cycles = dma_m_cycles_until_event(&emulator->dma);
+
+  if (m_cycles == UINT32_MAX)
+  {
+    return scheduler_cancel(&emulator->scheduler, SCHEDULER_EVENT_DMA);
+  }
+
+  /** The event lands on the boundary of the M-cycle in which the next byte is transferred */
+  uint64_t const m_cycle_boundary = (emulator->device_cycles[SCHEDULER_EVENT_DMA] >> 2) + m_cycles;
+
+  return scheduler_schedule(&emulator->scheduler, SCHEDULER_EVENT_DMA, m_cycle_boundary << 2);
+}
+
+static status_code_t schedule_apu_event(emulator_t *const emulator)
+{
+  uint64_t const m_cycle_boundary = (emulator->device_cycles[SCHEDULER_EVENT_APU] >> 2) + apu_m_cycles_until_event(&emulator->apu);
+
+  return scheduler_schedule(&emulator->scheduler, SCHEDULER_EVENT_APU, m_cycle_boundary << 2);
+}
+
+/**
+ * Get the device that owns an I/O register, or `SCHEDULER_EVENT_COUNT` if the register
+ * doesn't depend on any device that is advanced by the scheduler
+ */
+static inline scheduler_event_t io_register_device(uint16_t const address)
+{
+  if ((address >= 0x0004) && (address < 0x0008))
+  {
+    return SCHEDULER_EVENT_TIMER;
+  }
+  else if ((address >= 0x0010) && (address < 0x0040))
+  {
+    return SCHEDULER_EVENT_APU;
+  }
+  else if (address == 0x0046)
+  {
+    return SCHEDULER_EVENT_DMA;
+  }
+  else if ((address >= 0x0040) && (address < 0x004C))
+  {
+    return SCHEDULER_EVENT_PPU;
+  }
+
+  return SCHEDULER_EVENT_COUNT;
+}
+
+/**
+ * Bring the device behind an I/O register up to date before the CPU reads it
+ */
+static status_code_t io_bus_read(void *const resource, uint16_t const address, uint8_t *const data)
+{
+  emulator_t *const emulator = (emulator_t *)resource;
+  scheduler_event_t const device = io_register_device(address);
+  status_code_t status = STATUS_OK;
+
+  if (device != SCHEDULER_EVENT_COUNT)
+  {
+    status = device_ops[device].sync(emulator, emulator->master_cycles);
     RETURN_STATUS_IF_NOT_OK(status);
   }
 
-  return status;
+  return bus_interface_read(&emulator->io.bus_interface, address + emulator->io.bus_interface.offset, data);
+}
+
+/**
+ * Bring the device behind an I/O register up to date before the CPU writes it, then
+ * reschedule the device since the write may have moved its next event
+ */
+static status_code_t io_bus_write(void *const resource, uint16_t const address, uint8_t const data)
+{
+  emulator_t *const emulator = (emulator_t *)resource;
+  scheduler_event_t const device = io_register_device(address);
+  status_code_t status = STATUS_OK;
+
+  if (device == SCHEDULER_EVENT_COUNT)
+  {
+    return bus_interface_write(&emulator->io.bus_interface, address + emulator->io.bus_interface.offset, data);
+  }
+
+  status = device_ops[device].sync(emulator, emulator->master_cycles);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = bus_interface_write(&emulator->io.bus_interface, address + emulator->io.bus_interface.offset, data);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  return device_ops[device].schedule(emulator);
+}
+
+/**
+ * Advance the emulation to the target master cycle count. Each device is only advanced when
+ * one of its events fires, or when the CPU accesses its registers. The PPU is the exception:
+ * it renders from VRAM and OAM, which the CPU may be about to access, so it is always brought
+ * up to the target.
+ */
+static status_code_t advance_devices(emulator_t *const emulator, uint64_t const target)
+{
+  status_code_t status = STATUS_OK;
+
+  emulator->master_cycles = target;
+
+  status = scheduler_run_until(&emulator->scheduler, target);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  return sync_ppu(emulator, target);
 }
 
 status_code_t emulator_run_frame(emulator_t *const emulator)
@@ -118,7 +473,18 @@ status_code_t emulator_run_frame(emulator_t *const emulator)
 
   while(emulator->prev_frame_count == emulator->ppu.current_frame)
   {
-    status = cpu_emulation_cycle(&emulator->cpu_state);
+    if (emulator->timing_mode == TIMING_MODE_BATCHED)
+    {
+      status = cpu_run_cycles(&emulator->cpu_state, EMULATOR_BATCH_M_CYCLES);
+    }
+    else if (emulator->cpu_exec_mode == CPU_EXEC_MODE_THREADED)
+    {
+      status = cpu_run_threaded(&emulator->cpu_state);
+    }
+    else
+    {
+      status = cpu_emulation_cycle(&emulator->cpu_state);
+    }
     RETURN_STATUS_IF_NOT_OK(status);
 
     if (emulator->cpu_state.run_mode == RUN_MODE_STOPPED)
@@ -138,6 +504,7 @@ static inline status_code_t module_init(emulator_t *const emulator)
   cpu_init_param_t cpu_init_params = {
       .bus_interface = &emulator->bus_handle.bus_interface,
       .cycle_sync_callback = &emulator->cycle_sync_callback,
+      .halt_wake_callback = &emulator->halt_wake_callback,
   };
 
   io_init_param_t io_init_params = {
@@ -152,6 +519,8 @@ static inline status_code_t module_init(emulator_t *const emulator)
   ppu_init_param_t ppu_init_params = {
       .bus_interface = &emulator->bus_handle.bus_interface,
       .interrupt = &emulator->cpu_state.interrupt,
+      .tile_cache = &emulator->ram.tile_cache,
+      .vram = emulator->ram.vram.buf,
   };
 
   status = data_bus_init(&emulator->bus_handle);
@@ -187,6 +556,33 @@ static inline status_code_t module_init(emulator_t *const emulator)
   status = callback_init(&emulator->cycle_sync_callback, sync_callback_handler, (void *)emulator);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  status = callback_init(&emulator->halt_wake_callback, halt_wake_handler, (void *)emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = scheduler_init(&emulator->scheduler);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = callback_init(&emulator->device_event_callbacks[SCHEDULER_EVENT_TIMER], timer_event_handler, (void *)emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = callback_init(&emulator->device_event_callbacks[SCHEDULER_EVENT_PPU], ppu_event_handler, (void *)emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = callback_init(&emulator->device_event_callbacks[SCHEDULER_EVENT_DMA], dma_event_handler, (void *)emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = callback_init(&emulator->device_event_callbacks[SCHEDULER_EVENT_APU], apu_event_handler, (void *)emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  for (scheduler_event_t event = 0; event < SCHEDULER_EVENT_COUNT; event++)
+  {
+    status = scheduler_register_handler(&emulator->scheduler, event, &emulator->device_event_callbacks[event]);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  status = bus_interface_init(&emulator->io_bus_interface, io_bus_read, io_bus_write, (void *)emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   return STATUS_OK;
 }
 
@@ -215,11 +611,22 @@ static inline status_code_t configure_data_bus(emulator_t *const emulator)
   status = data_bus_add_segment(&emulator->bus_handle, SEGMENT_TYPE_HRAM, emulator->ram.bus_interface);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = data_bus_add_segment(&emulator->bus_handle, SEGMENT_TYPE_IO_REG, emulator->io.bus_interface);
+  status = data_bus_add_segment(&emulator->bus_handle, SEGMENT_TYPE_IO_REG, emulator->io_bus_interface);
   RETURN_STATUS_IF_NOT_OK(status);
 
   status = data_bus_add_segment(&emulator->bus_handle, SEGMENT_TYPE_IE_REG, emulator->cpu_state.interrupt.bus_interface);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  /** Plain RAM regions bypass the segment handlers; the MBC keeps the cartridge pages pointed at its active banks */
+  memory_map_t *const memory_map = &emulator->bus_handle.memory_map;
+  memory_map_set_pages(memory_map, emulator->ram.vram.offset, VRAM_SIZE, emulator->ram.vram.buf, emulator->ram.vram.buf);
+  /** Writes to VRAM tile data go through the RAM handler to keep the tile cache up to date */
+  memory_map_set_pages(memory_map, emulator->ram.vram.offset, TILE_CACHE_TILE_DATA_SIZE, emulator->ram.vram.buf, NULL);
+  memory_map_set_pages(memory_map, emulator->ram.wram.offset, WRAM_SIZE, emulator->ram.wram.buf, emulator->ram.wram.buf);
+  memory_map->hram = emulator->ram.hram.buf;
+
+  status = mbc_attach_memory_map(&emulator->mbc, memory_map);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   return STATUS_OK;
 }
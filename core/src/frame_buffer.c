@@ -0,0 +1,129 @@
+#include "frame_buffer.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "callback.h"
+#include "status_code.h"
+
+#define FRAME_BUFFER_FRESH (0x80)
+#define FRAME_BUFFER_INDEX_MASK (0x03)
+#define FNV_OFFSET_BASIS (0xCBF29CE484222325ULL)
+#define FNV_PRIME (0x100000001B3ULL)
+#define HASH_FOLD_SHIFT (29)
+
+static inline bool line_changed(frame_t const *const frame, uint64_t const *const line_hashes, uint16_t const line);
+
+status_code_t frame_buffer_init(frame_buffer_t *const frame_buffer)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(frame_buffer);
+
+  memset(frame_buffer->frames, 0, sizeof(frame_buffer->frames));
+  memset(&frame_buffer->frame_ready_callback, 0, sizeof(callback_t));
+  frame_buffer->back = 0;
+  frame_buffer->front = 1;
+  atomic_store(&frame_buffer->latest, 2);
+
+  return STATUS_OK;
+}
+
+status_code_t frame_buffer_register_ready_callback(frame_buffer_t *const frame_buffer, callback_t *const frame_ready_callback)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(frame_buffer);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(frame_ready_callback);
+  VERIFY_PTR_RETURN_STATUS_IF_NULL(frame_ready_callback->callback_fn, STATUS_ERR_NOT_INITIALIZED);
+
+  memcpy(&frame_buffer->frame_ready_callback, frame_ready_callback, sizeof(callback_t));
+
+  return STATUS_OK;
+}
+
+status_code_t frame_buffer_publish(frame_buffer_t *const frame_buffer)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(frame_buffer);
+
+  /** Release ordering makes the frame contents visible to the consumer before the index is */
+  uint8_t const previous = atomic_exchange_explicit(&frame_buffer->latest, frame_buffer->back | FRAME_BUFFER_FRESH, memory_order_acq_rel);
+  frame_buffer->back = previous & FRAME_BUFFER_INDEX_MASK;
+
+  if (frame_buffer->frame_ready_callback.callback_fn)
+  {
+    return callback_call(&frame_buffer->frame_ready_callback, frame_buffer);
+  }
+
+  return STATUS_OK;
+}
+
+status_code_t frame_buffer_hash_line(frame_buffer_t *const frame_buffer, uint8_t const line_y)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(frame_buffer);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(line_y >= SCREEN_HEIGHT, STATUS_ERR_INVALID_ARG);
+
+  frame_t *const frame = &frame_buffer->frames[frame_buffer->back];
+  uint8_t const *const pixels = frame->video_buffer.matrix[line_y];
+  uint64_t hash = FNV_OFFSET_BASIS;
+
+  /**
+   * FNV-1a over 8 pixels at a time rather than bytes; the line was just written, so it's still in cache.
+   * The multiply only carries bits upwards, so the high bits are folded back down before each word, or
+   * changes to the last pixel of different words could cancel each other out.
+   */
+  for (uint16_t x = 0; x < SCREEN_WIDTH; x += sizeof(uint64_t))
+  {
+    uint64_t word;
+    memcpy(&word, &pixels[x], sizeof(uint64_t));
+    hash ^= hash >> HASH_FOLD_SHIFT;
+    hash = (hash ^ word) * FNV_PRIME;
+  }
+
+  frame->line_hashes[line_y] = hash;
+
+  return STATUS_OK;
+}
+
+frame_t const *frame_buffer_acquire(frame_buffer_t *const frame_buffer)
+{
+  if ((frame_buffer == NULL) || !(atomic_load_explicit(&frame_buffer->latest, memory_order_relaxed) & FRAME_BUFFER_FRESH))
+  {
+    return NULL;
+  }
+
+  /** Only the consumer clears the fresh flag, so the exchange is guaranteed to get a fresh frame */
+  uint8_t const latest = atomic_exchange_explicit(&frame_buffer->latest, frame_buffer->front, memory_order_acq_rel);
+  frame_buffer->front = latest & FRAME_BUFFER_INDEX_MASK;
+
+  return &frame_buffer->frames[frame_buffer->front];
+}
+
+status_code_t frame_buffer_find_changed_lines(frame_t const *const frame, uint64_t const *const line_hashes, uint16_t const start_line,
+                                              uint16_t *const first_line, uint16_t *const line_count)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(frame);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(first_line);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(line_count);
+
+  uint16_t line = start_line;
+
+  while ((line < SCREEN_HEIGHT) && !line_changed(frame, line_hashes, line))
+  {
+    line++;
+  }
+
+  *first_line = line;
+
+  while ((line < SCREEN_HEIGHT) && line_changed(frame, line_hashes, line))
+  {
+    line++;
+  }
+
+  *line_count = line - *first_line;
+
+  return STATUS_OK;
+}
+
+static inline bool line_changed(frame_t const *const frame, uint64_t const *const line_hashes, uint16_t const line)
+{
+  return (line_hashes == NULL) || (frame->line_hashes[line] != line_hashes[line]);
+}
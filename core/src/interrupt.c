@@ -10,6 +10,9 @@
 #define REG_IEN_OFFSET (0xFF)
 #define REG_IRF_OFFSET (0x0F)
 
+/* Interrupt sources that can be serviced */
+#define INTERRUPT_MASK (INT_VBLANK | INT_LCD | INT_TIMER | INT_SERIAL | INT_JOYPAD)
+
 static interrupt_vector_t interrupt_vector_table[] = {
     {.address = 0x0040, .int_type = INT_VBLANK},
     {.address = 0x0048, .int_type = INT_LCD},
@@ -40,6 +43,11 @@ bool has_pending_interrupts(interrupt_handle_t *const interrupt)
   return (interrupt && interrupt->registers.irf);
 }
 
+bool has_serviceable_interrupts(interrupt_handle_t *const interrupt)
+{
+  return (interrupt && (interrupt->registers.ien & interrupt->registers.irf & INTERRUPT_MASK));
+}
+
 bool interrupt_globally_enabled(interrupt_handle_t *const interrupt)
 {
   return (interrupt && interrupt->registers.ime);
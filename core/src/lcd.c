@@ -8,6 +8,7 @@
 
 static status_code_t lcd_read(void *const resource, uint16_t const address, uint8_t *const data);
 static status_code_t lcd_write(void *const resource, uint16_t const address, uint8_t const data);
+static void build_palette(lcd_handle_t *const handle, palette_type_t const palette_type, uint8_t const palette);
 
 static const color_rgba_t default_palette_colors[4] = {
     {.r = 0xE0, .g = 0xFD, .b = 0xD0, .a = 0xFF},
@@ -32,6 +33,8 @@ status_code_t lcd_init(lcd_handle_t *const handle)
   handle->registers.window_x = 0x00;
   handle->registers.window_y = 0x00;
 
+  lcd_update_palettes(handle);
+
   return bus_interface_init(&handle->bus_interface, lcd_read, lcd_write, handle);
 }
 
@@ -41,24 +44,33 @@ status_code_t lcd_get_palette_color(lcd_handle_t *const handle, palette_type_t c
   VERIFY_PTR_RETURN_ERROR_IF_NULL(color);
   VERIFY_COND_RETURN_STATUS_IF_TRUE(color_index > 0x3, STATUS_ERR_INVALID_ARG);
 
-  uint8_t palette;
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(palette_type > PALETTE_OBJ_1, STATUS_ERR_INVALID_ARG);
+
+  color->as_hex = default_palette_colors[lcd_palette_pixel(handle, palette_type, color_index) & LCD_PIXEL_SHADE_MASK].as_hex;
+
+  return STATUS_OK;
+}
+
+status_code_t lcd_get_pixel_colors(uint32_t *const colors)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(colors);
 
-  switch (palette_type)
+  /** All of the palettes share the same shades */
+  for (uint8_t pixel = 0; pixel < LCD_NUM_PIXEL_VALUES; pixel++)
   {
-  case PALETTE_BGW:
-    palette = handle->registers.bg_palette;
-    break;
-  case PALETTE_OBJ_0:
-    palette = handle->registers.obj_palette_0;
-    break;
-  case PALETTE_OBJ_1:
-    palette = handle->registers.obj_palette_1;
-    break;
-  default:
-    return STATUS_ERR_INVALID_ARG;
+    colors[pixel] = default_palette_colors[pixel & LCD_PIXEL_SHADE_MASK].as_hex;
   }
 
-  color->as_hex = default_palette_colors[(palette >> (color_index * 2)) & 0x3].as_hex;
+  return STATUS_OK;
+}
+
+status_code_t lcd_update_palettes(lcd_handle_t *const handle)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(handle);
+
+  build_palette(handle, PALETTE_BGW, handle->registers.bg_palette);
+  build_palette(handle, PALETTE_OBJ_0, handle->registers.obj_palette_0);
+  build_palette(handle, PALETTE_OBJ_1, handle->registers.obj_palette_1);
 
   return STATUS_OK;
 }
@@ -135,6 +147,14 @@ static status_code_t lcd_write(void *const resource, uint16_t const address, uin
   {
     handle->registers.buffer[address] = (handle->registers.buffer[address] & 0x07) | (data & ~0x07);
   }
+  else if (address >= 0x0007 && address <= 0x0009) /* BGP, OBP-0, OBP-1 */
+  {
+    if (handle->registers.buffer[address] != data)
+    {
+      handle->registers.buffer[address] = data;
+      build_palette(handle, (palette_type_t)(PALETTE_BGW + (address - 0x0007)), data);
+    }
+  }
   else if (address != 0x0004) /* LY is read only */
   {
     handle->registers.buffer[address] = data;
@@ -142,3 +162,11 @@ static status_code_t lcd_write(void *const resource, uint16_t const address, uin
 
   return STATUS_OK;
 }
+
+static void build_palette(lcd_handle_t *const handle, palette_type_t const palette_type, uint8_t const palette)
+{
+  for (uint8_t index = 0; index < LCD_COLORS_PER_PALETTE; index++)
+  {
+    handle->palette_pixels[palette_type][index] = (palette_type << LCD_PIXEL_PALETTE_SHIFT) | ((palette >> (index * 2)) & LCD_PIXEL_SHADE_MASK);
+  }
+}
@@ -8,6 +8,7 @@
 #include "logging.h"
 #include "bus_interface.h"
 #include "callback.h"
+#include "memory_map.h"
 #include "rom.h"
 #include "rtc.h"
 #include "status_code.h"
@@ -29,7 +30,10 @@ static status_code_t mbc_3_write(void *const resource, uint16_t address, uint8_t
 static status_code_t mbc_5_write(void *const resource, uint16_t address, uint8_t const data);
 
 static inline status_code_t mbc_switch_ext_ram_bank(mbc_handle_t *const mbc, uint8_t ram_bank_num, bool save_game);
-static inline status_code_t mbc_switch_rom_bank(mbc_handle_t *const mbc, uint8_t rom_bank_num);
+static inline status_code_t mbc_switch_rom_bank(mbc_handle_t *const mbc, uint16_t rom_bank_num);
+static inline void mbc_enable_ext_ram(mbc_handle_t *const mbc, bool const enabled);
+static void mbc_map_rom(mbc_handle_t *const mbc);
+static void mbc_map_ext_ram(mbc_handle_t *const mbc);
 static inline void mbc_set_flag(mbc_handle_t *const mbc, mbc_flags_t const flags);
 static inline void mbc_clear_flag(mbc_handle_t *const mbc, mbc_flags_t const flags);
 
@@ -110,6 +114,8 @@ status_code_t mbc_load_rom(mbc_handle_t *const mbc, uint8_t *const rom_data, con
   status = mbc_switch_rom_bank(mbc, 1);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  mbc_map_ext_ram(mbc);
+
   status = mbc_load_saved_game(mbc);
   RETURN_STATUS_IF_NOT_OK(status);
 
@@ -127,12 +133,31 @@ status_code_t mbc_register_callbacks(mbc_handle_t *const mbc, mbc_callbacks_t *c
   return STATUS_OK;
 }
 
+status_code_t mbc_attach_memory_map(mbc_handle_t *const mbc, memory_map_t *const memory_map)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(mbc);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(memory_map);
+
+  mbc->memory_map = memory_map;
+
+  mbc_map_rom(mbc);
+  mbc_map_ext_ram(mbc);
+
+  return STATUS_OK;
+}
+
 status_code_t mbc_cleanup(mbc_handle_t *const mbc)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(mbc);
 
   mbc_save_game(mbc);
 
+  if (mbc->memory_map)
+  {
+    memory_map_set_pages(mbc->memory_map, 0x0000, 0x8000, NULL, NULL);
+    memory_map_set_pages(mbc->memory_map, 0xA000, 0x2000, NULL, NULL);
+  }
+
   free(mbc->ext_ram.data);
   mbc->ext_ram.data = NULL;
 
@@ -238,20 +263,66 @@ static inline status_code_t mbc_switch_ext_ram_bank(mbc_handle_t *const mbc, uin
 
   mbc->ext_ram.active_bank_num = ram_bank_num;
   mbc->ext_ram.active_bank = &(mbc->ext_ram.data[0x2000 * mbc->ext_ram.active_bank_num]);
+  mbc_map_ext_ram(mbc);
 
   return STATUS_OK;
 }
 
-static inline status_code_t mbc_switch_rom_bank(mbc_handle_t *const mbc, uint8_t rom_bank_num)
+static inline status_code_t mbc_switch_rom_bank(mbc_handle_t *const mbc, uint16_t rom_bank_num)
 {
   VERIFY_COND_RETURN_STATUS_IF_TRUE(rom_bank_num >= mbc->rom.num_banks, STATUS_ERR_INVALID_ARG);
 
   mbc->rom.active_bank_num = rom_bank_num;
   mbc->rom.active_switchable_bank = &(mbc->rom.content.data[0x4000 * mbc->rom.active_bank_num]);
+  mbc_map_rom(mbc);
 
   return STATUS_OK;
 }
 
+static inline void mbc_enable_ext_ram(mbc_handle_t *const mbc, bool const enabled)
+{
+  mbc->ext_ram.enabled = enabled;
+  mbc_map_ext_ram(mbc);
+}
+
+/**
+ * Repoint the ROM pages of the attached memory map to the active banks.
+ * ROM writes are bank controller commands, so the write pages are always left to the bus handlers.
+ */
+static void mbc_map_rom(mbc_handle_t *const mbc)
+{
+  if (!mbc->memory_map || !mbc->rom.content.data || !mbc->rom.active_switchable_bank)
+  {
+    return;
+  }
+
+  memory_map_set_pages(mbc->memory_map, 0x0000, 0x4000, mbc->rom.content.data, NULL);
+  memory_map_set_pages(mbc->memory_map, 0x4000, 0x4000, mbc->rom.active_switchable_bank, NULL);
+}
+
+/**
+ * Repoint the external RAM pages of the attached memory map.
+ * The pages are only mapped directly while the RAM is enabled and not shadowed by the RTC registers.
+ * With a battery present, writes stay on the bus handlers until the first one marks the save data dirty.
+ */
+static void mbc_map_ext_ram(mbc_handle_t *const mbc)
+{
+  if (!mbc->memory_map)
+  {
+    return;
+  }
+
+  bool const readable = mbc->ext_ram.enabled && mbc->ext_ram.active_bank && !(mbc->flags & MBC_FLAGS_ACCESS_MODE_RTC);
+  bool const writable = readable && (!mbc->batt.present || mbc->batt.has_unsaved_data);
+
+  memory_map_set_pages(
+      mbc->memory_map,
+      0xA000,
+      0x2000,
+      readable ? mbc->ext_ram.active_bank : NULL,
+      writable ? mbc->ext_ram.active_bank : NULL);
+}
+
 status_code_t mbc_load_saved_game(mbc_handle_t *const mbc)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(mbc);
@@ -300,6 +371,8 @@ status_code_t mbc_reload_banks(mbc_handle_t *const mbc)
   status = mbc_switch_rom_bank(mbc, mbc->rom.active_bank_num);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  mbc_map_ext_ram(mbc);
+
   return STATUS_OK;
 }
 
@@ -370,7 +443,7 @@ static status_code_t mbc_1_write(void *const resource, uint16_t address, uint8_t
   if (address < 0x2000)
   {
     /** 0x0000 - 0x1FFF: RAM enable (Write only) */
-    mbc->ext_ram.enabled = ((data & 0x0F) == 0xA);
+    mbc_enable_ext_ram(mbc, (data & 0x0F) == 0xA);
   }
   else if ((address >= 0x2000) && (address < 0x4000))
   {
@@ -429,7 +502,7 @@ static status_code_t mbc_2_write(void *const resource, uint16_t address, uint8_t
     }
     else
     {
-      mbc->ext_ram.enabled = ((data & 0x0F) == 0xA);
+      mbc_enable_ext_ram(mbc, (data & 0x0F) == 0xA);
     }
   }
   return STATUS_OK;
@@ -444,7 +517,7 @@ static status_code_t mbc_3_write(void *const resource, uint16_t address, uint8_t
   if (address < 0x2000)
   {
     /** 0x0000 - 0x1FFF: RAM and timer enable (Write only) */
-    mbc->ext_ram.enabled = ((data & 0x0F) == 0xA);
+    mbc_enable_ext_ram(mbc, (data & 0x0F) == 0xA);
 
     status = rtc_enable(&mbc->rtc, (data & 0x0F) == 0xA);
     RETURN_STATUS_IF_NOT_OK(status);
@@ -472,6 +545,7 @@ static status_code_t mbc_3_write(void *const resource, uint16_t address, uint8_t
       RETURN_STATUS_IF_NOT_OK(status);
 
       mbc_clear_flag(mbc, MBC_FLAGS_ACCESS_MODE_RTC);
+      mbc_map_ext_ram(mbc);
     }
     else if ((data >= 0x08) && (data <= 0x0C) && rtc_is_present(&mbc->rtc))
     {
@@ -479,6 +553,7 @@ static status_code_t mbc_3_write(void *const resource, uint16_t address, uint8_t
       RETURN_STATUS_IF_NOT_OK(status);
 
       mbc_set_flag(mbc, MBC_FLAGS_ACCESS_MODE_RTC);
+      mbc_map_ext_ram(mbc);
     }
   }
   else if ((address >= 0x6000) && (address < 0x8000) && rtc_is_present(&mbc->rtc))
@@ -504,7 +579,7 @@ static status_code_t mbc_5_write(void *const resource, uint16_t address, uint8_t
   if (address < 0x2000)
   {
     /** 0x0000 - 0x1FFF: RAM enable (Write only) */
-    mbc->ext_ram.enabled = ((data & 0x0F) == 0xA);
+    mbc_enable_ext_ram(mbc, (data & 0x0F) == 0xA);
   }
   else if ((address >= 0x2000) && (address < 0x3000))
   {
@@ -556,9 +631,10 @@ static status_code_t mbc_ext_ram_write(void *const resource, uint16_t address, u
 
   mbc->ext_ram.active_bank[address] = data;
 
-  if (mbc->batt.present)
+  if (mbc->batt.present && !mbc->batt.has_unsaved_data)
   {
     mbc->batt.has_unsaved_data = true;
+    mbc_map_ext_ram(mbc);
   }
 
   return STATUS_OK;
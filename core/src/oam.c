@@ -3,21 +3,16 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdbool.h>
-#include <stdlib.h>
 
 #include "bus_interface.h"
 #include "status_code.h"
 
-typedef struct
-{
-  oam_entry_t entry;
-  uint8_t index;
-} indexed_oam_entry_t;
-
 static status_code_t oam_read(void *const resource, uint16_t const address, uint8_t *const data);
 static status_code_t oam_write(void *const resource, uint16_t const address, uint8_t const data);
-static inline bool scanline_intersects_sprite(oam_entry_t *oam_entry, uint8_t line_y, obj_size_t obj_size);
-static int sort_compare(const void *value_1, const void *value_2);
+static void build_scan_index(oam_handle_t *const oam_handle, obj_size_t const sprite_size);
+static uint8_t collect_line_sprites(oam_handle_t *const oam_handle, uint8_t const line_y, obj_size_t const sprite_size, uint8_t *const indices);
+static void sort_by_x_pos(oam_entry_t const *const entries, uint8_t *const indices, uint8_t const count);
+static inline bool scanline_intersects_sprite(oam_entry_t const *oam_entry, uint8_t line_y, obj_size_t obj_size);
 
 /**
  * TODO: Disable OAM read/write by the CPU during DMA transfer
@@ -30,6 +25,7 @@ status_code_t oam_init(oam_handle_t *const oam_handle)
   VERIFY_PTR_RETURN_ERROR_IF_NULL(oam_handle);
 
   memset(oam_handle->entries, 0, sizeof(oam_handle->entries));
+  oam_handle->scan_index.dirty = true;
 
   return bus_interface_init(&oam_handle->bus_interface, oam_read, oam_write, oam_handle);
 }
@@ -40,41 +36,46 @@ status_code_t oam_scan(oam_handle_t *const oam_handle, uint8_t const line_y, obj
   VERIFY_PTR_RETURN_ERROR_IF_NULL(scan_results);
   VERIFY_COND_RETURN_STATUS_IF_TRUE((sprite_size != OBJ_SIZE_LARGE) && (sprite_size != OBJ_SIZE_SMALL), STATUS_ERR_INVALID_ARG);
 
-  uint8_t index = 0;
-  uint8_t entry_count = 0;
-  indexed_oam_entry_t entries[10];
+  oam_scan_index_t *const scan_index = &oam_handle->scan_index;
+  uint8_t full_scan_indices[MAX_SPRITES_PER_LINE];
+  uint8_t const *indices = full_scan_indices;
+  uint8_t count = 0;
 
-  memset(scan_results, 0, sizeof(oam_scanned_sprites_t));
-
-  // Scan until the end of OAM is reached or 10 sprites have been collected
-  while ((index < OAM_ENTRY_SIZE) && (entry_count < MAX_SPRITES_PER_LINE))
+  if ((line_y == 0) && (scan_index->dirty || (scan_index->sprite_size != sprite_size)))
   {
-    oam_entry_t *const oam_entry = &oam_handle->entries[index++];
+    build_scan_index(oam_handle, sprite_size);
+  }
 
-    if (scanline_intersects_sprite(oam_entry, line_y, sprite_size))
-    {
-      entries[entry_count].entry = *oam_entry;
-      entries[entry_count].index = entry_count;
-      entry_count++;
-    }
+  if (!scan_index->dirty && (scan_index->sprite_size == sprite_size) && (line_y < OAM_INDEXED_LINES))
+  {
+    indices = scan_index->sprite_index[line_y];
+    count = scan_index->sprite_count[line_y];
+  }
+  else
+  {
+    /** OAM or the sprite size has changed since the start of the frame */
+    count = collect_line_sprites(oam_handle, line_y, sprite_size, full_scan_indices);
   }
 
-  /**
-   * Sort the sprites based on their X coordinate in ascending order,
-   * and then based on their index in ascending order if the entries
-   * have the same X coordinate.
-   */
-  qsort(entries, entry_count, sizeof(indexed_oam_entry_t), sort_compare);
+  memset(scan_results, 0, sizeof(oam_scanned_sprites_t));
 
-  // Copy the sorted entries to the scan results
-  for (uint8_t i = 0; i < entry_count; i++)
+  for (uint8_t i = 0; i < count; i++)
   {
-    scan_results->sprite_attributes[scan_results->sprite_count++] = entries[i].entry;
+    scan_results->sprite_attributes[scan_results->sprite_count++] = oam_handle->entries[indices[i]];
   }
 
   return STATUS_OK;
 }
 
+status_code_t oam_invalidate_scan_index(oam_handle_t *const oam_handle)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(oam_handle);
+
+  oam_handle->scan_index.dirty = true;
+
+  return STATUS_OK;
+}
+
 static status_code_t oam_read(void *const resource, uint16_t const address, uint8_t *const data)
 {
   oam_handle_t *const oam_handle = (oam_handle_t *)resource;
@@ -94,25 +95,87 @@ static status_code_t oam_write(void *const resource, uint16_t const address, uin
   VERIFY_PTR_RETURN_ERROR_IF_NULL(oam_handle);
   VERIFY_COND_RETURN_STATUS_IF_TRUE(address >= sizeof(oam_handle->entries), STATUS_ERR_ADDRESS_OUT_OF_BOUND);
 
-  oam_handle->oam_buf[address] = data;
+  if (oam_handle->oam_buf[address] != data)
+  {
+    oam_handle->oam_buf[address] = data;
+    oam_handle->scan_index.dirty = true;
+  }
 
   return STATUS_OK;
 }
 
-static inline bool scanline_intersects_sprite(oam_entry_t *oam_entry, uint8_t line_y, obj_size_t sprite_size)
+static void build_scan_index(oam_handle_t *const oam_handle, obj_size_t const sprite_size)
 {
-  return (((oam_entry->y_pos <= (line_y + 16)) && (oam_entry->y_pos + sprite_size) > (line_y + 16)) && (oam_entry->x_pos != 0));
+  oam_scan_index_t *const scan_index = &oam_handle->scan_index;
+
+  memset(scan_index->sprite_count, 0, sizeof(scan_index->sprite_count));
+
+  // Going through OAM in order, add each sprite to the scanlines it intersects that have fewer than 10 sprites
+  for (uint8_t index = 0; index < OAM_ENTRY_SIZE; index++)
+  {
+    oam_entry_t const *const oam_entry = &oam_handle->entries[index];
+    int16_t const first_line = oam_entry->y_pos - 16;
+
+    for (int16_t line_y = (first_line < 0 ? 0 : first_line); (line_y < first_line + (int16_t)sprite_size) && (line_y < OAM_INDEXED_LINES); line_y++)
+    {
+      if (scanline_intersects_sprite(oam_entry, line_y, sprite_size) && (scan_index->sprite_count[line_y] < MAX_SPRITES_PER_LINE))
+      {
+        scan_index->sprite_index[line_y][scan_index->sprite_count[line_y]++] = index;
+      }
+    }
+  }
+
+  for (uint8_t line_y = 0; line_y < OAM_INDEXED_LINES; line_y++)
+  {
+    sort_by_x_pos(oam_handle->entries, scan_index->sprite_index[line_y], scan_index->sprite_count[line_y]);
+  }
+
+  scan_index->sprite_size = sprite_size;
+  scan_index->dirty = false;
+}
+
+static uint8_t collect_line_sprites(oam_handle_t *const oam_handle, uint8_t const line_y, obj_size_t const sprite_size, uint8_t *const indices)
+{
+  uint8_t index = 0;
+  uint8_t count = 0;
+
+  // Scan until the end of OAM is reached or 10 sprites have been collected
+  while ((index < OAM_ENTRY_SIZE) && (count < MAX_SPRITES_PER_LINE))
+  {
+    if (scanline_intersects_sprite(&oam_handle->entries[index], line_y, sprite_size))
+    {
+      indices[count++] = index;
+    }
+    index++;
+  }
+
+  sort_by_x_pos(oam_handle->entries, indices, count);
+
+  return count;
 }
 
-static int sort_compare(const void *value_1, const void *value_2)
+/**
+ * Sort the sprites based on their X coordinate in ascending order. This is a stable sort, so sprites
+ * with the same X coordinate stay in ascending OAM index order.
+ */
+static void sort_by_x_pos(oam_entry_t const *const entries, uint8_t *const indices, uint8_t const count)
 {
-  uint8_t const x_pos_1 = ((indexed_oam_entry_t *)value_1)->entry.x_pos;
-  uint8_t const x_pos_2 = ((indexed_oam_entry_t *)value_2)->entry.x_pos;
-  uint8_t const index_1 = ((indexed_oam_entry_t *)value_1)->index;
-  uint8_t const index_2 = ((indexed_oam_entry_t *)value_2)->index;
+  for (uint8_t i = 1; i < count; i++)
+  {
+    uint8_t const index = indices[i];
+    uint8_t j = i;
 
-  int const index_ordering = (index_1 > index_2) - (index_1 < index_2);
-  int const x_pos_ordering = (x_pos_1 > x_pos_2) - (x_pos_1 < x_pos_2);
+    while ((j > 0) && (entries[indices[j - 1]].x_pos > entries[index].x_pos))
+    {
+      indices[j] = indices[j - 1];
+      j--;
+    }
 
-  return (x_pos_1 == x_pos_2) ? index_ordering : x_pos_ordering;
+    indices[j] = index;
+  }
+}
+
+static inline bool scanline_intersects_sprite(oam_entry_t const *oam_entry, uint8_t line_y, obj_size_t sprite_size)
+{
+  return (((oam_entry->y_pos <= (line_y + 16)) && (oam_entry->y_pos + sprite_size) > (line_y + 16)) && (oam_entry->x_pos != 0));
 }
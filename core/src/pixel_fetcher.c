@@ -6,8 +6,11 @@
 
 #include "lcd.h"
 #include "oam.h"
+#include "pixel_kernels.h"
 #include "bus_interface.h"
+#include "ram.h"
 #include "status_code.h"
+#include "tile_cache.h"
 
 #define VERIFY_CTX_RETURN_STATUS_IF_ERROR(ctx)                                    \
   {                                                                               \
@@ -18,12 +21,11 @@
   }
 
 static status_code_t fetch_bgw_tile_num(pixel_fetcher_context_t *const ctx);
-static status_code_t fetch_sprite_tile_num(pixel_fetcher_context_t *const ctx);
 static status_code_t fetch_bgw_tile_data(pixel_fetcher_context_t *const ctx, uint8_t const offset);
-static status_code_t fetch_sprite_tile_data(pixel_fetcher_context_t *const ctx, uint8_t const offset);
+static status_code_t fetch_sprite_tile_row(pixel_fetcher_context_t *const ctx, oam_entry_t const *const sprite, uint8_t *const pixels);
 
+static inline status_code_t read_vram(pixel_fetcher_context_t *const ctx, uint16_t const address, uint8_t *const data);
 static inline bool window_is_in_view(lcd_handle_t *lcd_handle, pixel_fetcher_state_t *fetcher_state);
-static inline bool sprite_is_in_view(oam_entry_t *oam_entry, lcd_handle_t *lcd_handle, pixel_fetcher_state_t *fetcher_state);
 static inline uint16_t background_tile_num_address(pixel_fetcher_context_t *const ctx);
 static inline uint16_t window_tile_num_address(pixel_fetcher_context_t *const ctx);
 static inline uint16_t background_tile_data_address(pixel_fetcher_context_t *const ctx);
@@ -50,9 +52,6 @@ status_code_t fetch_tile_number(pixel_fetcher_context_t *const ctx)
     RETURN_STATUS_IF_NOT_OK(status);
   }
 
-  status = fetch_sprite_tile_num(ctx);
-  RETURN_STATUS_IF_NOT_OK(status);
-
   ctx->fetcher_state->fetcher_x_index++;
 
   return STATUS_OK;
@@ -62,45 +61,56 @@ status_code_t fetch_tile_data(pixel_fetcher_context_t *const ctx, uint8_t const
 {
   VERIFY_CTX_RETURN_STATUS_IF_ERROR(ctx);
 
-  status_code_t status = STATUS_OK;
+  return fetch_bgw_tile_data(ctx, offset);
+}
 
-  status = fetch_bgw_tile_data(ctx, offset);
-  RETURN_STATUS_IF_NOT_OK(status);
+status_code_t fetch_sprite_row(pixel_fetcher_context_t *const ctx)
+{
+  VERIFY_CTX_RETURN_STATUS_IF_ERROR(ctx);
 
-  status = fetch_sprite_tile_data(ctx, offset);
-  RETURN_STATUS_IF_NOT_OK(status);
+  status_code_t status = STATUS_OK;
+  pixel_fetcher_state_t *const fetcher_state = ctx->fetcher_state;
+  oam_scanned_sprites_t const *const sprites = &fetcher_state->oam_scanned_sprites;
 
-  return STATUS_OK;
-}
+  memset(fetcher_state->sprite_row, 0, sizeof(fetcher_state->sprite_row));
 
-uint8_t bgw_pixel_color_index(fetched_bgw_tile_t *const bgw_tile, uint8_t index)
-{
-  if (bgw_tile == NULL)
+  for (uint8_t i = 0; i < sprites->sprite_count; i++)
   {
-    return 0;
+    oam_entry_t const *const sprite = &sprites->sprite_attributes[i];
+    uint8_t pixels[TILE_CACHE_TILE_SIZE];
+
+    status = fetch_sprite_tile_row(ctx, sprite, pixels);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    for (uint8_t px = 0; px < TILE_CACHE_TILE_SIZE; px++)
+    {
+      int16_t const x = (sprite->x_pos - 8) + px;
+
+      /** Transparent pixels let the sprites behind them show through; opaque ones hide them */
+      if ((x < 0) || (x >= SCREEN_WIDTH) || !pixels[px] || fetcher_state->sprite_row[x].pixel_color)
+      {
+        continue;
+      }
+
+      fetcher_state->sprite_row[x] = (sprite_row_pixel_t){
+          .pixel_color = pixels[px],
+          .palette = (sprite->attrs & OAM_ATTR_DMG_PALETTE_NUM) ? PALETTE_OBJ_1 : PALETTE_OBJ_0,
+          .bg_priority = sprite->attrs & OAM_ATTR_BG_PRIORITY,
+      };
+    }
   }
-  uint8_t msb = ((bgw_tile->tile_data_high << index) >> 7) & 0x1;
-  uint8_t lsb = ((bgw_tile->tile_data_low << index) >> 7) & 0x1;
 
-  return (msb << 1) | lsb;
+  return STATUS_OK;
 }
 
-uint8_t sprite_pixel_color_index(fetched_sprite_tile_t *const sprite_tile, uint8_t index)
+uint8_t bgw_pixel_color_index(fetched_bgw_tile_t *const bgw_tile, uint8_t index)
 {
-  if (sprite_tile == 0)
+  if (bgw_tile == NULL)
   {
     return 0;
   }
 
-  if (sprite_tile->tile_entry.attrs & OAM_ATTR_X_FLIP)
-  {
-    index = 7 - index;
-  }
-
-  uint8_t msb = ((sprite_tile->tile_data_high << index) >> 7) & 0x1;
-  uint8_t lsb = ((sprite_tile->tile_data_low << index) >> 7) & 0x1;
-
-  return (msb << 1) | lsb;
+  return bgw_tile->pixels[index];
 }
 
 static status_code_t fetch_bgw_tile_num(pixel_fetcher_context_t *const ctx)
@@ -111,7 +121,7 @@ static status_code_t fetch_bgw_tile_num(pixel_fetcher_context_t *const ctx)
 
   uint16_t address = window_is_in_view(lcd_handle, fetcher_state) ? window_tile_num_address(ctx) : background_tile_num_address(ctx);
 
-  status = bus_interface_read(ctx->bus_interface, address, &fetcher_state->bgw_tile_data.tile_num);
+  status = read_vram(ctx, address, &fetcher_state->bgw_tile_data.tile_num);
   RETURN_STATUS_IF_NOT_OK(status);
 
   if (lcd_ctrl_bgw_tile_data_address(lcd_handle) == 0x8800)
@@ -122,82 +132,89 @@ static status_code_t fetch_bgw_tile_num(pixel_fetcher_context_t *const ctx)
   return STATUS_OK;
 }
 
-static status_code_t fetch_sprite_tile_num(pixel_fetcher_context_t *const ctx)
+static status_code_t fetch_bgw_tile_data(pixel_fetcher_context_t *const ctx, uint8_t const offset)
 {
+  status_code_t status = STATUS_OK;
   lcd_handle_t *const lcd_handle = ctx->lcd_handle;
   pixel_fetcher_state_t *const fetcher_state = ctx->fetcher_state;
 
-  fetcher_state->fetched_sprite_count = 0;
-  if (!(lcd_handle->registers.lcd_ctrl & LCD_CTRL_OBJ_EN))
+  fetched_bgw_tile_t *const bgw_tile = &fetcher_state->bgw_tile_data;
+  uint8_t *const target = !!offset ? &bgw_tile->tile_data_high : &bgw_tile->tile_data_low;
+
+  uint16_t address = window_is_in_view(lcd_handle, fetcher_state) ? window_tile_data_address(ctx) : background_tile_data_address(ctx);
+
+  /** With a tile cache, the whole decoded row is looked up once both bytes would have been fetched */
+  if (ctx->tile_cache)
   {
+    if (offset)
+    {
+      memcpy(bgw_tile->pixels, tile_cache_row_at(ctx->tile_cache, address, false), sizeof(bgw_tile->pixels));
+    }
     return STATUS_OK;
   }
 
-  uint8_t index = 0;
+  status = read_vram(ctx, (address + !!offset), target);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-  while ((index < fetcher_state->oam_scanned_sprites.sprite_count) && (fetcher_state->fetched_sprite_count < MAX_FETCHED_SPRITES))
+  if (offset)
   {
-    oam_entry_t *entry = &fetcher_state->oam_scanned_sprites.sprite_attributes[index++];
-
-    if (sprite_is_in_view(entry, lcd_handle, fetcher_state))
-    {
-      fetcher_state->sprite_tile_data[fetcher_state->fetched_sprite_count++].tile_entry = *entry;
-    }
+    pixel_kernels_decode_tile_row(bgw_tile->tile_data_low, bgw_tile->tile_data_high, false, bgw_tile->pixels);
   }
 
   return STATUS_OK;
 }
 
-static status_code_t fetch_bgw_tile_data(pixel_fetcher_context_t *const ctx, uint8_t const offset)
+static status_code_t fetch_sprite_tile_row(pixel_fetcher_context_t *const ctx, oam_entry_t const *const sprite, uint8_t *const pixels)
 {
   status_code_t status = STATUS_OK;
   lcd_handle_t *const lcd_handle = ctx->lcd_handle;
-  pixel_fetcher_state_t *const fetcher_state = ctx->fetcher_state;
-
-  uint8_t *const target = !!offset ? &fetcher_state->bgw_tile_data.tile_data_high : &fetcher_state->bgw_tile_data.tile_data_low;
 
-  uint16_t address = window_is_in_view(lcd_handle, fetcher_state) ? window_tile_data_address(ctx) : background_tile_data_address(ctx);
-
-  status = bus_interface_read(ctx->bus_interface, (address + !!offset), target);
-  RETURN_STATUS_IF_NOT_OK(status);
+  uint8_t sprite_height = lcd_ctrl_obj_size(lcd_handle);
+  uint8_t tile_index = sprite->tile;
+  uint8_t tile_y = ((lcd_handle->registers.ly + 16) - sprite->y_pos) * 2;
+  bool const x_flip = !!(sprite->attrs & OAM_ATTR_X_FLIP);
+  uint8_t data_low, data_high;
 
-  return STATUS_OK;
-}
+  // Check if the sprite is vertically flipped
+  if (sprite->attrs & OAM_ATTR_Y_FLIP)
+  {
+    tile_y = ((sprite_height * 2) - 2) - tile_y;
+  }
 
-static status_code_t fetch_sprite_tile_data(pixel_fetcher_context_t *const ctx, uint8_t const offset)
-{
-  status_code_t status = STATUS_OK;
-  lcd_handle_t *const lcd_handle = ctx->lcd_handle;
-  pixel_fetcher_state_t *const fetcher_state = ctx->fetcher_state;
+  if (sprite_height == 16)
+  {
+    tile_index &= ~0x1;
+  }
 
-  uint8_t sprite_height = lcd_ctrl_obj_size(lcd_handle);
+  uint16_t address = 0x8000 + (tile_index * 16) + tile_y;
 
-  for (uint8_t i = 0; i < fetcher_state->fetched_sprite_count; i++)
+  if (ctx->tile_cache)
   {
-    fetched_sprite_tile_t *current_sprite = &fetcher_state->sprite_tile_data[i];
+    memcpy(pixels, tile_cache_row_at(ctx->tile_cache, address, x_flip), TILE_CACHE_TILE_SIZE);
+    return STATUS_OK;
+  }
 
-    uint8_t tile_index = current_sprite->tile_entry.tile;
-    uint8_t tile_y = ((lcd_handle->registers.ly + 16) - current_sprite->tile_entry.y_pos) * 2;
+  status = read_vram(ctx, address, &data_low);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-    // Check if the sprite is vertically flipped
-    if (current_sprite->tile_entry.attrs & OAM_ATTR_Y_FLIP)
-    {
-      tile_y = ((sprite_height * 2) - 2) - tile_y;
-    }
+  status = read_vram(ctx, address + 1, &data_high);
+  RETURN_STATUS_IF_NOT_OK(status);
 
-    if (sprite_height == 16)
-    {
-      tile_index &= ~0x1;
-    }
+  pixel_kernels_decode_tile_row(data_low, data_high, x_flip, pixels);
 
-    uint8_t *const target = !!offset ? &current_sprite->tile_data_high : &current_sprite->tile_data_low;
+  return STATUS_OK;
+}
 
-    uint16_t address = 0x8000 + (tile_index * 16) + tile_y + !!offset;
-    status = bus_interface_read(ctx->bus_interface, address, target);
-    RETURN_STATUS_IF_NOT_OK(status);
+/** `address` is always within VRAM, as the fetcher only computes tile map and tile data addresses */
+static inline status_code_t read_vram(pixel_fetcher_context_t *const ctx, uint16_t const address, uint8_t *const data)
+{
+  if (ctx->vram)
+  {
+    *data = ctx->vram[address - VRAM_ADDR];
+    return STATUS_OK;
   }
 
-  return STATUS_OK;
+  return bus_interface_read(ctx->bus_interface, address, data);
 }
 
 static inline bool window_is_in_view(lcd_handle_t *lcd_handle, pixel_fetcher_state_t *fetcher_state)
@@ -215,19 +232,6 @@ static inline bool window_is_in_view(lcd_handle_t *lcd_handle, pixel_fetcher_sta
   return ((line_x >= wx) && (line_x < wx + SCREEN_WIDTH + 14) && (line_y >= wy) && (line_y < wy + SCREEN_HEIGHT));
 }
 
-static inline bool sprite_is_in_view(oam_entry_t *oam_entry, lcd_handle_t *lcd_handle, pixel_fetcher_state_t *fetcher_state)
-{
-  if (!oam_entry || !lcd_handle || !fetcher_state)
-  {
-    return false;
-  }
-
-  int16_t line_x = fetcher_state->fetcher_x_index * 8;
-  int16_t sprite_x = (oam_entry->x_pos - 8) + (lcd_handle->registers.scroll_x % 8);
-
-  return ((sprite_x >= line_x && sprite_x < line_x + 8) || ((sprite_x + 8) >= line_x && (sprite_x + 8) < line_x + 8));
-}
-
 static inline uint16_t background_tile_num_address(pixel_fetcher_context_t *const ctx)
 {
   lcd_handle_t *const lcd_handle = ctx->lcd_handle;
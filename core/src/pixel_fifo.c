@@ -4,7 +4,6 @@
 #include <string.h>
 #include <stdbool.h>
 
-#include "ring_buf.h"
 #include "bus_interface.h"
 #include "pixel_fetcher.h"
 #include "status_code.h"
@@ -24,12 +23,12 @@ status_code_t pxfifo_init(pxfifo_handle_t *const pxfifo, pxfifo_init_param_t *co
   VERIFY_PTR_RETURN_STATUS_IF_NULL(param->bus_interface, STATUS_ERR_INVALID_ARG);
   VERIFY_PTR_RETURN_STATUS_IF_NULL(param->lcd, STATUS_ERR_INVALID_ARG);
 
-  VERIFY_COND_RETURN_STATUS_IF_TRUE(
-      !INIT_RING_BUFFER(pxfifo->bg_fifo.buffer, pxfifo->bg_fifo.storage),
-      STATUS_ERR_GENERIC);
+  pxfifo_buffer_flush(&pxfifo->bg_fifo);
 
   pxfifo->fifo_state = PXFIFO_GET_TILE_NUM;
   pxfifo->lcd = param->lcd;
+  pxfifo->tile_cache = param->tile_cache;
+  pxfifo->vram = param->vram;
   memset(&pxfifo->counters, 0, sizeof(pxfifo_counter_t));
   memcpy(&pxfifo->bus_interface, param->bus_interface, sizeof(bus_interface_t));
 
@@ -41,12 +40,24 @@ status_code_t pxfifo_reset(pxfifo_handle_t *const pxfifo)
   VERIFY_PTR_RETURN_ERROR_IF_NULL(pxfifo);
 
   status_code_t status = STATUS_OK;
+  pixel_fetcher_context_t fetcher_ctx = (pixel_fetcher_context_t){
+      .fetcher_state = &pxfifo->pixel_fetcher,
+      .bus_interface = &pxfifo->bus_interface,
+      .vram = pxfifo->vram,
+      .lcd_handle = pxfifo->lcd,
+      .tile_cache = pxfifo->tile_cache,
+  };
+
   status = pixel_fetcher_reset(&pxfifo->pixel_fetcher);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  /** The OAM scan has just completed, so the sprites for the whole line are known */
+  status = fetch_sprite_row(&fetcher_ctx);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   memset(&pxfifo->counters, 0, sizeof(pxfifo_counter_t));
   pxfifo->fifo_state = PXFIFO_GET_TILE_NUM;
-  ring_buffer_flush(&pxfifo->bg_fifo.buffer);
+  pxfifo_buffer_flush(&pxfifo->bg_fifo);
 
   return STATUS_OK;
 }
@@ -75,7 +86,9 @@ static status_code_t pxfifo_shift_in(pxfifo_handle_t *const pxfifo)
   pixel_fetcher_context_t fetcher_ctx = (pixel_fetcher_context_t){
       .fetcher_state = &pxfifo->pixel_fetcher,
       .bus_interface = &pxfifo->bus_interface,
+      .vram = pxfifo->vram,
       .lcd_handle = pxfifo->lcd,
+      .tile_cache = pxfifo->tile_cache,
   };
 
   switch (pxfifo->fifo_state)
@@ -130,26 +143,19 @@ static status_code_t pxfifo_shift_out(pxfifo_handle_t *const pxfifo, pixel_data_
   VERIFY_PTR_RETURN_ERROR_IF_NULL(pxfifo);
   VERIFY_PTR_RETURN_ERROR_IF_NULL(pixel_out);
 
-  pxfifo_item_t fifo_item;
-  status_code_t status = STATUS_OK;
-
   pixel_out->data_valid = 0;
 
-  if (ring_buffer_size(&pxfifo->bg_fifo.buffer) <= 8)
+  if (pxfifo->bg_fifo.size <= 8)
   {
     return STATUS_OK;
   }
 
-  if (!ring_buffer_read(&pxfifo->bg_fifo.buffer, &fifo_item))
-  {
-    return STATUS_ERR_GENERIC;
-  }
+  pxfifo_item_t const fifo_item = pxfifo_buffer_pop(&pxfifo->bg_fifo);
 
   if (pxfifo->counters.popped_px >= (pxfifo->lcd->registers.scroll_x % 8) || on_a_window(pxfifo->lcd, pxfifo->counters.popped_px))
   {
-    status = lcd_get_palette_color(pxfifo->lcd, fifo_item.palette, fifo_item.pixel_color, &pixel_out->color);
-    RETURN_STATUS_IF_NOT_OK(status);
-
+    /* Looked up per pixel so that palette writes in the middle of a line take effect from the next pixel */
+    pixel_out->pixel = lcd_palette_pixel(pxfifo->lcd, fifo_item.palette, fifo_item.pixel_color);
     pixel_out->screen_x = pxfifo->counters.render_px;
     pixel_out->screen_y = pxfifo->lcd->registers.ly;
     pixel_out->data_valid = 1;
@@ -167,36 +173,20 @@ static status_code_t pxfifo_mix_sprite_pixel(pxfifo_handle_t *const pxfifo, pxfi
   VERIFY_PTR_RETURN_ERROR_IF_NULL(pxfifo);
   VERIFY_PTR_RETURN_ERROR_IF_NULL(bgw_pixel);
 
-  pixel_fetcher_state_t *const fetcher_state = &pxfifo->pixel_fetcher;
+  int16_t const screen_x = pxfifo->counters.pushed_px - (pxfifo->lcd->registers.scroll_x % 8);
 
-  for (uint8_t i = 0; i < fetcher_state->fetched_sprite_count; i++)
+  if (screen_x < 0 || screen_x >= SCREEN_WIDTH)
   {
-    fetched_sprite_tile_t *const current_sprite = &fetcher_state->sprite_tile_data[i];
-
-    int16_t sprite_x = (current_sprite->tile_entry.x_pos - 8) + (pxfifo->lcd->registers.scroll_x % 8);
-
-    if (sprite_x + 8 < pxfifo->counters.pushed_px)
-    {
-      continue;
-    }
-
-    int16_t offset = pxfifo->counters.pushed_px - sprite_x;
-
-    if (offset < 0 || offset > 7)
-    {
-      continue;
-    }
+    return STATUS_OK;
+  }
 
-    uint8_t sprite_pixel_color = sprite_pixel_color_index(current_sprite, offset);
-    uint8_t bg_priority = current_sprite->tile_entry.attrs & OAM_ATTR_BG_PRIORITY;
+  sprite_row_pixel_t const *const sprite_pixel = &pxfifo->pixel_fetcher.sprite_row[screen_x];
 
-    if (sprite_pixel_color && (!bg_priority || bgw_pixel->pixel_color == 0))
-    {
-      // Sprite is not transparent and the background does not have priority or is transparent
-      bgw_pixel->palette = (current_sprite->tile_entry.attrs & OAM_ATTR_DMG_PALETTE_NUM) ? PALETTE_OBJ_1 : PALETTE_OBJ_0;
-      bgw_pixel->pixel_color = sprite_pixel_color;
-      break;
-    }
+  if (sprite_pixel->pixel_color && (!sprite_pixel->bg_priority || bgw_pixel->pixel_color == 0))
+  {
+    // Sprite is not transparent and the background does not have priority or is transparent
+    bgw_pixel->palette = sprite_pixel->palette;
+    bgw_pixel->pixel_color = sprite_pixel->pixel_color;
   }
 
   return STATUS_OK;
@@ -204,7 +194,7 @@ static status_code_t pxfifo_mix_sprite_pixel(pxfifo_handle_t *const pxfifo, pxfi
 
 static status_code_t handle_pxfifo_push_data(pxfifo_handle_t *const pxfifo)
 {
-  if (ring_buffer_size(&pxfifo->bg_fifo.buffer) > 8)
+  if (pxfifo->bg_fifo.size > 8)
   {
     return STATUS_OK;
   }
@@ -224,8 +214,6 @@ static status_code_t handle_pxfifo_push_data(pxfifo_handle_t *const pxfifo)
   {
     pxfifo_item_t fifo_item = {
         .pixel_color = bgw_pixel_color_index(&pxfifo->pixel_fetcher.bgw_tile_data, i),
-        .obj_priority = 0,
-        .bg_priority = 0,
         .palette = PALETTE_BGW,
     };
 
@@ -241,7 +229,7 @@ static status_code_t handle_pxfifo_push_data(pxfifo_handle_t *const pxfifo)
       RETURN_STATUS_IF_NOT_OK(status);
     }
 
-    ring_buffer_write(&pxfifo->bg_fifo.buffer, &fifo_item);
+    pxfifo_buffer_push(&pxfifo->bg_fifo, fifo_item);
     pxfifo->counters.pushed_px++;
   }
 
@@ -0,0 +1,264 @@
+#include "pixel_kernels.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "status_code.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PIXEL_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+#define PIXELS_PER_ROW (8)
+#define COLORS_PER_PALETTE (4)
+#define PIXEL_VALUE_MASK (0xF)
+
+typedef void (*decode_tile_row_fn)(uint8_t const data_low, uint8_t const data_high, bool const x_flip, uint8_t *const pixels);
+typedef void (*map_palette_fn)(uint8_t const *const indices, uint8_t const *const palette, uint8_t *const pixels, uint16_t const count);
+typedef void (*expand_pixels_fn)(uint8_t const *const pixels, uint32_t const *const colors, uint32_t *const rgba, uint16_t const count);
+
+static void decode_tile_row_scalar(uint8_t const data_low, uint8_t const data_high, bool const x_flip, uint8_t *const pixels);
+static void map_palette_scalar(uint8_t const *const indices, uint8_t const *const palette, uint8_t *const pixels, uint16_t const count);
+static void expand_pixels_scalar(uint8_t const *const pixels, uint32_t const *const colors, uint32_t *const rgba, uint16_t const count);
+
+#ifdef PIXEL_KERNELS_X86
+static bool isa_supported(pixel_kernels_isa_t const isa);
+static void decode_tile_row_sse2(uint8_t const data_low, uint8_t const data_high, bool const x_flip, uint8_t *const pixels);
+static void map_palette_sse2(uint8_t const *const indices, uint8_t const *const palette, uint8_t *const pixels, uint16_t const count);
+static void decode_tile_row_bmi2(uint8_t const data_low, uint8_t const data_high, bool const x_flip, uint8_t *const pixels);
+static void map_palette_avx2(uint8_t const *const indices, uint8_t const *const palette, uint8_t *const pixels, uint16_t const count);
+static void expand_pixels_avx2(uint8_t const *const pixels, uint32_t const *const colors, uint32_t *const rgba, uint16_t const count);
+#endif
+
+static pixel_kernels_isa_t active_isa = PIXEL_KERNELS_ISA_SCALAR;
+static decode_tile_row_fn decode_tile_row = decode_tile_row_scalar;
+static map_palette_fn map_palette = map_palette_scalar;
+static expand_pixels_fn expand_pixels = expand_pixels_scalar;
+
+status_code_t pixel_kernels_init(void)
+{
+  if (pixel_kernels_select(PIXEL_KERNELS_ISA_AVX2) == STATUS_OK)
+  {
+    return STATUS_OK;
+  }
+
+  if (pixel_kernels_select(PIXEL_KERNELS_ISA_SSE2) == STATUS_OK)
+  {
+    return STATUS_OK;
+  }
+
+  return pixel_kernels_select(PIXEL_KERNELS_ISA_SCALAR);
+}
+
+status_code_t pixel_kernels_select(pixel_kernels_isa_t const isa)
+{
+  switch (isa)
+  {
+  case PIXEL_KERNELS_ISA_SCALAR:
+    decode_tile_row = decode_tile_row_scalar;
+    map_palette = map_palette_scalar;
+    expand_pixels = expand_pixels_scalar;
+    break;
+#ifdef PIXEL_KERNELS_X86
+  case PIXEL_KERNELS_ISA_SSE2:
+    VERIFY_COND_RETURN_STATUS_IF_TRUE(!isa_supported(isa), STATUS_ERR_UNSUPPORTED);
+    decode_tile_row = decode_tile_row_sse2;
+    map_palette = map_palette_sse2;
+    /** A 16-color lookup needs variable permutes, which SSE2 doesn't have */
+    expand_pixels = expand_pixels_scalar;
+    break;
+  case PIXEL_KERNELS_ISA_AVX2:
+    VERIFY_COND_RETURN_STATUS_IF_TRUE(!isa_supported(isa), STATUS_ERR_UNSUPPORTED);
+    decode_tile_row = decode_tile_row_bmi2;
+    map_palette = map_palette_avx2;
+    expand_pixels = expand_pixels_avx2;
+    break;
+#endif
+  default:
+    return STATUS_ERR_UNSUPPORTED;
+  }
+
+  active_isa = isa;
+
+  return STATUS_OK;
+}
+
+pixel_kernels_isa_t pixel_kernels_isa(void)
+{
+  return active_isa;
+}
+
+void pixel_kernels_decode_tile_row(uint8_t const data_low, uint8_t const data_high, bool const x_flip, uint8_t *const pixels)
+{
+  decode_tile_row(data_low, data_high, x_flip, pixels);
+}
+
+void pixel_kernels_map_palette(uint8_t const *const indices, uint8_t const *const palette, uint8_t *const pixels, uint16_t const count)
+{
+  map_palette(indices, palette, pixels, count);
+}
+
+void pixel_kernels_expand_pixels(uint8_t const *const pixels, uint32_t const *const colors, uint32_t *const rgba, uint16_t const count)
+{
+  expand_pixels(pixels, colors, rgba, count);
+}
+
+static void decode_tile_row_scalar(uint8_t const data_low, uint8_t const data_high, bool const x_flip, uint8_t *const pixels)
+{
+  for (uint8_t px = 0; px < PIXELS_PER_ROW; px++)
+  {
+    uint8_t const bit = x_flip ? px : (7 - px);
+    uint8_t const lsb = (data_low >> bit) & 0x1;
+    uint8_t const msb = (data_high >> bit) & 0x1;
+
+    pixels[px] = (msb << 1) | lsb;
+  }
+}
+
+static void map_palette_scalar(uint8_t const *const indices, uint8_t const *const palette, uint8_t *const pixels, uint16_t const count)
+{
+  for (uint16_t i = 0; i < count; i++)
+  {
+    pixels[i] = palette[indices[i] & 0x3];
+  }
+}
+
+static void expand_pixels_scalar(uint8_t const *const pixels, uint32_t const *const colors, uint32_t *const rgba, uint16_t const count)
+{
+  for (uint16_t i = 0; i < count; i++)
+  {
+    rgba[i] = colors[pixels[i] & PIXEL_VALUE_MASK];
+  }
+}
+
+#ifdef PIXEL_KERNELS_X86
+
+static bool isa_supported(pixel_kernels_isa_t const isa)
+{
+  __builtin_cpu_init();
+
+  switch (isa)
+  {
+  case PIXEL_KERNELS_ISA_SSE2:
+    return __builtin_cpu_supports("sse2");
+  case PIXEL_KERNELS_ISA_AVX2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+  default:
+    return false;
+  }
+}
+
+/**
+ * Broadcast the low bit plane to the lower 8 bytes and the high bit plane to the upper 8 bytes,
+ * then test one bit per byte, leftmost pixel (bit 7) first unless the row is flipped.
+ */
+__attribute__((target("sse2"))) static void decode_tile_row_sse2(uint8_t const data_low, uint8_t const data_high, bool const x_flip, uint8_t *const pixels)
+{
+  __m128i const bit_masks = x_flip
+                                ? _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80)
+                                : _mm_setr_epi8((char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+  __m128i const plane_values = _mm_setr_epi8(1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2);
+
+  __m128i planes = _mm_unpacklo_epi64(_mm_set1_epi8((char)data_low), _mm_set1_epi8((char)data_high));
+  planes = _mm_cmpeq_epi8(_mm_and_si128(planes, bit_masks), bit_masks);
+  planes = _mm_and_si128(planes, plane_values);
+  planes = _mm_or_si128(planes, _mm_srli_si128(planes, 8));
+
+  _mm_storel_epi64((__m128i *)pixels, planes);
+}
+
+/**
+ * Pick between the palette entries with the bits of the indices as masks, 16 pixels at a time:
+ * bit 0 selects between entries 0 / 1 and 2 / 3, then bit 1 selects between the two results.
+ */
+__attribute__((target("sse2"))) static void map_palette_sse2(uint8_t const *const indices, uint8_t const *const palette, uint8_t *const pixels, uint16_t const count)
+{
+  __m128i const bit_0 = _mm_set1_epi8(0x1);
+  __m128i const bit_1 = _mm_set1_epi8(0x2);
+  __m128i palette_entries[COLORS_PER_PALETTE];
+  uint16_t i = 0;
+
+  for (uint8_t c = 0; c < COLORS_PER_PALETTE; c++)
+  {
+    palette_entries[c] = _mm_set1_epi8((char)palette[c]);
+  }
+
+  for (; (i + 16) <= count; i += 16)
+  {
+    __m128i const idx = _mm_loadu_si128((__m128i const *)&indices[i]);
+    __m128i const mask_0 = _mm_cmpeq_epi8(_mm_and_si128(idx, bit_0), bit_0);
+    __m128i const mask_1 = _mm_cmpeq_epi8(_mm_and_si128(idx, bit_1), bit_1);
+
+    __m128i const low = _mm_xor_si128(palette_entries[0], _mm_and_si128(_mm_xor_si128(palette_entries[0], palette_entries[1]), mask_0));
+    __m128i const high = _mm_xor_si128(palette_entries[2], _mm_and_si128(_mm_xor_si128(palette_entries[2], palette_entries[3]), mask_0));
+
+    _mm_storeu_si128((__m128i *)&pixels[i], _mm_xor_si128(low, _mm_and_si128(_mm_xor_si128(low, high), mask_1)));
+  }
+
+  map_palette_scalar(&indices[i], palette, &pixels[i], count - i);
+}
+
+/**
+ * PDEP deposits bit N of a bit plane into byte N. Byte 0 holds the rightmost pixel (bit 0),
+ * so the bytes are swapped around unless the row is flipped.
+ */
+__attribute__((target("bmi2"))) static void decode_tile_row_bmi2(uint8_t const data_low, uint8_t const data_high, bool const x_flip, uint8_t *const pixels)
+{
+  uint64_t row = _pdep_u64(data_low, 0x0101010101010101ULL) | _pdep_u64(data_high, 0x0202020202020202ULL);
+
+  if (!x_flip)
+  {
+    row = __builtin_bswap64(row);
+  }
+
+  memcpy(pixels, &row, PIXELS_PER_ROW);
+}
+
+/** Shuffle the palette entries with the indices, 32 pixels at a time */
+__attribute__((target("avx2"))) static void map_palette_avx2(uint8_t const *const indices, uint8_t const *const palette, uint8_t *const pixels, uint16_t const count)
+{
+  uint32_t palette_entries;
+  uint16_t i = 0;
+
+  memcpy(&palette_entries, palette, COLORS_PER_PALETTE);
+
+  /** The shuffle stays within each 128-bit lane, so each lane gets a copy of the palette */
+  __m256i const table = _mm256_set1_epi32((int)palette_entries);
+  __m256i const index_mask = _mm256_set1_epi8(0x3);
+
+  for (; (i + 32) <= count; i += 32)
+  {
+    __m256i const idx = _mm256_and_si256(_mm256_loadu_si256((__m256i const *)&indices[i]), index_mask);
+
+    _mm256_storeu_si256((__m256i *)&pixels[i], _mm256_shuffle_epi8(table, idx));
+  }
+
+  map_palette_scalar(&indices[i], palette, &pixels[i], count - i);
+}
+
+/**
+ * Widen 8 pixels at a time to 32 bits and use bits 0-2 to permute both halves of the color table,
+ * then pick between the two results with bit 3, moved up to the sign bit for the blend.
+ */
+__attribute__((target("avx2"))) static void expand_pixels_avx2(uint8_t const *const pixels, uint32_t const *const colors, uint32_t *const rgba, uint16_t const count)
+{
+  __m256i const colors_low = _mm256_loadu_si256((__m256i const *)&colors[0]);
+  __m256i const colors_high = _mm256_loadu_si256((__m256i const *)&colors[8]);
+  uint16_t i = 0;
+
+  for (; (i + 8) <= count; i += 8)
+  {
+    __m256i const idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *)&pixels[i]));
+    __m256 const low = _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(colors_low, idx));
+    __m256 const high = _mm256_castsi256_ps(_mm256_permutevar8x32_epi32(colors_high, idx));
+    __m256 const mask = _mm256_castsi256_ps(_mm256_slli_epi32(idx, 28));
+
+    _mm256_storeu_si256((__m256i *)&rgba[i], _mm256_castps_si256(_mm256_blendv_ps(low, high, mask)));
+  }
+
+  expand_pixels_scalar(&pixels[i], colors, &rgba[i], count - i);
+}
+
+#endif /* PIXEL_KERNELS_X86 */
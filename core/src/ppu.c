@@ -6,23 +6,32 @@
 
 #include "bus_interface.h"
 #include "callback.h"
+#include "frame_buffer.h"
 #include "oam.h"
 #include "lcd.h"
 #include "interrupt.h"
 #include "pixel_fifo.h"
 #include "pixel_fetcher.h"
+#include "scanline_renderer.h"
 #include "logging.h"
 #include "status_code.h"
 
 #define OAM_SCAN_DURATION_TICKS (80)
+#define SCANLINE_XFER_END_TICKS (OAM_SCAN_DURATION_TICKS + 172)
 #define LINES_PER_FRAME (154)
 #define TICKS_PER_LINE (456)
+#define TICKS_PER_FRAME (LINES_PER_FRAME * TICKS_PER_LINE)
 
 static inline status_code_t fps_sync(ppu_handle_t *const ppu);
+static inline status_code_t notify_vram_block(ppu_handle_t *const ppu, bool const blocked);
 static status_code_t lcd_set_mode(ppu_handle_t *const ppu, lcd_mode_t mode);
 static status_code_t lyc_interrupt_check(ppu_handle_t *const ppu);
 static status_code_t increment_ly(ppu_handle_t *const ppu);
 static status_code_t reset_ly(ppu_handle_t *const ppu);
+static status_code_t ppu_step(ppu_handle_t *const ppu);
+static status_code_t advance_lcd_off(ppu_handle_t *const ppu, uint32_t const ticks);
+static status_code_t restart_lcd(ppu_handle_t *const ppu);
+static status_code_t render_scanline(ppu_handle_t *const ppu);
 
 /** PPU FSM mode handler functions */
 static status_code_t handle_mode_oam_scan(ppu_handle_t *const ppu);
@@ -41,13 +50,21 @@ status_code_t ppu_init(ppu_handle_t *const ppu, ppu_init_param_t *const param)
 
   pxfifo_init_param_t pxfifo_init_params = (pxfifo_init_param_t){
       .bus_interface = param->bus_interface,
+      .vram = param->vram,
       .lcd = &ppu->lcd,
+      .tile_cache = param->tile_cache,
   };
 
   ppu->interrupt = param->interrupt;
+  ppu->tile_cache = param->tile_cache;
   ppu->current_frame = 0;
   ppu->line_ticks = 0;
-  memset(ppu->video_buffer.buffer, 0, sizeof(ppu->video_buffer.buffer));
+  ppu->lcd_off = 0;
+  ppu->render_mode = PPU_RENDER_MODE_PIXEL_FIFO;
+  memset(&ppu->vram_block_callback, 0, sizeof(callback_t));
+
+  status = frame_buffer_init(&ppu->frame_buffer);
+  RETURN_STATUS_IF_NOT_OK(status);
 
   status = oam_init(&ppu->oam);
   RETURN_STATUS_IF_NOT_OK(status);
@@ -62,6 +79,133 @@ status_code_t ppu_init(ppu_handle_t *const ppu, ppu_init_param_t *const param)
 }
 
 status_code_t ppu_tick(ppu_handle_t *const ppu)
+{
+  return ppu_advance(ppu, 1);
+}
+
+status_code_t ppu_advance(ppu_handle_t *const ppu, uint32_t const ticks)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(ppu);
+
+  status_code_t status = STATUS_OK;
+  uint32_t remaining = ticks;
+
+  if (!(ppu->lcd.registers.lcd_ctrl & LCD_CTRL_LCD_PPU_EN))
+  {
+    return advance_lcd_off(ppu, ticks);
+  }
+
+  if (ppu->lcd_off)
+  {
+    status = restart_lcd(ppu);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  while (remaining > 0)
+  {
+    /**
+     * Outside of pixel transfer through the pixel FIFO, the mode handlers only count dots
+     * until the next event, so move the line tick counter straight to the dot before it.
+     */
+    if (((ppu->lcd.registers.lcd_stat & LCD_STAT_PPU_MODE) != MODE_XFER) || (ppu->render_mode == PPU_RENDER_MODE_SCANLINE))
+    {
+      uint32_t const idle_ticks = ppu_ticks_until_event(ppu) - 1;
+
+      if (idle_ticks >= remaining)
+      {
+        ppu->line_ticks += remaining;
+        return STATUS_OK;
+      }
+
+      ppu->line_ticks += idle_ticks;
+      remaining -= idle_ticks;
+    }
+
+    status = ppu_step(ppu);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    remaining--;
+  }
+
+  return STATUS_OK;
+}
+
+uint32_t ppu_ticks_until_event(ppu_handle_t const *const ppu)
+{
+  uint32_t const line_ticks = ppu->line_ticks;
+  uint8_t const render_px = ppu->pxfifo.counters.render_px;
+
+  if (!(ppu->lcd.registers.lcd_ctrl & LCD_CTRL_LCD_PPU_EN) || ppu->lcd_off)
+  {
+    /** With the LCD off, the only event is the end of an idle frame */
+    if (!(ppu->lcd.registers.lcd_ctrl & LCD_CTRL_LCD_PPU_EN) && ppu->lcd_off && (line_ticks < TICKS_PER_FRAME))
+    {
+      return TICKS_PER_FRAME - line_ticks;
+    }
+    return 1;
+  }
+
+  switch (ppu->lcd.registers.lcd_stat & LCD_STAT_PPU_MODE)
+  {
+  case MODE_OAM_SCAN:
+    /** OAM scan happens on the first tick of the line */
+    if (line_ticks == 0)
+    {
+      return 1;
+    }
+    return (line_ticks < OAM_SCAN_DURATION_TICKS) ? (OAM_SCAN_DURATION_TICKS - line_ticks) : 1;
+  case MODE_XFER:
+    if (ppu->render_mode == PPU_RENDER_MODE_SCANLINE)
+    {
+      return (line_ticks < SCANLINE_XFER_END_TICKS) ? (SCANLINE_XFER_END_TICKS - line_ticks) : 1;
+    }
+    /** At most one pixel is rendered per tick */
+    return (render_px < (SCREEN_WIDTH - 1)) ? ((SCREEN_WIDTH - 1) - render_px) : 1;
+  case MODE_VBLANK:
+    /** LY resets from 153 to 0 on the 4th tick of the line */
+    if ((ppu->lcd.registers.ly == 153) && (line_ticks < 4))
+    {
+      return 4 - line_ticks;
+    }
+    return (line_ticks < TICKS_PER_LINE) ? (TICKS_PER_LINE - line_ticks) : 1;
+  case MODE_HBLANK:
+  default:
+    return (line_ticks < TICKS_PER_LINE) ? (TICKS_PER_LINE - line_ticks) : 1;
+  }
+}
+
+status_code_t ppu_register_fps_sync_callback(ppu_handle_t *const ppu, callback_t *const fps_sync_callback)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(ppu);
+  VERIFY_PTR_RETURN_STATUS_IF_NULL(fps_sync_callback->callback_fn, STATUS_ERR_NOT_INITIALIZED);
+
+  memcpy(&ppu->fps_sync_callback, fps_sync_callback, sizeof(callback_t));
+
+  return STATUS_OK;
+}
+
+status_code_t ppu_register_vram_block_callback(ppu_handle_t *const ppu, callback_t *const vram_block_callback)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(ppu);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(vram_block_callback);
+  VERIFY_PTR_RETURN_STATUS_IF_NULL(vram_block_callback->callback_fn, STATUS_ERR_NOT_INITIALIZED);
+
+  memcpy(&ppu->vram_block_callback, vram_block_callback, sizeof(callback_t));
+
+  return STATUS_OK;
+}
+
+bool ppu_vram_accessible(ppu_handle_t const *const ppu)
+{
+  if (!ppu || ppu->lcd_off || !(ppu->lcd.registers.lcd_ctrl & LCD_CTRL_LCD_PPU_EN))
+  {
+    return true;
+  }
+
+  return (ppu->lcd.registers.lcd_stat & LCD_STAT_PPU_MODE) != MODE_XFER;
+}
+
+static status_code_t ppu_step(ppu_handle_t *const ppu)
 {
   status_code_t status = STATUS_OK;
 
@@ -88,16 +232,6 @@ status_code_t ppu_tick(ppu_handle_t *const ppu)
   return status;
 }
 
-status_code_t ppu_register_fps_sync_callback(ppu_handle_t *const ppu, callback_t *const fps_sync_callback)
-{
-  VERIFY_PTR_RETURN_ERROR_IF_NULL(ppu);
-  VERIFY_PTR_RETURN_STATUS_IF_NULL(fps_sync_callback->callback_fn, STATUS_ERR_NOT_INITIALIZED);
-
-  memcpy(&ppu->fps_sync_callback, fps_sync_callback, sizeof(callback_t));
-
-  return STATUS_OK;
-}
-
 static status_code_t handle_mode_oam_scan(ppu_handle_t *const ppu)
 {
   status_code_t status = STATUS_OK;
@@ -107,8 +241,12 @@ static status_code_t handle_mode_oam_scan(ppu_handle_t *const ppu)
     status = lcd_set_mode(ppu, MODE_XFER);
     RETURN_STATUS_IF_NOT_OK(status);
 
-    status = pxfifo_reset(&ppu->pxfifo);
-    RETURN_STATUS_IF_NOT_OK(status);
+    /** The scanline renderer resolves the sprites itself, so the FIFO and its sprite row are left alone */
+    if (ppu->render_mode == PPU_RENDER_MODE_PIXEL_FIFO)
+    {
+      status = pxfifo_reset(&ppu->pxfifo);
+      RETURN_STATUS_IF_NOT_OK(status);
+    }
   }
 
   if (ppu->line_ticks == 1)
@@ -129,12 +267,29 @@ static status_code_t handle_mode_xfer(ppu_handle_t *const ppu)
   status_code_t status = STATUS_OK;
   pixel_data_t pixel_out = {0};
 
+  if (ppu->render_mode == PPU_RENDER_MODE_SCANLINE)
+  {
+    /** Mode 3 takes a fixed number of dots; the whole line is drawn at the end of it */
+    if (ppu->line_ticks < SCANLINE_XFER_END_TICKS)
+    {
+      return STATUS_OK;
+    }
+
+    status = render_scanline(ppu);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    status = frame_buffer_hash_line(&ppu->frame_buffer, ppu->lcd.registers.ly);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    return lcd_set_mode(ppu, MODE_HBLANK);
+  }
+
   status = pxfifo_shift_pixel(&ppu->pxfifo, &pixel_out);
   RETURN_STATUS_IF_NOT_OK(status);
 
   if (pixel_out.data_valid)
   {
-    ppu->video_buffer.matrix[pixel_out.screen_y][pixel_out.screen_x] = pixel_out.color.as_hex;
+    frame_buffer_back(&ppu->frame_buffer)->matrix[pixel_out.screen_y][pixel_out.screen_x] = pixel_out.pixel;
   }
 
   if (pixel_out.screen_x < (SCREEN_WIDTH - 1))
@@ -142,6 +297,9 @@ static status_code_t handle_mode_xfer(ppu_handle_t *const ppu)
     return STATUS_OK;
   }
 
+  status = frame_buffer_hash_line(&ppu->frame_buffer, ppu->lcd.registers.ly);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   status = lcd_set_mode(ppu, MODE_HBLANK);
   RETURN_STATUS_IF_NOT_OK(status);
 
@@ -198,6 +356,9 @@ static status_code_t handle_mode_hblank(ppu_handle_t *const ppu)
 
     ppu->current_frame++;
 
+    status = frame_buffer_publish(&ppu->frame_buffer);
+    RETURN_STATUS_IF_NOT_OK(status);
+
     status = fps_sync(ppu);
     RETURN_STATUS_IF_NOT_OK(status);
   }
@@ -214,7 +375,9 @@ static status_code_t handle_mode_hblank(ppu_handle_t *const ppu)
 
 static status_code_t lcd_set_mode(ppu_handle_t *const ppu, lcd_mode_t mode)
 {
-  VERIFY_COND_RETURN_STATUS_IF_TRUE((ppu->lcd.registers.lcd_stat & LCD_STAT_PPU_MODE) == mode, STATUS_OK);
+  lcd_mode_t const prev_mode = (lcd_mode_t)(ppu->lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(prev_mode == mode, STATUS_OK);
 
   ppu->lcd.registers.lcd_stat &= ~(LCD_STAT_PPU_MODE);
   ppu->lcd.registers.lcd_stat |= (mode & LCD_STAT_PPU_MODE);
@@ -239,6 +402,12 @@ static status_code_t lcd_set_mode(ppu_handle_t *const ppu, lcd_mode_t mode)
     RETURN_STATUS_IF_NOT_OK(status);
   }
 
+  if ((mode == MODE_XFER) || (prev_mode == MODE_XFER))
+  {
+    status = notify_vram_block(ppu, mode == MODE_XFER);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
   return STATUS_OK;
 }
 
@@ -251,6 +420,15 @@ static inline status_code_t fps_sync(ppu_handle_t *const ppu)
   return STATUS_OK;
 }
 
+static inline status_code_t notify_vram_block(ppu_handle_t *const ppu, bool const blocked)
+{
+  if (ppu->vram_block_callback.callback_fn)
+  {
+    return callback_call(&ppu->vram_block_callback, &blocked);
+  }
+  return STATUS_OK;
+}
+
 static status_code_t lyc_interrupt_check(ppu_handle_t *const ppu)
 {
   status_code_t status = STATUS_OK;
@@ -293,3 +471,68 @@ static status_code_t reset_ly(ppu_handle_t *const ppu)
   ppu->pxfifo.pixel_fetcher.window_line = 0;
   return lyc_interrupt_check(ppu);
 }
+
+/**
+ * With the LCD off, LY stays at 0 and the PPU sits in HBlank without raising any interrupts.
+ * Dots are still counted so the frame counter and frame pacing keep going.
+ */
+static status_code_t advance_lcd_off(ppu_handle_t *const ppu, uint32_t const ticks)
+{
+  status_code_t status = STATUS_OK;
+
+  if (!ppu->lcd_off)
+  {
+    /** Turning the LCD off in the middle of pixel transfer releases VRAM */
+    if ((ppu->lcd.registers.lcd_stat & LCD_STAT_PPU_MODE) == MODE_XFER)
+    {
+      status = notify_vram_block(ppu, false);
+      RETURN_STATUS_IF_NOT_OK(status);
+    }
+
+    ppu->lcd_off = 1;
+    ppu->line_ticks = 0;
+    ppu->lcd.registers.ly = 0;
+    ppu->lcd.registers.lcd_stat &= ~(LCD_STAT_PPU_MODE);
+    ppu->pxfifo.pixel_fetcher.window_line = 0;
+  }
+
+  ppu->line_ticks += ticks;
+
+  while (ppu->line_ticks >= TICKS_PER_FRAME)
+  {
+    ppu->line_ticks -= TICKS_PER_FRAME;
+    ppu->current_frame++;
+
+    status = fps_sync(ppu);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  return STATUS_OK;
+}
+
+/**
+ * Turning the LCD back on starts a new frame from the OAM scan of line 0
+ */
+static status_code_t restart_lcd(ppu_handle_t *const ppu)
+{
+  ppu->lcd_off = 0;
+  ppu->line_ticks = 0;
+  ppu->lcd.registers.lcd_stat &= ~(LCD_STAT_PPU_MODE);
+  ppu->lcd.registers.lcd_stat |= MODE_OAM_SCAN;
+
+  return lyc_interrupt_check(ppu);
+}
+
+static status_code_t render_scanline(ppu_handle_t *const ppu)
+{
+  scanline_renderer_context_t ctx = (scanline_renderer_context_t){
+      .lcd_handle = &ppu->lcd,
+      .bus_interface = &ppu->pxfifo.bus_interface,
+      .vram = ppu->pxfifo.vram,
+      .scanned_sprites = &ppu->pxfifo.pixel_fetcher.oam_scanned_sprites,
+      .tile_cache = ppu->tile_cache,
+      .window_line = ppu->pxfifo.pixel_fetcher.window_line,
+  };
+
+  return scanline_render(&ctx, frame_buffer_back(&ppu->frame_buffer)->matrix[ppu->lcd.registers.ly]);
+}
@@ -5,6 +5,7 @@
 
 #include "bus_interface.h"
 #include "status_code.h"
+#include "tile_cache.h"
 
 static status_code_t ram_read(void *const resource, uint16_t const address, uint8_t *const data);
 static status_code_t ram_write(void *const resource, uint16_t const address, uint8_t const data);
@@ -18,8 +19,13 @@ status_code_t ram_init(ram_handle_t *const ram_handle)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(ram_handle);
 
+  status_code_t status = STATUS_OK;
+
   ram_handle->bus_interface.offset = 0x0000;
 
+  status = tile_cache_init(&ram_handle->tile_cache, ram_handle->vram.buf);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   return bus_interface_init(&ram_handle->bus_interface, ram_read, ram_write, ram_handle);
 }
 
@@ -71,6 +77,11 @@ static status_code_t ram_write(void *const resource, uint16_t const address, uin
   {
     effective_address = address - ram_handle->vram.offset;
     ram_handle->vram.buf[effective_address] = data;
+
+    if (effective_address < TILE_CACHE_TILE_DATA_SIZE)
+    {
+      return tile_cache_update(&ram_handle->tile_cache, ram_handle->vram.buf, effective_address);
+    }
   }
   else if (address_in_range(address, ram_handle->hram.offset, HRAM_SIZE))
   {
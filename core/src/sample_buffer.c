@@ -0,0 +1,88 @@
+#include "sample_buffer.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "status_code.h"
+
+#define SAMPLE_BUFFER_INDEX_MASK (SAMPLE_BUFFER_CAPACITY - 1)
+
+status_code_t sample_buffer_init(sample_buffer_t *const sample_buffer)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(sample_buffer);
+
+  memset(sample_buffer->frames, 0, sizeof(sample_buffer->frames));
+  atomic_store(&sample_buffer->write_index, 0);
+  atomic_store(&sample_buffer->read_index, 0);
+
+  return STATUS_OK;
+}
+
+uint32_t sample_buffer_write(sample_buffer_t *const sample_buffer, sample_frame_t const *const frames, uint32_t const count)
+{
+  if ((sample_buffer == NULL) || (frames == NULL))
+  {
+    return 0;
+  }
+
+  /** Acquire ordering keeps the consumer's reads of the slots being reused ahead of overwriting them */
+  uint32_t const write_index = atomic_load_explicit(&sample_buffer->write_index, memory_order_relaxed);
+  uint32_t const read_index = atomic_load_explicit(&sample_buffer->read_index, memory_order_acquire);
+  uint32_t const space = SAMPLE_BUFFER_CAPACITY - (write_index - read_index);
+  uint32_t const written = (count < space) ? count : space;
+
+  for (uint32_t i = 0; i < written;)
+  {
+    uint32_t const pos = (write_index + i) & SAMPLE_BUFFER_INDEX_MASK;
+    uint32_t const chunk = ((SAMPLE_BUFFER_CAPACITY - pos) < (written - i)) ? (SAMPLE_BUFFER_CAPACITY - pos) : (written - i);
+
+    memcpy(&sample_buffer->frames[pos], &frames[i], chunk * sizeof(sample_frame_t));
+    i += chunk;
+  }
+
+  /** Release ordering makes the frames visible to the consumer before the index is */
+  atomic_store_explicit(&sample_buffer->write_index, write_index + written, memory_order_release);
+
+  return written;
+}
+
+uint32_t sample_buffer_read(sample_buffer_t *const sample_buffer, sample_frame_t *const frames, uint32_t const count)
+{
+  if ((sample_buffer == NULL) || (frames == NULL))
+  {
+    return 0;
+  }
+
+  uint32_t const read_index = atomic_load_explicit(&sample_buffer->read_index, memory_order_relaxed);
+  uint32_t const write_index = atomic_load_explicit(&sample_buffer->write_index, memory_order_acquire);
+  uint32_t const available = write_index - read_index;
+  uint32_t const taken = (count < available) ? count : available;
+
+  for (uint32_t i = 0; i < taken;)
+  {
+    uint32_t const pos = (read_index + i) & SAMPLE_BUFFER_INDEX_MASK;
+    uint32_t const chunk = ((SAMPLE_BUFFER_CAPACITY - pos) < (taken - i)) ? (SAMPLE_BUFFER_CAPACITY - pos) : (taken - i);
+
+    memcpy(&frames[i], &sample_buffer->frames[pos], chunk * sizeof(sample_frame_t));
+    i += chunk;
+  }
+
+  /** Release ordering hands the slots back to the producer only after they've been copied out */
+  atomic_store_explicit(&sample_buffer->read_index, read_index + taken, memory_order_release);
+
+  return taken;
+}
+
+uint32_t sample_buffer_size(sample_buffer_t *const sample_buffer)
+{
+  if (sample_buffer == NULL)
+  {
+    return 0;
+  }
+
+  uint32_t const read_index = atomic_load_explicit(&sample_buffer->read_index, memory_order_acquire);
+  uint32_t const write_index = atomic_load_explicit(&sample_buffer->write_index, memory_order_acquire);
+
+  return write_index - read_index;
+}
@@ -0,0 +1,241 @@
+#include "scanline_renderer.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "bus_interface.h"
+#include "color.h"
+#include "lcd.h"
+#include "oam.h"
+#include "pixel_kernels.h"
+#include "ram.h"
+#include "status_code.h"
+#include "tile_cache.h"
+
+#define PIXELS_PER_TILE (8)
+#define BYTES_PER_TILE (16)
+#define TILE_MAP_WIDTH (32)
+#define OBJ_TILE_DATA_ADDR (0x8000)
+
+static inline status_code_t read_vram(scanline_renderer_context_t *const ctx, uint16_t const address, uint8_t *const data);
+static status_code_t fetch_tile_row(scanline_renderer_context_t *const ctx, uint16_t const tile_addr, bool const x_flip, uint8_t *const pixels);
+static status_code_t fetch_bgw_tile_row(scanline_renderer_context_t *const ctx, uint16_t const tile_map_addr, uint8_t const map_x, uint8_t const map_y, uint8_t const row, uint8_t *const pixels);
+static status_code_t draw_bgw_layer(scanline_renderer_context_t *const ctx, uint8_t *const color_indices);
+static status_code_t draw_sprites(scanline_renderer_context_t *const ctx, uint8_t const *const bgw_color_indices, uint8_t *const line_buffer);
+
+status_code_t scanline_render(scanline_renderer_context_t *const ctx, uint8_t *const line_buffer)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(ctx);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(line_buffer);
+  VERIFY_PTR_RETURN_STATUS_IF_NULL(ctx->lcd_handle, STATUS_ERR_INVALID_ARG);
+  VERIFY_PTR_RETURN_STATUS_IF_NULL(ctx->bus_interface, STATUS_ERR_INVALID_ARG);
+  VERIFY_PTR_RETURN_STATUS_IF_NULL(ctx->scanned_sprites, STATUS_ERR_INVALID_ARG);
+
+  status_code_t status = STATUS_OK;
+  uint8_t bgw_color_indices[SCREEN_WIDTH];
+
+  memset(bgw_color_indices, 0, sizeof(bgw_color_indices));
+
+  if (ctx->lcd_handle->registers.lcd_ctrl & LCD_CTRL_BGW_EN)
+  {
+    status = draw_bgw_layer(ctx, bgw_color_indices);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  pixel_kernels_map_palette(bgw_color_indices, ctx->lcd_handle->palette_pixels[PALETTE_BGW], line_buffer, SCREEN_WIDTH);
+
+  if (ctx->lcd_handle->registers.lcd_ctrl & LCD_CTRL_OBJ_EN)
+  {
+    status = draw_sprites(ctx, bgw_color_indices, line_buffer);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  return STATUS_OK;
+}
+
+/** `address` is always within VRAM, as the renderer only computes tile map and tile data addresses */
+static inline status_code_t read_vram(scanline_renderer_context_t *const ctx, uint16_t const address, uint8_t *const data)
+{
+  if (ctx->vram)
+  {
+    *data = ctx->vram[address - VRAM_ADDR];
+    return STATUS_OK;
+  }
+
+  return bus_interface_read(ctx->bus_interface, address, data);
+}
+
+/** `tile_addr` is the address of the low byte of the row */
+static status_code_t fetch_tile_row(scanline_renderer_context_t *const ctx, uint16_t const tile_addr, bool const x_flip, uint8_t *const pixels)
+{
+  status_code_t status = STATUS_OK;
+  uint8_t data_low, data_high;
+
+  if (ctx->tile_cache)
+  {
+    memcpy(pixels, tile_cache_row_at(ctx->tile_cache, tile_addr, x_flip), TILE_CACHE_TILE_SIZE);
+    return STATUS_OK;
+  }
+
+  status = read_vram(ctx, tile_addr, &data_low);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = read_vram(ctx, tile_addr + 1, &data_high);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  pixel_kernels_decode_tile_row(data_low, data_high, x_flip, pixels);
+
+  return STATUS_OK;
+}
+
+static status_code_t fetch_bgw_tile_row(
+    scanline_renderer_context_t *const ctx,
+    uint16_t const tile_map_addr,
+    uint8_t const map_x,
+    uint8_t const map_y,
+    uint8_t const row,
+    uint8_t *const pixels)
+{
+  status_code_t status = STATUS_OK;
+  uint8_t tile_num;
+  uint16_t tile_addr;
+
+  status = read_vram(ctx, tile_map_addr + (map_y * TILE_MAP_WIDTH) + map_x, &tile_num);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  /** In 0x8800 addressing mode, tile numbers are signed and relative to 0x9000 */
+  if (lcd_ctrl_bgw_tile_data_address(ctx->lcd_handle) == 0x8000)
+  {
+    tile_addr = 0x8000 + (tile_num * BYTES_PER_TILE);
+  }
+  else
+  {
+    tile_addr = 0x9000 + ((int8_t)tile_num * BYTES_PER_TILE);
+  }
+
+  return fetch_tile_row(ctx, tile_addr + (row * 2), false, pixels);
+}
+
+static status_code_t draw_bgw_layer(scanline_renderer_context_t *const ctx, uint8_t *const color_indices)
+{
+  status_code_t status = STATUS_OK;
+  lcd_registers_t const *const regs = &ctx->lcd_handle->registers;
+  uint8_t pixels[TILE_CACHE_TILE_SIZE];
+
+  /** The window covers the rest of the line from WX - 7 once LY has reached WY */
+  uint8_t window_start = SCREEN_WIDTH;
+  if (lcd_window_enabled(ctx->lcd_handle) && (regs->ly >= regs->window_y) && (regs->window_x < (SCREEN_WIDTH + 7)))
+  {
+    window_start = (regs->window_x >= 7) ? (regs->window_x - 7) : 0;
+  }
+
+  /** Background */
+  uint16_t const bg_map_addr = lcd_ctrl_bg_tile_map_address(ctx->lcd_handle);
+  uint8_t const bg_y = regs->ly + regs->scroll_y;
+  uint8_t bg_x = regs->scroll_x;
+
+  for (uint8_t x = 0; x < window_start; x++, bg_x++)
+  {
+    if ((x == 0) || ((bg_x % PIXELS_PER_TILE) == 0))
+    {
+      status = fetch_bgw_tile_row(ctx, bg_map_addr, bg_x / PIXELS_PER_TILE, bg_y / PIXELS_PER_TILE, bg_y % PIXELS_PER_TILE, pixels);
+      RETURN_STATUS_IF_NOT_OK(status);
+    }
+
+    color_indices[x] = pixels[bg_x % PIXELS_PER_TILE];
+  }
+
+  /** Window */
+  uint16_t const window_map_addr = lcd_ctrl_window_tile_map_address(ctx->lcd_handle);
+  uint8_t const window_y = ctx->window_line;
+  uint8_t window_x = (regs->window_x >= 7) ? 0 : (7 - regs->window_x);
+
+  for (uint8_t x = window_start; x < SCREEN_WIDTH; x++, window_x++)
+  {
+    if ((x == window_start) || ((window_x % PIXELS_PER_TILE) == 0))
+    {
+      status = fetch_bgw_tile_row(ctx, window_map_addr, window_x / PIXELS_PER_TILE, window_y / PIXELS_PER_TILE, window_y % PIXELS_PER_TILE, pixels);
+      RETURN_STATUS_IF_NOT_OK(status);
+    }
+
+    color_indices[x] = pixels[window_x % PIXELS_PER_TILE];
+  }
+
+  return STATUS_OK;
+}
+
+static status_code_t draw_sprites(
+    scanline_renderer_context_t *const ctx,
+    uint8_t const *const bgw_color_indices,
+    uint8_t *const line_buffer)
+{
+  status_code_t status = STATUS_OK;
+  lcd_handle_t *const lcd = ctx->lcd_handle;
+  oam_scanned_sprites_t const *const sprites = ctx->scanned_sprites;
+  uint8_t const sprite_height = lcd_ctrl_obj_size(lcd);
+  bool pixel_taken[SCREEN_WIDTH];
+
+  memset(pixel_taken, 0, sizeof(pixel_taken));
+
+  /**
+   * Sprites are in priority order. The first opaque sprite pixel at a given X coordinate
+   * hides the pixels of all the sprites after it, even if it is itself behind the background.
+   */
+  for (uint8_t i = 0; i < sprites->sprite_count; i++)
+  {
+    oam_entry_t const *const sprite = &sprites->sprite_attributes[i];
+    uint8_t tile_index = sprite->tile;
+    uint8_t tile_y = (lcd->registers.ly + 16) - sprite->y_pos;
+    uint8_t pixels[TILE_CACHE_TILE_SIZE];
+
+    if (tile_y >= sprite_height)
+    {
+      continue;
+    }
+
+    if (sprite->attrs & OAM_ATTR_Y_FLIP)
+    {
+      tile_y = (sprite_height - 1) - tile_y;
+    }
+
+    if (sprite_height == OBJ_SIZE_LARGE)
+    {
+      tile_index &= ~0x1;
+    }
+
+    uint16_t const tile_addr = OBJ_TILE_DATA_ADDR + (tile_index * BYTES_PER_TILE) + (tile_y * 2);
+
+    status = fetch_tile_row(ctx, tile_addr, !!(sprite->attrs & OAM_ATTR_X_FLIP), pixels);
+    RETURN_STATUS_IF_NOT_OK(status);
+
+    uint8_t const *const palette = lcd->palette_pixels[(sprite->attrs & OAM_ATTR_DMG_PALETTE_NUM) ? PALETTE_OBJ_1 : PALETTE_OBJ_0];
+    bool const behind_bgw = !!(sprite->attrs & OAM_ATTR_BG_PRIORITY);
+
+    for (uint8_t px = 0; px < PIXELS_PER_TILE; px++)
+    {
+      int16_t const x = (sprite->x_pos - 8) + px;
+
+      if ((x < 0) || (x >= SCREEN_WIDTH) || pixel_taken[x])
+      {
+        continue;
+      }
+
+      uint8_t const color_index = pixels[px];
+
+      if (color_index == 0)
+      {
+        continue;
+      }
+
+      pixel_taken[x] = true;
+
+      if (!behind_bgw || (bgw_color_indices[x] == 0))
+      {
+        line_buffer[x] = palette[color_index];
+      }
+    }
+  }
+
+  return STATUS_OK;
+}
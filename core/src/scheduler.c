@@ -0,0 +1,192 @@
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "callback.h"
+#include "status_code.h"
+
+#define HEAP_INDEX_NOT_QUEUED (0xFF)
+
+static inline void heap_swap(scheduler_t *const scheduler, uint8_t const a, uint8_t const b);
+static void heap_sift_up(scheduler_t *const scheduler, uint8_t index);
+static void heap_sift_down(scheduler_t *const scheduler, uint8_t index);
+static void heap_remove(scheduler_t *const scheduler, uint8_t const index);
+static void heap_restore(scheduler_t *const scheduler, uint8_t const index);
+
+status_code_t scheduler_init(scheduler_t *const scheduler)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(scheduler);
+
+  memset(scheduler, 0, sizeof(scheduler_t));
+  memset(scheduler->heap_index, HEAP_INDEX_NOT_QUEUED, sizeof(scheduler->heap_index));
+
+  return STATUS_OK;
+}
+
+status_code_t scheduler_register_handler(scheduler_t *const scheduler, scheduler_event_t const event, callback_t *const handler)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(scheduler);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(handler);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(event >= SCHEDULER_EVENT_COUNT, STATUS_ERR_INVALID_ARG);
+
+  memcpy(&scheduler->handlers[event], handler, sizeof(callback_t));
+
+  return STATUS_OK;
+}
+
+status_code_t scheduler_schedule(scheduler_t *const scheduler, scheduler_event_t const event, uint64_t const timestamp)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(scheduler);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(event >= SCHEDULER_EVENT_COUNT, STATUS_ERR_INVALID_ARG);
+
+  uint8_t index = scheduler->heap_index[event];
+
+  if (index == HEAP_INDEX_NOT_QUEUED)
+  {
+    index = scheduler->size++;
+    scheduler->heap[index].event = event;
+    scheduler->heap_index[event] = index;
+  }
+
+  scheduler->heap[index].timestamp = timestamp;
+  heap_restore(scheduler, index);
+
+  return STATUS_OK;
+}
+
+status_code_t scheduler_cancel(scheduler_t *const scheduler, scheduler_event_t const event)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(scheduler);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(event >= SCHEDULER_EVENT_COUNT, STATUS_ERR_INVALID_ARG);
+
+  uint8_t const index = scheduler->heap_index[event];
+
+  if (index != HEAP_INDEX_NOT_QUEUED)
+  {
+    heap_remove(scheduler, index);
+  }
+
+  return STATUS_OK;
+}
+
+uint64_t scheduler_next_timestamp(scheduler_t const *const scheduler)
+{
+  if (!scheduler || (scheduler->size == 0))
+  {
+    return SCHEDULER_NO_EVENT;
+  }
+
+  return scheduler->heap[0].timestamp;
+}
+
+uint64_t scheduler_event_timestamp(scheduler_t const *const scheduler, scheduler_event_t const event)
+{
+  if (!scheduler || (event >= SCHEDULER_EVENT_COUNT) || (scheduler->heap_index[event] == HEAP_INDEX_NOT_QUEUED))
+  {
+    return SCHEDULER_NO_EVENT;
+  }
+
+  return scheduler->heap[scheduler->heap_index[event]].timestamp;
+}
+
+status_code_t scheduler_run_until(scheduler_t *const scheduler, uint64_t const timestamp)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(scheduler);
+
+  status_code_t status = STATUS_OK;
+
+  while ((scheduler->size > 0) && (scheduler->heap[0].timestamp <= timestamp))
+  {
+    scheduler_entry_t const entry = scheduler->heap[0];
+    heap_remove(scheduler, 0);
+
+    callback_t *const handler = &scheduler->handlers[entry.event];
+    if (handler->callback_fn)
+    {
+      status = callback_call(handler, &entry.timestamp);
+      RETURN_STATUS_IF_NOT_OK(status);
+    }
+  }
+
+  return STATUS_OK;
+}
+
+static inline void heap_swap(scheduler_t *const scheduler, uint8_t const a, uint8_t const b)
+{
+  scheduler_entry_t const temp = scheduler->heap[a];
+  scheduler->heap[a] = scheduler->heap[b];
+  scheduler->heap[b] = temp;
+
+  scheduler->heap_index[scheduler->heap[a].event] = a;
+  scheduler->heap_index[scheduler->heap[b].event] = b;
+}
+
+static void heap_sift_up(scheduler_t *const scheduler, uint8_t index)
+{
+  while (index > 0)
+  {
+    uint8_t const parent = (index - 1) / 2;
+
+    if (scheduler->heap[parent].timestamp <= scheduler->heap[index].timestamp)
+    {
+      break;
+    }
+
+    heap_swap(scheduler, parent, index);
+    index = parent;
+  }
+}
+
+static void heap_sift_down(scheduler_t *const scheduler, uint8_t index)
+{
+  while (1)
+  {
+    uint8_t const left = 2 * index + 1;
+    uint8_t const right = left + 1;
+    uint8_t smallest = index;
+
+    if ((left < scheduler->size) && (scheduler->heap[left].timestamp < scheduler->heap[smallest].timestamp))
+    {
+      smallest = left;
+    }
+
+    if ((right < scheduler->size) && (scheduler->heap[right].timestamp < scheduler->heap[smallest].timestamp))
+    {
+      smallest = right;
+    }
+
+    if (smallest == index)
+    {
+      break;
+    }
+
+    heap_swap(scheduler, smallest, index);
+    index = smallest;
+  }
+}
+
+static void heap_remove(scheduler_t *const scheduler, uint8_t const index)
+{
+  uint8_t const last = --scheduler->size;
+
+  scheduler->heap_index[scheduler->heap[index].event] = HEAP_INDEX_NOT_QUEUED;
+
+  if (index == last)
+  {
+    return;
+  }
+
+  scheduler->heap[index] = scheduler->heap[last];
+  scheduler->heap_index[scheduler->heap[index].event] = index;
+
+  heap_restore(scheduler, index);
+}
+
+static void heap_restore(scheduler_t *const scheduler, uint8_t const index)
+{
+  scheduler_event_t const event = scheduler->heap[index].event;
+
+  heap_sift_up(scheduler, index);
+  heap_sift_down(scheduler, scheduler->heap_index[event]);
+}
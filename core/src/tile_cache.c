@@ -0,0 +1,56 @@
+#include "tile_cache.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "pixel_kernels.h"
+#include "status_code.h"
+
+static void decode_tile_row(tile_cache_t *const cache, uint8_t const *const tile_data, uint16_t const offset);
+
+status_code_t tile_cache_init(tile_cache_t *const cache, uint8_t const *const tile_data)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(cache);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(tile_data);
+
+  for (uint16_t offset = 0; offset < TILE_CACHE_TILE_DATA_SIZE; offset += 2)
+  {
+    decode_tile_row(cache, tile_data, offset);
+  }
+
+  memset(cache->dirty, 1, sizeof(cache->dirty));
+
+  return STATUS_OK;
+}
+
+status_code_t tile_cache_update(tile_cache_t *const cache, uint8_t const *const tile_data, uint16_t const offset)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(cache);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(tile_data);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(offset >= TILE_CACHE_TILE_DATA_SIZE, STATUS_ERR_ADDRESS_OUT_OF_BOUND);
+
+  decode_tile_row(cache, tile_data, offset & ~0x1);
+  cache->dirty[offset / TILE_CACHE_BYTES_PER_TILE] = 1;
+
+  return STATUS_OK;
+}
+
+status_code_t tile_cache_mark_clean(tile_cache_t *const cache, uint16_t const tile_index)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(cache);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(tile_index >= TILE_CACHE_NUM_TILES, STATUS_ERR_INVALID_ARG);
+
+  cache->dirty[tile_index] = 0;
+
+  return STATUS_OK;
+}
+
+/** `offset` is the offset of the low byte of the row */
+static void decode_tile_row(tile_cache_t *const cache, uint8_t const *const tile_data, uint16_t const offset)
+{
+  uint16_t const tile_index = offset / TILE_CACHE_BYTES_PER_TILE;
+  uint8_t const row = (offset % TILE_CACHE_BYTES_PER_TILE) / 2;
+
+  pixel_kernels_decode_tile_row(tile_data[offset], tile_data[offset + 1], false, cache->pixels[tile_index][row]);
+  pixel_kernels_decode_tile_row(tile_data[offset], tile_data[offset + 1], true, cache->pixels_x_flipped[tile_index][row]);
+}
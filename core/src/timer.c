@@ -5,6 +5,18 @@
 #include "bus_interface.h"
 #include "status_code.h"
 
+#define TIMER_INIT_DIV (0xABCC)
+
+/**
+ * TIMA increments on every falling edge of the DIV bit selected by TAC,
+ * i.e. once every (1 << shift) T-cycles of the internal DIV counter.
+ */
+static const uint8_t tima_period_shift[] = {10, 4, 6, 8};
+
+static inline uint16_t timer_div(timer_handle_t const *const timer);
+static inline uint8_t timer_tima(timer_handle_t const *const timer);
+static inline void timer_sync_tima(timer_handle_t *const timer);
+static void timer_update_overflow(timer_handle_t *const timer);
 static status_code_t timer_read(void *const resource, uint16_t const address, uint8_t *const data);
 static status_code_t timer_write(void *const resource, uint16_t const address, uint8_t const data);
 
@@ -13,44 +25,97 @@ status_code_t timer_init(timer_handle_t *const timer, interrupt_handle_t *const
   VERIFY_PTR_RETURN_ERROR_IF_NULL(timer);
   VERIFY_PTR_RETURN_ERROR_IF_NULL(interrupt);
 
-  timer->registers.div = 0xABCC;
+  timer->state.cycles = 0;
+  timer->state.div_epoch = timer->state.cycles - TIMER_INIT_DIV;
+  timer->state.tima_epoch = timer->state.cycles;
   timer->interrupt = interrupt;
+  timer_update_overflow(timer);
 
   return bus_interface_init(&timer->bus_interface, timer_read, timer_write, timer);
 }
 
 status_code_t timer_tick(timer_handle_t *const timer)
+{
+  return timer_advance(timer, 1);
+}
+
+status_code_t timer_advance(timer_handle_t *const timer, uint32_t const ticks)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(timer);
 
-  static const uint16_t clock_select_mask[] = {(1 << 9), (1 << 3), (1 << 5), (1 << 7)};
   status_code_t status = STATUS_OK;
+  uint64_t const target = timer->state.cycles + ticks;
+
+  /* Reload TIMA and request interrupt on every overflow within the span */
+  while (timer->state.overflow_cycle <= target)
+  {
+    timer->state.cycles = timer->state.overflow_cycle;
+    timer->state.tima_epoch = timer->state.cycles;
+    timer->registers.tima = timer->registers.tma;
+    timer_update_overflow(timer);
+
+    status = request_interrupt(timer->interrupt, INT_TIMER);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  timer->state.cycles = target;
+
+  return STATUS_OK;
+}
+
+uint32_t timer_ticks_until_event(timer_handle_t const *const timer)
+{
+  if (!timer || (timer->state.overflow_cycle == TIMER_NO_OVERFLOW))
+  {
+    return UINT32_MAX;
+  }
 
-  /**
-   * Always increment timer DIV at every T-cycle tick
-   * and determine which bits flipped from 1 to 0.
-   */
-  uint16_t bit_changes = (timer->registers.div++) & (~timer->registers.div);
+  return timer->state.overflow_cycle - timer->state.cycles;
+}
 
-  uint8_t clock_select = timer->registers.tac & TMR_TAC_CLK_SEL;
-  uint8_t timer_update = !!(bit_changes & clock_select_mask[clock_select]);
+static inline uint16_t timer_div(timer_handle_t const *const timer)
+{
+  return timer->state.cycles - timer->state.div_epoch;
+}
 
-  if (!(timer->registers.tac & TMR_TAC_ENABLE) || !timer_update)
+static inline uint8_t timer_tima(timer_handle_t const *const timer)
+{
+  if (!(timer->registers.tac & TMR_TAC_ENABLE))
   {
-    return STATUS_OK;
+    return timer->registers.tima;
   }
 
-  timer->registers.tima++;
+  uint8_t const shift = tima_period_shift[timer->registers.tac & TMR_TAC_CLK_SEL];
+  uint64_t const increments = ((timer->state.cycles - timer->state.div_epoch) >> shift) -
+                              ((timer->state.tima_epoch - timer->state.div_epoch) >> shift);
 
-  /* Reload TIMA and request interrupt when it overflows */
-  if (timer->registers.tima == 0xFF)
+  return timer->registers.tima + increments;
+}
+
+/**
+ * Fold the increments since the last TIMA epoch into the TIMA register
+ * so that DIV and TAC can be changed from the current cycle onwards.
+ */
+static inline void timer_sync_tima(timer_handle_t *const timer)
+{
+  timer->registers.tima = timer_tima(timer);
+  timer->state.tima_epoch = timer->state.cycles;
+}
+
+static void timer_update_overflow(timer_handle_t *const timer)
+{
+  if (!(timer->registers.tac & TMR_TAC_ENABLE))
   {
-    timer->registers.tima = timer->registers.tma;
-    status = request_interrupt(timer->interrupt, INT_TIMER);
-    RETURN_STATUS_IF_NOT_OK(status);
+    timer->state.overflow_cycle = TIMER_NO_OVERFLOW;
+    return;
   }
 
-  return STATUS_OK;
+  /* TIMA overflows when it reaches 0xFF; writing 0xFF takes a full wrap-around */
+  uint8_t const shift = tima_period_shift[timer->registers.tac & TMR_TAC_CLK_SEL];
+  uint64_t const increments = (timer->registers.tima == 0xFF) ? 0x100 : (0xFF - timer->registers.tima);
+  uint64_t const periods = (timer->state.tima_epoch - timer->state.div_epoch) >> shift;
+
+  timer->state.overflow_cycle = timer->state.div_epoch + ((periods + increments) << shift);
 }
 
 static status_code_t timer_read(void *const resource, uint16_t const address, uint8_t *const data)
@@ -61,10 +126,10 @@ static status_code_t timer_read(void *const resource, uint16_t const address, ui
   switch (address)
   {
   case 0:
-    *data = (timer->registers.div >> 8);
+    *data = (timer_div(timer) >> 8);
     break;
   case 1:
-    *data = timer->registers.tima;
+    *data = timer_tima(timer);
     break;
   case 2:
     *data = timer->registers.tma;
@@ -88,15 +153,19 @@ static status_code_t timer_write(void *const resource, uint16_t const address, u
   switch (address)
   {
   case 0:
-    timer->registers.div = 0;
+    /* Resetting DIV also restarts the TIMA prescaler */
+    timer_sync_tima(timer);
+    timer->state.div_epoch = timer->state.cycles;
     break;
   case 1:
     timer->registers.tima = data;
+    timer->state.tima_epoch = timer->state.cycles;
     break;
   case 2:
     timer->registers.tma = data;
     break;
   case 3:
+    timer_sync_tima(timer);
     timer->registers.tac = data;
     break;
   default:
@@ -104,5 +173,7 @@ static status_code_t timer_write(void *const resource, uint16_t const address, u
     break;
   }
 
+  timer_update_overflow(timer);
+
   return STATUS_OK;
 }
@@ -3,10 +3,30 @@
 
 #include <stdint.h>
 
+#include "apu.h"
 #include "callback.h"
 #include "status_code.h"
 
-status_code_t audio_init(callback_t *const playback_cb);
+/**
+ * Open the audio device and start playing the frames mixed by the APU
+ *
+ * @param apu Pointer to the APU to play the output of. It must be advanced from the emulation thread.
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t audio_init(apu_handle_t *const apu);
+
+/**
+ * Get a frame pacer that keeps the emulation in step with the audio device, for the frame synchronizer.
+ * It blocks the emulation thread until the device has played enough of the buffered output, and fine-tunes
+ * the APU's output rate to keep the buffer near its target latency.
+ *
+ * @param pacer Pointer to a callback to initialize with the pacer
+ *
+ * @return `STATUS_OK` if successful, `STATUS_ERR_NOT_INITIALIZED` if no audio device is open,
+ *         otherwise appropriate error code.
+ */
+status_code_t audio_get_frame_pacer(callback_t *const pacer);
 void audio_cleanup(void);
 
 #endif /* __AUDIO_H__ */
@@ -0,0 +1,46 @@
+#ifndef __AUDIO_RENDER_H__
+#define __AUDIO_RENDER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "apu.h"
+#include "status_code.h"
+
+#define AUDIO_RENDER_SAMPLE_RATE (48000)
+
+typedef enum
+{
+  AUDIO_RENDER_FORMAT_WAV,
+  AUDIO_RENDER_FORMAT_RAW, /** Headerless 16-bit little-endian stereo PCM */
+} audio_render_format_t;
+
+typedef struct
+{
+  const char *path;             /** File to write the mix to */
+  audio_render_format_t format; /** File format of every track */
+  bool split_channels;          /** Also write each channel to its own file, named after the mix with `_ch1`..`_ch4` before the extension */
+} audio_render_options_t;
+
+/**
+ * Start writing the APU output to files instead of playing it. Each track is streamed out by its own
+ * writer thread, and the emulation thread is held back whenever a writer falls behind, so no frame is
+ * dropped and the files are the same on every run. Nothing paces the emulation otherwise, so it runs
+ * as fast as it can.
+ *
+ * @param apu Pointer to the APU to render the output of. It must be advanced from the emulation thread.
+ * @param options Pointer to the rendering options
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t audio_render_init(apu_handle_t *const apu, audio_render_options_t const *const options);
+
+/**
+ * Write out what's left of the output, finish the files, and stop the writer threads. Must be called
+ * once the emulation thread has stopped advancing the APU.
+ *
+ * @return `STATUS_OK` if every file has been written successfully, otherwise appropriate error code.
+ */
+status_code_t audio_render_cleanup(void);
+
+#endif /* __AUDIO_RENDER_H__ */
@@ -2,13 +2,46 @@
 #define __DISPLAY_H__
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "callback.h"
 #include "status_code.h"
 #include "ppu.h"
-#include "bus_interface.h"
 
-status_code_t display_init(bus_interface_t const data_bus_interface, ppu_handle_t *const ppu_handle);
+status_code_t display_init(ppu_handle_t *const ppu_handle);
 status_code_t handle_events(void);
 void update_display(void);
+
+/**
+ * Block until there's an event to handle, such as user input or a newly completed frame
+ *
+ * @param timeout_ms Maximum number of milliseconds to wait for
+ */
+void display_wait_for_event(uint32_t const timeout_ms);
 void display_cleanup(void);
 
+/**
+ * Pace emulated frames with another clock, instead of sleeping between them
+ *
+ * @param pacer Pointer to a pacer callback, as described by `fps_sync_set_pacer`
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t display_set_frame_pacer(callback_t *const pacer);
+
+/**
+ * Restrict scaling of the emulator screen to whole multiples of the Game Boy resolution,
+ * instead of filling as much of the window as possible
+ *
+ * @param enabled Whether to use integer scaling
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t display_set_integer_scale(bool const enabled);
+
+/**
+ * Redraw the emulator screen on the next update, even if no new frame has been published since,
+ * e.g. after its window has been exposed or restored
+ */
+void display_request_redraw(void);
+
 #endif /* __DISPLAY_H__ */
@@ -2,6 +2,7 @@
 #define __FPS_SYNC_H__
 
 #include <stdint.h>
+#include "callback.h"
 #include "status_code.h"
 
 /**
@@ -10,8 +11,9 @@
  */
 typedef struct
 {
-  double frame_interval_sec;
-  uint64_t last_frame_timestamp; /** Timestamp of the previous frame rendering */
+  callback_t pacer;              /** Optional pacer that blocks until the next frame is due, such as the audio device */
+  uint64_t frame_interval;       /** Target frame interval in performance counter ticks */
+  uint64_t next_frame_timestamp; /** Timestamp the next frame is due at when pacing by sleeping */
   uint64_t secondly_timestamp;   /** Timestamp to keep track of when a second has elapsed */
   uint16_t actual_frame_rate;    /** The actual number of frames rendered in a second */
 } fps_sync_handle_t;
@@ -26,12 +28,23 @@ typedef struct
  */
 status_code_t fps_sync_init(fps_sync_handle_t *const handle, uint32_t const target_frame_rate);
 
+/**
+ * Hand pacing over to another clock. The pacer is called with a pointer to a `bool` to set when it has
+ * blocked until the next frame is due; if it leaves it cleared, the frame is paced by sleeping instead.
+ *
+ * @param handle Pointer to a frame rate synchronizer
+ * @param pacer Pointer to the pacer callback, copied into the synchronizer
+ *
+ * @return `STATUS_OK` if successful, otherwise appropriate error code.
+ */
+status_code_t fps_sync_set_pacer(fps_sync_handle_t *const handle, callback_t *const pacer);
+
 /**
  * Synchronizes each frame to the desired frame rate setting of the synchronizer.
  *
  * This function must be called after each frame finishes rendering, i.e. when the
- * PPU transitions into the V-Blank mode. This function adds necessary delays to
- * achieve the target frame rate.
+ * PPU transitions into the V-Blank mode. This function blocks the calling thread,
+ * without keeping it busy, until the next frame is due.
  *
  * @param handle Pointer to a frame rate synchronizer to synchronize to
  *
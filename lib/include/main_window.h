@@ -2,11 +2,36 @@
 #define __MAIN_WINDOW_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 
+#include "frame_buffer.h"
 #include "status_code.h"
 
-status_code_t main_window_init(uint32_t *const video_buffer, uint16_t window_width, uint16_t window_height);
-void main_window_update(void);
+typedef struct
+{
+  uint64_t presented_frames; /** Number of frames that had changed lines, and were uploaded and presented */
+  uint64_t skipped_frames;   /** Number of frames identical to the one on screen, for which nothing was uploaded or presented */
+  uint64_t uploaded_lines;   /** Total number of lines uploaded to the texture */
+} main_window_stats_t;
+
+status_code_t main_window_init(void);
+status_code_t main_window_set_integer_scale(bool const enabled);
+status_code_t main_window_get_stats(main_window_stats_t *const stats);
+
+/**
+ * Have the window presented on the next update even if nothing has changed, e.g. once it has been
+ * exposed or restored and its contents may have been lost
+ */
+void main_window_request_present(void);
+
+/**
+ * Upload the lines of a frame that have changed since the last one, and present the window if
+ * anything has changed
+ *
+ * @param frame Pointer to the latest frame, or NULL if no new frame has been published, in which
+ *              case the window is only presented again if that was requested
+ */
+void main_window_update(frame_t const *const frame);
 void main_window_cleanup(void);
 
 #endif /* __MAIN_WINDOW_H__ */
@@ -3,10 +3,10 @@
 
 #include <stdint.h>
 
-#include "bus_interface.h"
 #include "status_code.h"
+#include "tile_cache.h"
 
-status_code_t tile_debug_window_init(bus_interface_t const data_bus_interface);
+status_code_t tile_debug_window_init(tile_cache_t *const tile_cache);
 void tile_debug_window_update(void);
 void tile_debug_window_cleanup(void);
 
@@ -2,6 +2,7 @@
 #define __WINDOW_MANAGER_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <SDL2/SDL.h>
 #include "status_code.h"
 
@@ -10,7 +11,7 @@ typedef struct
   SDL_Window *window;
   SDL_Renderer *renderer;
   SDL_Texture *texture;
-  SDL_Surface *screen;
+  SDL_Surface *screen; /** Scaled-up drawing surface; NULL for streaming windows */
 } window_handle_t;
 
 typedef struct
@@ -18,6 +19,7 @@ typedef struct
   uint16_t width;
   uint16_t height;
   uint8_t scale;
+  bool streaming; /** If set, the texture is `width` x `height` and written with `SDL_LockTexture`; the renderer scales it to the resizable window */
 } window_init_param_t;
 
 status_code_t window_init(const char *title, window_handle_t *const handle, window_init_param_t *const param);
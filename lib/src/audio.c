@@ -1,40 +1,105 @@
 #include "audio.h"
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <SDL2/SDL.h>
 
-#include "audio_playback_samples.h"
+#include "apu.h"
+#include "audio_pacer.h"
 #include "callback.h"
+#include "sample_buffer.h"
 #include "logging.h"
 #include "status_code.h"
 
-#define SAMPLE_RATE (44000)
+#define SAMPLE_RATE (APU_DEFAULT_SAMPLE_RATE)
+#define DEVICE_BUFFER_FRAMES (512) /** Number of frames the device asks for at once; the pacer buffers two, about 23 ms */
+#define PACER_TIMEOUT_MS (50)      /** Longest wait for the device before falling back to sleeping */
 
 typedef struct
 {
   SDL_AudioDeviceID audio_device;
-  callback_t *playback_cb;
+  SDL_mutex *drain_mutex;
+  SDL_cond *drain_cond; /** Signaled whenever the device has taken frames off the sample buffer */
+  apu_handle_t *apu;
+  sample_buffer_t *sample_buffer;
+  sample_frame_t last_frame;
+  audio_pacer_t pacer;
+  uint32_t underruns;
+  uint32_t pacer_timeouts;
 } audio_handle_t;
 
 static audio_handle_t audio_handle;
 
+/**
+ * Runs on the SDL audio thread, and only drains the frames the APU has already mixed on the emulation thread
+ */
 static void audio_callback(void __attribute__((unused)) *userdata, uint8_t *stream_buffer, int length)
 {
-  const audio_playback_samples_t playback_samples = {
-      .data = stream_buffer,
-      .length = length,
-      .sample_rate_hz = SAMPLE_RATE,
-      .volume_adjust = 0.5f,
-  };
+  sample_frame_t *const frames = (sample_frame_t *)stream_buffer;
+  uint32_t const frame_count = length / sizeof(sample_frame_t);
+  uint32_t const read_count = sample_buffer_read(audio_handle.sample_buffer, frames, frame_count);
+
+  if (read_count > 0)
+  {
+    audio_handle.last_frame = frames[read_count - 1];
+  }
+
+  if (read_count < frame_count)
+  {
+    /** Hold the last frame rather than dropping to silence, which would click */
+    for (uint32_t i = read_count; i < frame_count; i++)
+    {
+      frames[i] = audio_handle.last_frame;
+    }
+    audio_handle.underruns++;
+  }
+
+  SDL_LockMutex(audio_handle.drain_mutex);
+  SDL_CondSignal(audio_handle.drain_cond);
+  SDL_UnlockMutex(audio_handle.drain_mutex);
+}
+
+/**
+ * Runs on the emulation thread once per video frame. Blocks until the device has drained the sample
+ * buffer down to the target fill level, which locks the emulation speed to the audio clock, then has
+ * the APU's output rate fine-tuned by the pacer, see `audio_pacer_t`.
+ *
+ * @param arg Pointer to a `bool` set when the frame has been paced
+ */
+static status_code_t audio_pace_frame(void __attribute__((unused)) * const ctx, const void *arg)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(arg);
+
+  bool *const paced = (bool *)arg;
+  bool timed_out = false;
+  uint32_t buffered_frames;
+  status_code_t status = STATUS_OK;
+
+  SDL_LockMutex(audio_handle.drain_mutex);
+  while (audio_pacer_must_wait(&audio_handle.pacer, (buffered_frames = sample_buffer_size(audio_handle.sample_buffer))) && !timed_out)
+  {
+    timed_out = (SDL_CondWaitTimeout(audio_handle.drain_cond, audio_handle.drain_mutex, PACER_TIMEOUT_MS) == SDL_MUTEX_TIMEDOUT);
+  }
+  SDL_UnlockMutex(audio_handle.drain_mutex);
 
-  if (audio_handle.playback_cb)
+  if (timed_out)
   {
-    callback_call(audio_handle.playback_cb, &playback_samples);
+    /** The device has stopped draining the buffer; the frame synchronizer keeps time until it resumes */
+    audio_handle.pacer_timeouts++;
+    *paced = false;
+    return STATUS_OK;
   }
+
+  status = audio_pacer_update(&audio_handle.pacer, buffered_frames, paced);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  return apu_set_rate_adjust(audio_handle.apu, audio_handle.pacer.rate_adjust_ppm);
 }
 
-status_code_t audio_init(callback_t *const playback_cb)
+status_code_t audio_init(apu_handle_t *const apu)
 {
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(apu);
+
   Log_I("Initializing the audio module...");
 
   int16_t init_result;
@@ -48,17 +113,28 @@ status_code_t audio_init(callback_t *const playback_cb)
       .freq = SAMPLE_RATE,
       .format = AUDIO_S16LSB,
       .channels = 2,
-      .samples = 512,
+      .samples = DEVICE_BUFFER_FRAMES,
       .callback = audio_callback,
       .userdata = NULL,
   };
 
   SDL_AudioSpec obtained_spec;
 
+  audio_handle.drain_mutex = SDL_CreateMutex();
+  audio_handle.drain_cond = SDL_CreateCond();
+  if ((audio_handle.drain_mutex == NULL) || (audio_handle.drain_cond == NULL))
+  {
+    Log_E("Failed to create the audio pacing primitives.");
+    return STATUS_ERR_GENERIC;
+  }
+
+  audio_handle.apu = apu;
+  audio_handle.sample_buffer = &apu->output.mix.sample_buffer;
   audio_handle.audio_device = SDL_OpenAudioDevice(NULL, 0, &desired_spec, &obtained_spec, 0);
-  audio_handle.playback_cb = playback_cb;
 
-  status_code_t status = STATUS_OK;
+  /** Frames aren't paced by the audio until the device is known to work */
+  status_code_t status = audio_pacer_init(&audio_handle.pacer, 0);
+  RETURN_STATUS_IF_NOT_OK(status);
 
   if (audio_handle.audio_device == 0)
   {
@@ -71,6 +147,10 @@ status_code_t audio_init(callback_t *const playback_cb)
     Log_E("Failed to obtain the desired audio sample rate. Desired: %d Hz; obtained: %d Hz", desired_spec.freq, obtained_spec.freq);
     status = STATUS_ERR_GENERIC;
   }
+  else
+  {
+    status = apu_set_sample_rate(apu, obtained_spec.freq);
+  }
 
   if (desired_spec.format != obtained_spec.format)
   {
@@ -90,19 +170,51 @@ status_code_t audio_init(callback_t *const playback_cb)
     status = STATUS_ERR_GENERIC;
   }
 
-  if (status == STATUS_OK)
+  if (status != STATUS_OK)
   {
-    Log_I("Audio module successfully initialized.");
+    SDL_CloseAudioDevice(audio_handle.audio_device);
+    audio_handle.audio_device = 0;
+    return status;
   }
 
+  status = audio_pacer_init(&audio_handle.pacer, obtained_spec.samples);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  Log_I("Audio module successfully initialized.");
   SDL_PauseAudioDevice(audio_handle.audio_device, 0);
 
-  return status;
+  return STATUS_OK;
+}
+
+status_code_t audio_get_frame_pacer(callback_t *const pacer)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(pacer);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(audio_handle.audio_device == 0, STATUS_ERR_NOT_INITIALIZED);
+
+  return callback_init(pacer, audio_pace_frame, NULL);
 }
 
 void audio_cleanup(void)
 {
   Log_I("Cleaning up the audio module.");
-  SDL_PauseAudioDevice(audio_handle.audio_device, 1);
-  SDL_CloseAudioDevice(audio_handle.audio_device);
+
+  if (audio_handle.audio_device != 0)
+  {
+    SDL_PauseAudioDevice(audio_handle.audio_device, 1);
+    SDL_CloseAudioDevice(audio_handle.audio_device);
+    audio_handle.audio_device = 0;
+    Log_I("Audio buffer underruns: %u, pacer timeouts: %u", audio_handle.underruns, audio_handle.pacer_timeouts);
+  }
+
+  if (audio_handle.drain_cond != NULL)
+  {
+    SDL_DestroyCond(audio_handle.drain_cond);
+    audio_handle.drain_cond = NULL;
+  }
+
+  if (audio_handle.drain_mutex != NULL)
+  {
+    SDL_DestroyMutex(audio_handle.drain_mutex);
+    audio_handle.drain_mutex = NULL;
+  }
 }
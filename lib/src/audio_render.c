@@ -0,0 +1,325 @@
+#include "audio_render.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "apu.h"
+#include "callback.h"
+#include "sample_buffer.h"
+#include "logging.h"
+#include "status_code.h"
+
+#define TRACK_COUNT (1 + APU_CHANNEL_COUNT) /** The mix, followed by each channel */
+#define WRITE_CHUNK_FRAMES (512)            /** Number of frames a writer waits for before writing them out */
+#define BYTES_PER_FRAME (4)
+#define WAV_HEADER_SIZE (44)
+#define FILE_BUFFER_SIZE (64 * 1024)
+#define TRACK_FILE_NAME_SIZE (530)
+
+/**
+ * Streams one output track to a file on a thread of its own. The emulation thread only ever waits on
+ * the writer when the track's sample buffer is close to full.
+ */
+typedef struct
+{
+  FILE *file;
+  sample_buffer_t *sample_buffer;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t data_cond;  /** Signaled when the sample buffer has enough frames to write out, or when stopping */
+  pthread_cond_t space_cond; /** Signaled when the writer has taken frames off the sample buffer */
+  bool stopping;
+  uint32_t frames_written;
+  status_code_t status; /** Only read once the thread has been joined */
+} track_writer_t;
+
+typedef struct
+{
+  track_writer_t writers[TRACK_COUNT];
+  uint8_t writer_count;
+  audio_render_format_t format;
+} audio_render_handle_t;
+
+static audio_render_handle_t render_handle;
+
+static status_code_t track_writer_start(track_writer_t *const writer, const char *filename, sample_buffer_t *const sample_buffer);
+static status_code_t track_writer_stop(track_writer_t *const writer);
+static void *track_writer_run(void *arg);
+static status_code_t write_wav_header(FILE *const file, uint32_t const frame_count);
+static void make_channel_file_name(char *const filename, size_t const size, const char *path, uint8_t const channel);
+
+static inline void put_le16(uint8_t *const dest, uint16_t const value)
+{
+  dest[0] = value & 0xFF;
+  dest[1] = value >> 8;
+}
+
+static inline void put_le32(uint8_t *const dest, uint32_t const value)
+{
+  put_le16(dest, value & 0xFFFF);
+  put_le16(&dest[2], value >> 16);
+}
+
+/**
+ * Called on the emulation thread after the APU has written new frames. Wakes up the writers that have
+ * a chunk to write, and waits on any that has fallen so far behind that the next frames may not fit.
+ */
+static status_code_t hold_back_emulation(void __attribute__((unused)) * const ctx, const void __attribute__((unused)) * arg)
+{
+  for (uint8_t i = 0; i < render_handle.writer_count; i++)
+  {
+    track_writer_t *const writer = &render_handle.writers[i];
+    uint32_t const buffered_frames = sample_buffer_size(writer->sample_buffer);
+
+    if (buffered_frames < WRITE_CHUNK_FRAMES)
+    {
+      continue;
+    }
+
+    pthread_mutex_lock(&writer->mutex);
+    pthread_cond_signal(&writer->data_cond);
+
+    while ((SAMPLE_BUFFER_CAPACITY - sample_buffer_size(writer->sample_buffer)) < APU_MAX_OUTPUT_FRAMES)
+    {
+      pthread_cond_wait(&writer->space_cond, &writer->mutex);
+    }
+
+    pthread_mutex_unlock(&writer->mutex);
+  }
+
+  return STATUS_OK;
+}
+
+status_code_t audio_render_init(apu_handle_t *const apu, audio_render_options_t const *const options)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(apu);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(options);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(options->path);
+
+  Log_I("Initializing audio rendering to %s...", options->path);
+
+  status_code_t status = STATUS_OK;
+  callback_t output_callback = {0};
+  char filename[TRACK_FILE_NAME_SIZE];
+
+  render_handle.writer_count = 0;
+  render_handle.format = options->format;
+
+  /** A fixed rate and no rate adjustment, so that the output only depends on the emulation */
+  status = apu_set_sample_rate(apu, AUDIO_RENDER_SAMPLE_RATE);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = apu_set_rate_adjust(apu, 0);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = apu_set_channel_tracks_enabled(apu, options->split_channels);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = track_writer_start(&render_handle.writers[0], options->path, &apu->output.mix.sample_buffer);
+  RETURN_STATUS_IF_NOT_OK(status);
+  render_handle.writer_count++;
+
+  for (uint8_t i = 0; (i < APU_CHANNEL_COUNT) && options->split_channels; i++)
+  {
+    make_channel_file_name(filename, sizeof(filename), options->path, i + 1);
+
+    status = track_writer_start(&render_handle.writers[i + 1], filename, &apu->output.channels[i].sample_buffer);
+    RETURN_STATUS_IF_NOT_OK(status);
+    render_handle.writer_count++;
+  }
+
+  status = callback_init(&output_callback, hold_back_emulation, NULL);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = apu_register_output_callback(apu, &output_callback);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  Log_I("Audio rendering successfully initialized.");
+  return STATUS_OK;
+}
+
+status_code_t audio_render_cleanup(void)
+{
+  status_code_t result = STATUS_OK;
+
+  Log_I("Cleaning up audio rendering.");
+
+  for (uint8_t i = 0; i < render_handle.writer_count; i++)
+  {
+    status_code_t const status = track_writer_stop(&render_handle.writers[i]);
+    if (status != STATUS_OK)
+    {
+      Log_E("Failed to write audio track %u: %d", i, status);
+      result = status;
+    }
+  }
+
+  if (render_handle.writer_count > 0)
+  {
+    Log_I("Audio frames rendered: %u", render_handle.writers[0].frames_written);
+  }
+
+  render_handle.writer_count = 0;
+
+  return result;
+}
+
+static status_code_t track_writer_start(track_writer_t *const writer, const char *filename, sample_buffer_t *const sample_buffer)
+{
+  writer->file = fopen(filename, "wb");
+  if (writer->file == NULL)
+  {
+    Log_E("Failed to open %s for writing", filename);
+    return STATUS_ERR_FILE_NOT_FOUND;
+  }
+
+  setvbuf(writer->file, NULL, _IOFBF, FILE_BUFFER_SIZE);
+
+  writer->sample_buffer = sample_buffer;
+  writer->stopping = false;
+  writer->frames_written = 0;
+  writer->status = STATUS_OK;
+
+  /** The sizes in the header are filled in once the length is known */
+  if ((render_handle.format == AUDIO_RENDER_FORMAT_WAV) && (write_wav_header(writer->file, 0) != STATUS_OK))
+  {
+    fclose(writer->file);
+    return STATUS_ERR_GENERIC;
+  }
+
+  pthread_mutex_init(&writer->mutex, NULL);
+  pthread_cond_init(&writer->data_cond, NULL);
+  pthread_cond_init(&writer->space_cond, NULL);
+
+  if (pthread_create(&writer->thread, NULL, track_writer_run, writer) != 0)
+  {
+    Log_E("Failed to start the writer thread for %s", filename);
+    fclose(writer->file);
+    return STATUS_ERR_GENERIC;
+  }
+
+  return STATUS_OK;
+}
+
+static status_code_t track_writer_stop(track_writer_t *const writer)
+{
+  pthread_mutex_lock(&writer->mutex);
+  writer->stopping = true;
+  pthread_cond_signal(&writer->data_cond);
+  pthread_mutex_unlock(&writer->mutex);
+
+  pthread_join(writer->thread, NULL);
+
+  if ((writer->status == STATUS_OK) && (render_handle.format == AUDIO_RENDER_FORMAT_WAV))
+  {
+    writer->status = write_wav_header(writer->file, writer->frames_written);
+  }
+
+  if (fclose(writer->file) != 0)
+  {
+    writer->status = STATUS_ERR_GENERIC;
+  }
+
+  pthread_cond_destroy(&writer->space_cond);
+  pthread_cond_destroy(&writer->data_cond);
+  pthread_mutex_destroy(&writer->mutex);
+
+  return writer->status;
+}
+
+/**
+ * Writer thread. Once stopping, the emulation thread has written its last frames, so whatever is left
+ * in the sample buffer is written out before exiting. After a failed write, frames are still taken off
+ * the sample buffer so that the emulation thread isn't held back forever.
+ */
+static void *track_writer_run(void *arg)
+{
+  track_writer_t *const writer = (track_writer_t *)arg;
+  sample_frame_t frames[WRITE_CHUNK_FRAMES];
+  uint8_t bytes[WRITE_CHUNK_FRAMES * BYTES_PER_FRAME];
+  bool stopping = false;
+
+  while (!stopping)
+  {
+    pthread_mutex_lock(&writer->mutex);
+    while (!writer->stopping && (sample_buffer_size(writer->sample_buffer) < WRITE_CHUNK_FRAMES))
+    {
+      pthread_cond_wait(&writer->data_cond, &writer->mutex);
+    }
+    stopping = writer->stopping;
+    pthread_mutex_unlock(&writer->mutex);
+
+    uint32_t count;
+    while ((count = sample_buffer_read(writer->sample_buffer, frames, WRITE_CHUNK_FRAMES)) > 0)
+    {
+      pthread_mutex_lock(&writer->mutex);
+      pthread_cond_signal(&writer->space_cond);
+      pthread_mutex_unlock(&writer->mutex);
+
+      /** Encoded explicitly so that the files are the same whatever the host's byte order */
+      for (uint32_t i = 0; i < count; i++)
+      {
+        put_le16(&bytes[i * BYTES_PER_FRAME], (uint16_t)frames[i].left);
+        put_le16(&bytes[(i * BYTES_PER_FRAME) + 2], (uint16_t)frames[i].right);
+      }
+
+      if ((writer->status == STATUS_OK) && (fwrite(bytes, BYTES_PER_FRAME, count, writer->file) != count))
+      {
+        writer->status = STATUS_ERR_GENERIC;
+      }
+
+      writer->frames_written += count;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Write a canonical 44-byte header for 16-bit stereo PCM at the start of the file
+ */
+static status_code_t write_wav_header(FILE *const file, uint32_t const frame_count)
+{
+  uint8_t header[WAV_HEADER_SIZE];
+  uint32_t const data_size = frame_count * BYTES_PER_FRAME;
+
+  memcpy(&header[0], "RIFF", 4);
+  put_le32(&header[4], (WAV_HEADER_SIZE - 8) + data_size);
+  memcpy(&header[8], "WAVE", 4);
+  memcpy(&header[12], "fmt ", 4);
+  put_le32(&header[16], 16);                                                /* Size of the format chunk */
+  put_le16(&header[20], 1);                                                 /* PCM */
+  put_le16(&header[22], 2);                                                 /* Channels */
+  put_le32(&header[24], AUDIO_RENDER_SAMPLE_RATE);                          /* Sample rate */
+  put_le32(&header[28], AUDIO_RENDER_SAMPLE_RATE * BYTES_PER_FRAME);        /* Byte rate */
+  put_le16(&header[32], BYTES_PER_FRAME);                                   /* Block alignment */
+  put_le16(&header[34], 16);                                                /* Bits per sample */
+  memcpy(&header[36], "data", 4);
+  put_le32(&header[40], data_size);
+
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(fseek(file, 0, SEEK_SET) != 0, STATUS_ERR_GENERIC);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(fwrite(header, 1, WAV_HEADER_SIZE, file) != WAV_HEADER_SIZE, STATUS_ERR_GENERIC);
+
+  return STATUS_OK;
+}
+
+/**
+ * Name a channel's file after the mix, e.g. `out.wav` becomes `out_ch1.wav`
+ */
+static void make_channel_file_name(char *const filename, size_t const size, const char *path, uint8_t const channel)
+{
+  const char *const extension = strrchr(path, '.');
+  const char *const separator = strrchr(path, '/');
+
+  if ((extension == NULL) || ((separator != NULL) && (extension < separator)))
+  {
+    snprintf(filename, size, "%s_ch%u", path, channel);
+  }
+  else
+  {
+    snprintf(filename, size, "%.*s_ch%u%s", (int)(extension - path), path, channel, extension);
+  }
+}
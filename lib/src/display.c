@@ -6,17 +6,17 @@
 #include "logging.h"
 #include "callback.h"
 #include "status_code.h"
-#include "bus_interface.h"
 #include "tile_debug_window.h"
 #include "main_window.h"
 #include "fps_sync.h"
 #include "color.h"
+#include "frame_buffer.h"
 
 typedef struct
 {
   fps_sync_handle_t fps_sync_handle;
   ppu_handle_t *ppu;
-  uint32_t prev_ppu_frame;
+  uint32_t frame_ready_event;
 } display_handle_t;
 
 static display_handle_t display_handle;
@@ -27,7 +27,16 @@ static status_code_t handle_fps_sync(void *const ctx, const void __attribute__((
   return fps_sync(handle);
 }
 
-status_code_t display_init(bus_interface_t const data_bus_interface, ppu_handle_t *const ppu_handle)
+/** Called on the emulation thread; SDL_PushEvent is thread safe and wakes up the display thread */
+static status_code_t handle_frame_ready(void __attribute__((unused)) * const ctx, const void __attribute__((unused)) * arg)
+{
+  SDL_Event event = {0};
+  event.type = display_handle.frame_ready_event;
+
+  return (SDL_PushEvent(&event) < 0) ? STATUS_ERR_GENERIC : STATUS_OK;
+}
+
+status_code_t display_init(ppu_handle_t *const ppu_handle)
 {
   Log_I("Initializing the display module...");
 
@@ -42,14 +51,26 @@ status_code_t display_init(bus_interface_t const data_bus_interface, ppu_handle_
   }
 
   callback_t fps_sync_callback = {0};
+  callback_t frame_ready_callback = {0};
 
   display_handle.ppu = ppu_handle;
-  display_handle.prev_ppu_frame = 0;
+  display_handle.frame_ready_event = SDL_RegisterEvents(1);
+  if (display_handle.frame_ready_event == (uint32_t)-1)
+  {
+    Log_E("Failed to register the frame ready event");
+    return STATUS_ERR_GENERIC;
+  }
 
-  status = tile_debug_window_init(data_bus_interface);
+  status = tile_debug_window_init(ppu_handle->tile_cache);
   RETURN_STATUS_IF_NOT_OK(status);
 
-  status = main_window_init(ppu_handle->video_buffer.buffer, SCREEN_WIDTH, SCREEN_HEIGHT);
+  status = main_window_init();
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = callback_init(&frame_ready_callback, handle_frame_ready, NULL);
+  RETURN_STATUS_IF_NOT_OK(status);
+
+  status = frame_buffer_register_ready_callback(&ppu_handle->frame_buffer, &frame_ready_callback);
   RETURN_STATUS_IF_NOT_OK(status);
 
   status = callback_init(&fps_sync_callback, handle_fps_sync, (void *)&display_handle.fps_sync_handle);
@@ -65,20 +86,53 @@ status_code_t display_init(bus_interface_t const data_bus_interface, ppu_handle_
   return STATUS_OK;
 }
 
+status_code_t display_set_frame_pacer(callback_t *const pacer)
+{
+  return fps_sync_set_pacer(&display_handle.fps_sync_handle, pacer);
+}
+
 void display_cleanup(void)
 {
+  main_window_stats_t stats = {0};
+
   Log_I("Cleaning up the display module.");
+
+  if (main_window_get_stats(&stats) == STATUS_OK)
+  {
+    Log_I("Frames presented: %lu, skipped: %lu, lines uploaded: %lu",
+          (unsigned long)stats.presented_frames, (unsigned long)stats.skipped_frames, (unsigned long)stats.uploaded_lines);
+  }
+
   main_window_cleanup();
   tile_debug_window_cleanup();
   SDL_Quit();
 }
 
+status_code_t display_set_integer_scale(bool const enabled)
+{
+  return main_window_set_integer_scale(enabled);
+}
+
+void display_request_redraw(void)
+{
+  main_window_request_present();
+}
+
 void update_display(void)
 {
-  if (display_handle.prev_ppu_frame != display_handle.ppu->current_frame)
+  frame_t const *const frame = frame_buffer_acquire(&display_handle.ppu->frame_buffer);
+
+  /** Called without a frame too, so that a requested redraw isn't held up until the next one */
+  main_window_update(frame);
+
+  if (frame)
   {
-    main_window_update();
     tile_debug_window_update();
   }
-  display_handle.prev_ppu_frame = display_handle.ppu->current_frame;
+}
+
+void display_wait_for_event(uint32_t const timeout_ms)
+{
+  /** Passing NULL leaves the event in the queue for the input handler and `update_display` */
+  SDL_WaitEventTimeout(NULL, timeout_ms);
 }
@@ -1,20 +1,37 @@
 #include "fps_sync.h"
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 #include <SDL2/SDL.h>
 
+#include "callback.h"
 #include "logging.h"
 #include "status_code.h"
 
+static void sleep_until(uint64_t const timestamp);
+
 status_code_t fps_sync_init(fps_sync_handle_t *const handle, uint32_t const target_frame_rate)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(handle);
   VERIFY_COND_RETURN_STATUS_IF_TRUE(target_frame_rate == 0, STATUS_ERR_INVALID_ARG);
 
+  memset(&handle->pacer, 0, sizeof(callback_t));
   handle->actual_frame_rate = 0;
-  handle->last_frame_timestamp = 0;
+  handle->next_frame_timestamp = 0;
   handle->secondly_timestamp = 0;
-  handle->frame_interval_sec = 1.0 / target_frame_rate;
+  handle->frame_interval = SDL_GetPerformanceFrequency() / target_frame_rate;
+
+  return STATUS_OK;
+}
+
+status_code_t fps_sync_set_pacer(fps_sync_handle_t *const handle, callback_t *const pacer)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(handle);
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(pacer);
+  VERIFY_PTR_RETURN_STATUS_IF_NULL(pacer->callback_fn, STATUS_ERR_NOT_INITIALIZED);
+
+  memcpy(&handle->pacer, pacer, sizeof(callback_t));
 
   return STATUS_OK;
 }
@@ -23,30 +40,60 @@ status_code_t fps_sync(fps_sync_handle_t *const handle)
 {
   VERIFY_PTR_RETURN_ERROR_IF_NULL(handle);
 
-  uint64_t initial_timestamp = SDL_GetPerformanceCounter();
-  uint64_t current_timestamp = initial_timestamp;
-  double frame_interval = (current_timestamp - handle->last_frame_timestamp);
-  frame_interval /= SDL_GetPerformanceFrequency();
+  status_code_t status = STATUS_OK;
+  bool paced = false;
 
-  while (frame_interval < handle->frame_interval_sec)
+  if (handle->pacer.callback_fn)
   {
-    current_timestamp = SDL_GetPerformanceCounter();
-    frame_interval = (current_timestamp - handle->last_frame_timestamp);
-    frame_interval /= SDL_GetPerformanceFrequency();
+    status = callback_call(&handle->pacer, &paced);
+    RETURN_STATUS_IF_NOT_OK(status);
+  }
+
+  if (!paced)
+  {
+    sleep_until(handle->next_frame_timestamp);
   }
 
-  double time_delta = (initial_timestamp - handle->secondly_timestamp);
+  uint64_t const current_timestamp = SDL_GetPerformanceCounter();
+
+  /**
+   * Deadlines follow each other at exact intervals, so that oversleeping on one frame is made up for on
+   * the next. If the emulation has fallen more than a frame behind, or the pacer is keeping time, they
+   * start over from now rather than rushing through the backlog.
+   */
+  handle->next_frame_timestamp += handle->frame_interval;
+  if (paced || (current_timestamp > handle->next_frame_timestamp))
+  {
+    handle->next_frame_timestamp = current_timestamp + handle->frame_interval;
+  }
+
+  double time_delta = (current_timestamp - handle->secondly_timestamp);
   time_delta /= SDL_GetPerformanceFrequency();
 
   if (time_delta >= 1.0)
   {
     Log_I("FPS: %u", handle->actual_frame_rate);
-    handle->secondly_timestamp = initial_timestamp;
+    handle->secondly_timestamp = current_timestamp;
     handle->actual_frame_rate = 0;
   }
 
   handle->actual_frame_rate++;
-  handle->last_frame_timestamp = SDL_GetPerformanceCounter();
 
   return STATUS_OK;
 }
+
+/**
+ * Sleep in whole milliseconds until the timestamp. Less than a millisecond of lateness or earliness is
+ * left for the next deadline to absorb, rather than spinning the remainder away.
+ */
+static void sleep_until(uint64_t const timestamp)
+{
+  uint64_t const ticks_per_ms = SDL_GetPerformanceFrequency() / 1000;
+  uint64_t current_timestamp = SDL_GetPerformanceCounter();
+
+  while ((current_timestamp < timestamp) && ((timestamp - current_timestamp) >= ticks_per_ms))
+  {
+    SDL_Delay((timestamp - current_timestamp) / ticks_per_ms);
+    current_timestamp = SDL_GetPerformanceCounter();
+  }
+}
@@ -4,6 +4,7 @@
 #include <SDL2/SDL.h>
 
 #include "callback.h"
+#include "display.h"
 #include "joypad.h"
 #include "snapshot.h"
 #include "status_code.h"
@@ -31,6 +32,7 @@ static uint8_t const scancode_key_mapping[] = {
 static inline uint16_t get_key_from_scancode(SDL_Scancode scancode);
 static inline uint8_t get_slot_num_from_scancode(SDL_Scancode scancode);
 static inline status_code_t should_quit(SDL_Event event);
+static void handle_window_events(SDL_Event event);
 static status_code_t update_key_press(SDL_Event event);
 static status_code_t handle_save_state_requests(SDL_Event event);
 
@@ -53,6 +55,8 @@ status_code_t key_input_read(void)
     status = should_quit(event);
     RETURN_STATUS_IF_NOT_OK(status);
 
+    handle_window_events(event);
+
     status = update_key_press(event);
     RETURN_STATUS_IF_NOT_OK(status);
 
@@ -110,6 +114,15 @@ static inline status_code_t should_quit(SDL_Event event)
   return STATUS_OK;
 }
 
+/** The window's contents may be gone once it's shown again, so redraw it even if the emulation is paused */
+static void handle_window_events(SDL_Event event)
+{
+  if ((event.type == SDL_WINDOWEVENT) && ((event.window.event == SDL_WINDOWEVENT_EXPOSED) || (event.window.event == SDL_WINDOWEVENT_RESTORED)))
+  {
+    display_request_redraw();
+  }
+}
+
 static status_code_t handle_save_state_requests(SDL_Event event)
 {
 
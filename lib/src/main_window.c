@@ -1,36 +1,49 @@
 #include "main_window.h"
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 
+#include "frame_buffer.h"
+#include "lcd.h"
+#include "pixel_kernels.h"
 #include "status_code.h"
 #include "window_manager.h"
 
 typedef struct
 {
   window_handle_t window;
-  uint32_t *video_buffer;
-  uint16_t window_width;
-  uint16_t window_height;
+  bool texture_valid;                        /** Set once the whole texture has been uploaded */
+  bool present_requested;                    /** Set when the window has to be presented even if nothing has changed */
+  uint64_t line_hashes[SCREEN_HEIGHT];       /** Hashes of the lines currently in the texture */
+  int output_width;                          /** Size of the rendering target when the window was last presented */
+  int output_height;                         /** Size of the rendering target when the window was last presented */
+  uint32_t pixel_colors[LCD_NUM_PIXEL_VALUES]; /** RGBA colors of the indexed pixel values */
+  main_window_stats_t stats;
 } window_ctx_t;
 
 static window_ctx_t window_ctx;
 static const uint8_t scale = 4;
 
-status_code_t main_window_init(uint32_t *const video_buffer, uint16_t window_width, uint16_t window_height)
-{
-  VERIFY_PTR_RETURN_ERROR_IF_NULL(video_buffer);
+static bool output_resized(void);
+static status_code_t upload_lines(frame_t const *const frame, uint16_t const first_line, uint16_t const line_count);
+static void present(void);
 
+status_code_t main_window_init(void)
+{
   status_code_t status = STATUS_OK;
 
   window_init_param_t main_window_init_params = {
-      .width = window_width,
-      .height = window_height,
+      .width = SCREEN_WIDTH,
+      .height = SCREEN_HEIGHT,
       .scale = scale,
+      .streaming = true,
   };
 
-  window_ctx.video_buffer = video_buffer;
-  window_ctx.window_width = window_width;
-  window_ctx.window_height = window_height;
+  memset(&window_ctx, 0, sizeof(window_ctx_t));
+
+  status = lcd_get_pixel_colors(window_ctx.pixel_colors);
+  RETURN_STATUS_IF_NOT_OK(status);
 
   status = window_init("VGBoy Gameboy Emulator", &window_ctx.window, &main_window_init_params);
   RETURN_STATUS_IF_NOT_OK(status);
@@ -38,34 +51,124 @@ status_code_t main_window_init(uint32_t *const video_buffer, uint16_t window_wid
   return STATUS_OK;
 }
 
-void main_window_update(void)
+status_code_t main_window_set_integer_scale(bool const enabled)
 {
-  SDL_Rect rc;
-  rc.x = 0;
-  rc.y = 0;
-  rc.w = window_ctx.window.screen->w;
-  rc.h = window_ctx.window.screen->h;
+  VERIFY_PTR_RETURN_STATUS_IF_NULL(window_ctx.window.renderer, STATUS_ERR_NOT_INITIALIZED);
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(SDL_RenderSetIntegerScale(window_ctx.window.renderer, enabled ? SDL_TRUE : SDL_FALSE) != 0, STATUS_ERR_UNSUPPORTED);
 
-  for (uint8_t row = 0; row < window_ctx.window_height; row++)
+  return STATUS_OK;
+}
+
+status_code_t main_window_get_stats(main_window_stats_t *const stats)
+{
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(stats);
+
+  memcpy(stats, &window_ctx.stats, sizeof(main_window_stats_t));
+
+  return STATUS_OK;
+}
+
+void main_window_request_present(void)
+{
+  window_ctx.present_requested = true;
+}
+
+void main_window_update(frame_t const *const frame)
+{
+  uint16_t uploaded_lines = 0;
+  bool upload_failed = false;
+  uint16_t first_line = 0;
+  uint16_t line_count = 0;
+
+  /** Without a new frame, the texture only has to be presented again if that was requested */
+  if (!frame)
   {
-    for (uint8_t col = 0; col < window_ctx.window_width; col++)
+    if (window_ctx.present_requested && window_ctx.texture_valid)
     {
-      rc.x = col * scale;
-      rc.y = row * scale;
-      rc.w = scale;
-      rc.h = scale;
+      present();
+    }
+    return;
+  }
+
+  /** Every line has to be uploaded until the whole texture has been */
+  uint64_t const *const line_hashes = window_ctx.texture_valid ? window_ctx.line_hashes : NULL;
 
-      SDL_FillRect(window_ctx.window.screen, &rc, window_ctx.video_buffer[col + (row * window_ctx.window_width)]);
+  /** Upload each run of consecutive changed lines in one go */
+  while ((frame_buffer_find_changed_lines(frame, line_hashes, first_line + line_count, &first_line, &line_count) == STATUS_OK) && (line_count > 0))
+  {
+    /** Lines that failed to upload keep their old hashes, so they're retried with the next frame */
+    if (upload_lines(frame, first_line, line_count) != STATUS_OK)
+    {
+      upload_failed = true;
+      continue;
     }
+
+    memcpy(&window_ctx.line_hashes[first_line], &frame->line_hashes[first_line], line_count * sizeof(uint64_t));
+    uploaded_lines += line_count;
   }
 
-  SDL_UpdateTexture(window_ctx.window.texture, NULL, window_ctx.window.screen->pixels, window_ctx.window.screen->pitch);
-  SDL_RenderClear(window_ctx.window.renderer);
-  SDL_RenderCopy(window_ctx.window.renderer, window_ctx.window.texture, NULL, NULL);
-  SDL_RenderPresent(window_ctx.window.renderer);
+  window_ctx.texture_valid = window_ctx.texture_valid || !upload_failed;
+  window_ctx.stats.uploaded_lines += uploaded_lines;
+
+  /** Nothing new to show, unless the window has to be redrawn at its new size or was asked to be */
+  if ((uploaded_lines == 0) && !output_resized() && !window_ctx.present_requested)
+  {
+    window_ctx.stats.skipped_frames++;
+    return;
+  }
+
+  present();
 }
 
 void main_window_cleanup(void)
 {
   window_destroy(&window_ctx.window);
 }
+
+static bool output_resized(void)
+{
+  int width = 0;
+  int height = 0;
+
+  SDL_GetRendererOutputSize(window_ctx.window.renderer, &width, &height);
+
+  if ((width == window_ctx.output_width) && (height == window_ctx.output_height))
+  {
+    return false;
+  }
+
+  window_ctx.output_width = width;
+  window_ctx.output_height = height;
+
+  return true;
+}
+
+/** Convert the lines to RGBA straight into the texture memory */
+static status_code_t upload_lines(frame_t const *const frame, uint16_t const first_line, uint16_t const line_count)
+{
+  SDL_Rect const rect = {.x = 0, .y = first_line, .w = SCREEN_WIDTH, .h = line_count};
+  void *pixels = NULL;
+  int pitch = 0;
+
+  VERIFY_COND_RETURN_STATUS_IF_TRUE(SDL_LockTexture(window_ctx.window.texture, &rect, &pixels, &pitch) != 0, STATUS_ERR_GENERIC);
+
+  for (uint16_t i = 0; i < line_count; i++)
+  {
+    uint32_t *const row = (uint32_t *)((uint8_t *)pixels + (i * pitch));
+    pixel_kernels_expand_pixels(frame->video_buffer.matrix[first_line + i], window_ctx.pixel_colors, row, SCREEN_WIDTH);
+  }
+
+  SDL_UnlockTexture(window_ctx.window.texture);
+
+  return STATUS_OK;
+}
+
+static void present(void)
+{
+  window_ctx.present_requested = false;
+  window_ctx.stats.presented_frames++;
+
+  SDL_RenderClear(window_ctx.window.renderer);
+  SDL_RenderCopy(window_ctx.window.renderer, window_ctx.window.texture, NULL, NULL);
+  SDL_RenderPresent(window_ctx.window.renderer);
+}
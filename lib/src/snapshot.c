@@ -8,6 +8,7 @@
 #include "file_manager.h"
 #include "logging.h"
 #include "status_code.h"
+#include "tile_cache.h"
 
 typedef struct
 {
@@ -56,6 +57,12 @@ typedef struct
   uint8_t prep_delay;
 } dma_snapshot_t;
 
+typedef struct
+{
+  timer_registers_t registers;
+  timer_state_t state;
+} timer_snapshot_t;
+
 typedef struct
 {
   uint16_t rom_active_bank_num;
@@ -78,6 +85,7 @@ typedef struct
   pxfifo_snapshot_t pxfifo;
   uint32_t current_frame;
   uint32_t line_ticks;
+  uint8_t lcd_off;
   video_buffer_t video_buffer;
 } ppu_snapshot_t;
 
@@ -96,7 +104,7 @@ typedef struct
   mbc_snapshot_t mbc;
   ppu_snapshot_t ppu;
   ram_snapshot_t ram;
-  timer_registers_t tmr;
+  timer_snapshot_t tmr;
   uint32_t prev_frame_count;
 } emulator_snapshot_t;
 
@@ -170,8 +178,13 @@ static status_code_t save_snapshot(emulator_t *const emulator, const uint8_t slo
   VERIFY_PTR_RETURN_ERROR_IF_NULL(emulator);
   VERIFY_COND_RETURN_STATUS_IF_TRUE(slot_num > 9, STATUS_ERR_INVALID_ARG);
 
+  status_code_t status = STATUS_OK;
   emulator_snapshot_t snapshot = {0};
 
+  /** Devices are advanced lazily, so bring them all up to date first */
+  status = emulator_sync_devices(emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   /** Save emulator states */
   snapshot.prev_frame_count = emulator->prev_frame_count;
 
@@ -210,20 +223,16 @@ static status_code_t save_snapshot(emulator_t *const emulator, const uint8_t slo
   /** Save PPU states */
   memcpy(&snapshot.ppu.lcd, &emulator->ppu.lcd.registers, sizeof(lcd_registers_t));
   memcpy(&snapshot.ppu.oam_entries, &emulator->ppu.oam.entries, sizeof(emulator->ppu.oam.entries));
-  memcpy(&snapshot.ppu.video_buffer, &emulator->ppu.video_buffer, sizeof(emulator->ppu.video_buffer));
+  memcpy(&snapshot.ppu.video_buffer, frame_buffer_back(&emulator->ppu.frame_buffer), sizeof(video_buffer_t));
   memcpy(&snapshot.ppu.pxfifo.counters, &emulator->ppu.pxfifo.counters, sizeof(pxfifo_counter_t));
   memcpy(&snapshot.ppu.pxfifo.pixel_fetcher, &emulator->ppu.pxfifo.pixel_fetcher, sizeof(pixel_fetcher_state_t));
   snapshot.ppu.pxfifo.fifo_state = emulator->ppu.pxfifo.fifo_state;
   snapshot.ppu.current_frame = emulator->ppu.current_frame;
   snapshot.ppu.line_ticks = emulator->ppu.line_ticks;
+  snapshot.ppu.lcd_off = emulator->ppu.lcd_off;
 
   /** Save Pixel FIFO states */
-  memcpy(&snapshot.ppu.pxfifo.bg_fifo.storage, &emulator->ppu.pxfifo.bg_fifo.storage, sizeof(emulator->ppu.pxfifo.bg_fifo.storage));
-  snapshot.ppu.pxfifo.bg_fifo.buffer.capacity = emulator->ppu.pxfifo.bg_fifo.buffer.capacity;
-  snapshot.ppu.pxfifo.bg_fifo.buffer.read_ptr = emulator->ppu.pxfifo.bg_fifo.buffer.read_ptr;
-  snapshot.ppu.pxfifo.bg_fifo.buffer.write_ptr = emulator->ppu.pxfifo.bg_fifo.buffer.write_ptr;
-  snapshot.ppu.pxfifo.bg_fifo.buffer.item_size = emulator->ppu.pxfifo.bg_fifo.buffer.item_size;
-  snapshot.ppu.pxfifo.bg_fifo.buffer.status = emulator->ppu.pxfifo.bg_fifo.buffer.status;
+  memcpy(&snapshot.ppu.pxfifo.bg_fifo, &emulator->ppu.pxfifo.bg_fifo, sizeof(pxfifo_buffer_t));
 
   /* Save RAM states */
   memcpy(&snapshot.ram.wram, &emulator->ram.wram, sizeof(wram_t));
@@ -231,7 +240,8 @@ static status_code_t save_snapshot(emulator_t *const emulator, const uint8_t slo
   memcpy(&snapshot.ram.hram, &emulator->ram.hram, sizeof(hram_t));
 
   /* Save timer states */
-  memcpy(&snapshot.tmr, &emulator->tmr.registers, sizeof(timer_registers_t));
+  memcpy(&snapshot.tmr.registers, &emulator->tmr.registers, sizeof(timer_registers_t));
+  memcpy(&snapshot.tmr.state, &emulator->tmr.state, sizeof(timer_state_t));
 
   Log_I("State snapshot saved to slot %d", slot_num);
 
@@ -253,6 +263,10 @@ static status_code_t load_snapshot(emulator_t *const emulator, const uint8_t slo
   }
   RETURN_STATUS_IF_NOT_OK(status);
 
+  /** Devices are advanced lazily, so bring them all up to date before replacing their states */
+  status = emulator_sync_devices(emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   /** Load emulator states */
   emulator->prev_frame_count = snapshot.prev_frame_count;
 
@@ -290,33 +304,42 @@ static status_code_t load_snapshot(emulator_t *const emulator, const uint8_t slo
 
   /** Load PPU states */
   memcpy(&emulator->ppu.lcd.registers, &snapshot.ppu.lcd, sizeof(lcd_registers_t));
+  status = lcd_update_palettes(&emulator->ppu.lcd);
+  RETURN_STATUS_IF_NOT_OK(status);
   memcpy(&emulator->ppu.oam.entries, &snapshot.ppu.oam_entries, sizeof(emulator->ppu.oam.entries));
-  memcpy(&emulator->ppu.video_buffer, &snapshot.ppu.video_buffer, sizeof(emulator->ppu.video_buffer));
+  status = oam_invalidate_scan_index(&emulator->ppu.oam);
+  RETURN_STATUS_IF_NOT_OK(status);
+  memcpy(frame_buffer_back(&emulator->ppu.frame_buffer), &snapshot.ppu.video_buffer, sizeof(video_buffer_t));
   memcpy(&emulator->ppu.pxfifo.counters, &snapshot.ppu.pxfifo.counters, sizeof(pxfifo_counter_t));
   memcpy(&emulator->ppu.pxfifo.pixel_fetcher, &snapshot.ppu.pxfifo.pixel_fetcher, sizeof(pixel_fetcher_state_t));
   emulator->ppu.pxfifo.fifo_state = snapshot.ppu.pxfifo.fifo_state;
   emulator->ppu.current_frame = snapshot.ppu.current_frame;
   emulator->ppu.line_ticks = snapshot.ppu.line_ticks;
+  emulator->ppu.lcd_off = snapshot.ppu.lcd_off;
 
   /** Load Pixel FIFO states */
-  memcpy(&emulator->ppu.pxfifo.bg_fifo.storage, &snapshot.ppu.pxfifo.bg_fifo.storage, sizeof(emulator->ppu.pxfifo.bg_fifo.storage));
-  emulator->ppu.pxfifo.bg_fifo.buffer.capacity = snapshot.ppu.pxfifo.bg_fifo.buffer.capacity;
-  emulator->ppu.pxfifo.bg_fifo.buffer.read_ptr = snapshot.ppu.pxfifo.bg_fifo.buffer.read_ptr;
-  emulator->ppu.pxfifo.bg_fifo.buffer.write_ptr = snapshot.ppu.pxfifo.bg_fifo.buffer.write_ptr;
-  emulator->ppu.pxfifo.bg_fifo.buffer.item_size = snapshot.ppu.pxfifo.bg_fifo.buffer.item_size;
-  emulator->ppu.pxfifo.bg_fifo.buffer.status = snapshot.ppu.pxfifo.bg_fifo.buffer.status;
+  memcpy(&emulator->ppu.pxfifo.bg_fifo, &snapshot.ppu.pxfifo.bg_fifo, sizeof(pxfifo_buffer_t));
 
   /* Load RAM states */
   memcpy(&emulator->ram.wram, &snapshot.ram.wram, sizeof(wram_t));
   memcpy(&emulator->ram.vram, &snapshot.ram.vram, sizeof(vram_t));
   memcpy(&emulator->ram.hram, &snapshot.ram.hram, sizeof(hram_t));
 
+  /* The tile cache is not saved, so re-decode the restored tile data */
+  status = tile_cache_init(&emulator->ram.tile_cache, emulator->ram.vram.buf);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   /* Load timer states */
-  memcpy(&emulator->tmr.registers, &snapshot.tmr, sizeof(timer_registers_t));
+  memcpy(&emulator->tmr.registers, &snapshot.tmr.registers, sizeof(timer_registers_t));
+  memcpy(&emulator->tmr.state, &snapshot.tmr.state, sizeof(timer_state_t));
 
   status = mbc_reload_banks(&emulator->mbc);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  /** The device events were scheduled from the replaced states */
+  status = emulator_sync_devices(emulator);
+  RETURN_STATUS_IF_NOT_OK(status);
+
   Log_I("State snapshot loaded from slot %d", slot_num);
 
   return STATUS_OK;
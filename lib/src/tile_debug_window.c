@@ -3,15 +3,15 @@
 #include <stdint.h>
 #include <string.h>
 
-#include "bus_interface.h"
 #include "color.h"
 #include "status_code.h"
+#include "tile_cache.h"
 #include "window_manager.h"
 
 typedef struct
 {
   window_handle_t window;
-  bus_interface_t data_bus_interface;
+  tile_cache_t *tile_cache;
 } window_ctx_t;
 
 static const uint8_t scale = 4;
@@ -29,12 +29,14 @@ static const color_rgba_t tile_colors[4] = {
     {.r = 0x00, .g = 0x00, .b = 0x00, .a = 0xFF},
 };
 
-static void render_tile(SDL_Surface *surface, uint16_t start_address, uint16_t tileNum, uint16_t x, uint16_t y);
-static inline uint8_t get_color_index(uint8_t msb, uint8_t lsb, uint8_t index);
+static void render_tile(SDL_Surface *surface, uint16_t tile_num, uint16_t row, uint16_t col);
 
-status_code_t tile_debug_window_init(bus_interface_t const data_bus_interface)
+status_code_t tile_debug_window_init(tile_cache_t *const tile_cache)
 {
+  VERIFY_PTR_RETURN_ERROR_IF_NULL(tile_cache);
+
   status_code_t status = STATUS_OK;
+  color_rgba_t background_color = {.r = 0x11, .g = 0x11, .b = 0x11, .a = 0xFF};
 
   window_init_param_t tile_debug_window_init_params = {
       .width = tile_col_num * (tile_size + padding) + padding,
@@ -42,33 +44,34 @@ status_code_t tile_debug_window_init(bus_interface_t const data_bus_interface)
       .scale = scale,
   };
 
-  memcpy(&window_ctx.data_bus_interface, &data_bus_interface, sizeof(bus_interface_t));
+  window_ctx.tile_cache = tile_cache;
 
   status = window_init("Tilemap Debug Window", &window_ctx.window, &tile_debug_window_init_params);
   RETURN_STATUS_IF_NOT_OK(status);
 
+  /** Only the tiles are redrawn on updates, so the padding between them is filled in once here */
+  SDL_FillRect(window_ctx.window.screen, NULL, background_color.as_hex);
+  memset(tile_cache->dirty, 1, sizeof(tile_cache->dirty));
+
   return STATUS_OK;
 }
 
 void tile_debug_window_update(void)
 {
-  uint16_t addr = 0x8000;
   uint16_t tile_num = 0;
-  color_rgba_t background_color = {.r = 0x11, .g = 0x11, .b = 0x11, .a = 0xFF};
-  SDL_Rect rect;
-
-  rect.x = 0;
-  rect.y = 0;
-  rect.w = window_ctx.window.screen->w;
-  rect.h = window_ctx.window.screen->h;
-
-  SDL_FillRect(window_ctx.window.screen, &rect, background_color.as_hex);
 
   for (uint8_t row = 0; row < tile_row_num; row++)
   {
-    for (uint8_t col = 0; col < tile_col_num; col++)
+    for (uint8_t col = 0; col < tile_col_num; col++, tile_num++)
     {
-      render_tile(window_ctx.window.screen, addr, tile_num++, row, col);
+      /** Tiles that have not been written to since they were last drawn are still up to date */
+      if (!window_ctx.tile_cache->dirty[tile_num])
+      {
+        continue;
+      }
+
+      tile_cache_mark_clean(window_ctx.tile_cache, tile_num);
+      render_tile(window_ctx.window.screen, tile_num, row, col);
     }
   }
 
@@ -83,31 +86,22 @@ void tile_debug_window_cleanup(void)
   window_destroy(&window_ctx.window);
 }
 
-static void render_tile(SDL_Surface *surface, uint16_t start_address, uint16_t tile_num, uint16_t row, uint16_t col)
+static void render_tile(SDL_Surface *surface, uint16_t tile_num, uint16_t row, uint16_t col)
 {
   SDL_Rect rect;
 
-  for (uint8_t tile_col = 0; tile_col < 16; tile_col += 2)
+  for (uint8_t tile_row = 0; tile_row < tile_size; tile_row++)
   {
-    uint8_t lsb, msb;
-    bus_interface_read(&window_ctx.data_bus_interface, start_address + (tile_num * 16) + tile_col, &lsb);
-    bus_interface_read(&window_ctx.data_bus_interface, start_address + (tile_num * 16) + tile_col + 1, &msb);
+    uint8_t const *const pixels = tile_cache_row(window_ctx.tile_cache, tile_num, tile_row, false);
 
-    for (uint8_t index = 0; index < 8; index++)
+    for (uint8_t index = 0; index < tile_size; index++)
     {
       rect.x = ((col * 9 + padding) + index) * scale;
-      rect.y = ((row * 9 + padding) + (tile_col / 2)) * scale;
+      rect.y = ((row * 9 + padding) + tile_row) * scale;
       rect.w = scale;
       rect.h = scale;
 
-      SDL_FillRect(surface, &rect, tile_colors[get_color_index(msb, lsb, index)].as_hex);
+      SDL_FillRect(surface, &rect, tile_colors[pixels[index]].as_hex);
     }
   }
 }
-
-static inline uint8_t get_color_index(uint8_t msb, uint8_t lsb, uint8_t index)
-{
-  msb = ((msb << index) >> 7) & 0x1;
-  lsb = ((lsb << index) >> 7) & 0x1;
-  return ((msb << 1) | lsb) & 0x3;
-}
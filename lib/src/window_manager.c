@@ -36,12 +36,27 @@ status_code_t window_init(const char *title, window_handle_t *const handle, wind
   uint16_t width = param->width * param->scale;
   uint16_t height = param->height * param->scale;
 
-  handle->window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, 0);
+  handle->window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, param->streaming ? SDL_WINDOW_RESIZABLE : 0);
   VERIFY_COND_RETURN_STATUS_IF_TRUE(handle->window == NULL, STATUS_ERR_GENERIC);
 
   handle->renderer = SDL_CreateRenderer(handle->window, -1, SDL_RENDERER_ACCELERATED);
   VERIFY_COND_RETURN_STATUS_IF_TRUE(handle->renderer == NULL, STATUS_ERR_GENERIC);
 
+  if (param->streaming)
+  {
+    /** Keeps the aspect ratio when the window is resized, letterboxing as needed */
+    VERIFY_COND_RETURN_STATUS_IF_TRUE(SDL_RenderSetLogicalSize(handle->renderer, param->width, param->height) != 0, STATUS_ERR_GENERIC);
+
+    handle->texture = SDL_CreateTexture(
+        handle->renderer,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING,
+        param->width, param->height);
+    VERIFY_COND_RETURN_STATUS_IF_TRUE(handle->texture == NULL, STATUS_ERR_GENERIC);
+
+    return STATUS_OK;
+  }
+
   handle->screen = SDL_CreateRGBSurface(
       0, width, height, 32,
       rgba_mask.r_mask.as_hex,
@@ -1,5 +1,8 @@
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "status_code.h"
 #include "cpu.h"
@@ -8,11 +11,22 @@
 #include "logging.h"
 #include "emulator.h"
 #include "audio.h"
+#include "audio_render.h"
 #include "display.h"
 #include "key_input.h"
+#include "callback.h"
 
 #include <pthread.h>
-#include <unistd.h>
+
+#define EVENT_WAIT_TIMEOUT_MS (100)
+
+typedef struct
+{
+  bool integer_scale;
+  bool headless;                        /** Run without a window or an audio device */
+  uint32_t frame_limit;                 /** Number of frames to run for when headless; 0 to run until the CPU stops */
+  audio_render_options_t audio_render;  /** Where to write the audio when headless; no audio is written without a path */
+} options_t;
 
 void *cpu_run(void *p)
 {
@@ -71,18 +85,41 @@ static status_code_t init(emulator_t *const emulator, const char *rom_file)
     return status;
   }
 
-  status = display_init(emulator->bus_handle.bus_interface, &emulator->ppu);
+  return STATUS_OK;
+}
+
+static status_code_t init_frontend(emulator_t *const emulator, options_t const *const options)
+{
+  status_code_t status = STATUS_OK;
+
+  status = display_init(&emulator->ppu);
   if (status != STATUS_OK)
   {
     Log_E("Failed to init display: %d", status);
     return status;
   }
 
-  status = audio_init(&emulator->apu.playback_cb);
+  status = audio_init(&emulator->apu);
   if (status != STATUS_OK)
   {
-    Log_E("Failed to init audio device: %d", status);
-    return status;
+    /** Not fatal; frames are then paced by sleeping between them */
+    Log_W("Failed to init audio device, continuing without sound: %d", status);
+  }
+  else
+  {
+    callback_t audio_pacer = {0};
+
+    status = audio_get_frame_pacer(&audio_pacer);
+    if (status == STATUS_OK)
+    {
+      status = display_set_frame_pacer(&audio_pacer);
+    }
+
+    if (status != STATUS_OK)
+    {
+      Log_E("Failed to pace frames with the audio device: %d", status);
+      return status;
+    }
   }
 
   status = key_input_init(&emulator->joypad.key_update_callback);
@@ -92,20 +129,117 @@ static status_code_t init(emulator_t *const emulator, const char *rom_file)
     return status;
   }
 
+  if (options->integer_scale && (display_set_integer_scale(true) != STATUS_OK))
+  {
+    Log_W("Integer scaling is not supported");
+  }
+
   return STATUS_OK;
 }
 
-static void cleanup(emulator_t *const emulator)
+static void cleanup_frontend(void)
 {
   audio_cleanup();
   display_cleanup();
+}
+
+static void cleanup(emulator_t *const emulator)
+{
   unload_cartridge(&emulator->mbc);
 }
 
-int main(int __attribute__((unused)) argc, char **argv)
+/**
+ * Run the emulation on the calling thread, as fast as it goes, without a window or an audio device
+ */
+static status_code_t run_headless(emulator_t *const emulator, options_t const *const options)
+{
+  status_code_t status = STATUS_OK;
+
+  if (options->audio_render.path)
+  {
+    status = audio_render_init(&emulator->apu, &options->audio_render);
+    if (status != STATUS_OK)
+    {
+      Log_E("Failed to init audio rendering: %d", status);
+      audio_render_cleanup();
+      return status;
+    }
+  }
+
+  for (uint32_t frame = 0; (options->frame_limit == 0) || (frame < options->frame_limit); frame++)
+  {
+    status = emulator_run_frame(emulator);
+    if (status != STATUS_OK)
+    {
+      Log_E("CPU emulation cycle encountered an error: %d", status);
+      break;
+    }
+    else if (emulator->cpu_state.run_mode == RUN_MODE_STOPPED)
+    {
+      Log_I("CPU Stopped!");
+      break;
+    }
+  }
+
+  status_code_t const render_status = audio_render_cleanup();
+
+  return (status != STATUS_OK) ? status : render_status;
+}
+
+static void parse_options(emulator_t *const emulator, options_t *const options, int argc, char **argv)
+{
+  for (int i = 2; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--threaded-cpu") == 0)
+    {
+      emulator->cpu_exec_mode = CPU_EXEC_MODE_THREADED;
+    }
+    else if (strcmp(argv[i], "--batched-timing") == 0)
+    {
+      emulator->timing_mode = TIMING_MODE_BATCHED;
+    }
+    else if (strcmp(argv[i], "--scanline-renderer") == 0)
+    {
+      emulator->ppu.render_mode = PPU_RENDER_MODE_SCANLINE;
+    }
+    else if (strcmp(argv[i], "--integer-scale") == 0)
+    {
+      options->integer_scale = true;
+    }
+    else if (strcmp(argv[i], "--headless") == 0)
+    {
+      options->headless = true;
+    }
+    else if ((strcmp(argv[i], "--frames") == 0) && ((i + 1) < argc))
+    {
+      options->frame_limit = strtoul(argv[++i], NULL, 10);
+    }
+    else if ((strcmp(argv[i], "--audio-out") == 0) && ((i + 1) < argc))
+    {
+      /** Rendering doesn't go through the audio device, so it's only done headless */
+      options->audio_render.path = argv[++i];
+      options->headless = true;
+    }
+    else if (strcmp(argv[i], "--raw-audio") == 0)
+    {
+      options->audio_render.format = AUDIO_RENDER_FORMAT_RAW;
+    }
+    else if (strcmp(argv[i], "--split-channels") == 0)
+    {
+      options->audio_render.split_channels = true;
+    }
+    else
+    {
+      Log_W("Unknown option: %s", argv[i]);
+    }
+  }
+}
+
+int main(int argc, char **argv)
 {
   status_code_t status;
   emulator_t emulator = {0};
+  options_t options = {0};
 
   status = init(&emulator, argv[1]);
   if (status != STATUS_OK)
@@ -114,6 +248,25 @@ int main(int __attribute__((unused)) argc, char **argv)
     return -status;
   }
 
+  parse_options(&emulator, &options, argc, argv);
+
+  if (options.headless)
+  {
+    status = run_headless(&emulator, &options);
+    cleanup(&emulator);
+
+    Log_I("Exiting: %d", status);
+    return -status;
+  }
+
+  status = init_frontend(&emulator, &options);
+  if (status != STATUS_OK)
+  {
+    cleanup_frontend();
+    cleanup(&emulator);
+    return -status;
+  }
+
   pthread_t t1;
   if (pthread_create(&t1, NULL, cpu_run, &emulator))
   {
@@ -123,7 +276,7 @@ int main(int __attribute__((unused)) argc, char **argv)
 
   while (emulator.state == EMU_MODE_RUNNING)
   {
-    usleep(1000);
+    display_wait_for_event(EVENT_WAIT_TIMEOUT_MS);
     status = key_input_read();
 
     if (status == STATUS_REQ_EXIT)
@@ -139,6 +292,7 @@ int main(int __attribute__((unused)) argc, char **argv)
   emulator_stop(&emulator);
   pthread_join(t1, NULL);
 
+  cleanup_frontend();
   cleanup(&emulator);
 
   Log_I("Exiting: %d", status);
@@ -1,6 +1,5 @@
 #include "unity.h"
 #include "apu.h"
-#include "audio_playback_samples.h"
 #include "status_code.h"
 
 #include "bus_interface_test_helper.h"
@@ -9,9 +8,11 @@
 #include "mock_apu_lfsr.h"
 #include "mock_apu_wave.h"
 #include "mock_bus_interface.h"
-#include "mock_callback.h"
 
 TEST_FILE("apu.c")
+TEST_FILE("blip_buffer.c")
+TEST_FILE("sample_buffer.c")
+TEST_FILE("callback.c")
 
 void setUp(void)
 {
@@ -30,9 +31,6 @@ void test_apu_init(void)
   apu_wave_init_ExpectAndReturn(&apu.ch3, STATUS_OK);
   apu_lfsr_init_ExpectAndReturn(&apu.ch4, STATUS_OK);
 
-  callback_init_ExpectAndReturn(&apu.playback_cb, NULL, &apu, STATUS_OK);
-  callback_init_IgnoreArg_callback_fn();
-
   bus_interface_init_ExpectAndReturn(&apu.bus_interface, NULL, NULL, &apu, STATUS_OK);
   bus_interface_init_IgnoreArg_read_fn();
   bus_interface_init_IgnoreArg_write_fn();
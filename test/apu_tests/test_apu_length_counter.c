@@ -7,13 +7,13 @@
 #include "apu_lfsr.h"
 #include "apu_wave.h"
 #include "apu_common.h"
-#include "audio_playback_samples.h"
 #include "bus_interface.h"
 #include "status_code.h"
 
-#include "mock_callback.h"
-
 TEST_FILE("apu.c")
+TEST_FILE("blip_buffer.c")
+TEST_FILE("sample_buffer.c")
+TEST_FILE("callback.c")
 TEST_FILE("apu_pwm.c")
 TEST_FILE("apu_lfsr.c")
 TEST_FILE("apu_wave.c")
@@ -137,12 +137,7 @@ static const uint8_t channel_enabled_mask[] = {
 
 static void apu_delay(uint32_t count)
 {
-  count *= (CPU_FREQ / FRAME_SEQ_RATE);
-
-  while (count--)
-  {
-    apu_tick(&apu);
-  }
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, count * (CPU_FREQ / FRAME_SEQ_RATE)));
 }
 
 static inline uint16_t get_reg_addr(uint8_t ch_num, uint8_t reg_num)
@@ -521,7 +516,6 @@ void setUp(void)
   memset(&apu, 0, sizeof(apu_handle_t));
   apu.bus_interface.offset = 0xFF10;
 
-  callback_init_IgnoreAndReturn(STATUS_OK);
   apu_init(&apu);
 
   /* Enable APU */
@@ -530,7 +524,6 @@ void setUp(void)
 
 void tearDown(void)
 {
-  callback_init_StopIgnore();
 }
 
 TEST_CH_LENGTH_CTR_RESET(1);
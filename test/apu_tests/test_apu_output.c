@@ -0,0 +1,267 @@
+#include "unity.h"
+
+#include <string.h>
+
+#include "apu.h"
+#include "apu_pwm.h"
+#include "apu_lfsr.h"
+#include "apu_wave.h"
+#include "bus_interface.h"
+#include "callback.h"
+#include "sample_buffer.h"
+#include "status_code.h"
+
+TEST_FILE("apu.c")
+TEST_FILE("blip_buffer.c")
+TEST_FILE("sample_buffer.c")
+TEST_FILE("callback.c")
+TEST_FILE("apu_pwm.c")
+TEST_FILE("apu_lfsr.c")
+TEST_FILE("apu_wave.c")
+
+static apu_handle_t apu;
+static sample_frame_t frames[SAMPLE_BUFFER_CAPACITY];
+static sample_frame_t channel_frames[APU_CHANNEL_COUNT][SAMPLE_BUFFER_CAPACITY];
+static uint32_t drained_frame_count;
+static uint32_t output_callback_count;
+
+/** Consumes the mix as soon as it's written, the way a writer that holds the emulation back would */
+static status_code_t drain_output(void *const __attribute__((unused)) ctx, const void __attribute__((unused)) * arg)
+{
+  TEST_ASSERT_LESS_OR_EQUAL(SAMPLE_BUFFER_CAPACITY - APU_MAX_OUTPUT_FRAMES, sample_buffer_size(&apu.output.mix.sample_buffer));
+
+  drained_frame_count += sample_buffer_read(&apu.output.mix.sample_buffer, frames, SAMPLE_BUFFER_CAPACITY);
+  output_callback_count++;
+
+  return STATUS_OK;
+}
+
+/** Channel 2 at full volume, 50% duty, on both sides at the highest master volume */
+static void start_square_wave(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&apu.bus_interface, 0xFF26, APU_ACTL_AUDIO_EN));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&apu.bus_interface, 0xFF24, 0x77));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&apu.bus_interface, 0xFF25, APU_SNDP_CH2_LEFT | APU_SNDP_CH2_RIGHT));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&apu.bus_interface, 0xFF16, 0x80));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&apu.bus_interface, 0xFF17, 0xF0));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&apu.bus_interface, 0xFF18, 0x00));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&apu.bus_interface, 0xFF19, 0x87));
+}
+
+void setUp(void)
+{
+  memset(&apu, 0, sizeof(apu_handle_t));
+  drained_frame_count = 0;
+  output_callback_count = 0;
+  apu.bus_interface.offset = 0xFF10;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_init(&apu));
+}
+
+void tearDown(void)
+{
+}
+
+void test_apu_output_null_ptr(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, apu_advance(NULL, 1));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, apu_catch_up(NULL, 1));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, apu_set_sample_rate(NULL, APU_DEFAULT_SAMPLE_RATE));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, apu_set_rate_adjust(NULL, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, apu_set_channel_tracks_enabled(NULL, true));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, apu_register_output_callback(NULL, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, apu_register_output_callback(&apu, NULL));
+}
+
+void test_apu_output_invalid_sample_rate(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, apu_set_sample_rate(&apu, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, apu_set_sample_rate(&apu, APU_MAX_SAMPLE_RATE + 1));
+  TEST_ASSERT_EQUAL_UINT32(APU_DEFAULT_SAMPLE_RATE, apu.output.sample_rate_hz);
+}
+
+void test_apu_output_frames_written_on_advance(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_set_sample_rate(&apu, APU_CLOCK_HZ / 32));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, 31));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_size(&apu.output.mix.sample_buffer));
+
+  /** Frames are handed over as soon as the time they cover has passed */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, 1));
+  TEST_ASSERT_EQUAL_UINT32(1, sample_buffer_size(&apu.output.mix.sample_buffer));
+
+  /** Longer than a single synthesized stretch */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, 32 * 300));
+  TEST_ASSERT_EQUAL_UINT32(301, sample_buffer_size(&apu.output.mix.sample_buffer));
+}
+
+void test_apu_output_catch_up_hands_over_frames_on_frame_sequencer_steps(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_set_sample_rate(&apu, APU_CLOCK_HZ / 32));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_catch_up(&apu, 2047));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_size(&apu.output.mix.sample_buffer));
+
+  /** A frame sequencer step happens every 2048 ticks */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_catch_up(&apu, 1));
+  TEST_ASSERT_EQUAL_UINT32(2048 / 32, sample_buffer_size(&apu.output.mix.sample_buffer));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_catch_up(&apu, 100));
+  TEST_ASSERT_EQUAL_UINT32(2048 / 32, sample_buffer_size(&apu.output.mix.sample_buffer));
+
+  /** Whatever has been caught up on is handed over on the next advance */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, 0));
+  TEST_ASSERT_EQUAL_UINT32((2048 + 100) / 32, sample_buffer_size(&apu.output.mix.sample_buffer));
+}
+
+void test_apu_output_m_cycles_until_event(void)
+{
+  /** Nothing is audible, so only the frame sequencer counts */
+  TEST_ASSERT_EQUAL_UINT32(2048, apu_m_cycles_until_event(&apu));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_catch_up(&apu, 48));
+  TEST_ASSERT_EQUAL_UINT32(2000, apu_m_cycles_until_event(&apu));
+}
+
+void test_apu_output_m_cycles_until_event_with_audible_channel(void)
+{
+  start_square_wave();
+
+  /** At this frequency, channel 2 steps through its duty cycle every 256 ticks */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_catch_up(&apu, 1));
+  TEST_ASSERT_EQUAL_UINT32(256, apu_m_cycles_until_event(&apu));
+
+  /** Whichever of the channel and the frame sequencer steps first */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_catch_up(&apu, 256 * 7));
+  TEST_ASSERT_EQUAL_UINT32(2048 - (1 + (256 * 7)), apu_m_cycles_until_event(&apu));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_catch_up(&apu, 2048 - (1 + (256 * 7))));
+  TEST_ASSERT_EQUAL_UINT32(1, apu_m_cycles_until_event(&apu));
+}
+
+void test_apu_output_sample_rate_is_exact(void)
+{
+  uint32_t frame_count = 0;
+
+  /** One second of emulated time, in chunks that fit in the sample buffer */
+  for (uint32_t i = 0; i < 64; i++)
+  {
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, APU_CLOCK_HZ / 64));
+    frame_count += sample_buffer_read(&apu.output.mix.sample_buffer, frames, SAMPLE_BUFFER_CAPACITY);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(APU_DEFAULT_SAMPLE_RATE, frame_count);
+}
+
+void test_apu_output_rate_adjust(void)
+{
+  uint32_t frame_count = 0;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, apu_set_rate_adjust(&apu, BLIP_MAX_RATE_ADJUST_PPM + 1));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_set_rate_adjust(&apu, -2000));
+
+  /** The adjustment outlives a change of sample rate */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_set_sample_rate(&apu, 48000));
+
+  for (uint32_t i = 0; i < 64; i++)
+  {
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, APU_CLOCK_HZ / 64));
+    frame_count += sample_buffer_read(&apu.output.mix.sample_buffer, frames, SAMPLE_BUFFER_CAPACITY);
+  }
+
+  TEST_ASSERT_UINT32_WITHIN(1, 48000 - 96, frame_count);
+}
+
+void test_apu_output_silent_when_disabled(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, 4096));
+
+  uint32_t const frame_count = sample_buffer_read(&apu.output.mix.sample_buffer, frames, SAMPLE_BUFFER_CAPACITY);
+  TEST_ASSERT_GREATER_THAN(0, frame_count);
+
+  for (uint32_t i = 0; i < frame_count; i++)
+  {
+    TEST_ASSERT_EQUAL_INT16(0, frames[i].left);
+    TEST_ASSERT_EQUAL_INT16(0, frames[i].right);
+  }
+}
+
+void test_apu_output_square_wave(void)
+{
+  int32_t sum = 0;
+  int16_t peak = 0;
+
+  start_square_wave();
+
+  /** Let the high-pass filter settle, then look at the next 1024 frames */
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, APU_CLOCK_HZ / 16));
+    sample_buffer_read(&apu.output.mix.sample_buffer, frames, SAMPLE_BUFFER_CAPACITY);
+  }
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, APU_CLOCK_HZ / 32));
+  uint32_t const frame_count = sample_buffer_read(&apu.output.mix.sample_buffer, frames, 1024);
+  TEST_ASSERT_EQUAL_UINT32(1024, frame_count);
+
+  for (uint32_t i = 0; i < frame_count; i++)
+  {
+    TEST_ASSERT_EQUAL_INT16(frames[i].left, frames[i].right);
+    sum += frames[i].left;
+    peak = (frames[i].left > peak) ? frames[i].left : peak;
+  }
+
+  /** Centered on 0, with an amplitude of half the channel's contribution to the output */
+  TEST_ASSERT_INT32_WITHIN(1024 * 200, 0, sum);
+  TEST_ASSERT_INT32_WITHIN(600, (15 * 8 * (INT16_MAX / (15 * 4 * 8 * 2))) / 2, peak);
+}
+
+void test_apu_output_callback_holds_back_emulation(void)
+{
+  callback_t output_callback = {0};
+
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NOT_INITIALIZED, apu_register_output_callback(&apu, &output_callback));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, callback_init(&output_callback, drain_output, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_register_output_callback(&apu, &output_callback));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_set_sample_rate(&apu, APU_MAX_SAMPLE_RATE));
+
+  /** Not called until a frame has been written */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, 5));
+  TEST_ASSERT_EQUAL_UINT32(0, output_callback_count);
+
+  /** Far more than fits in the sample buffer, all in one go, and not a frame dropped */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, APU_CLOCK_HZ - 5));
+  TEST_ASSERT_EQUAL_UINT32(APU_MAX_SAMPLE_RATE, drained_frame_count);
+  TEST_ASSERT_GREATER_THAN(APU_MAX_SAMPLE_RATE / APU_MAX_OUTPUT_FRAMES, output_callback_count);
+}
+
+void test_apu_output_channel_tracks(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_set_channel_tracks_enabled(&apu, true));
+  start_square_wave();
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, APU_CLOCK_HZ / 32));
+  uint32_t const frame_count = sample_buffer_read(&apu.output.mix.sample_buffer, frames, SAMPLE_BUFFER_CAPACITY);
+  TEST_ASSERT_GREATER_THAN(0, frame_count);
+
+  for (uint8_t i = 0; i < APU_CHANNEL_COUNT; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT32(frame_count, sample_buffer_read(&apu.output.channels[i].sample_buffer, channel_frames[i], SAMPLE_BUFFER_CAPACITY));
+  }
+
+  /** Only channel 2 is playing, so its track carries the mix, and the others are silent */
+  TEST_ASSERT_EQUAL_MEMORY(frames, channel_frames[1], frame_count * sizeof(sample_frame_t));
+
+  for (uint32_t i = 0; i < frame_count; i++)
+  {
+    TEST_ASSERT_EQUAL_INT16(0, channel_frames[0][i].left);
+    TEST_ASSERT_EQUAL_INT16(0, channel_frames[2][i].right);
+    TEST_ASSERT_EQUAL_INT16(0, channel_frames[3][i].left);
+  }
+
+  /** Disabled tracks aren't synthesized */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_set_channel_tracks_enabled(&apu, false));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, apu_advance(&apu, 4096));
+  TEST_ASSERT_GREATER_THAN(0, sample_buffer_size(&apu.output.mix.sample_buffer));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_size(&apu.output.channels[1].sample_buffer));
+}
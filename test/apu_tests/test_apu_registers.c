@@ -6,13 +6,13 @@
 #include "apu_pwm.h"
 #include "apu_lfsr.h"
 #include "apu_wave.h"
-#include "audio_playback_samples.h"
 #include "bus_interface.h"
 #include "status_code.h"
 
-#include "mock_callback.h"
-
 TEST_FILE("apu.c")
+TEST_FILE("blip_buffer.c")
+TEST_FILE("sample_buffer.c")
+TEST_FILE("callback.c")
 TEST_FILE("apu_pwm.c")
 TEST_FILE("apu_lfsr.c")
 TEST_FILE("apu_wave.c")
@@ -32,13 +32,11 @@ void setUp(void)
   memset(&apu, 0, sizeof(apu_handle_t));
   apu.bus_interface.offset = 0xFF10;
 
-  callback_init_IgnoreAndReturn(STATUS_OK);
   apu_init(&apu);
 }
 
 void tearDown(void)
 {
-  callback_init_StopIgnore();
 }
 
 void test_apu_registers_initial_values(void)
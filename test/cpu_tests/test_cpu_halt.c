@@ -0,0 +1,123 @@
+#include "unity.h"
+#include <string.h>
+
+#include "cpu.h"
+#include "status_code.h"
+
+#include "mock_bus_interface.h"
+#include "mock_callback.h"
+#include "mock_interrupt.h"
+#include "mock_debug_serial.h"
+#include "cpu_test_helper.h"
+
+TEST_FILE("cpu.c")
+
+#define MAX_SYNC_CALLS (8)
+
+static cpu_state_t state;
+static callback_t cycle_sync_callback;
+static callback_t halt_wake_callback;
+static uint32_t m_cycles_until_wake;
+static uint8_t sync_calls[MAX_SYNC_CALLS];
+static uint8_t sync_call_count;
+
+static status_code_t stub_callback(callback_t *const callback, const void *arg, int __attribute__((unused)) num_calls)
+{
+  if (callback == &halt_wake_callback)
+  {
+    *(uint32_t *)arg = m_cycles_until_wake;
+    return STATUS_OK;
+  }
+
+  TEST_ASSERT_EQUAL_PTR(&cycle_sync_callback, callback);
+  TEST_ASSERT_LESS_THAN(MAX_SYNC_CALLS, sync_call_count);
+  sync_calls[sync_call_count++] = *(uint8_t *)arg;
+  return STATUS_OK;
+}
+
+void setUp(void)
+{
+  serial_check_Ignore();
+  interrupt_globally_enabled_IgnoreAndReturn(false);
+  callback_call_StubWithCallback(stub_callback);
+
+  memset(&state, 0, sizeof(cpu_state_t));
+  stub_cpu_state_init(&state);
+  state.run_mode = RUN_MODE_HALTED;
+  state.cycle_sync_callback = &cycle_sync_callback;
+  state.halt_wake_callback = &halt_wake_callback;
+
+  memset(sync_calls, 0, sizeof(sync_calls));
+  sync_call_count = 0;
+  m_cycles_until_wake = 1;
+}
+
+void tearDown(void)
+{
+}
+
+void test_cpu_halt_syncs_single_cycle_without_wake_callback(void)
+{
+  state.halt_wake_callback = NULL;
+  m_cycles_until_wake = 40;
+
+  has_pending_interrupts_ExpectAndReturn(&state.interrupt, false);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_emulation_cycle(&state));
+  TEST_ASSERT_EQUAL_INT(RUN_MODE_HALTED, state.run_mode);
+  TEST_ASSERT_EQUAL_INT(1, state.m_cycles);
+  TEST_ASSERT_EQUAL_INT(1, sync_call_count);
+  TEST_ASSERT_EQUAL_INT(1, sync_calls[0]);
+}
+
+void test_cpu_halt_skips_to_wake_event(void)
+{
+  m_cycles_until_wake = 40;
+
+  has_pending_interrupts_ExpectAndReturn(&state.interrupt, false);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_emulation_cycle(&state));
+  TEST_ASSERT_EQUAL_INT(RUN_MODE_HALTED, state.run_mode);
+  TEST_ASSERT_EQUAL_INT(40, state.m_cycles);
+  TEST_ASSERT_EQUAL_INT(1, sync_call_count);
+  TEST_ASSERT_EQUAL_INT(40, sync_calls[0]);
+}
+
+void test_cpu_halt_skip_is_limited_to_one_sync_step(void)
+{
+  m_cycles_until_wake = 1000;
+
+  has_pending_interrupts_ExpectAndReturn(&state.interrupt, false);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_emulation_cycle(&state));
+  TEST_ASSERT_EQUAL_INT(UINT8_MAX, state.m_cycles);
+  TEST_ASSERT_EQUAL_INT(1, sync_call_count);
+  TEST_ASSERT_EQUAL_INT(UINT8_MAX, sync_calls[0]);
+}
+
+void test_cpu_halt_wakes_after_skip(void)
+{
+  m_cycles_until_wake = 12;
+
+  has_pending_interrupts_ExpectAndReturn(&state.interrupt, true);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_emulation_cycle(&state));
+  TEST_ASSERT_EQUAL_INT(RUN_MODE_NORMAL, state.run_mode);
+  TEST_ASSERT_EQUAL_INT(12, state.m_cycles);
+}
+
+void test_cpu_halt_skip_respects_cycle_budget(void)
+{
+  m_cycles_until_wake = 40;
+
+  has_pending_interrupts_ExpectAndReturn(&state.interrupt, false);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_run_cycles(&state, 10));
+  TEST_ASSERT_EQUAL_INT(RUN_MODE_HALTED, state.run_mode);
+  TEST_ASSERT_EQUAL_INT(10, state.m_cycles);
+
+  /* Skipped cycles are caught up right away rather than at the end of the budget */
+  TEST_ASSERT_EQUAL_INT(1, sync_call_count);
+  TEST_ASSERT_EQUAL_INT(10, sync_calls[0]);
+  TEST_ASSERT_EQUAL_INT(0, state.owed_m_cycles);
+}
@@ -0,0 +1,107 @@
+#include "unity.h"
+#include <string.h>
+
+#include "cpu.h"
+#include "status_code.h"
+
+#include "mock_bus_interface.h"
+#include "mock_callback.h"
+#include "mock_interrupt.h"
+#include "mock_debug_serial.h"
+#include "cpu_test_helper.h"
+
+TEST_FILE("cpu.c")
+
+#define MAX_SYNC_CALLS (8)
+
+static cpu_state_t state;
+static callback_t cycle_sync_callback;
+static uint8_t sync_calls[MAX_SYNC_CALLS];
+static uint8_t sync_call_count;
+
+static status_code_t stub_cycle_sync(callback_t *const __attribute__((unused)) callback, const void *arg, int __attribute__((unused)) num_calls)
+{
+  TEST_ASSERT_LESS_THAN(MAX_SYNC_CALLS, sync_call_count);
+  sync_calls[sync_call_count++] = *(uint8_t *)arg;
+  return STATUS_OK;
+}
+
+void setUp(void)
+{
+  serial_check_Ignore();
+  interrupt_globally_enabled_IgnoreAndReturn(false);
+  callback_call_StubWithCallback(stub_cycle_sync);
+
+  memset(&state, 0, sizeof(cpu_state_t));
+  stub_cpu_state_init(&state);
+  state.cycle_sync_callback = &cycle_sync_callback;
+
+  memset(sync_calls, 0, sizeof(sync_calls));
+  sync_call_count = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_cpu_run_cycles_null_ptr(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, cpu_run_cycles(NULL, 1));
+}
+
+void test_cpu_run_cycles_catches_up_devices_at_budget_boundary(void)
+{
+  uint8_t opcode = 0x00; // NOP
+
+  stub_mem_read_8(TEST_PC_INIT_VALUE, &opcode);
+  stub_mem_read_8(TEST_PC_INIT_VALUE + 1, &opcode);
+  stub_mem_read_8(TEST_PC_INIT_VALUE + 2, &opcode);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_run_cycles(&state, 3));
+  TEST_ASSERT_EQUAL_HEX16(TEST_PC_INIT_VALUE + 3, state.registers.pc);
+  TEST_ASSERT_EQUAL_INT(3, state.m_cycles);
+
+  TEST_ASSERT_EQUAL_INT(1, sync_call_count);
+  TEST_ASSERT_EQUAL_INT(3, sync_calls[0]);
+  TEST_ASSERT_EQUAL_INT(0, state.owed_m_cycles);
+  TEST_ASSERT_EQUAL_INT(0, state.batched_sync);
+}
+
+void test_cpu_run_cycles_catches_up_devices_before_io_access(void)
+{
+  uint8_t program[] = {
+      0x00,       // NOP
+      0xF0, 0x44, // LDH A, (0x44)
+  };
+  uint8_t ly = 0x90;
+
+  stub_mem_read_8(TEST_PC_INIT_VALUE, &program[0]);
+  stub_mem_read_8(TEST_PC_INIT_VALUE + 1, &program[1]);
+  stub_mem_read_8(TEST_PC_INIT_VALUE + 2, &program[2]);
+  stub_mem_read_8(0xFF44, &ly);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_run_cycles(&state, 4));
+  TEST_ASSERT_EQUAL_HEX8(0x90, state.registers.a);
+  TEST_ASSERT_EQUAL_INT(4, state.m_cycles);
+
+  /* All 4 cycles, including the one of the I/O access, are synced before the access */
+  TEST_ASSERT_EQUAL_INT(1, sync_call_count);
+  TEST_ASSERT_EQUAL_INT(4, sync_calls[0]);
+}
+
+void test_cpu_run_cycles_does_not_catch_up_on_wram_access(void)
+{
+  uint8_t opcode = 0x7E; // LD A, (HL)
+  uint8_t data = 0x5A;
+
+  state.registers.hl = 0xC000;
+
+  stub_mem_read_8(TEST_PC_INIT_VALUE, &opcode);
+  stub_mem_read_8(0xC000, &data);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_run_cycles(&state, 2));
+  TEST_ASSERT_EQUAL_HEX8(0x5A, state.registers.a);
+
+  TEST_ASSERT_EQUAL_INT(1, sync_call_count);
+  TEST_ASSERT_EQUAL_INT(2, sync_calls[0]);
+}
@@ -0,0 +1,103 @@
+#include "unity.h"
+#include <string.h>
+
+#include "cpu.h"
+#include "status_code.h"
+
+#include "mock_bus_interface.h"
+#include "mock_callback.h"
+#include "mock_interrupt.h"
+#include "mock_debug_serial.h"
+#include "cpu_test_helper.h"
+
+TEST_FILE("cpu.c")
+
+static cpu_state_t state;
+static callback_t cycle_sync_callback;
+static uint32_t exit_after_m_cycles;
+
+static status_code_t stub_cycle_sync(callback_t *const callback, const void *arg, int __attribute__((unused)) num_calls)
+{
+  TEST_ASSERT_EQUAL_PTR(&cycle_sync_callback, callback);
+  TEST_ASSERT_EQUAL_INT(1, *(uint8_t *)arg);
+
+  if (state.m_cycles >= exit_after_m_cycles)
+  {
+    cpu_request_exit(&state);
+  }
+
+  return STATUS_OK;
+}
+
+void setUp(void)
+{
+  serial_check_Ignore();
+  interrupt_globally_enabled_IgnoreAndReturn(false);
+  callback_call_StubWithCallback(stub_cycle_sync);
+
+  memset(&state, 0, sizeof(cpu_state_t));
+  stub_cpu_state_init(&state);
+  state.cycle_sync_callback = &cycle_sync_callback;
+  exit_after_m_cycles = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_cpu_run_threaded_null_ptr(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, cpu_run_threaded(NULL));
+}
+
+void test_cpu_run_threaded_runs_until_exit_requested(void)
+{
+  uint8_t program[] = {
+      0x3E, 0x42, // LD A, 0x42
+      0x04,       // INC B
+  };
+
+  stub_mem_read_8(TEST_PC_INIT_VALUE, &program[0]);
+  stub_mem_read_8(TEST_PC_INIT_VALUE + 1, &program[1]);
+  stub_mem_read_8(TEST_PC_INIT_VALUE + 2, &program[2]);
+
+  exit_after_m_cycles = 3;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_run_threaded(&state));
+  TEST_ASSERT_EQUAL_HEX16(TEST_PC_INIT_VALUE + 3, state.registers.pc);
+  TEST_ASSERT_EQUAL_HEX8(0x42, state.registers.a);
+  TEST_ASSERT_EQUAL_HEX8(0x01, state.registers.b);
+  TEST_ASSERT_EQUAL_INT(3, state.m_cycles);
+}
+
+void test_cpu_run_threaded_returns_error_with_registers_written_back(void)
+{
+  uint8_t program[] = {
+      0x04, // INC B
+      0xD3, // Undefined
+  };
+
+  stub_mem_read_8(TEST_PC_INIT_VALUE, &program[0]);
+  stub_mem_read_8(TEST_PC_INIT_VALUE + 1, &program[1]);
+
+  exit_after_m_cycles = UINT32_MAX;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_UNDEFINED_INST, cpu_run_threaded(&state));
+  TEST_ASSERT_EQUAL_HEX16(TEST_PC_INIT_VALUE + 2, state.registers.pc);
+  TEST_ASSERT_EQUAL_HEX8(0x01, state.registers.b);
+}
+
+void test_cpu_run_threaded_steps_through_halt(void)
+{
+  uint8_t opcode = 0x76; // HALT
+
+  stub_mem_read_8(TEST_PC_INIT_VALUE, &opcode);
+  has_pending_interrupts_ExpectAndReturn(&state.interrupt, false);
+
+  exit_after_m_cycles = 2;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, cpu_run_threaded(&state));
+  TEST_ASSERT_EQUAL_INT(RUN_MODE_HALTED, state.run_mode);
+  TEST_ASSERT_EQUAL_HEX16(TEST_PC_INIT_VALUE + 1, state.registers.pc);
+  TEST_ASSERT_EQUAL_INT(2, state.m_cycles);
+}
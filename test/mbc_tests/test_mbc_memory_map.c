@@ -0,0 +1,124 @@
+#include "unity.h"
+
+#include <string.h>
+
+#include "mbc.h"
+#include "rom.h"
+#include "bus_interface.h"
+#include "memory_map.h"
+
+#include "mbc_test_helper.h"
+#include "mock_rtc.h"
+
+TEST_FILE("mbc.c")
+
+static mbc_handle_t mbc;
+static memory_map_t memory_map;
+static uint8_t *rom_data;
+
+static void load_rom(cartridge_type_t const cartridge_type)
+{
+  rom_data = create_rom(cartridge_type, 0x01, MBC_EXT_RAM_SIZE_32K);
+  TEST_ASSERT_NOT_NULL(rom_data);
+
+  rtc_is_present_ExpectAndReturn(&mbc.rtc, false);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, mbc_load_rom(&mbc, rom_data, 0x10000));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, mbc_attach_memory_map(&mbc, &memory_map));
+}
+
+void setUp(void)
+{
+  memset(&mbc, 0, sizeof(mbc_handle_t));
+  memset(&memory_map, 0, sizeof(memory_map_t));
+  mbc_init(&mbc);
+}
+
+void tearDown(void)
+{
+  mbc_cleanup(&mbc);
+}
+
+void test_mbc_memory_map__attach_rejects_null_args(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, mbc_attach_memory_map(NULL, &memory_map));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, mbc_attach_memory_map(&mbc, NULL));
+}
+
+void test_mbc_memory_map__maps_rom_pages_read_only(void)
+{
+  load_rom(ROM_MBC5_RAM);
+
+  TEST_ASSERT_EQUAL_PTR(&mbc.rom.content.data[0x0000], memory_map.read[0x00]);
+  TEST_ASSERT_EQUAL_PTR(&mbc.rom.content.data[0x3F00], memory_map.read[0x3F]);
+  TEST_ASSERT_EQUAL_PTR(&mbc.rom.content.data[0x4000], memory_map.read[0x40]);
+  TEST_ASSERT_EQUAL_PTR(&mbc.rom.content.data[0x7F00], memory_map.read[0x7F]);
+
+  for (uint16_t page = 0x00; page < 0x80; page++)
+  {
+    TEST_ASSERT_NULL(memory_map.write[page]);
+  }
+}
+
+void test_mbc_memory_map__rom_bank_switch_repoints_pages(void)
+{
+  load_rom(ROM_MBC5_RAM);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&mbc.bus_interface, 0x2000, 3));
+
+  TEST_ASSERT_EQUAL_PTR(&mbc.rom.content.data[0x3 * 0x4000], memory_map.read[0x40]);
+  TEST_ASSERT_EQUAL_PTR(&mbc.rom.content.data[0x3 * 0x4000 + 0x3F00], memory_map.read[0x7F]);
+  TEST_ASSERT_EQUAL_HEX8(0xB3, memory_map.read[0x45][0x10]);
+}
+
+void test_mbc_memory_map__ext_ram_is_mapped_only_while_enabled(void)
+{
+  load_rom(ROM_MBC5_RAM);
+
+  TEST_ASSERT_NULL(memory_map.read[0xA0]);
+  TEST_ASSERT_NULL(memory_map.write[0xA0]);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&mbc.bus_interface, 0x0000, 0x0A));
+  TEST_ASSERT_EQUAL_PTR(&mbc.ext_ram.active_bank[0x0000], memory_map.read[0xA0]);
+  TEST_ASSERT_EQUAL_PTR(&mbc.ext_ram.active_bank[0x1F00], memory_map.write[0xBF]);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&mbc.bus_interface, 0x0000, 0x00));
+  TEST_ASSERT_NULL(memory_map.read[0xA0]);
+  TEST_ASSERT_NULL(memory_map.write[0xBF]);
+}
+
+void test_mbc_memory_map__ext_ram_bank_switch_repoints_pages(void)
+{
+  load_rom(ROM_MBC5_RAM);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&mbc.bus_interface, 0x0000, 0x0A));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&mbc.bus_interface, 0x4000, 2));
+
+  TEST_ASSERT_EQUAL_PTR(&mbc.ext_ram.data[0x2 * 0x2000], memory_map.read[0xA0]);
+  TEST_ASSERT_EQUAL_PTR(&mbc.ext_ram.data[0x2 * 0x2000], memory_map.write[0xA0]);
+}
+
+void test_mbc_memory_map__battery_backed_ram_writes_go_through_handler_until_dirty(void)
+{
+  load_rom(ROM_MBC5_RAM_BATT);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&mbc.bus_interface, 0x0000, 0x0A));
+  TEST_ASSERT_NOT_NULL(memory_map.read[0xA0]);
+  TEST_ASSERT_NULL(memory_map.write[0xA0]);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&mbc.bus_interface, 0xA000, 0x55));
+  TEST_ASSERT_TRUE(mbc.batt.has_unsaved_data);
+  TEST_ASSERT_EQUAL_PTR(&mbc.ext_ram.active_bank[0x0000], memory_map.write[0xA0]);
+}
+
+void test_mbc_memory_map__cleanup_unmaps_cartridge_pages(void)
+{
+  load_rom(ROM_MBC5_RAM);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&mbc.bus_interface, 0x0000, 0x0A));
+
+  mbc_cleanup(&mbc);
+
+  TEST_ASSERT_NULL(memory_map.read[0x00]);
+  TEST_ASSERT_NULL(memory_map.read[0x7F]);
+  TEST_ASSERT_NULL(memory_map.read[0xA0]);
+  TEST_ASSERT_NULL(memory_map.write[0xA0]);
+}
@@ -0,0 +1,38 @@
+#include "vram_test_helper.h"
+
+#include <stdint.h>
+
+#include "bus_interface.h"
+#include "oam.h"
+#include "status_code.h"
+
+status_code_t stub_vram_read(void *const resource, uint16_t const address, uint8_t *const data)
+{
+  uint8_t const *const vram = (uint8_t const *)resource;
+  *data = vram[address - VRAM_BASE_ADDR];
+
+  return STATUS_OK;
+}
+
+status_code_t stub_vram_write(void *const resource, uint16_t const address, uint8_t const data)
+{
+  uint8_t *const vram = (uint8_t *)resource;
+  vram[address - VRAM_BASE_ADDR] = data;
+
+  return STATUS_OK;
+}
+
+status_code_t stub_blocked_read(void *const __attribute__((unused)) resource, uint16_t const __attribute__((unused)) address, uint8_t *const __attribute__((unused)) data)
+{
+  return STATUS_ERR_GENERIC;
+}
+
+void add_scanned_sprite(oam_scanned_sprites_t *const sprites, uint8_t const x_pos, uint8_t const y_pos, uint8_t const tile, uint8_t const attrs)
+{
+  oam_entry_t *const sprite = &sprites->sprite_attributes[sprites->sprite_count++];
+
+  sprite->x_pos = x_pos;
+  sprite->y_pos = y_pos;
+  sprite->tile = tile;
+  sprite->attrs = attrs;
+}
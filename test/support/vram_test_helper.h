@@ -0,0 +1,22 @@
+#ifndef __VRAM_TEST_HELPER_H__
+#define __VRAM_TEST_HELPER_H__
+
+#include <stdint.h>
+
+#include "bus_interface.h"
+#include "oam.h"
+#include "status_code.h"
+
+#define VRAM_BASE_ADDR (0x8000)
+#define VRAM_SIZE (0x2000)
+
+/** Bus stubs for a VRAM array of `VRAM_SIZE` bytes passed as the bus interface resource */
+status_code_t stub_vram_read(void *const resource, uint16_t const address, uint8_t *const data);
+status_code_t stub_vram_write(void *const resource, uint16_t const address, uint8_t const data);
+
+/** Bus read stub for VRAM that's blocked, e.g. during pixel transfer */
+status_code_t stub_blocked_read(void *const resource, uint16_t const address, uint8_t *const data);
+
+void add_scanned_sprite(oam_scanned_sprites_t *const sprites, uint8_t const x_pos, uint8_t const y_pos, uint8_t const tile, uint8_t const attrs);
+
+#endif /* __VRAM_TEST_HELPER_H__ */
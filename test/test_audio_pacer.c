@@ -0,0 +1,133 @@
+#include "unity.h"
+
+#include "audio_pacer.h"
+#include "status_code.h"
+
+TEST_FILE("audio_pacer.c")
+
+#define DEVICE_BUFFER_FRAMES (512)
+#define TARGET_BUFFERED_FRAMES (2 * DEVICE_BUFFER_FRAMES)
+#define LOW_LEVEL (TARGET_BUFFERED_FRAMES - DEVICE_BUFFER_FRAMES)
+
+static audio_pacer_t pacer;
+
+/** Update the pacer at the same fill level until the rate adjustment settles */
+static void settle(uint32_t const buffered_frames)
+{
+  bool paced = false;
+
+  for (uint16_t i = 0; i < 200; i++)
+  {
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, audio_pacer_update(&pacer, buffered_frames, &paced));
+    TEST_ASSERT_TRUE(paced);
+  }
+}
+
+void setUp(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, audio_pacer_init(&pacer, DEVICE_BUFFER_FRAMES));
+}
+
+void tearDown(void)
+{
+}
+
+void test_audio_pacer_null_ptr(void)
+{
+  bool paced;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, audio_pacer_init(NULL, DEVICE_BUFFER_FRAMES));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, audio_pacer_update(NULL, 0, &paced));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, audio_pacer_update(&pacer, 0, NULL));
+  TEST_ASSERT_FALSE(audio_pacer_must_wait(NULL, TARGET_BUFFERED_FRAMES + 1));
+}
+
+void test_audio_pacer_init(void)
+{
+  TEST_ASSERT_EQUAL_UINT32(DEVICE_BUFFER_FRAMES, pacer.device_buffer_frames);
+  TEST_ASSERT_EQUAL_UINT32(TARGET_BUFFERED_FRAMES, pacer.target_buffered_frames);
+  TEST_ASSERT_EQUAL_INT32(0, pacer.rate_adjust_ppm);
+}
+
+void test_audio_pacer_must_wait_above_target(void)
+{
+  TEST_ASSERT_FALSE(audio_pacer_must_wait(&pacer, 0));
+  TEST_ASSERT_FALSE(audio_pacer_must_wait(&pacer, TARGET_BUFFERED_FRAMES));
+  TEST_ASSERT_TRUE(audio_pacer_must_wait(&pacer, TARGET_BUFFERED_FRAMES + 1));
+  TEST_ASSERT_TRUE(audio_pacer_must_wait(&pacer, 2048));
+}
+
+void test_audio_pacer_nominal_rate_within_a_device_buffer_of_target(void)
+{
+  bool paced = false;
+
+  /* Draining a whole device buffer at a time leaves the fill level anywhere down to the low level */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, audio_pacer_update(&pacer, TARGET_BUFFERED_FRAMES, &paced));
+  TEST_ASSERT_TRUE(paced);
+  TEST_ASSERT_EQUAL_INT32(0, pacer.rate_adjust_ppm);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, audio_pacer_update(&pacer, LOW_LEVEL, &paced));
+  TEST_ASSERT_TRUE(paced);
+  TEST_ASSERT_EQUAL_INT32(0, pacer.rate_adjust_ppm);
+}
+
+void test_audio_pacer_rate_adjust_is_proportional_to_shortfall(void)
+{
+  bool paced = false;
+
+  /* The first update only goes an eighth of the way to the desired adjustment */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, audio_pacer_update(&pacer, 0, &paced));
+  TEST_ASSERT_TRUE(paced);
+  TEST_ASSERT_EQUAL_INT32(AUDIO_PACER_MAX_RATE_ADJUST_PPM / 8, pacer.rate_adjust_ppm);
+
+  /* An empty buffer settles at the largest adjustment */
+  settle(0);
+  TEST_ASSERT_EQUAL_INT32(AUDIO_PACER_MAX_RATE_ADJUST_PPM, pacer.rate_adjust_ppm);
+
+  /* Half way down from the low level settles at half of it */
+  settle(LOW_LEVEL / 2);
+  TEST_ASSERT_EQUAL_INT32(AUDIO_PACER_MAX_RATE_ADJUST_PPM / 2, pacer.rate_adjust_ppm);
+}
+
+void test_audio_pacer_rate_adjust_eases_back_to_nominal(void)
+{
+  int32_t previous_ppm;
+
+  settle(0);
+
+  /* Once the buffer has recovered, the adjustment shrinks on every frame without overshooting */
+  for (uint16_t i = 0; i < 100; i++)
+  {
+    bool paced = false;
+
+    previous_ppm = pacer.rate_adjust_ppm;
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, audio_pacer_update(&pacer, TARGET_BUFFERED_FRAMES, &paced));
+    TEST_ASSERT_TRUE(paced);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT32(0, pacer.rate_adjust_ppm);
+    TEST_ASSERT_LESS_OR_EQUAL_INT32(previous_ppm, pacer.rate_adjust_ppm);
+  }
+
+  TEST_ASSERT_EQUAL_INT32(0, pacer.rate_adjust_ppm);
+}
+
+void test_audio_pacer_without_audio_device(void)
+{
+  bool paced = true;
+
+  settle(0);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, audio_pacer_init(&pacer, 0));
+
+  /* Nothing drains the buffer, so the emulation is never held back by it */
+  TEST_ASSERT_FALSE(audio_pacer_must_wait(&pacer, 0));
+  TEST_ASSERT_FALSE(audio_pacer_must_wait(&pacer, 2048));
+
+  /* Frames are left to be paced some other way, at the nominal rate */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, audio_pacer_update(&pacer, 0, &paced));
+  TEST_ASSERT_FALSE(paced);
+  TEST_ASSERT_EQUAL_INT32(0, pacer.rate_adjust_ppm);
+
+  pacer.rate_adjust_ppm = 1000;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, audio_pacer_update(&pacer, 2048, &paced));
+  TEST_ASSERT_FALSE(paced);
+  TEST_ASSERT_EQUAL_INT32(0, pacer.rate_adjust_ppm);
+}
@@ -0,0 +1,128 @@
+#include "unity.h"
+#include <string.h>
+
+#include "blip_buffer.h"
+#include "status_code.h"
+
+TEST_FILE("blip_buffer.c")
+
+#define CLOCK_RATE (1048576)
+#define SAMPLE_RATE (32768) /** 32 clock cycles per sample */
+
+static blip_buffer_t blip_buffer;
+static int16_t samples[BLIP_BUFFER_SIZE];
+
+void setUp(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, blip_buffer_init(&blip_buffer, CLOCK_RATE, SAMPLE_RATE));
+}
+
+void tearDown(void)
+{
+}
+
+void test_blip_buffer_init_invalid_args(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, blip_buffer_init(NULL, CLOCK_RATE, SAMPLE_RATE));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, blip_buffer_init(&blip_buffer, CLOCK_RATE, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, blip_buffer_init(&blip_buffer, CLOCK_RATE, CLOCK_RATE + 1));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, blip_buffer_set_rate_adjust(NULL, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, blip_buffer_set_rate_adjust(&blip_buffer, BLIP_MAX_RATE_ADJUST_PPM + 1));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, blip_buffer_set_rate_adjust(&blip_buffer, -BLIP_MAX_RATE_ADJUST_PPM - 1));
+  TEST_ASSERT_EQUAL_UINT32(0, blip_buffer_read_samples(NULL, samples, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, blip_buffer_read_samples(&blip_buffer, NULL, 1));
+}
+
+void test_blip_buffer_samples_avail(void)
+{
+  blip_buffer_end_frame(&blip_buffer, 31);
+  TEST_ASSERT_EQUAL_UINT32(0, blip_buffer_samples_avail(&blip_buffer));
+
+  blip_buffer_end_frame(&blip_buffer, 1 + (32 * 99));
+  TEST_ASSERT_EQUAL_UINT32(100, blip_buffer_samples_avail(&blip_buffer));
+
+  TEST_ASSERT_EQUAL_UINT32(60, blip_buffer_read_samples(&blip_buffer, samples, 60));
+  TEST_ASSERT_EQUAL_UINT32(40, blip_buffer_samples_avail(&blip_buffer));
+  TEST_ASSERT_EQUAL_UINT32(40, blip_buffer_read_samples(&blip_buffer, samples, 60));
+  TEST_ASSERT_EQUAL_UINT32(0, blip_buffer_samples_avail(&blip_buffer));
+}
+
+void test_blip_buffer_fractional_ratio(void)
+{
+  uint32_t sample_count = 0;
+
+  /** 1048576 / 44100 isn't a whole number of clock cycles per sample */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, blip_buffer_init(&blip_buffer, CLOCK_RATE, 44100));
+
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    blip_buffer_end_frame(&blip_buffer, CLOCK_RATE / 256);
+    sample_count += blip_buffer_read_samples(&blip_buffer, samples, BLIP_BUFFER_SIZE);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(44100, sample_count);
+}
+
+void test_blip_buffer_rate_adjust(void)
+{
+  uint32_t sample_count = 0;
+
+  /** Pending samples are kept across the change */
+  blip_buffer_end_frame(&blip_buffer, 32 * 10);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, blip_buffer_set_rate_adjust(&blip_buffer, 1000));
+  TEST_ASSERT_EQUAL_UINT32(10, blip_buffer_samples_avail(&blip_buffer));
+
+  for (uint32_t i = 0; i < 256; i++)
+  {
+    blip_buffer_end_frame(&blip_buffer, CLOCK_RATE / 256);
+    sample_count += blip_buffer_read_samples(&blip_buffer, samples, BLIP_BUFFER_SIZE);
+  }
+
+  TEST_ASSERT_UINT32_WITHIN(1, 10 + SAMPLE_RATE + (SAMPLE_RATE / 1000), sample_count);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, blip_buffer_set_rate_adjust(&blip_buffer, -1000));
+  blip_buffer_end_frame(&blip_buffer, CLOCK_RATE / 32);
+  TEST_ASSERT_UINT32_WITHIN(1, (SAMPLE_RATE - (SAMPLE_RATE / 1000)) / 32, blip_buffer_samples_avail(&blip_buffer));
+}
+
+void test_blip_buffer_step_settles(void)
+{
+  /** A step in the middle of the frame, between two samples */
+  blip_buffer_add_delta(&blip_buffer, (32 * 10) + 13, 10000);
+  blip_buffer_end_frame(&blip_buffer, 32 * 64);
+  TEST_ASSERT_EQUAL_UINT32(64, blip_buffer_read_samples(&blip_buffer, samples, 64));
+
+  for (uint8_t i = 0; i < 10; i++)
+  {
+    TEST_ASSERT_EQUAL_INT16(0, samples[i]);
+  }
+
+  /** Past the kernel, only the slow decay of the high-pass filter is left */
+  for (uint8_t i = 10 + BLIP_KERNEL_WIDTH; i < 64; i++)
+  {
+    TEST_ASSERT_INT32_WITHIN(1000, 10000, samples[i]);
+    TEST_ASSERT_LESS_OR_EQUAL(samples[i - 1], samples[i]);
+  }
+}
+
+void test_blip_buffer_pulses_leave_no_lasting_offset(void)
+{
+  /** Short pulses starting at every phase between two samples */
+  for (uint8_t i = 0; i < 32; i++)
+  {
+    blip_buffer_add_delta(&blip_buffer, (i * 64) + i, 5000);
+    blip_buffer_add_delta(&blip_buffer, (i * 64) + i + 40, -5000);
+  }
+  blip_buffer_end_frame(&blip_buffer, 32 * 128);
+  TEST_ASSERT_EQUAL_UINT32(128, blip_buffer_read_samples(&blip_buffer, samples, 128));
+
+  /**
+   * Only what the high-pass filter took off the pulses remains, about the pulses' total area scaled
+   * down by the filter's time constant (32 pulses * 5000 * 40/32 samples / 512), slowly decaying back to 0
+   */
+  for (uint8_t i = 64 + BLIP_KERNEL_WIDTH; i < 128; i++)
+  {
+    TEST_ASSERT_INT32_WITHIN(100, -350, samples[i]);
+    TEST_ASSERT_GREATER_OR_EQUAL(samples[i - 1] - 2, samples[i]);
+  }
+}
@@ -0,0 +1,252 @@
+#include "unity.h"
+#include <string.h>
+
+#include "frame_buffer.h"
+#include "callback.h"
+#include "status_code.h"
+
+TEST_FILE("frame_buffer.c")
+
+static frame_buffer_t frame_buffer;
+static uint32_t frame_ready_count;
+
+static status_code_t stub_frame_ready(void *const ctx, const void *arg)
+{
+  TEST_ASSERT_EQUAL_PTR(&frame_buffer, ctx);
+  TEST_ASSERT_EQUAL_PTR(&frame_buffer, arg);
+  frame_ready_count++;
+  return STATUS_OK;
+}
+
+/** Draw a frame filled with the given value and publish it */
+static void draw_frame(uint32_t const value)
+{
+  video_buffer_t *const back = frame_buffer_back(&frame_buffer);
+
+  for (uint16_t i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++)
+  {
+    back->buffer[i] = value;
+  }
+
+  for (uint8_t y = 0; y < SCREEN_HEIGHT; y++)
+  {
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_hash_line(&frame_buffer, y));
+  }
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_publish(&frame_buffer));
+}
+
+void setUp(void)
+{
+  frame_ready_count = 0;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_init(&frame_buffer));
+}
+
+void tearDown(void)
+{
+}
+
+void test_frame_buffer_null_ptr(void)
+{
+  callback_t callback = {0};
+
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, frame_buffer_init(NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, frame_buffer_publish(NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, frame_buffer_register_ready_callback(NULL, &callback));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, frame_buffer_register_ready_callback(&frame_buffer, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NOT_INITIALIZED, frame_buffer_register_ready_callback(&frame_buffer, &callback));
+  TEST_ASSERT_NULL(frame_buffer_acquire(NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, frame_buffer_hash_line(NULL, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, frame_buffer_hash_line(&frame_buffer, SCREEN_HEIGHT));
+}
+
+void test_frame_buffer_line_hash_high_pixels_of_several_words(void)
+{
+  frame_t const *frame;
+  uint64_t line_hashes[SCREEN_HEIGHT];
+
+  draw_frame(0);
+  frame = frame_buffer_acquire(&frame_buffer);
+  memcpy(line_hashes, frame->line_hashes, sizeof(line_hashes));
+
+  /* The last pixels of two words only reach the top bits of the hash until they're folded back down */
+  video_buffer_t *const back = frame_buffer_back(&frame_buffer);
+  memset(back, 0, sizeof(video_buffer_t));
+  back->matrix[10][7] = 3;
+  back->matrix[10][31] = 1;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_hash_line(&frame_buffer, 10));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_publish(&frame_buffer));
+
+  frame = frame_buffer_acquire(&frame_buffer);
+  TEST_ASSERT_TRUE(frame->line_hashes[10] != line_hashes[10]);
+}
+
+void test_frame_buffer_find_changed_lines_null_ptr(void)
+{
+  frame_t const *const frame = &frame_buffer.frames[0];
+  uint16_t first_line;
+  uint16_t line_count;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, frame_buffer_find_changed_lines(NULL, NULL, 0, &first_line, &line_count));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, frame_buffer_find_changed_lines(frame, NULL, 0, NULL, &line_count));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, frame_buffer_find_changed_lines(frame, NULL, 0, &first_line, NULL));
+}
+
+void test_frame_buffer_acquire_latest_frame(void)
+{
+  frame_t const *frame;
+
+  /* Nothing has been published yet */
+  TEST_ASSERT_NULL(frame_buffer_acquire(&frame_buffer));
+
+  draw_frame(1);
+  frame = frame_buffer_acquire(&frame_buffer);
+  TEST_ASSERT_NOT_NULL(frame);
+  TEST_ASSERT_EQUAL_UINT32(1, frame->video_buffer.buffer[0]);
+
+  /* The same frame is not handed out twice */
+  TEST_ASSERT_NULL(frame_buffer_acquire(&frame_buffer));
+
+  /* Frames the display did not get around to are dropped */
+  draw_frame(2);
+  draw_frame(3);
+  draw_frame(4);
+  frame = frame_buffer_acquire(&frame_buffer);
+  TEST_ASSERT_NOT_NULL(frame);
+  TEST_ASSERT_EQUAL_UINT32(4, frame->video_buffer.buffer[0]);
+  TEST_ASSERT_EQUAL_UINT32(4, frame->video_buffer.buffer[(SCREEN_WIDTH * SCREEN_HEIGHT) - 1]);
+}
+
+void test_frame_buffer_presented_frame_is_not_drawn_over(void)
+{
+  draw_frame(1);
+  frame_t const *const frame = frame_buffer_acquire(&frame_buffer);
+
+  /* The PPU keeps drawing while the acquired frame is being presented */
+  for (uint32_t i = 2; i < 10; i++)
+  {
+    TEST_ASSERT_TRUE(frame_buffer_back(&frame_buffer) != &frame->video_buffer);
+    draw_frame(i);
+    TEST_ASSERT_EQUAL_UINT32(1, frame->video_buffer.buffer[0]);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(9, frame_buffer_acquire(&frame_buffer)->video_buffer.buffer[0]);
+}
+
+void test_frame_buffer_ready_callback(void)
+{
+  callback_t callback;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, callback_init(&callback, stub_frame_ready, &frame_buffer));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_register_ready_callback(&frame_buffer, &callback));
+
+  draw_frame(1);
+  draw_frame(2);
+  TEST_ASSERT_EQUAL_UINT32(2, frame_ready_count);
+}
+
+void test_frame_buffer_line_hashes(void)
+{
+  frame_t const *frame;
+  uint64_t line_hashes[SCREEN_HEIGHT];
+
+  draw_frame(1);
+  frame = frame_buffer_acquire(&frame_buffer);
+  memcpy(line_hashes, frame->line_hashes, sizeof(line_hashes));
+
+  /* Lines with the same pixels have the same hash */
+  TEST_ASSERT_EQUAL_UINT64(line_hashes[0], line_hashes[SCREEN_HEIGHT - 1]);
+
+  /* Redrawing the same frame into another buffer gives the same hashes */
+  draw_frame(1);
+  frame = frame_buffer_acquire(&frame_buffer);
+  TEST_ASSERT_EQUAL_MEMORY(line_hashes, frame->line_hashes, sizeof(line_hashes));
+
+  /* Only the hash of the modified line changes */
+  video_buffer_t *const back = frame_buffer_back(&frame_buffer);
+  memcpy(back, &frame->video_buffer, sizeof(video_buffer_t));
+  back->matrix[42][SCREEN_WIDTH - 1] = 2;
+  for (uint8_t y = 0; y < SCREEN_HEIGHT; y++)
+  {
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_hash_line(&frame_buffer, y));
+  }
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_publish(&frame_buffer));
+
+  frame = frame_buffer_acquire(&frame_buffer);
+  for (uint8_t y = 0; y < SCREEN_HEIGHT; y++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(y != 42, frame->line_hashes[y] == line_hashes[y]);
+  }
+}
+
+void test_frame_buffer_find_changed_lines_without_presented_lines(void)
+{
+  frame_t const *const frame = &frame_buffer.frames[0];
+  uint16_t first_line;
+  uint16_t line_count;
+
+  /* Nothing has been presented yet, so the whole frame is a single run */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_find_changed_lines(frame, NULL, 0, &first_line, &line_count));
+  TEST_ASSERT_EQUAL_UINT16(0, first_line);
+  TEST_ASSERT_EQUAL_UINT16(SCREEN_HEIGHT, line_count);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_find_changed_lines(frame, NULL, 100, &first_line, &line_count));
+  TEST_ASSERT_EQUAL_UINT16(100, first_line);
+  TEST_ASSERT_EQUAL_UINT16(SCREEN_HEIGHT - 100, line_count);
+}
+
+void test_frame_buffer_find_changed_lines_unchanged_frame(void)
+{
+  frame_t const *const frame = &frame_buffer.frames[0];
+  uint16_t first_line = 0;
+  uint16_t line_count = 0;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_find_changed_lines(frame, frame->line_hashes, 0, &first_line, &line_count));
+  TEST_ASSERT_EQUAL_UINT16(SCREEN_HEIGHT, first_line);
+  TEST_ASSERT_EQUAL_UINT16(0, line_count);
+
+  /* Starting past the last line finds nothing either */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_find_changed_lines(frame, NULL, SCREEN_HEIGHT, &first_line, &line_count));
+  TEST_ASSERT_EQUAL_UINT16(SCREEN_HEIGHT, first_line);
+  TEST_ASSERT_EQUAL_UINT16(0, line_count);
+}
+
+void test_frame_buffer_find_changed_lines_runs(void)
+{
+  frame_t const *const frame = &frame_buffer.frames[0];
+  uint64_t line_hashes[SCREEN_HEIGHT];
+  uint16_t first_line = 0;
+  uint16_t line_count = 0;
+
+  memcpy(line_hashes, frame->line_hashes, sizeof(line_hashes));
+
+  /* A run at each end of the frame, one in the middle, and a single line */
+  for (uint16_t line = 0; line < 3; line++)
+  {
+    line_hashes[line]++;
+  }
+  for (uint16_t line = 40; line < 50; line++)
+  {
+    line_hashes[line]++;
+  }
+  line_hashes[100]++;
+  line_hashes[SCREEN_HEIGHT - 1]++;
+
+  uint16_t const expected_runs[][2] = {{0, 3}, {40, 10}, {100, 1}, {SCREEN_HEIGHT - 1, 1}};
+
+  for (uint8_t i = 0; i < sizeof(expected_runs) / sizeof(expected_runs[0]); i++)
+  {
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_find_changed_lines(frame, line_hashes, first_line + line_count, &first_line, &line_count));
+    TEST_ASSERT_EQUAL_UINT16(expected_runs[i][0], first_line);
+    TEST_ASSERT_EQUAL_UINT16(expected_runs[i][1], line_count);
+  }
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_find_changed_lines(frame, line_hashes, first_line + line_count, &first_line, &line_count));
+  TEST_ASSERT_EQUAL_UINT16(SCREEN_HEIGHT, first_line);
+  TEST_ASSERT_EQUAL_UINT16(0, line_count);
+
+  /* Starting in the middle of a run only finds the rest of it */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, frame_buffer_find_changed_lines(frame, line_hashes, 45, &first_line, &line_count));
+  TEST_ASSERT_EQUAL_UINT16(45, first_line);
+  TEST_ASSERT_EQUAL_UINT16(5, line_count);
+}
@@ -0,0 +1,101 @@
+#include "unity.h"
+#include <string.h>
+
+#include "lcd.h"
+#include "bus_interface.h"
+#include "color.h"
+#include "status_code.h"
+
+TEST_FILE("lcd.c")
+
+#define BGP_OFFSET (0x0007)
+#define OBP0_OFFSET (0x0008)
+#define OBP1_OFFSET (0x0009)
+
+static lcd_handle_t lcd;
+
+/** Indexed pixel value of a shade of a palette */
+#define PIXEL(palette, shade) (((palette) << LCD_PIXEL_PALETTE_SHIFT) | (shade))
+
+void setUp(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, lcd_init(&lcd));
+}
+
+void tearDown(void)
+{
+}
+
+void test_lcd_null_ptr(void)
+{
+  color_rgba_t color;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, lcd_init(NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, lcd_update_palettes(NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, lcd_get_palette_color(NULL, PALETTE_BGW, 0, &color));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, lcd_get_palette_color(&lcd, PALETTE_BGW, 0, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, lcd_get_pixel_colors(NULL));
+}
+
+void test_lcd_get_palette_color_invalid_arg(void)
+{
+  color_rgba_t color;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, lcd_get_palette_color(&lcd, PALETTE_BGW, 4, &color));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, lcd_get_palette_color(&lcd, (palette_type_t)(PALETTE_OBJ_1 + 1), 0, &color));
+}
+
+void test_lcd_init_palettes(void)
+{
+  /* BGP = 0xFC, OBP-0 = OBP-1 = 0xFF */
+  TEST_ASSERT_EQUAL_UINT8(PIXEL(PALETTE_BGW, 0), lcd_palette_pixel(&lcd, PALETTE_BGW, 0));
+  TEST_ASSERT_EQUAL_UINT8(PIXEL(PALETTE_BGW, 3), lcd_palette_pixel(&lcd, PALETTE_BGW, 1));
+
+  for (uint8_t i = 0; i < LCD_COLORS_PER_PALETTE; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(PIXEL(PALETTE_OBJ_0, 3), lcd_palette_pixel(&lcd, PALETTE_OBJ_0, i));
+    TEST_ASSERT_EQUAL_UINT8(PIXEL(PALETTE_OBJ_1, 3), lcd_palette_pixel(&lcd, PALETTE_OBJ_1, i));
+  }
+}
+
+void test_lcd_palette_write_rebuilds_lut(void)
+{
+  color_rgba_t color;
+  uint32_t colors[LCD_NUM_PIXEL_VALUES];
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, lcd_get_pixel_colors(colors));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&lcd.bus_interface, BGP_OFFSET, 0x1B));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&lcd.bus_interface, OBP0_OFFSET, 0xE4));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&lcd.bus_interface, OBP1_OFFSET, 0x4E));
+
+  TEST_ASSERT_EQUAL_HEX8(0x1B, lcd.registers.bg_palette);
+  TEST_ASSERT_EQUAL_HEX8(0xE4, lcd.registers.obj_palette_0);
+  TEST_ASSERT_EQUAL_HEX8(0x4E, lcd.registers.obj_palette_1);
+
+  for (uint8_t i = 0; i < LCD_COLORS_PER_PALETTE; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(PIXEL(PALETTE_BGW, 3 - i), lcd_palette_pixel(&lcd, PALETTE_BGW, i));
+    TEST_ASSERT_EQUAL_UINT8(PIXEL(PALETTE_OBJ_0, i), lcd_palette_pixel(&lcd, PALETTE_OBJ_0, i));
+    TEST_ASSERT_EQUAL_UINT8(PIXEL(PALETTE_OBJ_1, (0x4E >> (i * 2)) & 0x3), lcd_palette_pixel(&lcd, PALETTE_OBJ_1, i));
+
+    /* The color of an indexed pixel only depends on its shade */
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, lcd_get_palette_color(&lcd, PALETTE_BGW, i, &color));
+    TEST_ASSERT_EQUAL_UINT32(colors[PIXEL(PALETTE_OBJ_1, 3 - i)], color.as_hex);
+  }
+}
+
+void test_lcd_update_palettes_after_direct_register_write(void)
+{
+  lcd.registers.bg_palette = 0xE4;
+
+  /* The lookup table is stale until it's rebuilt */
+  TEST_ASSERT_EQUAL_UINT8(PIXEL(PALETTE_BGW, 3), lcd_palette_pixel(&lcd, PALETTE_BGW, 1));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, lcd_update_palettes(&lcd));
+
+  for (uint8_t i = 0; i < LCD_COLORS_PER_PALETTE; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(PIXEL(PALETTE_BGW, i), lcd_palette_pixel(&lcd, PALETTE_BGW, i));
+  }
+}
@@ -0,0 +1,159 @@
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+
+#include "oam.h"
+#include "bus_interface.h"
+#include "status_code.h"
+
+TEST_FILE("oam.c")
+
+static oam_handle_t oam;
+static oam_scanned_sprites_t scan_results;
+
+static void write_sprite(uint8_t const index, uint8_t const y_pos, uint8_t const x_pos)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&oam.bus_interface, (index * 4) + 0, y_pos));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&oam.bus_interface, (index * 4) + 1, x_pos));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&oam.bus_interface, (index * 4) + 2, index));
+}
+
+/** Straightforward scan to check the results against: first 10 sprites in OAM order, then stable sorted by X */
+static void reference_scan(uint8_t const line_y, obj_size_t const sprite_size, oam_scanned_sprites_t *const expected)
+{
+  memset(expected, 0, sizeof(oam_scanned_sprites_t));
+
+  for (uint8_t i = 0; (i < OAM_ENTRY_SIZE) && (expected->sprite_count < MAX_SPRITES_PER_LINE); i++)
+  {
+    oam_entry_t const *const entry = &oam.entries[i];
+
+    if ((entry->y_pos <= line_y + 16) && (entry->y_pos + (int)sprite_size > line_y + 16) && (entry->x_pos != 0))
+    {
+      uint8_t j = expected->sprite_count++;
+
+      while ((j > 0) && (expected->sprite_attributes[j - 1].x_pos > entry->x_pos))
+      {
+        expected->sprite_attributes[j] = expected->sprite_attributes[j - 1];
+        j--;
+      }
+      expected->sprite_attributes[j] = *entry;
+    }
+  }
+}
+
+static void assert_scan_matches_reference(uint8_t const line_y, obj_size_t const sprite_size)
+{
+  oam_scanned_sprites_t expected;
+
+  reference_scan(line_y, sprite_size, &expected);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, oam_scan(&oam, line_y, sprite_size, &scan_results));
+  TEST_ASSERT_EQUAL_MEMORY(&expected, &scan_results, sizeof(oam_scanned_sprites_t));
+}
+
+void setUp(void)
+{
+  memset(&scan_results, 0, sizeof(scan_results));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, oam_init(&oam));
+}
+
+void tearDown(void)
+{
+}
+
+void test_oam_scan_invalid_args(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, oam_scan(NULL, 0, OBJ_SIZE_SMALL, &scan_results));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, oam_scan(&oam, 0, OBJ_SIZE_SMALL, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, oam_scan(&oam, 0, (obj_size_t)12, &scan_results));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, oam_invalidate_scan_index(NULL));
+}
+
+void test_oam_scan_sorted_and_limited(void)
+{
+  /* 12 sprites on line 0. Sprite 3 is at X = 0 and does not count; sprite 11 is over the limit. */
+  for (uint8_t i = 0; i < 12; i++)
+  {
+    write_sprite(i, 16, 100 - (i % 4) * 10);
+  }
+  write_sprite(3, 16, 0);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, oam_scan(&oam, 0, OBJ_SIZE_SMALL, &scan_results));
+  TEST_ASSERT_EQUAL_INT(MAX_SPRITES_PER_LINE, scan_results.sprite_count);
+
+  /* X = 80: 2, 6, 10; X = 90: 1, 5, 9; X = 100: 0, 4, 8; X = 70: 7 */
+  uint8_t const expected_tiles[MAX_SPRITES_PER_LINE] = {7, 2, 6, 10, 1, 5, 9, 0, 4, 8};
+
+  for (uint8_t i = 0; i < MAX_SPRITES_PER_LINE; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(expected_tiles[i], scan_results.sprite_attributes[i].tile);
+  }
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, oam_scan(&oam, 8, OBJ_SIZE_SMALL, &scan_results));
+  TEST_ASSERT_EQUAL_INT(0, scan_results.sprite_count);
+
+  /* Tall sprites reach line 8 */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, oam_scan(&oam, 0, OBJ_SIZE_LARGE, &scan_results));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, oam_scan(&oam, 8, OBJ_SIZE_LARGE, &scan_results));
+  TEST_ASSERT_EQUAL_INT(MAX_SPRITES_PER_LINE, scan_results.sprite_count);
+}
+
+void test_oam_scan_index_rebuilt_once_per_frame(void)
+{
+  write_sprite(0, 16, 8);
+  assert_scan_matches_reference(0, OBJ_SIZE_SMALL);
+  TEST_ASSERT_FALSE(oam.scan_index.dirty);
+
+  /* Writing the same values back doesn't invalidate the index */
+  write_sprite(0, 16, 8);
+  TEST_ASSERT_FALSE(oam.scan_index.dirty);
+
+  /* A mid-frame change is picked up by the following lines */
+  write_sprite(1, 20, 8);
+  TEST_ASSERT_TRUE(oam.scan_index.dirty);
+  assert_scan_matches_reference(4, OBJ_SIZE_SMALL);
+  TEST_ASSERT_EQUAL_INT(2, scan_results.sprite_count);
+  TEST_ASSERT_TRUE(oam.scan_index.dirty);
+
+  /* The index is rebuilt at the start of the next frame */
+  assert_scan_matches_reference(0, OBJ_SIZE_SMALL);
+  TEST_ASSERT_FALSE(oam.scan_index.dirty);
+  assert_scan_matches_reference(4, OBJ_SIZE_SMALL);
+}
+
+void test_oam_invalidate_scan_index(void)
+{
+  assert_scan_matches_reference(0, OBJ_SIZE_SMALL);
+
+  oam.entries[5] = (oam_entry_t){.y_pos = 30, .x_pos = 50, .tile = 5, .attrs = 0};
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, oam_invalidate_scan_index(&oam));
+
+  assert_scan_matches_reference(14, OBJ_SIZE_SMALL);
+  TEST_ASSERT_EQUAL_INT(1, scan_results.sprite_count);
+}
+
+void test_oam_scan_matches_full_scan(void)
+{
+  srand(0x0A4);
+
+  for (uint8_t frame = 0; frame < 20; frame++)
+  {
+    obj_size_t const sprite_size = (frame & 1) ? OBJ_SIZE_LARGE : OBJ_SIZE_SMALL;
+
+    /* Crowd the sprites together so that the 10 sprite limit is reached */
+    for (uint8_t i = 0; i < OAM_ENTRY_SIZE; i++)
+    {
+      write_sprite(i, rand() % 64, rand() % 40);
+    }
+
+    for (uint8_t line_y = 0; line_y < 154; line_y++)
+    {
+      /* Change OAM in the middle of some of the frames */
+      if ((frame % 3 == 0) && (line_y == 20))
+      {
+        write_sprite(rand() % OAM_ENTRY_SIZE, 16 + line_y, 20);
+      }
+
+      assert_scan_matches_reference(line_y, sprite_size);
+    }
+  }
+}
@@ -0,0 +1,203 @@
+#include "unity.h"
+#include <string.h>
+
+#include "pixel_fetcher.h"
+#include "bus_interface.h"
+#include "lcd.h"
+#include "oam.h"
+#include "pixel_kernels.h"
+#include "status_code.h"
+#include "tile_cache.h"
+#include "vram_test_helper.h"
+
+TEST_FILE("pixel_fetcher.c")
+
+static uint8_t vram[VRAM_SIZE];
+static bus_interface_t bus_interface;
+static lcd_handle_t lcd;
+static pixel_fetcher_state_t fetcher_state;
+static pixel_fetcher_context_t ctx;
+
+/** Set every row of a tile to the given bit planes */
+static void fill_tile(uint8_t const tile, uint8_t const data_low, uint8_t const data_high)
+{
+  for (uint8_t i = 0; i < 16; i += 2)
+  {
+    vram[(tile * 16) + i] = data_low;
+    vram[(tile * 16) + i + 1] = data_high;
+  }
+}
+
+void setUp(void)
+{
+  memset(vram, 0, sizeof(vram));
+  memset(&fetcher_state, 0, sizeof(fetcher_state));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_init(&bus_interface, stub_vram_read, stub_vram_write, vram));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, lcd_init(&lcd));
+
+  /* Sprites at Y = 16 cover line 0 */
+  lcd.registers.ly = 0;
+
+  ctx = (pixel_fetcher_context_t){
+      .fetcher_state = &fetcher_state,
+      .lcd_handle = &lcd,
+      .bus_interface = &bus_interface,
+  };
+}
+
+void tearDown(void)
+{
+}
+
+void test_fetch_sprite_row_null_ptr(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, fetch_sprite_row(NULL));
+
+  ctx.lcd_handle = NULL;
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, fetch_sprite_row(&ctx));
+}
+
+void test_fetch_sprite_row_no_sprites(void)
+{
+  memset(fetcher_state.sprite_row, 0xFF, sizeof(fetcher_state.sprite_row));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_sprite_row(&ctx));
+
+  for (uint8_t x = 0; x < SCREEN_WIDTH; x++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(0, fetcher_state.sprite_row[x].pixel_color);
+  }
+}
+
+void test_fetch_sprite_row_attributes(void)
+{
+  /* Color 1 on the left half, color 2 on the right half */
+  fill_tile(1, 0xF0, 0x0F);
+
+  add_scanned_sprite(&fetcher_state.oam_scanned_sprites, 8, 16, 1, OAM_ATTR_DMG_PALETTE_NUM | OAM_ATTR_BG_PRIORITY);
+  add_scanned_sprite(&fetcher_state.oam_scanned_sprites, 28, 16, 1, OAM_ATTR_X_FLIP);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_sprite_row(&ctx));
+
+  for (uint8_t px = 0; px < 8; px++)
+  {
+    TEST_ASSERT_EQUAL_UINT8((px < 4) ? 1 : 2, fetcher_state.sprite_row[px].pixel_color);
+    TEST_ASSERT_EQUAL_INT(PALETTE_OBJ_1, fetcher_state.sprite_row[px].palette);
+    TEST_ASSERT_TRUE(fetcher_state.sprite_row[px].bg_priority);
+
+    TEST_ASSERT_EQUAL_UINT8((px < 4) ? 2 : 1, fetcher_state.sprite_row[20 + px].pixel_color);
+    TEST_ASSERT_EQUAL_INT(PALETTE_OBJ_0, fetcher_state.sprite_row[20 + px].palette);
+    TEST_ASSERT_FALSE(fetcher_state.sprite_row[20 + px].bg_priority);
+  }
+
+  TEST_ASSERT_EQUAL_UINT8(0, fetcher_state.sprite_row[8].pixel_color);
+  TEST_ASSERT_EQUAL_UINT8(0, fetcher_state.sprite_row[19].pixel_color);
+}
+
+void test_fetch_sprite_row_priority(void)
+{
+  /* Tile 1 is opaque (color 3) on the left half only; tile 2 is color 1 throughout */
+  fill_tile(1, 0xF0, 0xF0);
+  fill_tile(2, 0xFF, 0x00);
+
+  /* Scan results are in priority order: the first sprite wins where it is opaque */
+  add_scanned_sprite(&fetcher_state.oam_scanned_sprites, 40, 16, 1, 0);
+  add_scanned_sprite(&fetcher_state.oam_scanned_sprites, 44, 16, 2, OAM_ATTR_DMG_PALETTE_NUM);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_sprite_row(&ctx));
+
+  for (uint8_t x = 32; x < 36; x++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(3, fetcher_state.sprite_row[x].pixel_color);
+    TEST_ASSERT_EQUAL_INT(PALETTE_OBJ_0, fetcher_state.sprite_row[x].palette);
+  }
+
+  /* The second sprite shows through the transparent half of the first one */
+  for (uint8_t x = 36; x < 44; x++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(1, fetcher_state.sprite_row[x].pixel_color);
+    TEST_ASSERT_EQUAL_INT(PALETTE_OBJ_1, fetcher_state.sprite_row[x].palette);
+  }
+}
+
+void test_fetch_sprite_row_clipped_and_flipped(void)
+{
+  /* Only the last row of the tile is opaque */
+  vram[(3 * 16) + 14] = 0xFF;
+
+  /* Partially off the left and right edges of the screen */
+  add_scanned_sprite(&fetcher_state.oam_scanned_sprites, 4, 16, 3, OAM_ATTR_Y_FLIP);
+  add_scanned_sprite(&fetcher_state.oam_scanned_sprites, 164, 16, 3, OAM_ATTR_Y_FLIP);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_sprite_row(&ctx));
+
+  for (uint8_t x = 0; x < 4; x++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(1, fetcher_state.sprite_row[x].pixel_color);
+    TEST_ASSERT_EQUAL_UINT8(1, fetcher_state.sprite_row[SCREEN_WIDTH - 4 + x].pixel_color);
+  }
+
+  TEST_ASSERT_EQUAL_UINT8(0, fetcher_state.sprite_row[4].pixel_color);
+  TEST_ASSERT_EQUAL_UINT8(0, fetcher_state.sprite_row[SCREEN_WIDTH - 5].pixel_color);
+}
+
+void test_fetch_sprite_row_same_with_tile_cache(void)
+{
+  static tile_cache_t tile_cache;
+  sprite_row_pixel_t expected[SCREEN_WIDTH];
+
+  for (uint16_t i = 0; i < VRAM_SIZE; i++)
+  {
+    vram[i] = (i * 37) ^ (i >> 3);
+  }
+
+  lcd.registers.lcd_ctrl |= LCD_CTRL_OBJ_SIZE;
+  lcd.registers.ly = 5;
+
+  for (uint8_t i = 0; i < MAX_SPRITES_PER_LINE; i++)
+  {
+    add_scanned_sprite(&fetcher_state.oam_scanned_sprites, i * 17, 16 - (i % 3) * 4, i * 23, (i * 0x30) & 0xF0);
+  }
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_sprite_row(&ctx));
+  memcpy(expected, fetcher_state.sprite_row, sizeof(expected));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, tile_cache_init(&tile_cache, vram));
+  ctx.tile_cache = &tile_cache;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_sprite_row(&ctx));
+  TEST_ASSERT_EQUAL_MEMORY(expected, fetcher_state.sprite_row, sizeof(expected));
+}
+
+void test_fetch_sprite_row_reads_vram_directly(void)
+{
+  bus_interface_t blocked_bus_interface;
+  sprite_row_pixel_t expected[SCREEN_WIDTH];
+
+  fill_tile(1, 0xF0, 0x0F);
+  add_scanned_sprite(&fetcher_state.oam_scanned_sprites, 8, 16, 1, OAM_ATTR_X_FLIP);
+  add_scanned_sprite(&fetcher_state.oam_scanned_sprites, 60, 16, 1, OAM_ATTR_DMG_PALETTE_NUM);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_sprite_row(&ctx));
+  memcpy(expected, fetcher_state.sprite_row, sizeof(expected));
+
+  /* The bus is never used once the fetcher has a pointer to VRAM */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_init(&blocked_bus_interface, stub_blocked_read, stub_vram_write, vram));
+  ctx.bus_interface = &blocked_bus_interface;
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_GENERIC, fetch_sprite_row(&ctx));
+
+  ctx.vram = vram;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_sprite_row(&ctx));
+  TEST_ASSERT_EQUAL_MEMORY(expected, fetcher_state.sprite_row, sizeof(expected));
+
+  /* Tile numbers and tile data come from VRAM as well */
+  lcd.registers.lcd_ctrl |= LCD_CTRL_BGW_EN | LCD_CTRL_BGW_TILE_DATA;
+  vram[0x9800 - VRAM_BASE_ADDR] = 1;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_tile_number(&ctx));
+  TEST_ASSERT_EQUAL_UINT8(1, fetcher_state.bgw_tile_data.tile_num);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_tile_data(&ctx, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, fetch_tile_data(&ctx, 1));
+  TEST_ASSERT_EQUAL_HEX8(0xF0, fetcher_state.bgw_tile_data.tile_data_low);
+  TEST_ASSERT_EQUAL_HEX8(0x0F, fetcher_state.bgw_tile_data.tile_data_high);
+}
@@ -0,0 +1,164 @@
+#include "unity.h"
+#include <string.h>
+
+#include "pixel_fifo.h"
+#include "pixel_fetcher.h"
+#include "bus_interface.h"
+#include "lcd.h"
+#include "oam.h"
+#include "pixel_kernels.h"
+#include "status_code.h"
+#include "tile_cache.h"
+#include "vram_test_helper.h"
+
+TEST_FILE("pixel_fifo.c")
+
+static pxfifo_buffer_t fifo;
+
+/** Give each pixel a distinct color and palette so that its position in the FIFO can be told apart */
+static pxfifo_item_t make_item(uint8_t const index)
+{
+  return (pxfifo_item_t){
+      .pixel_color = index & 0x3,
+      .palette = (palette_type_t)((index >> 2) % 3),
+  };
+}
+
+static void assert_item_equal(pxfifo_item_t const expected, pxfifo_item_t const actual)
+{
+  TEST_ASSERT_EQUAL_UINT8(expected.pixel_color, actual.pixel_color);
+  TEST_ASSERT_EQUAL_INT(expected.palette, actual.palette);
+}
+
+void setUp(void)
+{
+  memset(&fifo, 0xA5, sizeof(fifo));
+  pxfifo_buffer_flush(&fifo);
+}
+
+void tearDown(void)
+{
+}
+
+void test_pixel_fifo_buffer_flush(void)
+{
+  for (uint8_t i = 0; i < 5; i++)
+  {
+    pxfifo_buffer_push(&fifo, make_item(i));
+  }
+  pxfifo_buffer_pop(&fifo);
+
+  pxfifo_buffer_flush(&fifo);
+  TEST_ASSERT_EQUAL_UINT8(0, fifo.size);
+  TEST_ASSERT_EQUAL_UINT8(0, fifo.head);
+
+  /* Pixels pushed after a flush come out first */
+  pxfifo_buffer_push(&fifo, make_item(9));
+  assert_item_equal(make_item(9), pxfifo_buffer_pop(&fifo));
+  TEST_ASSERT_EQUAL_UINT8(0, fifo.size);
+}
+
+void test_pixel_fifo_buffer_fill_and_drain(void)
+{
+  /* Filled up to its capacity, every pixel is kept */
+  for (uint8_t i = 0; i < PXFIFO_CAPACITY; i++)
+  {
+    pxfifo_buffer_push(&fifo, make_item(i));
+    TEST_ASSERT_EQUAL_UINT8(i + 1, fifo.size);
+  }
+
+  for (uint8_t i = 0; i < PXFIFO_CAPACITY; i++)
+  {
+    assert_item_equal(make_item(i), pxfifo_buffer_pop(&fifo));
+    TEST_ASSERT_EQUAL_UINT8(PXFIFO_CAPACITY - 1 - i, fifo.size);
+  }
+
+  /* Drained, it can be filled up again from where it left off */
+  for (uint8_t i = 0; i < PXFIFO_CAPACITY; i++)
+  {
+    pxfifo_buffer_push(&fifo, make_item(i + 1));
+  }
+  TEST_ASSERT_EQUAL_UINT8(PXFIFO_CAPACITY, fifo.size);
+
+  for (uint8_t i = 0; i < PXFIFO_CAPACITY; i++)
+  {
+    assert_item_equal(make_item(i + 1), pxfifo_buffer_pop(&fifo));
+  }
+  TEST_ASSERT_EQUAL_UINT8(0, fifo.size);
+}
+
+void test_pixel_fifo_buffer_wrap_around(void)
+{
+  uint8_t pushed = 0;
+  uint8_t popped = 0;
+
+  /* Push a tile's worth and pop half as the PPU does, so that the pixels wrap around the storage many times */
+  for (uint16_t round = 0; round < 100; round++)
+  {
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      pxfifo_buffer_push(&fifo, make_item(pushed++));
+    }
+
+    while (fifo.size > 8)
+    {
+      assert_item_equal(make_item(popped++), pxfifo_buffer_pop(&fifo));
+    }
+  }
+
+  TEST_ASSERT_EQUAL_UINT8(8, fifo.size);
+  TEST_ASSERT_EQUAL_UINT8((uint8_t)(pushed - popped), fifo.size);
+}
+
+void test_pixel_fifo_buffer_head_counter_overflow(void)
+{
+  /* The head is a free-running counter, so the FIFO has to keep working once it overflows */
+  fifo.head = UINT8_MAX - 2;
+
+  for (uint8_t i = 0; i < PXFIFO_CAPACITY; i++)
+  {
+    pxfifo_buffer_push(&fifo, make_item(i));
+  }
+
+  for (uint8_t i = 0; i < PXFIFO_CAPACITY; i++)
+  {
+    assert_item_equal(make_item(i), pxfifo_buffer_pop(&fifo));
+  }
+
+  TEST_ASSERT_EQUAL_UINT8(0, fifo.size);
+  TEST_ASSERT_EQUAL_UINT8((uint8_t)(UINT8_MAX - 2 + PXFIFO_CAPACITY), fifo.head);
+}
+
+void test_pixel_fifo_init_and_reset_flush_the_buffer(void)
+{
+  static uint8_t vram[VRAM_SIZE];
+  pxfifo_handle_t pxfifo;
+  bus_interface_t bus_interface;
+  lcd_handle_t lcd;
+
+  memset(&pxfifo, 0, sizeof(pxfifo));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, lcd_init(&lcd));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_init(&bus_interface, stub_vram_read, stub_vram_write, vram));
+
+  pxfifo_init_param_t param = {
+      .bus_interface = &bus_interface,
+      .lcd = &lcd,
+  };
+
+  pxfifo.bg_fifo.head = 7;
+  pxfifo.bg_fifo.size = 5;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, pxfifo_init(&pxfifo, &param));
+  TEST_ASSERT_EQUAL_UINT8(0, pxfifo.bg_fifo.size);
+  TEST_ASSERT_EQUAL_UINT8(0, pxfifo.bg_fifo.head);
+
+  /* No sprites on the line, so that the reset doesn't fetch any */
+  pxfifo.pixel_fetcher.oam_scanned_sprites.sprite_count = 0;
+
+  for (uint8_t i = 0; i < 9; i++)
+  {
+    pxfifo_buffer_push(&pxfifo.bg_fifo, make_item(i));
+  }
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, pxfifo_reset(&pxfifo));
+  TEST_ASSERT_EQUAL_UINT8(0, pxfifo.bg_fifo.size);
+  TEST_ASSERT_EQUAL_UINT8(0, pxfifo.bg_fifo.head);
+}
@@ -0,0 +1,132 @@
+#include "unity.h"
+#include <string.h>
+#include <stdlib.h>
+
+#include "pixel_kernels.h"
+#include "status_code.h"
+
+TEST_FILE("pixel_kernels.c")
+
+#define LINE_WIDTH (160)
+
+static const pixel_kernels_isa_t all_isas[] = {
+    PIXEL_KERNELS_ISA_SCALAR,
+    PIXEL_KERNELS_ISA_SSE2,
+    PIXEL_KERNELS_ISA_AVX2,
+};
+
+static const uint8_t palette[4] = {0x4, 0x6, 0x5, 0x7};
+static const uint32_t colors[16] = {
+    0xFFD0FDE0, 0xFF70C088, 0xFF566834, 0xFF201808,
+    0xFFD0FDE1, 0xFF70C089, 0xFF566835, 0xFF201809,
+    0xFFD0FDE2, 0xFF70C08A, 0xFF566836, 0xFF20180A,
+    0xFFD0FDE3, 0xFF70C08B, 0xFF566837, 0xFF20180B};
+
+void setUp(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, pixel_kernels_select(PIXEL_KERNELS_ISA_SCALAR));
+}
+
+void tearDown(void)
+{
+}
+
+void test_pixel_kernels_select(void)
+{
+  TEST_ASSERT_EQUAL_INT(PIXEL_KERNELS_ISA_SCALAR, pixel_kernels_isa());
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_UNSUPPORTED, pixel_kernels_select((pixel_kernels_isa_t)-1));
+  TEST_ASSERT_EQUAL_INT(PIXEL_KERNELS_ISA_SCALAR, pixel_kernels_isa());
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, pixel_kernels_init());
+}
+
+void test_pixel_kernels_decode_tile_row(void)
+{
+  uint8_t pixels[8];
+  uint8_t const expected[8] = {1, 0, 3, 0, 0, 0, 2, 2};
+  uint8_t const expected_flipped[8] = {2, 2, 0, 0, 0, 3, 0, 1};
+
+  pixel_kernels_decode_tile_row(0xA0, 0x23, false, pixels);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, pixels, 8);
+
+  pixel_kernels_decode_tile_row(0xA0, 0x23, true, pixels);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_flipped, pixels, 8);
+}
+
+void test_pixel_kernels_map_palette(void)
+{
+  uint8_t const indices[6] = {0, 1, 2, 3, 0xFE, 0x07};
+  uint8_t pixels[6];
+  uint8_t const expected[6] = {palette[0], palette[1], palette[2], palette[3], palette[2], palette[3]};
+
+  pixel_kernels_map_palette(indices, palette, pixels, 6);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, pixels, 6);
+}
+
+void test_pixel_kernels_expand_pixels(void)
+{
+  uint8_t const pixels[6] = {0x0, 0x5, 0xA, 0xF, 0x13, 0xFC};
+  uint32_t rgba[6];
+  uint32_t const expected[6] = {colors[0x0], colors[0x5], colors[0xA], colors[0xF], colors[0x3], colors[0xC]};
+
+  pixel_kernels_expand_pixels(pixels, colors, rgba, 6);
+  TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, rgba, 6);
+}
+
+void test_pixel_kernels_simd_matches_scalar(void)
+{
+  uint8_t indices[LINE_WIDTH];
+  uint8_t line_pixels[LINE_WIDTH];
+  uint8_t expected_pixels[256][2][8];
+  uint8_t expected_line_pixels[LINE_WIDTH];
+  uint32_t expected_rgba[LINE_WIDTH];
+
+  srand(0x2BB);
+  for (uint16_t i = 0; i < LINE_WIDTH; i++)
+  {
+    indices[i] = rand() & 0x3;
+    line_pixels[i] = rand() & 0xF;
+  }
+
+  /* The scalar kernels are the reference */
+  for (uint16_t data = 0; data < 256; data++)
+  {
+    pixel_kernels_decode_tile_row(data, ~data, false, expected_pixels[data][0]);
+    pixel_kernels_decode_tile_row(data, ~data, true, expected_pixels[data][1]);
+  }
+  pixel_kernels_map_palette(indices, palette, expected_line_pixels, LINE_WIDTH);
+  pixel_kernels_expand_pixels(line_pixels, colors, expected_rgba, LINE_WIDTH);
+
+  for (uint8_t i = 0; i < sizeof(all_isas) / sizeof(all_isas[0]); i++)
+  {
+    if (pixel_kernels_select(all_isas[i]) != STATUS_OK)
+    {
+      /* Not supported by this CPU */
+      continue;
+    }
+
+    for (uint16_t data = 0; data < 256; data++)
+    {
+      uint8_t pixels[8];
+
+      pixel_kernels_decode_tile_row(data, ~data, false, pixels);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_pixels[data][0], pixels, 8);
+
+      pixel_kernels_decode_tile_row(data, ~data, true, pixels);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_pixels[data][1], pixels, 8);
+    }
+
+    /* Odd counts exercise the scalar tails of the vector loops */
+    for (uint16_t count = LINE_WIDTH - 7; count <= LINE_WIDTH; count++)
+    {
+      uint8_t pixels[LINE_WIDTH] = {0};
+      uint32_t rgba[LINE_WIDTH] = {0};
+
+      pixel_kernels_map_palette(indices, palette, pixels, count);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_line_pixels, pixels, count);
+
+      pixel_kernels_expand_pixels(line_pixels, colors, rgba, count);
+      TEST_ASSERT_EQUAL_UINT32_ARRAY(expected_rgba, rgba, count);
+    }
+  }
+}
@@ -0,0 +1,237 @@
+#include "unity.h"
+#include <string.h>
+
+#include "ppu.h"
+#include "lcd.h"
+#include "callback.h"
+#include "frame_buffer.h"
+#include "status_code.h"
+
+#include "mock_interrupt.h"
+#include "mock_oam.h"
+#include "mock_pixel_fifo.h"
+#include "mock_scanline_renderer.h"
+
+TEST_FILE("ppu.c")
+
+#define TICKS_PER_LINE (456)
+#define TICKS_PER_FRAME (154 * TICKS_PER_LINE)
+
+static ppu_handle_t ppu;
+static interrupt_handle_t interrupt;
+static bus_interface_t bus_interface;
+static callback_t fps_sync_callback;
+static uint32_t fps_sync_count;
+
+static status_code_t stub_fps_sync(void *const __attribute__((unused)) ctx, const void __attribute__((unused)) * arg)
+{
+  fps_sync_count++;
+  return STATUS_OK;
+}
+
+static bool vram_block_events[4];
+static uint8_t vram_block_count;
+
+static status_code_t stub_vram_block(void *const __attribute__((unused)) ctx, const void *arg)
+{
+  TEST_ASSERT_LESS_THAN(4, vram_block_count);
+  vram_block_events[vram_block_count++] = *(bool const *)arg;
+  return STATUS_OK;
+}
+
+static void set_mode(lcd_mode_t const mode, uint8_t const ly, uint32_t const line_ticks)
+{
+  ppu.lcd.registers.lcd_stat = (ppu.lcd.registers.lcd_stat & ~LCD_STAT_PPU_MODE) | mode;
+  ppu.lcd.registers.ly = ly;
+  ppu.line_ticks = line_ticks;
+}
+
+void setUp(void)
+{
+  ppu_init_param_t param = {
+      .bus_interface = &bus_interface,
+      .interrupt = &interrupt,
+  };
+
+  memset(&ppu, 0, sizeof(ppu_handle_t));
+  oam_init_IgnoreAndReturn(STATUS_OK);
+  pxfifo_init_IgnoreAndReturn(STATUS_OK);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_init(&ppu, &param));
+
+  fps_sync_count = 0;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, callback_init(&fps_sync_callback, stub_fps_sync, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_register_fps_sync_callback(&ppu, &fps_sync_callback));
+
+  /* Keep LYC out of the way unless a test needs it */
+  ppu.lcd.registers.ly_comp = 0xFF;
+}
+
+void tearDown(void)
+{
+}
+
+void test_ppu_advance_null_ptr(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, ppu_advance(NULL, 1));
+}
+
+void test_ppu_advance_skips_hblank(void)
+{
+  set_mode(MODE_HBLANK, 10, 200);
+  TEST_ASSERT_EQUAL_UINT32(TICKS_PER_LINE - 200, ppu_ticks_until_event(&ppu));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 255));
+  TEST_ASSERT_EQUAL_UINT32(455, ppu.line_ticks);
+  TEST_ASSERT_EQUAL_INT(10, ppu.lcd.registers.ly);
+  TEST_ASSERT_EQUAL_INT(MODE_HBLANK, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+
+  /* The next line starts with an OAM scan, raising the STAT interrupt if selected */
+  ppu.lcd.registers.lcd_stat |= LCD_STAT_OAM_SCAN_MODE_INT_SEL;
+  request_interrupt_ExpectAndReturn(&interrupt, INT_LCD, STATUS_OK);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, ppu.line_ticks);
+  TEST_ASSERT_EQUAL_INT(11, ppu.lcd.registers.ly);
+  TEST_ASSERT_EQUAL_INT(MODE_OAM_SCAN, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+}
+
+void test_ppu_advance_enters_vblank(void)
+{
+  set_mode(MODE_HBLANK, 143, 100);
+  ppu.lcd.registers.lcd_stat |= LCD_STAT_VBLANK_MODE_INT_SEL;
+
+  request_interrupt_ExpectAndReturn(&interrupt, INT_LCD, STATUS_OK);
+  request_interrupt_ExpectAndReturn(&interrupt, INT_VBLANK, STATUS_OK);
+
+  TEST_ASSERT_NULL(frame_buffer_acquire(&ppu.frame_buffer));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, TICKS_PER_LINE - 100 + 50));
+  TEST_ASSERT_NOT_NULL(frame_buffer_acquire(&ppu.frame_buffer));
+  TEST_ASSERT_EQUAL_INT(144, ppu.lcd.registers.ly);
+  TEST_ASSERT_EQUAL_UINT32(50, ppu.line_ticks);
+  TEST_ASSERT_EQUAL_INT(MODE_VBLANK, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+  TEST_ASSERT_EQUAL_UINT32(1, ppu.current_frame);
+  TEST_ASSERT_EQUAL_UINT32(1, fps_sync_count);
+}
+
+void test_ppu_advance_skips_vblank_with_lyc_interrupts(void)
+{
+  set_mode(MODE_VBLANK, 144, 0);
+  ppu.lcd.registers.ly_comp = 0;
+  ppu.lcd.registers.lcd_stat |= LCD_STAT_LYC_INT_SEL;
+
+  /* LY wraps from 153 to 0 4 dots into the last line, matching LYC */
+  request_interrupt_ExpectAndReturn(&interrupt, INT_LCD, STATUS_OK);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 9 * TICKS_PER_LINE + 4));
+  TEST_ASSERT_EQUAL_INT(0, ppu.lcd.registers.ly);
+  TEST_ASSERT_TRUE(ppu.lcd.registers.lcd_stat & LCD_STAT_LY_EQ_LYC);
+  TEST_ASSERT_EQUAL_INT(MODE_VBLANK, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, TICKS_PER_LINE - 4));
+  TEST_ASSERT_EQUAL_INT(0, ppu.lcd.registers.ly);
+  TEST_ASSERT_EQUAL_UINT32(0, ppu.line_ticks);
+  TEST_ASSERT_EQUAL_INT(MODE_OAM_SCAN, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+}
+
+void test_ppu_advance_oam_scan(void)
+{
+  set_mode(MODE_OAM_SCAN, 20, 0);
+
+  oam_scan_ExpectAndReturn(&ppu.oam, 20, 8, &ppu.pxfifo.pixel_fetcher.oam_scanned_sprites, STATUS_OK);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 79));
+  TEST_ASSERT_EQUAL_INT(MODE_OAM_SCAN, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+
+  pxfifo_reset_ExpectAndReturn(&ppu.pxfifo, STATUS_OK);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 1));
+  TEST_ASSERT_EQUAL_INT(MODE_XFER, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+}
+
+void test_ppu_advance_idles_with_lcd_off(void)
+{
+  set_mode(MODE_XFER, 50, 120);
+  ppu.lcd.registers.lcd_stat |= LCD_STAT_HBLANK_MODE_INT_SEL;
+  ppu.lcd.registers.lcd_ctrl &= ~LCD_CTRL_LCD_PPU_EN;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 1000));
+  TEST_ASSERT_EQUAL_INT(0, ppu.lcd.registers.ly);
+  TEST_ASSERT_EQUAL_INT(MODE_HBLANK, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+  TEST_ASSERT_EQUAL_UINT32(TICKS_PER_FRAME - 1000, ppu_ticks_until_event(&ppu));
+  TEST_ASSERT_EQUAL_UINT32(0, ppu.current_frame);
+
+  /* Frame boundaries keep occurring so the frame loop does not spin */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 2 * TICKS_PER_FRAME));
+  TEST_ASSERT_EQUAL_UINT32(2, ppu.current_frame);
+  TEST_ASSERT_EQUAL_UINT32(2, fps_sync_count);
+  TEST_ASSERT_EQUAL_INT(0, ppu.lcd.registers.ly);
+
+  /* Nothing is drawn, so the last frame stays on the display */
+  TEST_ASSERT_NULL(frame_buffer_acquire(&ppu.frame_buffer));
+}
+
+void test_ppu_advance_restarts_when_lcd_turned_on(void)
+{
+  ppu.lcd.registers.lcd_ctrl &= ~LCD_CTRL_LCD_PPU_EN;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 5000));
+
+  ppu.lcd.registers.lcd_ctrl |= LCD_CTRL_LCD_PPU_EN;
+  TEST_ASSERT_EQUAL_UINT32(1, ppu_ticks_until_event(&ppu));
+
+  oam_scan_ExpectAndReturn(&ppu.oam, 0, 8, &ppu.pxfifo.pixel_fetcher.oam_scanned_sprites, STATUS_OK);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 1));
+  TEST_ASSERT_EQUAL_INT(0, ppu.lcd.registers.ly);
+  TEST_ASSERT_EQUAL_UINT32(1, ppu.line_ticks);
+  TEST_ASSERT_EQUAL_INT(MODE_OAM_SCAN, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+  TEST_ASSERT_EQUAL_INT(0, ppu.lcd_off);
+}
+
+void test_ppu_advance_scanline_render_mode(void)
+{
+  ppu.render_mode = PPU_RENDER_MODE_SCANLINE;
+  set_mode(MODE_XFER, 30, 80);
+  TEST_ASSERT_EQUAL_UINT32(172, ppu_ticks_until_event(&ppu));
+
+  /* Pixel transfer takes a fixed number of dots, without shifting pixels out of the FIFO */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 171));
+  TEST_ASSERT_EQUAL_INT(MODE_XFER, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+
+  /* The whole line is drawn at once when it ends */
+  scanline_render_ExpectAnyArgsAndReturn(STATUS_OK);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 1));
+  TEST_ASSERT_EQUAL_INT(MODE_HBLANK, ppu.lcd.registers.lcd_stat & LCD_STAT_PPU_MODE);
+  TEST_ASSERT_EQUAL_UINT32(80 + 172, ppu.line_ticks);
+}
+
+void test_ppu_vram_block_callback(void)
+{
+  callback_t vram_block_callback;
+
+  vram_block_count = 0;
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, ppu_register_vram_block_callback(&ppu, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, callback_init(&vram_block_callback, stub_vram_block, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_register_vram_block_callback(&ppu, &vram_block_callback));
+
+  ppu.render_mode = PPU_RENDER_MODE_SCANLINE;
+  set_mode(MODE_OAM_SCAN, 30, 79);
+  TEST_ASSERT_TRUE(ppu_vram_accessible(&ppu));
+
+  /* VRAM is blocked for the whole pixel transfer, and the unused FIFO isn't reset for it */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 1));
+  TEST_ASSERT_FALSE(ppu_vram_accessible(&ppu));
+  TEST_ASSERT_EQUAL_UINT8(1, vram_block_count);
+  TEST_ASSERT_TRUE(vram_block_events[0]);
+
+  scanline_render_ExpectAnyArgsAndReturn(STATUS_OK);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 172));
+  TEST_ASSERT_TRUE(ppu_vram_accessible(&ppu));
+  TEST_ASSERT_EQUAL_UINT8(2, vram_block_count);
+  TEST_ASSERT_FALSE(vram_block_events[1]);
+
+  /* Turning the LCD off in the middle of pixel transfer releases VRAM */
+  set_mode(MODE_XFER, 31, 100);
+  ppu.lcd.registers.lcd_ctrl &= ~LCD_CTRL_LCD_PPU_EN;
+  TEST_ASSERT_TRUE(ppu_vram_accessible(&ppu));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, ppu_advance(&ppu, 1));
+  TEST_ASSERT_EQUAL_UINT8(3, vram_block_count);
+  TEST_ASSERT_FALSE(vram_block_events[2]);
+}
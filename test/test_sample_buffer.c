@@ -0,0 +1,98 @@
+#include "unity.h"
+#include <string.h>
+
+#include "sample_buffer.h"
+#include "status_code.h"
+
+TEST_FILE("sample_buffer.c")
+
+static sample_buffer_t sample_buffer;
+
+/** Fill frames with values that identify their position in the stream */
+static void make_frames(sample_frame_t *const frames, uint32_t const count, uint32_t const first)
+{
+  for (uint32_t i = 0; i < count; i++)
+  {
+    frames[i].left = (int16_t)(first + i);
+    frames[i].right = (int16_t)~(first + i);
+  }
+}
+
+void setUp(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, sample_buffer_init(&sample_buffer));
+}
+
+void tearDown(void)
+{
+}
+
+void test_sample_buffer_null_ptr(void)
+{
+  sample_frame_t frame = {0};
+
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, sample_buffer_init(NULL));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_write(NULL, &frame, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_write(&sample_buffer, NULL, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_read(NULL, &frame, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_read(&sample_buffer, NULL, 1));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_size(NULL));
+}
+
+void test_sample_buffer_read_empty(void)
+{
+  sample_frame_t frame = {0};
+
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_size(&sample_buffer));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_read(&sample_buffer, &frame, 1));
+}
+
+void test_sample_buffer_write_read(void)
+{
+  sample_frame_t frames[100];
+  sample_frame_t read_frames[100];
+
+  make_frames(frames, 100, 0);
+
+  TEST_ASSERT_EQUAL_UINT32(100, sample_buffer_write(&sample_buffer, frames, 100));
+  TEST_ASSERT_EQUAL_UINT32(100, sample_buffer_size(&sample_buffer));
+
+  /** Reads no more than what's available */
+  TEST_ASSERT_EQUAL_UINT32(60, sample_buffer_read(&sample_buffer, read_frames, 60));
+  TEST_ASSERT_EQUAL_UINT32(40, sample_buffer_read(&sample_buffer, &read_frames[60], 60));
+  TEST_ASSERT_EQUAL_MEMORY(frames, read_frames, sizeof(frames));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_size(&sample_buffer));
+}
+
+void test_sample_buffer_drops_when_full(void)
+{
+  static sample_frame_t frames[SAMPLE_BUFFER_CAPACITY + 10];
+  static sample_frame_t read_frames[SAMPLE_BUFFER_CAPACITY];
+
+  make_frames(frames, SAMPLE_BUFFER_CAPACITY + 10, 0);
+
+  TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUFFER_CAPACITY, sample_buffer_write(&sample_buffer, frames, SAMPLE_BUFFER_CAPACITY + 10));
+  TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUFFER_CAPACITY, sample_buffer_size(&sample_buffer));
+  TEST_ASSERT_EQUAL_UINT32(0, sample_buffer_write(&sample_buffer, frames, 1));
+
+  /** The oldest frames are kept */
+  TEST_ASSERT_EQUAL_UINT32(SAMPLE_BUFFER_CAPACITY, sample_buffer_read(&sample_buffer, read_frames, SAMPLE_BUFFER_CAPACITY));
+  TEST_ASSERT_EQUAL_MEMORY(frames, read_frames, sizeof(read_frames));
+}
+
+void test_sample_buffer_wrap_around(void)
+{
+  sample_frame_t frames[300];
+  sample_frame_t read_frames[300];
+  uint32_t first = 0;
+
+  /** Not a divisor of the capacity, so the writes and reads straddle the end of the storage */
+  for (uint16_t i = 0; i < 50; i++)
+  {
+    make_frames(frames, 300, first);
+    TEST_ASSERT_EQUAL_UINT32(300, sample_buffer_write(&sample_buffer, frames, 300));
+    TEST_ASSERT_EQUAL_UINT32(300, sample_buffer_read(&sample_buffer, read_frames, 300));
+    TEST_ASSERT_EQUAL_MEMORY(frames, read_frames, sizeof(frames));
+    first += 300;
+  }
+}
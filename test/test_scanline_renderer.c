@@ -0,0 +1,272 @@
+#include "unity.h"
+#include <string.h>
+
+#include "scanline_renderer.h"
+#include "bus_interface.h"
+#include "lcd.h"
+#include "oam.h"
+#include "pixel_kernels.h"
+#include "status_code.h"
+#include "tile_cache.h"
+#include "vram_test_helper.h"
+
+TEST_FILE("scanline_renderer.c")
+
+static uint8_t vram[VRAM_SIZE];
+static bus_interface_t bus_interface;
+static lcd_handle_t lcd;
+static oam_scanned_sprites_t scanned_sprites;
+static scanline_renderer_context_t ctx;
+static uint8_t line_buffer[SCREEN_WIDTH];
+
+/** Fill a tile row so that every pixel in it has the given color index */
+static void fill_tile(uint16_t const tile_addr, uint8_t const color_index)
+{
+  for (uint8_t i = 0; i < 16; i += 2)
+  {
+    vram[tile_addr - VRAM_BASE_ADDR + i] = (color_index & 0x1) ? 0xFF : 0x00;
+    vram[tile_addr - VRAM_BASE_ADDR + i + 1] = (color_index & 0x2) ? 0xFF : 0x00;
+  }
+}
+
+/** Indexed pixel value of a color of a palette, which tells which palette it came from */
+static uint8_t pixel_of(palette_type_t const palette, uint8_t const color_index)
+{
+  return (palette << LCD_PIXEL_PALETTE_SHIFT) | ((lcd.registers.buffer[0x7 + palette] >> (color_index * 2)) & 0x3);
+}
+
+void setUp(void)
+{
+  memset(vram, 0, sizeof(vram));
+  memset(line_buffer, 0, sizeof(line_buffer));
+  memset(&scanned_sprites, 0, sizeof(scanned_sprites));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_init(&bus_interface, stub_vram_read, stub_vram_write, vram));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, lcd_init(&lcd));
+
+  /* Identity palettes so that color index N maps to shade N */
+  lcd.registers.lcd_ctrl = LCD_CTRL_LCD_PPU_EN | LCD_CTRL_BGW_TILE_DATA | LCD_CTRL_BGW_EN | LCD_CTRL_OBJ_EN;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&lcd.bus_interface, 0x0007, 0xE4));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&lcd.bus_interface, 0x0008, 0xE4));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_write(&lcd.bus_interface, 0x0009, 0x1B));
+
+  ctx = (scanline_renderer_context_t){
+      .lcd_handle = &lcd,
+      .bus_interface = &bus_interface,
+      .scanned_sprites = &scanned_sprites,
+      .window_line = 0,
+  };
+}
+
+void tearDown(void)
+{
+}
+
+void test_scanline_render_null_ptr(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, scanline_render(NULL, line_buffer));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, scanline_render(&ctx, NULL));
+
+  ctx.bus_interface = NULL;
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, scanline_render(&ctx, line_buffer));
+}
+
+void test_scanline_render_background_with_scroll(void)
+{
+  /* Tile 1 is solid color 3, and is placed at map position (1, 1) */
+  fill_tile(0x8010, 3);
+  vram[0x9800 + 32 + 1 - VRAM_BASE_ADDR] = 1;
+
+  lcd.registers.ly = 2;
+  lcd.registers.scroll_y = 6;
+  lcd.registers.scroll_x = 4;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+
+  /* Line 8 of the map, shifted left by 4 pixels: the tile covers screen X 4-11 */
+  for (uint8_t x = 0; x < SCREEN_WIDTH; x++)
+  {
+    uint8_t const expected = ((x >= 4) && (x < 12)) ? 3 : 0;
+    TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, expected), line_buffer[x]);
+  }
+}
+
+void test_scanline_render_signed_tile_addressing(void)
+{
+  /* Tile -1 is right below 0x9000 in 0x8800 addressing mode */
+  fill_tile(0x8FF0, 2);
+  vram[0x9800 - VRAM_BASE_ADDR] = 0xFF;
+  lcd.registers.lcd_ctrl &= ~LCD_CTRL_BGW_TILE_DATA;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 2), line_buffer[0]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 2), line_buffer[7]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 0), line_buffer[8]);
+}
+
+void test_scanline_render_bgw_disabled(void)
+{
+  fill_tile(0x8000, 3);
+  lcd.registers.lcd_ctrl &= ~LCD_CTRL_BGW_EN;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+
+  for (uint8_t x = 0; x < SCREEN_WIDTH; x++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 0), line_buffer[x]);
+  }
+}
+
+void test_scanline_render_window(void)
+{
+  /* The window uses the 0x9C00 map, filled with tile 2 (solid color 1) */
+  fill_tile(0x8020, 1);
+  memset(&vram[0x9C00 - VRAM_BASE_ADDR], 2, 32 * 32);
+
+  lcd.registers.lcd_ctrl |= LCD_CTRL_WINDOW_EN | LCD_CTRL_WINDOW_TILE_MAP;
+  lcd.registers.ly = 40;
+  lcd.registers.window_y = 30;
+  lcd.registers.window_x = 87;
+  ctx.window_line = 10;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 0), line_buffer[79]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 1), line_buffer[80]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 1), line_buffer[SCREEN_WIDTH - 1]);
+
+  /* Not drawn above WY */
+  lcd.registers.ly = 29;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 0), line_buffer[80]);
+}
+
+void test_scanline_render_sprite_over_background(void)
+{
+  /* Tile 1: only the leftmost pixel of each row is opaque (color 2) */
+  for (uint8_t i = 0; i < 16; i += 2)
+  {
+    vram[0x10 + i + 1] = 0x80;
+  }
+
+  lcd.registers.ly = 20;
+  add_scanned_sprite(&scanned_sprites, 18, 30, 1, 0);
+  add_scanned_sprite(&scanned_sprites, 38, 30, 1, OAM_ATTR_X_FLIP | OAM_ATTR_DMG_PALETTE_NUM);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_OBJ_0, 2), line_buffer[10]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 0), line_buffer[11]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 0), line_buffer[30]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_OBJ_1, 2), line_buffer[37]);
+}
+
+void test_scanline_render_sprite_behind_background(void)
+{
+  /* Tile 1 is solid color 1 and covers the left half of the background */
+  fill_tile(0x8010, 1);
+  fill_tile(0x8020, 3);
+  memset(&vram[0x9800 - VRAM_BASE_ADDR], 1, 10);
+
+  add_scanned_sprite(&scanned_sprites, 84, 16, 2, OAM_ATTR_BG_PRIORITY);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+
+  /* Hidden where the background is not color 0, visible elsewhere */
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 1), line_buffer[79]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_OBJ_0, 3), line_buffer[80]);
+}
+
+void test_scanline_render_sprite_priority(void)
+{
+  fill_tile(0x8010, 1);
+  fill_tile(0x8020, 3);
+
+  /* The first sprite wins where they overlap */
+  add_scanned_sprite(&scanned_sprites, 20, 16, 1, OAM_ATTR_BG_PRIORITY);
+  add_scanned_sprite(&scanned_sprites, 24, 16, 2, 0);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_OBJ_0, 1), line_buffer[12]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_OBJ_0, 1), line_buffer[19]);
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_OBJ_0, 3), line_buffer[20]);
+
+  /* Sprites are not drawn if disabled */
+  lcd.registers.lcd_ctrl &= ~LCD_CTRL_OBJ_EN;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_BGW, 0), line_buffer[12]);
+}
+
+void test_scanline_render_tall_sprite(void)
+{
+  /* In 8x16 mode the low bit of the tile index is ignored; line 9 comes from the second tile */
+  fill_tile(0x8040, 1);
+  fill_tile(0x8050, 2);
+  lcd.registers.lcd_ctrl |= LCD_CTRL_OBJ_SIZE;
+  lcd.registers.ly = 9;
+  add_scanned_sprite(&scanned_sprites, 8, 16, 5, 0);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_OBJ_0, 2), line_buffer[0]);
+
+  /* Flipped vertically, line 9 comes from the first tile */
+  scanned_sprites.sprite_attributes[0].attrs = OAM_ATTR_Y_FLIP;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+  TEST_ASSERT_EQUAL_UINT8(pixel_of(PALETTE_OBJ_0, 1), line_buffer[0]);
+}
+
+void test_scanline_render_same_with_tile_cache(void)
+{
+  tile_cache_t tile_cache;
+  uint8_t cached_line_buffer[SCREEN_WIDTH];
+
+  /* Arbitrary tile data and maps, with flipped sprites and the window */
+  for (uint16_t i = 0; i < VRAM_SIZE; i++)
+  {
+    vram[i] = (uint8_t)((i * 37) ^ (i >> 3));
+  }
+
+  lcd.registers.lcd_ctrl |= LCD_CTRL_WINDOW_EN | LCD_CTRL_OBJ_SIZE;
+  lcd.registers.ly = 45;
+  lcd.registers.scroll_x = 13;
+  lcd.registers.window_y = 40;
+  lcd.registers.window_x = 100;
+  ctx.window_line = 5;
+  add_scanned_sprite(&scanned_sprites, 20, 50, 0x31, OAM_ATTR_X_FLIP);
+  add_scanned_sprite(&scanned_sprites, 60, 55, 0x42, OAM_ATTR_Y_FLIP | OAM_ATTR_DMG_PALETTE_NUM);
+  add_scanned_sprite(&scanned_sprites, 110, 60, 0x07, OAM_ATTR_X_FLIP | OAM_ATTR_Y_FLIP | OAM_ATTR_BG_PRIORITY);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, tile_cache_init(&tile_cache, vram));
+  ctx.tile_cache = &tile_cache;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, cached_line_buffer));
+
+  TEST_ASSERT_EQUAL_MEMORY(line_buffer, cached_line_buffer, sizeof(line_buffer));
+}
+
+void test_scanline_render_reads_vram_directly(void)
+{
+  bus_interface_t blocked_bus_interface;
+  uint8_t direct_line_buffer[SCREEN_WIDTH];
+
+  for (uint16_t i = 0; i < VRAM_SIZE; i++)
+  {
+    vram[i] = (uint8_t)((i * 37) ^ (i >> 3));
+  }
+
+  lcd.registers.lcd_ctrl |= LCD_CTRL_WINDOW_EN;
+  lcd.registers.ly = 45;
+  lcd.registers.window_y = 40;
+  lcd.registers.window_x = 100;
+  add_scanned_sprite(&scanned_sprites, 20, 50, 0x31, OAM_ATTR_X_FLIP);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, line_buffer));
+
+  /* The bus is never used once the renderer has a pointer to VRAM */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, bus_interface_init(&blocked_bus_interface, stub_blocked_read, stub_vram_write, vram));
+  ctx.bus_interface = &blocked_bus_interface;
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_GENERIC, scanline_render(&ctx, direct_line_buffer));
+
+  ctx.vram = vram;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scanline_render(&ctx, direct_line_buffer));
+  TEST_ASSERT_EQUAL_MEMORY(line_buffer, direct_line_buffer, sizeof(line_buffer));
+}
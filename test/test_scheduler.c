@@ -0,0 +1,196 @@
+#include "unity.h"
+#include <string.h>
+
+#include "scheduler.h"
+#include "callback.h"
+#include "status_code.h"
+
+TEST_FILE("scheduler.c")
+
+#define MAX_FIRED_EVENTS (8)
+
+typedef struct
+{
+  scheduler_t *scheduler;
+  scheduler_event_t event;
+  uint64_t reschedule_interval;
+} handler_ctx_t;
+
+static scheduler_t scheduler;
+static callback_t handlers[SCHEDULER_EVENT_COUNT];
+static handler_ctx_t handler_ctx[SCHEDULER_EVENT_COUNT];
+static scheduler_event_t fired_events[MAX_FIRED_EVENTS];
+static uint64_t fired_timestamps[MAX_FIRED_EVENTS];
+static uint8_t fired_count;
+
+static status_code_t stub_event_handler(void *const ctx, const void *arg)
+{
+  handler_ctx_t *const handler_ctx = (handler_ctx_t *)ctx;
+  uint64_t const timestamp = *(uint64_t *)arg;
+
+  TEST_ASSERT_LESS_THAN(MAX_FIRED_EVENTS, fired_count);
+  fired_events[fired_count] = handler_ctx->event;
+  fired_timestamps[fired_count] = timestamp;
+  fired_count++;
+
+  if (handler_ctx->reschedule_interval)
+  {
+    return scheduler_schedule(handler_ctx->scheduler, handler_ctx->event, timestamp + handler_ctx->reschedule_interval);
+  }
+
+  return STATUS_OK;
+}
+
+void setUp(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_init(&scheduler));
+
+  for (scheduler_event_t event = 0; event < SCHEDULER_EVENT_COUNT; event++)
+  {
+    handler_ctx[event].scheduler = &scheduler;
+    handler_ctx[event].event = event;
+    handler_ctx[event].reschedule_interval = 0;
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, callback_init(&handlers[event], stub_event_handler, &handler_ctx[event]));
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_register_handler(&scheduler, event, &handlers[event]));
+  }
+
+  memset(fired_events, 0, sizeof(fired_events));
+  memset(fired_timestamps, 0, sizeof(fired_timestamps));
+  fired_count = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_scheduler_null_ptr(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, scheduler_init(NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, scheduler_register_handler(NULL, SCHEDULER_EVENT_TIMER, &handlers[0]));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, scheduler_register_handler(&scheduler, SCHEDULER_EVENT_TIMER, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, scheduler_schedule(NULL, SCHEDULER_EVENT_TIMER, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, scheduler_cancel(NULL, SCHEDULER_EVENT_TIMER));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, scheduler_run_until(NULL, 0));
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(NULL) == SCHEDULER_NO_EVENT);
+  TEST_ASSERT_TRUE(scheduler_event_timestamp(NULL, SCHEDULER_EVENT_TIMER) == SCHEDULER_NO_EVENT);
+}
+
+void test_scheduler_invalid_event(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, scheduler_register_handler(&scheduler, SCHEDULER_EVENT_COUNT, &handlers[0]));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, scheduler_schedule(&scheduler, SCHEDULER_EVENT_COUNT, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, scheduler_cancel(&scheduler, SCHEDULER_EVENT_COUNT));
+  TEST_ASSERT_TRUE(scheduler_event_timestamp(&scheduler, SCHEDULER_EVENT_COUNT) == SCHEDULER_NO_EVENT);
+}
+
+void test_scheduler_empty_queue(void)
+{
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == SCHEDULER_NO_EVENT);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_run_until(&scheduler, UINT64_MAX - 1));
+  TEST_ASSERT_EQUAL_INT(0, fired_count);
+}
+
+void test_scheduler_next_timestamp_is_earliest_event(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_TIMER, 300));
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == 300);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_PPU, 80));
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == 80);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_DMA, 120));
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == 80);
+}
+
+void test_scheduler_event_timestamp(void)
+{
+  TEST_ASSERT_TRUE(scheduler_event_timestamp(&scheduler, SCHEDULER_EVENT_TIMER) == SCHEDULER_NO_EVENT);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_TIMER, 300));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_PPU, 80));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_DMA, 120));
+  TEST_ASSERT_TRUE(scheduler_event_timestamp(&scheduler, SCHEDULER_EVENT_TIMER) == 300);
+  TEST_ASSERT_TRUE(scheduler_event_timestamp(&scheduler, SCHEDULER_EVENT_PPU) == 80);
+  TEST_ASSERT_TRUE(scheduler_event_timestamp(&scheduler, SCHEDULER_EVENT_DMA) == 120);
+
+  /* Events that have fired or been cancelled are no longer queued */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_cancel(&scheduler, SCHEDULER_EVENT_TIMER));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_run_until(&scheduler, 100));
+  TEST_ASSERT_TRUE(scheduler_event_timestamp(&scheduler, SCHEDULER_EVENT_TIMER) == SCHEDULER_NO_EVENT);
+  TEST_ASSERT_TRUE(scheduler_event_timestamp(&scheduler, SCHEDULER_EVENT_PPU) == SCHEDULER_NO_EVENT);
+  TEST_ASSERT_TRUE(scheduler_event_timestamp(&scheduler, SCHEDULER_EVENT_DMA) == 120);
+}
+
+void test_scheduler_reschedule_moves_event(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_TIMER, 100));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_PPU, 200));
+
+  /* Moving an event later must not leave a stale copy of it on the queue */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_TIMER, 500));
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == 200);
+
+  /* Moving an event earlier */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_TIMER, 50));
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == 50);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_run_until(&scheduler, 1000));
+  TEST_ASSERT_EQUAL_INT(2, fired_count);
+  TEST_ASSERT_EQUAL_INT(SCHEDULER_EVENT_TIMER, fired_events[0]);
+  TEST_ASSERT_EQUAL_INT(SCHEDULER_EVENT_PPU, fired_events[1]);
+}
+
+void test_scheduler_cancel(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_TIMER, 100));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_PPU, 200));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_cancel(&scheduler, SCHEDULER_EVENT_TIMER));
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == 200);
+
+  /* Cancelling an event that is not queued has no effect */
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_cancel(&scheduler, SCHEDULER_EVENT_TIMER));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_cancel(&scheduler, SCHEDULER_EVENT_DMA));
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == 200);
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_run_until(&scheduler, 1000));
+  TEST_ASSERT_EQUAL_INT(1, fired_count);
+  TEST_ASSERT_EQUAL_INT(SCHEDULER_EVENT_PPU, fired_events[0]);
+}
+
+void test_scheduler_run_until_fires_due_events_in_order(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_DMA, 40));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_TIMER, 20));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_PPU, 60));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_run_until(&scheduler, 40));
+  TEST_ASSERT_EQUAL_INT(2, fired_count);
+  TEST_ASSERT_EQUAL_INT(SCHEDULER_EVENT_TIMER, fired_events[0]);
+  TEST_ASSERT_TRUE(fired_timestamps[0] == 20);
+  TEST_ASSERT_EQUAL_INT(SCHEDULER_EVENT_DMA, fired_events[1]);
+  TEST_ASSERT_TRUE(fired_timestamps[1] == 40);
+
+  /* Events that are not yet due stay queued */
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == 60);
+}
+
+void test_scheduler_handler_can_reschedule_its_event(void)
+{
+  handler_ctx[SCHEDULER_EVENT_DMA].reschedule_interval = 4;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_DMA, 4));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_schedule(&scheduler, SCHEDULER_EVENT_PPU, 10));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, scheduler_run_until(&scheduler, 12));
+  TEST_ASSERT_EQUAL_INT(4, fired_count);
+  TEST_ASSERT_EQUAL_INT(SCHEDULER_EVENT_DMA, fired_events[0]);
+  TEST_ASSERT_TRUE(fired_timestamps[0] == 4);
+  TEST_ASSERT_EQUAL_INT(SCHEDULER_EVENT_DMA, fired_events[1]);
+  TEST_ASSERT_TRUE(fired_timestamps[1] == 8);
+  TEST_ASSERT_EQUAL_INT(SCHEDULER_EVENT_PPU, fired_events[2]);
+  TEST_ASSERT_TRUE(fired_timestamps[2] == 10);
+  TEST_ASSERT_EQUAL_INT(SCHEDULER_EVENT_DMA, fired_events[3]);
+  TEST_ASSERT_TRUE(fired_timestamps[3] == 12);
+
+  TEST_ASSERT_TRUE(scheduler_next_timestamp(&scheduler) == 16);
+}
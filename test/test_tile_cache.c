@@ -0,0 +1,79 @@
+#include "unity.h"
+#include <string.h>
+
+#include "tile_cache.h"
+#include "pixel_kernels.h"
+#include "status_code.h"
+
+TEST_FILE("tile_cache.c")
+
+static tile_cache_t cache;
+static uint8_t tile_data[TILE_CACHE_TILE_DATA_SIZE];
+
+void setUp(void)
+{
+  memset(tile_data, 0, sizeof(tile_data));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, tile_cache_init(&cache, tile_data));
+}
+
+void tearDown(void)
+{
+}
+
+void test_tile_cache_null_ptr(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, tile_cache_init(NULL, tile_data));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, tile_cache_init(&cache, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, tile_cache_update(NULL, tile_data, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, tile_cache_update(&cache, NULL, 0));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, tile_cache_mark_clean(NULL, 0));
+}
+
+void test_tile_cache_out_of_bound(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_ADDRESS_OUT_OF_BOUND, tile_cache_update(&cache, tile_data, TILE_CACHE_TILE_DATA_SIZE));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_INVALID_ARG, tile_cache_mark_clean(&cache, TILE_CACHE_NUM_TILES));
+}
+
+void test_tile_cache_init_decodes_all_tiles(void)
+{
+  uint8_t const expected[TILE_CACHE_TILE_SIZE] = {1, 1, 1, 1, 0, 0, 0, 0};
+  uint8_t const expected_flipped[TILE_CACHE_TILE_SIZE] = {0, 0, 0, 0, 1, 1, 1, 1};
+
+  /* Last row of the last tile */
+  tile_data[TILE_CACHE_TILE_DATA_SIZE - 2] = 0xF0;
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, tile_cache_init(&cache, tile_data));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, tile_cache_row(&cache, TILE_CACHE_NUM_TILES - 1, 7, false), TILE_CACHE_TILE_SIZE);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_flipped, tile_cache_row(&cache, TILE_CACHE_NUM_TILES - 1, 7, true), TILE_CACHE_TILE_SIZE);
+
+  for (uint16_t i = 0; i < TILE_CACHE_NUM_TILES; i++)
+  {
+    TEST_ASSERT_TRUE(cache.dirty[i]);
+  }
+}
+
+void test_tile_cache_update_row(void)
+{
+  uint8_t const expected[TILE_CACHE_TILE_SIZE] = {2, 2, 0, 0, 0, 0, 0, 0};
+  uint8_t const expected_blank[TILE_CACHE_TILE_SIZE] = {0};
+
+  for (uint16_t i = 0; i < TILE_CACHE_NUM_TILES; i++)
+  {
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, tile_cache_mark_clean(&cache, i));
+  }
+
+  /* High byte of row 3 of tile 0x90 */
+  tile_data[(0x90 * 16) + (3 * 2) + 1] = 0xC0;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, tile_cache_update(&cache, tile_data, (0x90 * 16) + (3 * 2) + 1));
+
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, tile_cache_row(&cache, 0x90, 3, false), TILE_CACHE_TILE_SIZE);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, tile_cache_row_at(&cache, 0x8000 + (0x90 * 16) + (3 * 2), false), TILE_CACHE_TILE_SIZE);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_blank, tile_cache_row(&cache, 0x90, 2, false), TILE_CACHE_TILE_SIZE);
+
+  /* Only the modified tile is dirty */
+  for (uint16_t i = 0; i < TILE_CACHE_NUM_TILES; i++)
+  {
+    TEST_ASSERT_EQUAL_UINT8(i == 0x90, cache.dirty[i]);
+  }
+}
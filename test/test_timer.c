@@ -0,0 +1,235 @@
+#include "unity.h"
+#include <string.h>
+
+#include "timer.h"
+#include "bus_interface.h"
+#include "status_code.h"
+
+#include "mock_interrupt.h"
+
+TEST_FILE("timer.c")
+
+static timer_handle_t timer;
+static interrupt_handle_t interrupt;
+
+static uint8_t read_reg(uint16_t const address)
+{
+  uint8_t data = 0;
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, timer.bus_interface.read(&timer, address, &data));
+  return data;
+}
+
+static void write_reg(uint16_t const address, uint8_t const data)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, timer.bus_interface.write(&timer, address, data));
+}
+
+static void advance(uint32_t const ticks)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, timer_advance(&timer, ticks));
+}
+
+void setUp(void)
+{
+  memset(&timer, 0, sizeof(timer_handle_t));
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, timer_init(&timer, &interrupt));
+}
+
+void tearDown(void)
+{
+}
+
+void test_timer_null_ptr(void)
+{
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, timer_init(NULL, &interrupt));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, timer_init(&timer, NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, timer_tick(NULL));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_NULL_PTR, timer_advance(NULL, 1));
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, timer_ticks_until_event(NULL));
+}
+
+void test_timer_register_address_out_of_bound(void)
+{
+  uint8_t data;
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_ADDRESS_OUT_OF_BOUND, timer.bus_interface.read(&timer, 4, &data));
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_ADDRESS_OUT_OF_BOUND, timer.bus_interface.write(&timer, 4, 0));
+}
+
+void test_timer_div_counts_t_cycles(void)
+{
+  /* Internal DIV counter starts at 0xABCC */
+  TEST_ASSERT_EQUAL_HEX8(0xAB, read_reg(0));
+
+  advance(0x33);
+  TEST_ASSERT_EQUAL_HEX8(0xAB, read_reg(0));
+
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, timer_tick(&timer));
+  TEST_ASSERT_EQUAL_HEX8(0xAC, read_reg(0));
+
+  advance(0x5400);
+  TEST_ASSERT_EQUAL_HEX8(0x00, read_reg(0));
+}
+
+void test_timer_div_write_resets_div(void)
+{
+  advance(1000);
+  write_reg(0, 0x5A);
+  TEST_ASSERT_EQUAL_HEX8(0x00, read_reg(0));
+
+  advance(255);
+  TEST_ASSERT_EQUAL_HEX8(0x00, read_reg(0));
+
+  advance(1);
+  TEST_ASSERT_EQUAL_HEX8(0x01, read_reg(0));
+}
+
+void test_timer_tima_frozen_when_disabled(void)
+{
+  write_reg(1, 0x10);
+  write_reg(3, 0x01);
+
+  advance(4096);
+  TEST_ASSERT_EQUAL_HEX8(0x10, read_reg(1));
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, timer_ticks_until_event(&timer));
+}
+
+void test_timer_tima_increments_at_selected_rate(void)
+{
+  uint32_t const periods[] = {1024, 16, 64, 256};
+
+  for (uint8_t clock_select = 0; clock_select < 4; clock_select++)
+  {
+    write_reg(0, 0);
+    write_reg(1, 0x00);
+    write_reg(3, TMR_TAC_ENABLE | clock_select);
+
+    advance(periods[clock_select] - 1);
+    TEST_ASSERT_EQUAL_HEX8(0x00, read_reg(1));
+
+    advance(1);
+    TEST_ASSERT_EQUAL_HEX8(0x01, read_reg(1));
+
+    advance(periods[clock_select] * 10);
+    TEST_ASSERT_EQUAL_HEX8(0x0B, read_reg(1));
+  }
+}
+
+void test_timer_overflow_reloads_tma_and_requests_interrupt(void)
+{
+  write_reg(0, 0);
+  write_reg(1, 0xFD);
+  write_reg(2, 0x80);
+  write_reg(3, TMR_TAC_ENABLE | 0x01);
+
+  /* TIMA overflows when it reaches 0xFF, two increments from 0xFD */
+  TEST_ASSERT_EQUAL_UINT32(32, timer_ticks_until_event(&timer));
+
+  advance(31);
+  TEST_ASSERT_EQUAL_HEX8(0xFE, read_reg(1));
+
+  request_interrupt_ExpectAndReturn(&interrupt, INT_TIMER, STATUS_OK);
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, timer_tick(&timer));
+  TEST_ASSERT_EQUAL_HEX8(0x80, read_reg(1));
+
+  /* The next overflow counts up from the reloaded TMA value */
+  TEST_ASSERT_EQUAL_UINT32(0x7F * 16, timer_ticks_until_event(&timer));
+}
+
+void test_timer_advance_handles_multiple_overflows(void)
+{
+  write_reg(0, 0);
+  write_reg(1, 0xFE);
+  write_reg(2, 0xFE);
+  write_reg(3, TMR_TAC_ENABLE | 0x01);
+
+  request_interrupt_ExpectAndReturn(&interrupt, INT_TIMER, STATUS_OK);
+  request_interrupt_ExpectAndReturn(&interrupt, INT_TIMER, STATUS_OK);
+  request_interrupt_ExpectAndReturn(&interrupt, INT_TIMER, STATUS_OK);
+
+  advance(16 * 3 + 8);
+  TEST_ASSERT_EQUAL_HEX8(0xFE, read_reg(1));
+  TEST_ASSERT_EQUAL_UINT32(8, timer_ticks_until_event(&timer));
+}
+
+void test_timer_overflow_error_is_propagated(void)
+{
+  write_reg(1, 0xFE);
+  write_reg(3, TMR_TAC_ENABLE | 0x01);
+
+  request_interrupt_ExpectAndReturn(&interrupt, INT_TIMER, STATUS_ERR_GENERIC);
+  TEST_ASSERT_EQUAL_INT(STATUS_ERR_GENERIC, timer_advance(&timer, 16));
+}
+
+void test_timer_tima_0xff_write_takes_full_wraparound(void)
+{
+  write_reg(0, 0);
+  write_reg(1, 0xFF);
+  write_reg(3, TMR_TAC_ENABLE | 0x01);
+
+  TEST_ASSERT_EQUAL_UINT32(0x100 * 16, timer_ticks_until_event(&timer));
+
+  advance(16);
+  TEST_ASSERT_EQUAL_HEX8(0x00, read_reg(1));
+}
+
+void test_timer_div_write_restarts_prescaler(void)
+{
+  write_reg(0, 0);
+  write_reg(1, 0x00);
+  write_reg(3, TMR_TAC_ENABLE | 0x01);
+
+  /* Resetting DIV just before the falling edge delays the increment by a full period */
+  advance(15);
+  write_reg(0, 0);
+  TEST_ASSERT_EQUAL_HEX8(0x00, read_reg(1));
+
+  advance(15);
+  TEST_ASSERT_EQUAL_HEX8(0x00, read_reg(1));
+
+  advance(1);
+  TEST_ASSERT_EQUAL_HEX8(0x01, read_reg(1));
+}
+
+void test_timer_tac_change_preserves_tima(void)
+{
+  write_reg(0, 0);
+  write_reg(1, 0x00);
+  write_reg(3, TMR_TAC_ENABLE | 0x01);
+
+  advance(16 * 5 + 4);
+  TEST_ASSERT_EQUAL_HEX8(0x05, read_reg(1));
+
+  /* Switch to the 64 T-cycle rate; DIV has counted 84 cycles so the next edge is at 128 */
+  write_reg(3, TMR_TAC_ENABLE | 0x02);
+  TEST_ASSERT_EQUAL_HEX8(0x05, read_reg(1));
+
+  advance(43);
+  TEST_ASSERT_EQUAL_HEX8(0x05, read_reg(1));
+
+  advance(1);
+  TEST_ASSERT_EQUAL_HEX8(0x06, read_reg(1));
+
+  /* Disabling the timer freezes TIMA at its current value */
+  advance(64 * 2);
+  write_reg(3, 0x02);
+  advance(1024);
+  TEST_ASSERT_EQUAL_HEX8(0x08, read_reg(1));
+}
+
+void test_timer_tick_matches_advance(void)
+{
+  timer_handle_t reference;
+
+  write_reg(1, 0x20);
+  write_reg(3, TMR_TAC_ENABLE | 0x03);
+  memcpy(&reference, &timer, sizeof(timer_handle_t));
+
+  for (uint32_t t = 0; t < 1000; t++)
+  {
+    TEST_ASSERT_EQUAL_INT(STATUS_OK, timer_tick(&timer));
+  }
+  TEST_ASSERT_EQUAL_INT(STATUS_OK, timer_advance(&reference, 1000));
+
+  TEST_ASSERT_EQUAL_MEMORY(&reference.registers, &timer.registers, sizeof(timer_registers_t));
+  TEST_ASSERT_EQUAL_MEMORY(&reference.state, &timer.state, sizeof(timer_state_t));
+}